@@ -0,0 +1,563 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <chrono>
+
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "TestSetup.h"
+#undef INCLUDE_TESTSETUP_WITHOUT_BOOST
+
+extern "C"
+{
+#include <solv/pool.h>
+}
+
+#include "zypp/base/GzStream.h"
+#include "zypp/base/Json.h"
+#include "zypp/base/Regex.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/Digest.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/PoolQuery.h"
+#include "zypp/Fetcher.h"
+#include "zypp/MediaSetAccess.h"
+#include "zypp/HistoryLogData.h"
+#include "zypp/media/MediaBlockList.h"
+#include "zypp/parser/HistoryLogReader.h"
+
+#include "WebServer.h"
+
+using std::endl;
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+//
+// Micro benchmarks for the hot paths on the data below tests/data:
+// loading solv files, building the whatprovides index, PoolQuery,
+// solving testcases, downloading from a loopback server, parsing
+// the history, parsing mirror urls, reusing blocks of an old file,
+// starting programs, and on generated data: hashing and copying files.
+// Each scenario is set up once; the setup is not timed.
+//
+//   zypp-bench [--repeat N] [--filter SUBSTR] [--output FILE] [--list]
+//
+// Results (ms per iteration) are written as JSON to stdout or FILE.
+//
+///////////////////////////////////////////////////////////////////
+
+static std::string appname( "zypp-bench" );
+
+int errexit( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+    std::cerr << endl << msg_r << endl << endl;
+  return exit_r;
+}
+
+int usage( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+    std::cerr << endl << msg_r << endl << endl;
+  std::cerr << "Usage: " << appname << " [OPTIONS]" << endl;
+  std::cerr << "  Run the benchmark scenarios and report the timings as JSON." << endl;
+  std::cerr << endl;
+  std::cerr << "  --repeat N       Timed iterations per scenario (default 10)." << endl;
+  std::cerr << "  --filter SUBSTR  Run only scenarios whose name contains SUBSTR." << endl;
+  std::cerr << "  --output FILE    Write the JSON report to FILE instead of stdout." << endl;
+  std::cerr << "  --list           Just list the scenarios." << endl;
+  return exit_r;
+}
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  /** A time in ms, written as JSON number. */
+  struct Ms
+  {
+    Ms( double val_r ) : _val( val_r ) {}
+    std::string asJSON() const { return str::form( "%.3f", _val ); }
+    double _val;
+  };
+
+  /** A benchmark: \c setup once, then \c run timed, finally \c teardown. */
+  struct Scenario
+  {
+    std::string name;
+    std::string description;
+    std::function<void()> setup;
+    std::function<void()> run;
+    std::function<void()> teardown;
+  };
+
+  /** Nearest rank percentile of the sorted \a ms_r. */
+  double percentile( const std::vector<double> & ms_r, unsigned p_r )
+  {
+    size_t rank = ( ms_r.size() * p_r + 99 ) / 100;
+    return ms_r[rank ? rank-1 : 0];
+  }
+
+  json::Object report( const Scenario & scenario_r, std::vector<double> ms_r )
+  {
+    std::sort( ms_r.begin(), ms_r.end() );
+    double sum = 0;
+    for ( double ms : ms_r )
+      sum += ms;
+    json::Object ret;
+    ret.add( "name",		scenario_r.name );
+    ret.add( "description",	scenario_r.description );
+    ret.add( "iterations",	unsigned(ms_r.size()) );
+    ret.add( "min_ms",		Ms( ms_r.front() ) );
+    ret.add( "median_ms",	Ms( percentile( ms_r, 50 ) ) );
+    ret.add( "p90_ms",		Ms( percentile( ms_r, 90 ) ) );
+    ret.add( "p99_ms",		Ms( percentile( ms_r, 99 ) ) );
+    ret.add( "max_ms",		Ms( ms_r.back() ) );
+    ret.add( "mean_ms",		Ms( sum / ms_r.size() ) );
+    return ret;
+  }
+
+  /** Keep the compiler from dropping results. */
+  volatile unsigned sink = 0;
+
+  ///////////////////////////////////////////////////////////////////
+  /// Pool states the scenarios work on. Switching is part of the setup.
+  ///////////////////////////////////////////////////////////////////
+  struct Bench
+  {
+    Bench()
+    : _test( Arch_x86_64 )
+    {}
+
+    /** The repos below tests/data, loaded from their solv caches. */
+    void useRepos()
+    {
+      if ( _state == "repos" )
+        return;
+      _test.satpool().reposEraseAll();
+      ZConfig::instance().setSystemArchitecture( Arch_x86_64 );
+      if ( _solvfiles.empty() )
+      {
+        // initial load builds the caches
+        for ( const auto & repo : repos() )
+        {
+          _test.loadRepo( Pathname( TESTS_SRC_DIR "/data" ) / repo.first, repo.second );
+          _solvfiles.push_back( RepoManagerOptions::makeTestSetup( _test.root() ).repoSolvCachePath / repo.second / "solv" );
+        }
+      }
+      else
+        loadSolvFiles();
+      _state = "repos";
+    }
+
+    void loadSolvFiles()
+    {
+      _test.satpool().reposEraseAll();
+      for ( const Pathname & solv : _solvfiles )
+      {
+        RepoInfo nrepo;
+        nrepo.setAlias( solv.dirname().basename() );
+        _test.satpool().addRepoSolv( solv, nrepo );
+      }
+    }
+
+    /** A solver testcase below tests/data. */
+    void useTestcase( const std::string & tc_r )
+    {
+      if ( _state == tc_r )
+        return;
+      _test.satpool().reposEraseAll();
+      _test.loadTestcaseRepos( Pathname( TESTS_SRC_DIR "/data" ) / tc_r );
+      _state = tc_r;
+    }
+
+    static std::vector<std::pair<std::string,std::string>> repos()
+    { return { { "openSUSE-11.1", "opensuse" }, { "11.0-update", "update" }, { "OBS_zypp_svn-11.1", "zyppsvn" } }; }
+
+    TestSetup _test;
+    std::string _state;
+    std::vector<Pathname> _solvfiles;
+  };
+
+  Scenario queryScenario( Bench & bench_r, const std::string & name_r, const std::string & description_r,
+                          const std::function<void(PoolQuery&)> & prepare_r )
+  {
+    return Scenario{ name_r, description_r,
+      [&bench_r]() { bench_r.useRepos(); },
+      [prepare_r]() {
+        PoolQuery q;
+        prepare_r( q );
+        sink += q.size();
+      } };
+  }
+
+  Scenario resolveScenario( Bench & bench_r, const std::string & tc_r, bool upgrade_r )
+  {
+    return Scenario{ "resolve_" + tc_r, ( upgrade_r ? "Resolver::doUpgrade on testcase " : "Resolver::resolvePool on testcase " ) + tc_r,
+      [&bench_r,tc_r]() { bench_r.useTestcase( tc_r ); },
+      [&bench_r,upgrade_r]() {
+        Resolver & resolver( bench_r._test.resolver() );
+        sink += ( upgrade_r ? resolver.doUpgrade() : resolver.resolvePool() );
+      } };
+  }
+
+  /** Blocklist for \a data_r like metalink (full checksum) or zsync (short sums) provide it. */
+  media::MediaBlockList blockList( const std::string & data_r, size_t blksize_r, bool zsync_r )
+  {
+    media::MediaBlockList bl( data_r.size() );
+    std::string type( zsync_r ? "MD5" : "SHA1" );
+    int rsumlen = zsync_r ? 2 : 4;
+    for ( size_t off = 0; off < data_r.size(); off += blksize_r )
+    {
+      size_t size = std::min( blksize_r, data_r.size() - off );
+      size_t blkno = bl.addBlock( off, size );
+
+      Digest dig;
+      dig.create( type );
+      dig.update( data_r.data() + off, size );
+      std::string pad( blksize_r - size, '\0' );
+      dig.update( pad.data(), pad.size() );
+      std::vector<unsigned char> sum( dig.digestVector() );
+      bl.setChecksum( blkno, type, zsync_r ? 4 : sum.size(), &sum[0], blksize_r );
+
+      unsigned int rs = bl.updateRsum( 0, data_r.data() + off, size );
+      rs = bl.updateRsum( rs, pad.data(), pad.size() );
+      bl.setRsum( blkno, rsumlen, zsync_r ? rs & 0xffff : rs, blksize_r );
+    }
+    return bl;
+  }
+
+  Scenario reuseBlocksScenario( bool zsync_r )
+  {
+    // two versions of the same metadata
+    static std::string data;
+    static filesystem::TmpFile oldFile;
+    std::shared_ptr<media::MediaBlockList> bl( new media::MediaBlockList );
+    return Scenario{ zsync_r ? "blocks_reuse_zsync" : "blocks_reuse_metalink",
+      std::string( "MediaBlockList::reuseBlocks of openSUSE-11.1 packages.en from packages.cs, 1KiB blocks with " )
+      + ( zsync_r ? "MD5 and 2 byte rsums" : "SHA1 and 4 byte rsums" ),
+      [bl,zsync_r]() {
+        if ( data.empty() )
+        {
+          ifgzstream in( TESTS_SRC_DIR "/data/openSUSE-11.1/suse/setup/descr/packages.en.gz" );
+          data.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+          ifgzstream old( TESTS_SRC_DIR "/data/openSUSE-11.1/suse/setup/descr/packages.cs.gz" );
+          std::ofstream( oldFile.path().c_str() ) << old.rdbuf();
+        }
+        *bl = blockList( data, 1024, zsync_r );
+      },
+      [bl]() {
+        // reuseBlocks removes the blocks found, so work on a copy
+        media::MediaBlockList work( *bl );
+        filesystem::TmpFile target;
+        AutoDispose<FILE*> wfp( ::fopen( target.path().c_str(), "w" ), ::fclose );
+        work.reuseBlocks( wfp, oldFile.path().asString() );
+        sink += work.numBlocks();
+      } };
+  }
+
+  std::vector<Scenario> scenarios( Bench & bench_r )
+  {
+    std::vector<Scenario> ret;
+
+    ret.push_back( Scenario{ "solv_load", "Load the solv caches of 3 repos into an empty pool",
+      [&bench_r]() { bench_r.useRepos(); },
+      [&bench_r]() { bench_r.loadSolvFiles(); sink += bench_r._test.satpool().solvablesSize(); } } );
+
+    ret.push_back( Scenario{ "whatprovides", "pool_createwhatprovides on the loaded repos",
+      [&bench_r]() { bench_r.useRepos(); },
+      []() { ::pool_createwhatprovides( sat::Pool::instance().get() ); } } );
+
+    ret.push_back( queryScenario( bench_r, "query_name_exact", "PoolQuery: name is 'zypper'",
+      []( PoolQuery & q ) { q.addAttribute( sat::SolvAttr::name, "zypper" ); q.setMatchExact(); } ) );
+    ret.push_back( queryScenario( bench_r, "query_name_substring", "PoolQuery: name contains 'lib'",
+      []( PoolQuery & q ) { q.addAttribute( sat::SolvAttr::name, "lib" ); q.setMatchSubstring(); } ) );
+    ret.push_back( queryScenario( bench_r, "query_name_glob", "PoolQuery: name matches 'yast2-*'",
+      []( PoolQuery & q ) { q.addAttribute( sat::SolvAttr::name, "yast2-*" ); q.setMatchGlob(); } ) );
+    ret.push_back( queryScenario( bench_r, "query_summary_regex", "PoolQuery: summary matches '[Ll]ibrar(y|ies)$'",
+      []( PoolQuery & q ) { q.addAttribute( sat::SolvAttr::summary, "[Ll]ibrar(y|ies)$" ); q.setMatchRegex(); } ) );
+    ret.push_back( queryScenario( bench_r, "query_provides", "PoolQuery: provides 'perl >= 5'",
+      []( PoolQuery & q ) { q.addDependency( sat::SolvAttr::provides, "perl", Rel::GE, Edition( "5" ) ); } ) );
+    ret.push_back( queryScenario( bench_r, "query_filelist", "PoolQuery: filelist contains '/usr/bin/'",
+      []( PoolQuery & q ) { q.addAttribute( sat::SolvAttr::filelist, "/usr/bin/" ); q.setMatchSubstring(); q.setFilesMatchFullPath(); } ) );
+
+    ret.push_back( resolveScenario( bench_r, "TCSelectable", false ) );
+    ret.push_back( resolveScenario( bench_r, "TCWhatObsoletes", false ) );
+    ret.push_back( resolveScenario( bench_r, "TCdup", true ) );
+
+    // loopback downloads; a port of its own as tests may run in parallel
+    static std::shared_ptr<WebServer> server;
+    ret.push_back( Scenario{ "fetcher_download", "Fetcher: 5 files from openSUSE-11.1 via a loopback http server",
+      []() {
+        server.reset( new WebServer( TESTS_SRC_DIR "/data/openSUSE-11.1", 10007 ) );
+        server->start();
+      },
+      []() {
+        filesystem::TmpDir dest;
+        MediaSetAccess media( server->url(), "/" );
+        Fetcher fetcher;
+        for ( const char * file : { "/content", "/media.1/media", "/suse/setup/descr/packages.gz",
+                                    "/suse/setup/descr/packages.en.gz", "/suse/setup/descr/packages.DU.gz" } )
+          fetcher.enqueue( OnMediaLocation( file ) );
+        fetcher.start( dest.path(), media );
+      },
+      []() {
+        server->stop();
+        server.reset();
+      } } );
+
+    static filesystem::TmpDir historyDir;
+    ret.push_back( Scenario{ "history_parse", "HistoryLogReader::readAll on 100000 entries",
+      []() {
+        std::ofstream out( ( historyDir.path() / "history" ).c_str() );
+        Date start( Date::now() - 100000 * 60 );
+        for ( unsigned i = 0; i < 100000; ++i )
+        {
+          Date d( Date::ValueType(start) + 60 * i );
+          if ( i % 10 == 0 )
+            out << "# " << d.form( HISTORY_LOG_DATE_FORMAT ) << " some comment" << endl;
+          out << d.form( HISTORY_LOG_DATE_FORMAT )
+              << ( i % 2 ? "|remove |" : "|install|" ) << "pkg" << (i % 100) << "|1-" << i << "|x86_64|";
+          if ( i % 2 )
+            out << "|" << endl;
+          else
+            out << "|repo|d99de2872270cbd436b0c10af85c286a1365a348|" << endl;
+        }
+      },
+      []() {
+        parser::HistoryLogReader parser( historyDir.path() / "history", parser::HistoryLogReader::Options(),
+                                         []( HistoryLogData::Ptr ptr )->bool { ++sink; return true; } );
+        parser.setIgnoreInvalidItems( true );
+        parser.readAll();
+      } } );
+
+    // 16 x 4MiB files, hashed one by one via istream or by Digest::digestFiles
+    static filesystem::TmpDir digestDir;
+    static std::vector<Pathname> digestFiles;
+    auto digestSetup = []() {
+      if ( ! digestFiles.empty() )
+        return;
+      std::string data( 4 * 1024 * 1024, 'x' );
+      for ( unsigned i = 0; i < 16; ++i )
+      {
+        digestFiles.push_back( digestDir.path() / str::numstring( i ) );
+        std::ofstream( digestFiles.back().c_str() ) << data << i;
+      }
+    };
+    ret.push_back( Scenario{ "digest_istream", "sha256 of 16 x 4MiB files via istream Digest::digest",
+      digestSetup,
+      []() {
+        for ( const Pathname & file : digestFiles )
+        {
+          std::ifstream istr( file.c_str() );
+          sink += Digest::digest( "sha256", istr ).size();
+        }
+      } } );
+    ret.push_back( Scenario{ "digest_files", "sha256 of 16 x 4MiB files via Digest::digestFiles",
+      digestSetup,
+      []() { sink += Digest::digestFiles( "sha256", digestFiles ).size(); } } );
+
+    // the same files copied by forking /bin/cp or in-process by filesystem::copy
+    static filesystem::TmpDir copyDir;
+    ret.push_back( Scenario{ "copy_cp", "Copy 16 x 4MiB files by /bin/cp --remove-destination",
+      digestSetup,
+      []() {
+        for ( const Pathname & file : digestFiles )
+        {
+          Pathname dest( copyDir.path() / file.basename() );
+          const char *const argv[] = { "/bin/cp", "--remove-destination", "--", file.c_str(), dest.c_str(), NULL };
+          sink += ExternalProgram( argv, ExternalProgram::Stderr_To_Stdout ).close();
+        }
+      } } );
+    ret.push_back( Scenario{ "copy_filesystem", "Copy 16 x 4MiB files by filesystem::copy",
+      digestSetup,
+      []() {
+        for ( const Pathname & file : digestFiles )
+          sink += filesystem::copy( file, copyDir.path() / file.basename() );
+      } } );
+
+    ret.push_back( reuseBlocksScenario( false ) );
+    ret.push_back( reuseBlocksScenario( true ) );
+
+    // 100 x 'true' started from a process with a big heap, which makes fork expensive
+    static std::vector<char> spawnHeap;
+    auto spawnSetup = []() { spawnHeap.assign( 256 * 1024 * 1024, 'x' ); };
+    auto spawnTeardown = []() { std::vector<char>().swap( spawnHeap ); };
+    ret.push_back( Scenario{ "spawn_fork", "Start 100 x 'true' by fork/exec with a 256MiB heap",
+      spawnSetup,
+      []() {
+        for ( unsigned i = 0; i < 100; ++i )
+        {
+          pid_t pid = ::fork();
+          if ( pid == 0 )
+          {
+            for ( int fd = ::getdtablesize() - 1; fd > 2; --fd )
+              ::close( fd );
+            ::execlp( "true", "true", (char *)NULL );
+            ::_exit( 129 );
+          }
+          int status = 0;
+          ::waitpid( pid, &status, 0 );
+          sink += status;
+        }
+      },
+      spawnTeardown } );
+    ret.push_back( Scenario{ "spawn_externalprogram", "Start 100 x 'true' by ExternalProgram with a 256MiB heap",
+      spawnSetup,
+      []() {
+        for ( unsigned i = 0; i < 100; ++i )
+        {
+          const char *const argv[] = { "true", NULL };
+          sink += ExternalProgram( argv ).close();
+        }
+      },
+      spawnTeardown } );
+
+    // the urls of a real mirrorlist, split by the former regex or parsed by Url
+    static std::vector<std::string> mirrorUrls;
+    auto mirrorUrlsSetup = []() {
+      if ( ! mirrorUrls.empty() )
+        return;
+      std::ifstream in( TESTS_SRC_DIR "/media/data/openSUSE-11.3-NET-i586.iso.metalink" );
+      str::regex rx( "<url[^>]*>([^<]+)</url>" );
+      str::smatch what;
+      std::string line;
+      while ( std::getline( in, line ) )
+      {
+        if ( str::regex_match( line, what, rx ) )
+          mirrorUrls.push_back( what[1] );
+      }
+    };
+    ret.push_back( Scenario{ "url_split_regex", "Split 100 x the metalink mirror urls by the former RX_SPLIT_URL",
+      mirrorUrlsSetup,
+      []() {
+        for ( unsigned i = 0; i < 100; ++i )
+        {
+          for ( const std::string & url : mirrorUrls )
+          {
+            str::regex rx( "^([^:/?#]+:|)(//[^/?#]*|)([^?#]*)([?][^#]*|)(#.*|)" );
+            str::smatch what;
+            sink += str::regex_match( url, what, rx );
+          }
+        }
+      } } );
+    ret.push_back( Scenario{ "url_parse", "Parse and validate 100 x the metalink mirror urls as Url",
+      mirrorUrlsSetup,
+      []() {
+        for ( unsigned i = 0; i < 100; ++i )
+        {
+          for ( const std::string & url : mirrorUrls )
+            sink += Url( url ).isValid();
+        }
+      } } );
+
+    return ret;
+  }
+} // namespace
+
+/******************************************************************
+**
+**      FUNCTION NAME : main
+**      FUNCTION TYPE : int
+*/
+int main( int argc, char * argv[] )
+{
+  appname = Pathname::basename( argv[0] );
+  --argc,++argv;
+
+  unsigned repeat = 10;
+  std::string filter;
+  Pathname output;
+  bool list = false;
+
+  while ( argc )
+  {
+    std::string arg( argv[0] );
+    if ( arg == "--list" )
+      list = true;
+    else if ( arg == "--repeat" || arg == "--filter" || arg == "--output" )
+    {
+      if ( argc < 2 )
+        return usage( "Missing argument to " + arg );
+      --argc,++argv;
+      if ( arg == "--repeat" )
+      {
+        repeat = str::strtonum<unsigned>( argv[0] );
+        if ( ! repeat )
+          return usage( "Invalid --repeat " + std::string( argv[0] ) );
+      }
+      else if ( arg == "--filter" )
+        filter = argv[0];
+      else
+        output = argv[0];
+    }
+    else if ( arg == "--help" || arg == "-h" )
+      return usage( std::string(), 0 );
+    else
+      return usage( "Unknown argument " + arg );
+    --argc,++argv;
+  }
+
+  Bench bench;
+  std::vector<Scenario> all( scenarios( bench ) );
+
+  if ( list )
+  {
+    for ( const Scenario & scenario : all )
+      std::cout << scenario.name << "\t" << scenario.description << endl;
+    return 0;
+  }
+
+  json::Array results;
+  for ( const Scenario & scenario : all )
+  {
+    if ( ! filter.empty() && scenario.name.find( filter ) == std::string::npos )
+      continue;
+
+    std::vector<double> ms;
+    try
+    {
+      MIL << "Bench " << scenario.name << " setup" << endl;
+      scenario.setup();
+      scenario.run();	// warmup
+      for ( unsigned i = 0; i < repeat; ++i )
+      {
+        Clock::time_point start( Clock::now() );
+        scenario.run();
+        ms.push_back( std::chrono::duration<double,std::milli>( Clock::now() - start ).count() );
+      }
+      if ( scenario.teardown )
+        scenario.teardown();
+    }
+    catch ( const Exception & excpt )
+    {
+      ZYPP_CAUGHT( excpt );
+      return errexit( scenario.name + ": " + excpt.asUserHistory() );
+    }
+
+    json::Object result( report( scenario, ms ) );
+    MIL << "Bench " << result << endl;
+    std::cerr << scenario.name << ": " << result << endl;
+    results.add( result );
+  }
+
+  json::Object doc;
+  doc.add( "repeat", repeat );
+  doc.add( "scenarios", results );
+
+  if ( output.empty() )
+    std::cout << doc << endl;
+  else
+  {
+    std::ofstream out( output.c_str() );
+    out << doc << endl;
+    if ( ! out )
+      return errexit( "Unable to write " + output.asString() );
+  }
+  return 0;
+}
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+#
+# Write the minimal noarch test packages in this directory without
+# needing rpmbuild. The packages carry no files, an empty cpio payload
+# and (unless --nosign) are signed with private.asc:
+#
+#   GNUPGHOME=$(mktemp -d) ; gpg --import private.asc
+#   ./mkrpm.py foo 1.0 1 --provides foo-capability --requires bar-capability \
+#              --conflicts foo-old
+#   ./mkrpm.py bar 1.0 1 --provides bar-capability
+#
+import argparse
+import gzip
+import hashlib
+import io
+import struct
+import subprocess
+import tempfile
+import os
+
+T_CHAR, T_INT8, T_INT16, T_INT32, T_INT64, T_STRING, T_BIN, T_STRING_ARRAY, T_I18NSTRING = range(1, 10)
+ALIGN = {T_INT16: 2, T_INT32: 4, T_INT64: 8}
+
+RPMSENSE_EQUAL = 8
+
+def header(entries, region):
+    """entries: list of (tag, type, value); value is str, bytes or list"""
+    entries = sorted(entries)
+    index = b''
+    data = b''
+    for tag, typ, value in entries:
+        align = ALIGN.get(typ, 1)
+        data += b'\0' * (-len(data) % align)
+        if typ == T_STRING:
+            blob, count = value.encode() + b'\0', 1
+        elif typ in (T_STRING_ARRAY, T_I18NSTRING):
+            blob, count = b''.join(v.encode() + b'\0' for v in value), len(value)
+        elif typ == T_INT32:
+            blob, count = b''.join(struct.pack('>I', v) for v in value), len(value)
+        elif typ == T_BIN:
+            blob, count = value, len(value)
+        else:
+            raise ValueError(typ)
+        index += struct.pack('>iIiI', tag, typ, len(data), count)
+        data += blob
+    il = len(entries) + 1
+    # immutable region: the trailer is stored at the end of the data
+    trailer = struct.pack('>iIiI', region, T_BIN, -(il * 16), 16)
+    index = struct.pack('>iIiI', region, T_BIN, len(data), 16) + index
+    data += trailer
+    return b'\x8e\xad\xe8\x01\0\0\0\0' + struct.pack('>II', il, len(data)) + index + data
+
+def cpio_payload():
+    def entry(name, mode=0, nlink=1):
+        fields = [0, mode, 0, 0, nlink, 0, 0, 0, 0, 0, 0, len(name) + 1, 0]
+        hdr = b'070701' + b''.join(b'%08X' % f for f in fields) + name.encode() + b'\0'
+        return hdr + b'\0' * (-len(hdr) % 4)
+    archive = entry('TRAILER!!!')
+    out = io.BytesIO()
+    with gzip.GzipFile(fileobj=out, mode='wb', mtime=0) as gz:
+        gz.write(archive)
+    return out.getvalue(), len(archive)
+
+def gpgsign(blob):
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'data')
+        with open(src, 'wb') as f:
+            f.write(blob)
+        subprocess.check_call(['gpg', '--batch', '--quiet', '--digest-algo', 'SHA256',
+                               '--detach-sign', src])
+        with open(src + '.sig', 'rb') as f:
+            return f.read()
+
+def deps(names, tagname, tagflags, tagversion, evr=None):
+    if not names:
+        return []
+    return [(tagname, T_STRING_ARRAY, names),
+            (tagflags, T_INT32, [RPMSENSE_EQUAL if evr and i == 0 else 0 for i in range(len(names))]),
+            (tagversion, T_STRING_ARRAY, [evr if evr and i == 0 else '' for i in range(len(names))])]
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument('name')
+    ap.add_argument('version')
+    ap.add_argument('release')
+    ap.add_argument('--provides', action='append', default=[])
+    ap.add_argument('--requires', action='append', default=[])
+    ap.add_argument('--conflicts', action='append', default=[])
+    ap.add_argument('--nosign', action='store_true')
+    ap.add_argument('-o', '--output')
+    args = ap.parse_args()
+
+    nvr = '%s-%s-%s' % (args.name, args.version, args.release)
+    evr = '%s-%s' % (args.version, args.release)
+    entries = [
+        (100, T_STRING_ARRAY, ['C']),
+        (1000, T_STRING, args.name),
+        (1001, T_STRING, args.version),
+        (1002, T_STRING, args.release),
+        (1004, T_I18NSTRING, ['%s test package' % args.name]),
+        (1005, T_I18NSTRING, ['Empty %s package for the libzypp testsuite.' % args.name]),
+        (1006, T_INT32, [1451606400]),
+        (1009, T_INT32, [0]),
+        (1014, T_STRING, 'GPL-2.0+'),
+        (1016, T_I18NSTRING, ['Development/Testsuite']),
+        (1021, T_STRING, 'linux'),
+        (1022, T_STRING, 'noarch'),
+        (1044, T_STRING, '%s.src.rpm' % nvr),
+        (1124, T_STRING, 'cpio'),
+        (1125, T_STRING, 'gzip'),
+        (1126, T_STRING, '9'),
+    ]
+    entries += deps([args.name] + args.provides, 1047, 1112, 1113, evr)
+    entries += deps(args.requires, 1049, 1048, 1050)
+    entries += deps(args.conflicts, 1054, 1053, 1055)
+
+    hdr = header(entries, 63)
+    payload, payloadsize = cpio_payload()
+    sigs = [
+        (269, T_STRING, hashlib.sha1(hdr).hexdigest()),
+        (1000, T_INT32, [len(hdr) + len(payload)]),
+        (1004, T_BIN, hashlib.md5(hdr + payload).digest()),
+        (1007, T_INT32, [payloadsize]),
+    ]
+    if not args.nosign:
+        sigs += [(268, T_BIN, gpgsign(hdr)),
+                 (1002, T_BIN, gpgsign(hdr + payload))]
+    sig = header(sigs, 62)
+    sig += b'\0' * (-len(sig) % 8)
+
+    lead = struct.pack('>4sBBhh66shh16x', b'\xed\xab\xee\xdb', 3, 0, 0, 1,
+                       nvr.encode(), 1, 5)
+    with open(args.output or '%s.noarch.rpm' % nvr, 'wb') as f:
+        f.write(lead + sig + hdr + payload)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/GzStream.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/TmpPath.h"
+#include "zypp/media/MediaBlockList.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  // two versions of the same metadata
+  const Pathname newFile( TESTS_SRC_DIR "/data/openSUSE-11.1/suse/setup/descr/packages.en.gz" );
+  const Pathname oldFile( TESTS_SRC_DIR "/data/openSUSE-11.1/suse/setup/descr/packages.cs.gz" );
+
+  string readGz( const Pathname & file_r )
+  {
+    ifgzstream in( file_r.c_str() );
+    return string( istreambuf_iterator<char>( in ), istreambuf_iterator<char>() );
+  }
+
+  /** Blocklist for \a data_r like metalink (full checksum) or zsync (short sums) provide it. */
+  MediaBlockList blockList( const string & data_r, size_t blksize_r, bool zsync_r )
+  {
+    MediaBlockList bl( data_r.size() );
+    string type( zsync_r ? "MD5" : "SHA1" );
+    int rsumlen = zsync_r ? 2 : 4;
+    for ( size_t off = 0; off < data_r.size(); off += blksize_r )
+    {
+      size_t size = min( blksize_r, data_r.size() - off );
+      size_t blkno = bl.addBlock( off, size );
+
+      Digest dig;
+      dig.create( type );
+      dig.update( data_r.data() + off, size );
+      string pad( blksize_r - size, '\0' );
+      dig.update( pad.data(), pad.size() );
+      vector<unsigned char> sum( dig.digestVector() );
+      bl.setChecksum( blkno, type, zsync_r ? 4 : sum.size(), &sum[0], blksize_r );
+
+      unsigned int rs = bl.updateRsum( 0, data_r.data() + off, size );
+      rs = bl.updateRsum( rs, pad.data(), pad.size() );
+      bl.setRsum( blkno, rsumlen, zsync_r ? rs & 0xffff : rs, blksize_r );
+    }
+    return bl;
+  }
+
+  /** Reuse blocks from \a old_r, check the blocks written and return the number reused. */
+  size_t reuse( const string & data_r, MediaBlockList & bl_r, const Pathname & old_r )
+  {
+    filesystem::TmpFile target;
+    size_t nblks = bl_r.numBlocks();
+    vector<MediaBlock> blocks;
+    for ( size_t i = 0; i < nblks; ++i )
+      blocks.push_back( bl_r.getBlock( i ) );
+    {
+      AutoDispose<FILE*> wfp( ::fopen( target.path().c_str(), "w" ), ::fclose );
+      bl_r.reuseBlocks( wfp, old_r.asString() );
+    }
+
+    // blocks no longer in the list were written to target
+    ifstream in( target.path().c_str() );
+    string written( (istreambuf_iterator<char>( in )), istreambuf_iterator<char>() );
+    size_t left = 0;
+    for ( const MediaBlock & blk : blocks )
+    {
+      if ( left < bl_r.numBlocks() && bl_r.getBlock( left ).off == blk.off )
+      {
+        ++left;
+        continue;
+      }
+      BOOST_REQUIRE( written.size() >= size_t(blk.off) + blk.size );
+      BOOST_CHECK( written.compare( blk.off, blk.size, data_r, blk.off, blk.size ) == 0 );
+    }
+    BOOST_CHECK_EQUAL( left, bl_r.numBlocks() );
+    return nblks - bl_r.numBlocks();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(rsum)
+{
+  MediaBlockList bl;
+  string data( "The quick brown fox jumps over the lazy dog" );
+  // updating in pieces is the same as updating at once
+  unsigned int rs = bl.updateRsum( 0, data.data(), 10 );
+  rs = bl.updateRsum( rs, data.data() + 10, data.size() - 10 );
+  BOOST_CHECK_EQUAL( rs, bl.updateRsum( 0, data.data(), data.size() ) );
+  BOOST_CHECK_EQUAL( bl.updateRsum( 0, "\x01\x02\x03", 3 ), ( 6U << 16 ) | 10U );
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks)
+{
+  string data( readGz( newFile ) );
+  BOOST_REQUIRE( ! data.empty() );
+  filesystem::TmpFile same;
+  ofstream( same.path().c_str() ) << data;
+
+  for ( bool zsync : { false, true } )
+  {
+    // identical file: everything is reused
+    MediaBlockList bl( blockList( data, 2048, zsync ) );
+    size_t nblks = bl.numBlocks();
+    BOOST_CHECK_EQUAL( reuse( data, bl, same.path() ), nblks );
+    BOOST_CHECK_EQUAL( bl.numBlocks(), 0 );
+
+    // older version: most of it
+    filesystem::TmpFile old;
+    ofstream( old.path().c_str() ) << readGz( oldFile );
+    bl = blockList( data, 1024, zsync );
+    nblks = bl.numBlocks();
+    size_t reused = reuse( data, bl, old.path() );
+    BOOST_CHECK( reused * 10 > nblks * 9 );
+    BOOST_CHECK( reused < nblks );
+  }
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/TmpPath.h"
+#include "zypp/media/MediaCurl.h"
+
+#include "WebServer.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+BOOST_AUTO_TEST_CASE(check_modified)
+{
+  filesystem::TmpDir docroot;
+  ofstream( (docroot.path() / "repomd.xml").c_str() ) << "<repomd/>" << endl;
+
+  WebServer web( docroot.path(), 10001 );
+  web.start();
+
+  vector<MediaCurl::ConditionalRequest> requests;
+  // unconditional: the validators are returned
+  requests.push_back( MediaCurl::ConditionalRequest( web.url(), "repomd.xml" ) );
+  // not modified since
+  requests.push_back( MediaCurl::ConditionalRequest( web.url(), "repomd.xml" ) );
+  requests.back().lastModified = "Fri, 01 Jan 2038 00:00:00 GMT";
+  // modified since
+  requests.push_back( MediaCurl::ConditionalRequest( web.url(), "repomd.xml" ) );
+  requests.back().lastModified = "Fri, 01 Jan 2010 00:00:00 GMT";
+  // missing
+  requests.push_back( MediaCurl::ConditionalRequest( web.url(), "missing.xml" ) );
+  // not reachable
+  requests.push_back( MediaCurl::ConditionalRequest( Url( "http://localhost:10002/" ), "repomd.xml" ) );
+
+  MediaCurl::checkModified( requests );
+
+  BOOST_CHECK_EQUAL( requests[0].httpCode, 200 );
+  BOOST_CHECK( requests[0].error.empty() );
+  BOOST_CHECK( ! requests[0].newLastModified.empty() );
+  BOOST_CHECK( ! requests[0].newEtag.empty() );
+
+  BOOST_CHECK_EQUAL( requests[1].httpCode, 304 );
+  BOOST_CHECK( requests[1].error.empty() );
+
+  BOOST_CHECK_EQUAL( requests[2].httpCode, 200 );
+
+  BOOST_CHECK_EQUAL( requests[3].httpCode, 0 );
+  BOOST_CHECK( ! requests[3].error.empty() );
+
+  BOOST_CHECK_EQUAL( requests[4].httpCode, 0 );
+  BOOST_CHECK( ! requests[4].error.empty() );
+
+  web.stop();
+}
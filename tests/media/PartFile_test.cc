@@ -0,0 +1,269 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/AutoDispose.h"
+#include "zypp/Digest.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/MediaSetAccess.h"
+#include "zypp/media/PartFile.h"
+#include "zypp/media/MediaBlockList.h"
+#include "zypp/media/MediaCurl.h"
+
+#include "WebServer.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace zypp
+{
+  void reconfigureZConfig( const Pathname & );
+}
+
+namespace
+{
+  const Url testUrl( "http://localhost/dir/file.gz" );
+
+  string readFile( const Pathname & file_r )
+  {
+    ifstream in( file_r.c_str() );
+    return string( istreambuf_iterator<char>( in ), istreambuf_iterator<char>() );
+  }
+
+  /** Blocklist for \a data_r like a metalink provides it. */
+  MediaBlockList blockList( const string & data_r, size_t blksize_r )
+  {
+    MediaBlockList bl( data_r.size() );
+    for ( size_t off = 0; off < data_r.size(); off += blksize_r )
+    {
+      size_t size = min( blksize_r, data_r.size() - off );
+      size_t blkno = bl.addBlock( off, size );
+      Digest dig;
+      dig.create( "SHA1" );
+      dig.update( data_r.data() + off, size );
+      vector<unsigned char> sum( dig.digestVector() );
+      bl.setChecksum( blkno, "SHA1", sum.size(), &sum[0] );
+    }
+    return bl;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(state)
+{
+  filesystem::TmpDir dir;
+  {
+    PartFile part( testUrl, dir.path() );
+    BOOST_CHECK( ! part.load() );	// nothing there
+    BOOST_REQUIRE( part.reset() );
+    ofstream( part.path().c_str() ) << "0123456789";
+    part.setValidators( "\"abc\"", "Thu, 01 Jan 2015 00:00:00 GMT" );
+    part.addRange( 0, 4 );
+    part.addRange( 6, 8 );
+    part.addRange( 4, 5 );	// adjacent: merged
+    BOOST_CHECK_EQUAL( part.ranges().size(), 2 );
+    BOOST_CHECK_EQUAL( part.resumeOffset(), 5 );
+    BOOST_CHECK( part.save() );
+  }
+  {
+    PartFile part( testUrl, dir.path() );
+    BOOST_REQUIRE( part.load() );
+    BOOST_CHECK( ! part.metalink() );
+    BOOST_CHECK_EQUAL( part.etag(), "\"abc\"" );
+    BOOST_CHECK_EQUAL( part.ifRange(), "\"abc\"" );
+    BOOST_CHECK_EQUAL( part.ranges().size(), 2 );
+    BOOST_CHECK_EQUAL( part.resumeOffset(), 5 );
+
+    // weak etags can't guard a range request
+    part.setValidators( "W/\"abc\"", "Thu, 01 Jan 2015 00:00:00 GMT" );
+    BOOST_CHECK_EQUAL( part.ifRange(), "Thu, 01 Jan 2015 00:00:00 GMT" );
+
+    // no ranges recorded (crashed): continue at the end of the data
+    part.clearRanges();
+    BOOST_CHECK_EQUAL( part.resumeOffset(), 10 );
+    part.addRange( 2, 4 );
+    BOOST_CHECK_EQUAL( part.resumeOffset(), 0 );
+  }
+  {
+    // same file, different url: dropped
+    PartFile part( testUrl, dir.path() );
+    ofstream( part.statePath().c_str() ) << "url http://localhost/other" << endl;
+    BOOST_CHECK( ! part.load() );
+    BOOST_CHECK( ! PathInfo( part.path() ).isExist() );
+    BOOST_CHECK( ! PathInfo( part.statePath() ).isExist() );
+  }
+  {
+    // completed
+    PartFile part( testUrl, dir.path() );
+    BOOST_REQUIRE( part.reset() );
+    ofstream( part.path().c_str() ) << "data";
+    part.save();
+    filesystem::TmpDir dest;
+    BOOST_CHECK_EQUAL( part.commit( dest.path() / "file.gz" ), 0 );
+    BOOST_CHECK_EQUAL( readFile( dest.path() / "file.gz" ), "data" );
+    BOOST_CHECK( ! PathInfo( part.path() ).isExist() );
+    BOOST_CHECK( ! PathInfo( part.statePath() ).isExist() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(blocks)
+{
+  string data;
+  for ( unsigned i = 0; i < 10000; ++i )
+    data += str::numstring( i ) + "\n";
+  filesystem::TmpDir dir;
+
+  PartFile part( testUrl, dir.path() );
+  BOOST_REQUIRE( part.reset() );
+  part.setMetalink( true );
+  {
+    // blocks 0, 1 and 3 downloaded, 2 corrupt, the rest missing
+    string got( data.substr( 0, 2048 ) );
+    got += string( 1024, 'X' );
+    got += data.substr( 3072, 1024 );
+    AutoDispose<FILE*> fp( ::fopen( part.path().c_str(), "w+" ), ::fclose );
+    ::fwrite( got.data(), 1, got.size(), fp );
+    BOOST_CHECK_EQUAL( part.recordBlocks( blockList( data, 1024 ), fp ), 3 );
+    BOOST_CHECK( part.save() );
+  }
+
+  PartFile resumed( testUrl, dir.path() );
+  BOOST_REQUIRE( resumed.load() );
+  BOOST_CHECK( resumed.metalink() );
+  BOOST_CHECK_EQUAL( resumed.blocks().size(), 3 );
+
+  MediaBlockList bl( blockList( data, 1024 ) );
+  size_t nblks = bl.numBlocks();
+  BOOST_CHECK_EQUAL( resumed.reuseBlocks( bl ), 3 );
+  BOOST_CHECK_EQUAL( bl.numBlocks(), nblks - 3 );
+  BOOST_CHECK_EQUAL( bl.getBlock( 0 ).off, 2048 );
+
+  // a different blocking does not match the records
+  MediaBlockList other( blockList( data, 2048 ) );
+  BOOST_CHECK_EQUAL( resumed.reuseBlocks( other ), 0 );
+}
+
+BOOST_AUTO_TEST_CASE(remove_stale)
+{
+  filesystem::TmpDir dir;
+  PartFile part( testUrl, dir.path() );
+  BOOST_REQUIRE( part.reset() );
+  ofstream( part.path().c_str() ) << "data";
+  part.save();
+  BOOST_CHECK_EQUAL( PartFile::removeStale( dir.path(), 3600 ), 0 );
+  struct timeval old[2] = { { 1000, 0 }, { 1000, 0 } };
+  ::utimes( part.path().c_str(), old );
+  ::utimes( part.statePath().c_str(), old );
+  BOOST_CHECK_EQUAL( PartFile::removeStale( dir.path(), 3600 ), 1 );
+  BOOST_CHECK( ! PathInfo( part.path() ).isExist() );
+  BOOST_CHECK( ! PathInfo( part.statePath() ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(lock)
+{
+  filesystem::TmpDir dir;
+  PartFile part( testUrl, dir.path() );
+  BOOST_REQUIRE( part.lock() );
+  BOOST_CHECK( part.locked() );
+  {
+    // another download of the same url must not touch it
+    PartFile other( testUrl, dir.path() );
+    BOOST_CHECK( ! other.lock() );
+    BOOST_CHECK( ! other.locked() );
+  }
+
+  // in use: not removed even if stale
+  BOOST_REQUIRE( part.reset() );
+  ofstream( part.path().c_str() ) << "data";
+  part.save();
+  struct timeval old[2] = { { 1000, 0 }, { 1000, 0 } };
+  ::utimes( part.path().c_str(), old );
+  ::utimes( part.statePath().c_str(), old );
+  BOOST_CHECK_EQUAL( PartFile::removeStale( dir.path(), 3600 ), 0 );
+  BOOST_CHECK( PathInfo( part.path() ).isExist() );
+
+  // the lock file is kept as long as there are data
+  part.unlock();
+  BOOST_CHECK( ! part.locked() );
+  BOOST_CHECK( PathInfo( part.lockPath() ).isExist() );
+  {
+    PartFile other( testUrl, dir.path() );
+    BOOST_CHECK( other.lock() );
+    BOOST_CHECK( other.load() );
+    other.remove();
+  }
+  BOOST_CHECK( ! PathInfo( part.lockPath() ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(resume_download)
+{
+  // keep the partial downloads in a private cache
+  filesystem::TmpDir cache;
+  Pathname conf( cache.path() / "zypp.conf" );
+  ofstream( conf.c_str() ) << "[main]" << endl
+                           << "cachedir = " << cache.path() << endl
+                           << "download.media_mountdir = " << cache.path() << endl;
+  reconfigureZConfig( conf );
+  // attach points are on the same filesystem
+  BOOST_CHECK_EQUAL( PartFile::dirFor( cache.path() / "file" ), PartFile::defaultDir() );
+
+  const Pathname file( "/suse/setup/descr/packages.en.gz" );
+  const string data( readFile( Pathname( TESTS_SRC_DIR "/data/openSUSE-11.1" ) / file ) );
+  BOOST_REQUIRE( data.size() > 2 );
+
+  WebServer web( TESTS_SRC_DIR "/data/openSUSE-11.1", 10001 );
+  web.start();
+
+  vector<MediaCurl::ConditionalRequest> requests( 1, MediaCurl::ConditionalRequest( web.url(), file ) );
+  MediaCurl::checkModified( requests );
+  BOOST_REQUIRE_EQUAL( requests[0].httpCode, 200 );
+
+  Url url( web.url() );
+  url.setPathName( file.asString() );
+  // the servers validator, a changed one, none
+  for ( const string & etag : { requests[0].newEtag, string( "\"bogus\"" ), string() } )
+  {
+    bool valid = ( etag == requests[0].newEtag );
+    // the first half downloaded (as 'X'), no ranges recorded
+    PartFile part( url );
+    BOOST_REQUIRE( part.reset() );
+    ofstream( part.path().c_str() ) << string( data.size() / 2, 'X' );
+    part.setValidators( etag, "" );
+    BOOST_REQUIRE( part.save() );
+
+    MediaSetAccess setaccess( web.url(), "/" );
+    string got( readFile( setaccess.provideFile( file ) ) );
+    BOOST_REQUIRE_EQUAL( got.size(), data.size() );
+    if ( valid )	// continued
+    {
+      BOOST_CHECK_EQUAL( got.substr( 0, data.size() / 2 ), string( data.size() / 2, 'X' ) );
+      BOOST_CHECK( got.compare( data.size() / 2, string::npos, data, data.size() / 2, string::npos ) == 0 );
+    }
+    else		// file changed on the server or can't tell: restarted
+    {
+      BOOST_CHECK( got == data );
+    }
+    BOOST_CHECK( ! PathInfo( part.path() ).isExist() );
+    BOOST_CHECK( ! PathInfo( part.statePath() ).isExist() );
+  }
+  {
+    // in use by another download: not touched, downloaded to a temp file
+    PartFile part( url );
+    BOOST_REQUIRE( part.reset() );
+    ofstream( part.path().c_str() ) << string( data.size() / 2, 'X' );
+    part.setValidators( requests[0].newEtag, "" );
+    BOOST_REQUIRE( part.save() );
+    BOOST_REQUIRE( part.lock() );
+
+    MediaSetAccess setaccess( web.url(), "/" );
+    BOOST_CHECK( readFile( setaccess.provideFile( file ) ) == data );
+    BOOST_CHECK_EQUAL( PathInfo( part.path() ).size(), off_t( data.size() / 2 ) );
+    BOOST_CHECK( PathInfo( part.statePath() ).isFile() );
+    part.remove();
+  }
+  web.stop();
+}
@@ -1,5 +1,9 @@
 #include "TestSetup.h"
+#include <fstream>
 #include "zypp/parser/HistoryLogReader.h"
+#include "zypp/parser/HistoryLogIndex.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
 #include "zypp/parser/ParseException.h"
 
 using namespace zypp;
@@ -48,3 +52,89 @@ BOOST_AUTO_TEST_CASE(basic)
   HistoryLogDataInstall::Ptr p = dynamic_pointer_cast<HistoryLogDataInstall>( history[1] );
   BOOST_CHECK_EQUAL( p->userdata(), "trans|ID" ); // properly (un)escaped?
 }
+
+namespace
+{
+  /** Write a history file with \a count_r install/remove lines, one per minute starting at \a start_r. */
+  void writeHistory( const Pathname & file_r, const Date & start_r, unsigned count_r )
+  {
+    std::ofstream out( file_r.c_str() );
+    for ( unsigned i = 0; i < count_r; ++i )
+    {
+      Date d( Date::ValueType(start_r) + 60 * i );
+      if ( i % 10 == 0 )
+	out << "# " << d.form( HISTORY_LOG_DATE_FORMAT ) << " some comment" << endl;
+      out << d.form( HISTORY_LOG_DATE_FORMAT )
+          << ( i % 2 ? "|remove |" : "|install|" ) << "pkg" << (i % 100) << "|1-" << i << "|x86_64|";
+      if ( i % 2 )
+	out << "|" << endl;
+      else
+	out << "|repo|d99de2872270cbd436b0c10af85c286a1365a348|" << endl;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(indexed)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp / "history" );
+  Date start( "2015-01-01 00:00:00", HISTORY_LOG_DATE_FORMAT );
+  writeHistory( file, start, 20000 );
+
+  std::vector<HistoryLogData::Ptr> history;
+  parser::HistoryLogReader parser( file, parser::HistoryLogReader::Options(),
+    [&history]( HistoryLogData::Ptr ptr )->bool {
+      history.push_back( ptr );
+      return true;
+    } );
+
+  // entries 10000..10099 (fromDate itself is excluded)
+  Date from( Date::ValueType(start) + 60 * 9999 );
+  Date to( Date::ValueType(start) + 60 * 10100 );
+  parser.readFromTo( from, to );
+  BOOST_CHECK( ! PathInfo( parser::HistoryLogIndex::indexFile( file ) ).isExist() );	// readers don't write
+  BOOST_REQUIRE_EQUAL( history.size(), 100 );
+  BOOST_CHECK_EQUAL( history.front()->date(), Date( Date::ValueType(start) + 60 * 10000 ) );
+  BOOST_CHECK_EQUAL( history.back()->date(), Date( Date::ValueType(start) + 60 * 10099 ) );
+
+  // as done by HistoryLog
+  parser::HistoryLogIndex::update( file );
+  BOOST_REQUIRE( PathInfo( parser::HistoryLogIndex::indexFile( file ) ).isFile() );
+  history.clear();
+  parser.readFromTo( from, to );
+  BOOST_CHECK_EQUAL( history.size(), 100 );
+
+  history.clear();
+  parser.readFrom( Date( Date::ValueType(start) + 60 * 19989 ) );
+  BOOST_CHECK_EQUAL( history.size(), 10 );
+
+  parser::HistoryLogIndex index( file );
+  BOOST_CHECK( index.valid() );
+  BOOST_CHECK( index.blocks().size() > 1 );
+  BOOST_CHECK_EQUAL( index.indexedSize(), off_t(PathInfo( file ).size()) );
+
+  history.clear();
+  parser.readPackage( "pkg42" );
+  BOOST_CHECK_EQUAL( history.size(), 200 );
+  for ( const auto & p : history )
+    BOOST_CHECK_EQUAL( dynamic_pointer_cast<HistoryLogDataInstall>( p )->name(), "pkg42" );
+
+  history.clear();
+  parser.readAction( HistoryActionID::REMOVE );
+  BOOST_CHECK_EQUAL( history.size(), 10000 );
+
+  // Appended lines are picked up, a rewritten file is reindexed.
+  {
+    std::ofstream out( file.c_str(), std::ios::out|std::ios::app );
+    out << Date( Date::ValueType(start) + 60 * 20000 ).form( HISTORY_LOG_DATE_FORMAT ) << "|rremove|InstallationImage|" << endl;
+  }
+  history.clear();
+  parser.readAction( HistoryActionID::REPO_REMOVE );
+  BOOST_CHECK_EQUAL( history.size(), 1 );
+
+  writeHistory( file, Date( Date::ValueType(start) + 3600 ), 50 );
+  history.clear();
+  parser.readFrom( start );
+  BOOST_CHECK_EQUAL( history.size(), 50 );
+  BOOST_CHECK_EQUAL( parser::HistoryLogIndex( file ).indexedSize(), off_t(PathInfo( file ).size()) );
+}
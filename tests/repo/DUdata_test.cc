@@ -10,6 +10,7 @@
 #include "zypp/base/Exception.h"
 #include "zypp/RepoManager.h"
 #include "zypp/ResPool.h"
+#include "zypp/ResPoolProxy.h"
 #include "zypp/sat/Pool.h"
 #include "zypp/PoolQuery.h"
 
@@ -111,3 +112,68 @@ BOOST_AUTO_TEST_CASE(dudata)
   ins.status().setTransact( false, ResStatus::USER );
   up3.status().setTransact( false, ResStatus::USER );
 }
+
+BOOST_AUTO_TEST_CASE(dudata_incremental)
+{
+  Pathname repodir( TEST_DIR );
+  TestSetup test( Arch_x86_64 );
+  test.loadTargetRepo( repodir/"system" );
+  test.loadRepo( repodir/"repo", "repo" );
+
+  ResPool pool( ResPool::instance() );
+  PoolItem ins( piFind( "dutest", "1.0", true ) );
+  PoolItem up1( piFind( "dutest", "1.0" ) );
+  PoolItem up2( piFind( "dutest", "2.0" ) );
+  PoolItem up3( piFind( "dutest", "3.0" ) );
+
+  DiskUsageCounter::MountPointSet mps( { DiskUsageCounter::MountPoint( "/grow", DiskUsageCounter::MountPoint::Hint_growonly ),
+                                         DiskUsageCounter::MountPoint( "/norm" ) } );
+  DiskUsageCounter duc( mps );	// incrementally updated along the sequence
+
+  PoolItem seq[] = { ins, up1, up2, ins, up3, ins, up1, up3, up2, up1 };
+  for ( PoolItem & pi : seq )
+  {
+    pi.status().setTransact( ! pi.status().transacts(), ResStatus::USER );
+    BOOST_CHECK_EQUAL( getSize( duc, pool ), getSize( DiskUsageCounter( mps ), pool ) );
+    BOOST_CHECK_EQUAL( getSize( duc, pool ), getSize( DiskUsageCounter( mps ), pool ) );	// unchanged
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dudata_restore_state)
+{
+  Pathname repodir( TEST_DIR );
+  TestSetup test( Arch_x86_64 );
+  test.loadTargetRepo( repodir/"system" );
+  test.loadRepo( repodir/"repo", "repo" );
+
+  ResPool pool( ResPool::instance() );
+  PoolItem up1( piFind( "dutest", "1.0" ) );
+  PoolItem up2( piFind( "dutest", "2.0" ) );
+  PoolItem up3( piFind( "dutest", "3.0" ) );
+
+  DiskUsageCounter::MountPointSet mps( { DiskUsageCounter::MountPoint( "/grow", DiskUsageCounter::MountPoint::Hint_growonly ),
+                                         DiskUsageCounter::MountPoint( "/norm" ) } );
+  DiskUsageCounter duc( mps );
+
+  // restoring the saved state is a status change as well
+  const ByteSet saved( getSize( duc, pool ) );
+  pool.proxy().saveState();
+  up2.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), getSize( DiskUsageCounter( mps ), pool ) );
+  BOOST_CHECK( getSize( duc, pool ) != saved );
+  pool.proxy().restoreState();
+  BOOST_CHECK( ! up2.status().transacts() );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), saved );
+
+  // more changes than ResStatus::transactLog keeps
+  for ( unsigned i = 0; i < 5000; ++i )
+  {
+    up1.status().setTransact( ! up1.status().transacts(), ResStatus::USER );
+    up3.status().setTransact( ! up3.status().transacts(), ResStatus::USER );
+  }
+  up3.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK( ResStatus::transactLog().begin > 0 );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), getSize( DiskUsageCounter( mps ), pool ) );
+  up3.status().setTransact( false, ResStatus::USER );
+  BOOST_CHECK_EQUAL( getSize( duc, pool ), saved );
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/repo/PackageStore.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::repo;
+
+namespace
+{
+  CheckSum writeFile( const Pathname & file_r, const std::string & content_r )
+  {
+    filesystem::assert_dir( file_r.dirname() );
+    ofstream( file_r.c_str() ) << content_r;
+    return CheckSum::sha256( filesystem::checksum( file_r, "sha256" ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(store_path)
+{
+  PackageStore store( "/store" );
+  BOOST_CHECK_EQUAL( store.storePath( CheckSum() ), Pathname() );
+  BOOST_CHECK_EQUAL( store.storePath( CheckSum::md5( "0123456789ABCDEF0123456789abcdef" ) ),
+                     Pathname( "/store/md5/01/0123456789abcdef0123456789abcdef" ) );
+}
+
+BOOST_AUTO_TEST_CASE(insert_provide_collect)
+{
+  filesystem::TmpDir tmp;
+  PackageStore store( PackageStore::defaultRoot( tmp.path() ) );
+
+  Pathname repo1( tmp.path() / "repo1/x86_64/foo.rpm" );
+  Pathname repo2( tmp.path() / "repo2/x86_64/foo.rpm" );
+  CheckSum sum( writeFile( repo1, "foo content" ) );
+
+  BOOST_CHECK( ! store.contains( sum ) );
+  BOOST_CHECK( ! store.provide( sum, repo2 ) );
+
+  // files not matching the checksum are not stored
+  BOOST_CHECK( ! store.insert( repo1, CheckSum::sha256( string( 64, 'a' ) ) ) );
+
+  BOOST_REQUIRE( store.insert( repo1, sum ) );
+  BOOST_CHECK( store.contains( sum ) );
+  BOOST_CHECK_EQUAL( PathInfo( repo1 ).nlink(), 2 );
+
+  BOOST_REQUIRE( store.provide( sum, repo2 ) );
+  BOOST_CHECK_EQUAL( PathInfo( repo2 ).ino(), PathInfo( repo1 ).ino() );
+  BOOST_CHECK_EQUAL( PathInfo( store.storePath( sum ) ).nlink(), 3 );
+
+  // an identical download is replaced by a link to the stored package
+  Pathname repo3( tmp.path() / "repo3/foo.rpm" );
+  writeFile( repo3, "foo content" );
+  BOOST_CHECK( store.insert( repo3, sum ) );
+  BOOST_CHECK_EQUAL( PathInfo( repo3 ).ino(), PathInfo( repo1 ).ino() );
+
+  // referenced packages are kept
+  filesystem::unlink( repo1 );
+  filesystem::unlink( repo3 );
+  BOOST_CHECK_EQUAL( store.collectGarbage(), 0 );
+  BOOST_CHECK( store.contains( sum ) );
+
+  filesystem::unlink( repo2 );
+  BOOST_CHECK_EQUAL( store.collectGarbage(), 1 );
+  BOOST_CHECK( ! store.contains( sum ) );
+}
@@ -0,0 +1,106 @@
+#include <utime.h>
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/OnMediaLocation.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/repo/PlaindirIndex.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::repo;
+
+// see tests/data/rpms/mkrpm.py
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/data/rpms")
+
+namespace
+{
+  void writeFile( const Pathname & file_r, const std::string & content_r )
+  {
+    filesystem::assert_dir( file_r.dirname() );
+    ofstream( file_r.c_str() ) << content_r;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(cache_file)
+{
+  BOOST_CHECK_EQUAL( PlaindirIndex::cacheFile( "/cache/solv/repo/solv" ), Pathname( "/cache/solv/repo/solv.rpms" ) );
+}
+
+BOOST_AUTO_TEST_CASE(update)
+{
+  filesystem::TmpDir tmp;
+  Pathname dir( tmp.path() / "repo" );
+  Pathname solvfile( tmp.path() / "solv" );
+  writeFile( dir / "x86_64/broken.rpm", "no rpm" );
+  writeFile( dir / "x86_64/foo.delta.rpm", "no rpm" );
+  writeFile( dir / "README", "no rpm" );
+
+  PlaindirIndex index( dir, solvfile );
+  index.update();
+  BOOST_CHECK_EQUAL( index.packages(), 1 );
+  BOOST_CHECK_EQUAL( index.reused(), 0 );
+  BOOST_CHECK_EQUAL( index.parsed(), 0 );
+  BOOST_CHECK_EQUAL( index.failed(), 1 );
+  BOOST_REQUIRE( PathInfo( solvfile ).isFile() );
+  BOOST_CHECK( PathInfo( PlaindirIndex::cacheFile( solvfile ) ).isFile() );
+
+  // broken packages are not cached but tried again
+  index.update();
+  BOOST_CHECK_EQUAL( index.packages(), 1 );
+  BOOST_CHECK_EQUAL( index.failed(), 1 );
+
+  // the toolversion is set, otherwise RepoManager would rebuild the solv file
+  sat::Pool satpool( sat::Pool::instance() );
+  Repository repo( satpool.addRepoSolv( solvfile, "plaindir" ) );
+  sat::LookupRepoAttr toolversion( sat::SolvAttr::repositoryToolVersion, repo );
+  BOOST_CHECK_EQUAL( toolversion.begin().asString(), "1.0" );
+  BOOST_CHECK_EQUAL( repo.solvablesSize(), 0 );
+  repo.eraseFromPool();
+}
+
+BOOST_AUTO_TEST_CASE(reuse)
+{
+  filesystem::TmpDir tmp;
+  Pathname dir( tmp.path() / "repo" );
+  Pathname solvfile( tmp.path() / "solv" );
+  BOOST_REQUIRE_EQUAL( filesystem::assert_dir( dir / "noarch" ), 0 );
+  BOOST_REQUIRE_EQUAL( filesystem::copy( DATADIR / "foo-1.0-1.noarch.rpm", dir / "noarch" ), 0 );
+  BOOST_REQUIRE_EQUAL( filesystem::copy( DATADIR / "bar-1.0-1.noarch.rpm", dir / "noarch" ), 0 );
+  // like repo2solv hidden directories are skipped
+  BOOST_REQUIRE_EQUAL( filesystem::assert_dir( dir / ".hidden" ), 0 );
+  BOOST_REQUIRE_EQUAL( filesystem::copy( DATADIR / "foo-1.0-1.noarch.rpm", dir / ".hidden" ), 0 );
+
+  PlaindirIndex index( dir, solvfile );
+  index.update();
+  BOOST_CHECK_EQUAL( index.packages(), 2 );
+  BOOST_CHECK_EQUAL( index.reused(), 0 );
+  BOOST_CHECK_EQUAL( index.parsed(), 2 );
+  BOOST_CHECK_EQUAL( index.failed(), 0 );
+
+  index.update();
+  BOOST_CHECK_EQUAL( index.packages(), 2 );
+  BOOST_CHECK_EQUAL( index.reused(), 2 );
+  BOOST_CHECK_EQUAL( index.parsed(), 0 );
+  BOOST_CHECK_EQUAL( index.failed(), 0 );
+
+  // a touched package is read again
+  struct utimbuf times = { 1451606400, 1451606400 };
+  BOOST_REQUIRE_EQUAL( ::utime( ( dir / "noarch/foo-1.0-1.noarch.rpm" ).c_str(), &times ), 0 );
+  index.update();
+  BOOST_CHECK_EQUAL( index.packages(), 2 );
+  BOOST_CHECK_EQUAL( index.reused(), 1 );
+  BOOST_CHECK_EQUAL( index.parsed(), 1 );
+  BOOST_CHECK_EQUAL( index.failed(), 0 );
+
+  sat::Pool satpool( sat::Pool::instance() );
+  Repository repo( satpool.addRepoSolv( solvfile, "plaindir-rpms" ) );
+  BOOST_CHECK_EQUAL( repo.solvablesSize(), 2 );
+  for ( const sat::Solvable & solv : repo.solvables() )
+    BOOST_CHECK_EQUAL( solv.lookupLocation().filename(), Pathname( "noarch" ) / ( solv.asString() + ".rpm" ) );
+  repo.eraseFromPool();
+}
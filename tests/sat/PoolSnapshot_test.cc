@@ -0,0 +1,61 @@
+#include <iostream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/TmpPath.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/PoolSnapshot.h"
+#include "zypp/sat/WhatProvides.h"
+#include "TestSetup.h"
+
+#define BOOST_TEST_MODULE PoolSnapshot
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace boost::unit_test;
+
+BOOST_AUTO_TEST_CASE(snapshot)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "opensuse" );
+  test.loadRepo( TESTS_SRC_DIR "/data/11.0-update", "update" );
+
+  sat::Pool pool( sat::Pool::instance() );
+  unsigned opensuseSize = pool.reposFind( "opensuse" ).solvablesSize();
+  unsigned updateSize = pool.reposFind( "update" ).solvablesSize();
+  unsigned fileProviders = sat::WhatProvides( Capability( "/bin/sh" ) ).size();
+  BOOST_REQUIRE( opensuseSize );
+  BOOST_REQUIRE( updateSize );
+
+  filesystem::TmpDir tmpdir;
+  Pathname snapshot( tmpdir / "snapshot" );
+  BOOST_REQUIRE( sat::PoolSnapshot::store( snapshot, "stamp" ) );
+
+  // repos already in the pool are not replaced
+  BOOST_CHECK( sat::PoolSnapshot::load( snapshot, "stamp" ).empty() );
+
+  pool.reposEraseAll();
+  BOOST_CHECK( sat::PoolSnapshot::load( snapshot, "otherstamp" ).empty() );
+  BOOST_CHECK( sat::PoolSnapshot::load( tmpdir / "nonexisting", "stamp" ).empty() );
+  BOOST_CHECK_EQUAL( pool.reposSize(), 0 );
+
+  std::vector<Repository> repos( sat::PoolSnapshot::load( snapshot, "stamp" ) );
+  BOOST_REQUIRE_EQUAL( repos.size(), 2 );
+  BOOST_CHECK_EQUAL( repos[0].alias(), "opensuse" );
+  BOOST_CHECK_EQUAL( repos[0].solvablesSize(), opensuseSize );
+  BOOST_CHECK_EQUAL( repos[1].alias(), "update" );
+  BOOST_CHECK_EQUAL( repos[1].solvablesSize(), updateSize );
+  BOOST_CHECK_EQUAL( sat::WhatProvides( Capability( "/bin/sh" ) ).size(), fileProviders );
+
+  // store just the repos the stamp describes
+  Pathname partial( tmpdir / "partial" );
+  BOOST_CHECK( ! sat::PoolSnapshot::store( partial, "update", std::vector<Repository>( 1, pool.systemRepo() ) ) );
+  BOOST_REQUIRE( sat::PoolSnapshot::store( partial, "update", std::vector<Repository>( 1, pool.reposFind( "update" ) ) ) );
+  pool.reposEraseAll();
+  repos = sat::PoolSnapshot::load( partial, "update" );
+  BOOST_REQUIRE_EQUAL( repos.size(), 1 );
+  BOOST_CHECK_EQUAL( repos[0].alias(), "update" );
+  BOOST_CHECK_EQUAL( repos[0].solvablesSize(), updateSize );
+  BOOST_CHECK_EQUAL( pool.reposSize(), 1 );
+}
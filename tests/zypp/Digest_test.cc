@@ -4,12 +4,14 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <boost/test/auto_unit_test.hpp>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/Exception.h"
 #include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
 #include "zypp/Digest.h"
 
 using boost::unit_test::test_case;
@@ -34,3 +36,34 @@ BOOST_AUTO_TEST_CASE(digest)
   // FIXME i think it should throw
   BOOST_CHECK_EQUAL( Digest::digest( "lalala", str3) , "" ); 
 }
+
+/**
+ * Test case for
+ * static std::string digestFile(const std::string& name, const Pathname & file);
+ * static std::vector<std::string> digestFiles(const std::string& name, const std::vector<Pathname> & files);
+ */
+BOOST_AUTO_TEST_CASE(digest_files)
+{
+  TmpDir dir;
+  std::vector<Pathname> files;
+  std::string data;
+  for ( unsigned i = 0; i < 8; ++i )
+  {
+    files.push_back( dir.path() / str::numstring( i ) );
+    ofstream( files.back().c_str() ) << data;
+    data += string( 1000 * i + 1, 'a' + i );
+  }
+  files.push_back( dir.path() / "missing" );
+
+  std::vector<std::string> sums( Digest::digestFiles( "sha256", files ) );
+  BOOST_REQUIRE_EQUAL( sums.size(), files.size() );
+  for ( unsigned i = 0; i < files.size() - 1; ++i )
+  {
+    ifstream istr( files[i].c_str() );
+    BOOST_CHECK_EQUAL( sums[i], Digest::digest( "sha256", istr ) );
+    BOOST_CHECK_EQUAL( sums[i], Digest::digestFile( "sha256", files[i] ) );
+  }
+  BOOST_CHECK_EQUAL( sums.back(), "" );
+  BOOST_CHECK_EQUAL( Digest::digestFile( "sha256", files.back() ), "" );
+  BOOST_CHECK_EQUAL( Digest::digestFile( "lalala", files.front() ), "" );
+}
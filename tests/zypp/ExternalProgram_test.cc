@@ -0,0 +1,90 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <fstream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/TmpPath.h"
+
+using std::endl;
+using namespace zypp;
+
+namespace
+{
+  std::string output( ExternalProgram & prog )
+  {
+    std::string ret;
+    for ( std::string line( prog.receiveLine() ); line.length(); line = prog.receiveLine() )
+      ret += line;
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(externalprogram_options)
+{
+  {
+    ExternalProgram::Environment env;
+    env["ZYPP_TEST_VAR"] = "value";
+    const char *const argv[] = { "sh", "-c", "echo $ZYPP_TEST_VAR $LC_ALL; echo err >&2", NULL };
+    ExternalProgram prog( argv, env, ExternalProgram::Stderr_To_Stdout, false, -1, /*default_locale*/true );
+    BOOST_CHECK_EQUAL( output( prog ), "value C\nerr\n" );
+    BOOST_CHECK_EQUAL( prog.close(), 0 );
+  }
+  {
+    const char *const argv[] = { "#/tmp", "pwd", NULL };
+    ExternalProgram prog( argv, ExternalProgram::Discard_Stderr );
+    BOOST_CHECK_EQUAL( output( prog ), "/tmp\n" );
+    BOOST_CHECK_EQUAL( prog.close(), 0 );
+  }
+  {
+    filesystem::TmpFile in;
+    filesystem::TmpFile out;
+    std::ofstream( in.path().c_str() ) << "redirected" << endl;
+    std::string redirectIn( "<" + in.path().asString() );
+    std::string redirectOut( ">" + out.path().asString() );
+    const char *const argv[] = { redirectIn.c_str(), redirectOut.c_str(), "cat", NULL };
+    ExternalProgram prog( argv );
+    BOOST_CHECK_EQUAL( output( prog ), "" );
+    BOOST_CHECK_EQUAL( prog.close(), 0 );
+    std::string line;
+    std::getline( std::ifstream( out.path().c_str() ), line );
+    BOOST_CHECK_EQUAL( line, "redirected" );
+  }
+  {
+    ExternalProgram prog( "echo pty", ExternalProgram::Normal_Stderr, /*use_pty*/true );
+    BOOST_CHECK_EQUAL( str::trim( output( prog ) ), "pty" );
+    BOOST_CHECK_EQUAL( prog.close(), 0 );
+  }
+  {
+    // our fds are not inherited
+    int fd = ::open( "/dev/null", O_RDONLY );
+    ExternalProgram prog( str::form( "test -e /proc/self/fd/%d && echo open || echo closed", fd ) );
+    BOOST_CHECK_EQUAL( output( prog ), "closed\n" );
+    prog.close();
+    ::close( fd );
+  }
+  {
+    // a script without #! is run by the shell, like execvp does
+    filesystem::TmpDir dir;
+    Pathname script( dir.path() / "noshebang" );
+    std::ofstream( script.c_str() ) << "echo script $1 $#" << endl;
+    ::chmod( script.c_str(), 0755 );
+    const char *const argv[] = { script.c_str(), "arg", NULL };
+    ExternalProgram prog( argv );
+    BOOST_CHECK_EQUAL( output( prog ), "script arg 1\n" );
+    BOOST_CHECK_EQUAL( prog.close(), 0 );
+  }
+  {
+    const char *const argv[] = { "zypp-no-such-program", NULL };
+    ExternalProgram prog( argv );
+    BOOST_CHECK_EQUAL( prog.execError(), "Can't exec 'zypp-no-such-program' (No such file or directory)." );
+    BOOST_CHECK_EQUAL( prog.close(), 129 );
+  }
+  {
+    const char *const argv[] = { "true", NULL };
+    ExternalProgram prog( argv, ExternalProgram::Normal_Stderr, false, -1, false, "/zypp-no-such-root" );
+    BOOST_CHECK_EQUAL( prog.close(), 128 );
+  }
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/Digest.h"
+#include "zypp/FileDigestCache.h"
+
+using boost::unit_test::test_case;
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::filesystem;
+
+BOOST_AUTO_TEST_CASE(remember_while_writing)
+{
+  TmpDir dir;
+  Pathname file( dir.path() / "file" );
+  Pathname link( dir.path() / "link" );
+  string data( "I will test the checksum of this" );
+
+  FileDigestCache::Builder digests;
+  {
+    ofstream out( file.c_str() );
+    out << data;
+    digests.update( data.c_str(), data.size() );
+  }
+  BOOST_CHECK( FileDigestCache::lookup( file, "sha1" ).empty() );
+  digests.commit( file );
+
+  BOOST_CHECK_EQUAL( FileDigestCache::lookup( file, "sha1" ).checksum(), "142df4277c326f3549520478c188cab6e3b5d042" );
+  BOOST_CHECK_EQUAL( FileDigestCache::lookup( file, "SHA256" ).checksum(), Digest::digest( "sha256", data ) );
+  BOOST_CHECK( FileDigestCache::lookup( file, "md5" ).empty() );	// not computed
+  BOOST_CHECK_EQUAL( checksum( file, "sha1" ), "142df4277c326f3549520478c188cab6e3b5d042" );
+
+  // hardlinks share the entry
+  BOOST_CHECK_EQUAL( hardlinkCopy( file, link ), 0 );
+  BOOST_CHECK_EQUAL( FileDigestCache::lookup( link, "sha1" ).checksum(), "142df4277c326f3549520478c188cab6e3b5d042" );
+
+  // modification invalidates
+  {
+    ofstream out( file.c_str(), ios::app );
+    out << "!";
+  }
+  BOOST_CHECK( FileDigestCache::lookup( file, "sha1" ).empty() );
+  BOOST_CHECK_EQUAL( checksum( file, "sha1" ), Digest::digest( "sha1", data + "!" ) );
+}
+
+BOOST_AUTO_TEST_CASE(remember_and_forget)
+{
+  TmpDir dir;
+  Pathname file( dir.path() / "file" );
+  {
+    ofstream out( file.c_str() );
+    out << "bad data";
+  }
+  // remembered checksums are trusted as long as the file is unchanged
+  string other( "other data" );
+  FileDigestCache::Builder digests;
+  digests.update( other.c_str(), other.size() );
+  digests.commit( file );
+  BOOST_CHECK( ! is_checksum( file, CheckSum::sha1FromString( "bad data" ) ) );
+  BOOST_CHECK( is_checksum( file, CheckSum::sha1FromString( other ) ) );
+
+  FileDigestCache::forget( file );
+  BOOST_CHECK( is_checksum( file, CheckSum::sha1FromString( "bad data" ) ) );
+}
+
+BOOST_AUTO_TEST_CASE(same_size_rewrite)
+{
+  TmpDir dir;
+  Pathname file( dir.path() / "file" );
+  string data( "data one" );
+  {
+    ofstream out( file.c_str() );
+    out << data;
+  }
+  FileDigestCache::Builder digests;
+  digests.update( data.c_str(), data.size() );
+  digests.commit( file );
+  BOOST_CHECK_EQUAL( FileDigestCache::lookup( file, "sha1" ).checksum(), Digest::digest( "sha1", data ) );
+
+  // rewritten in the same second with the same size
+  struct stat st;
+  BOOST_REQUIRE_EQUAL( ::stat( file.c_str(), &st ), 0 );
+  {
+    ofstream out( file.c_str() );
+    out << "data two";
+  }
+  struct timespec times[2] = { st.st_atim, st.st_mtim };
+  times[1].tv_nsec = ( times[1].tv_nsec + 1 ) % 1000000000;
+  BOOST_REQUIRE_EQUAL( ::utimensat( AT_FDCWD, file.c_str(), times, 0 ), 0 );
+  BOOST_CHECK( FileDigestCache::lookup( file, "sha1" ).empty() );
+  BOOST_CHECK_EQUAL( checksum( file, "sha1" ), Digest::digest( "sha1", "data two" ) );
+}
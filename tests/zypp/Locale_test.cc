@@ -83,6 +83,13 @@ BOOST_AUTO_TEST_CASE(language_code)
   BOOST_CHECK( LanguageCode("deu") < LanguageCode("ger") );
 
   BOOST_CHECK_EQUAL( LanguageCode("XX"), IdString("XX") );
+
+  // first/last table entries and malformed codes
+  BOOST_CHECK_EQUAL( LanguageCode("aar").name(), "Afar" );
+  BOOST_CHECK_EQUAL( LanguageCode("zu").name(), "Zulu" );
+  BOOST_CHECK_EQUAL( LanguageCode("DE").name(), name );
+  BOOST_CHECK_EQUAL( LanguageCode("xx").name(), "Unknown language: 'xx'" );
+  BOOST_CHECK_EQUAL( LanguageCode("dex").name(), "Unknown language: 'dex'" );
 }
 
 BOOST_AUTO_TEST_CASE(country_code)
@@ -101,6 +108,12 @@ BOOST_AUTO_TEST_CASE(country_code)
   BOOST_CHECK( CountryCode("AA") < CountryCode("DE") );
 
   BOOST_CHECK_EQUAL( CountryCode("XX"), IdString("XX") );
+
+  BOOST_CHECK_EQUAL( CountryCode("AD").name(), "Andorra" );
+  BOOST_CHECK_EQUAL( CountryCode("TL").name(), "East Timor" );
+  BOOST_CHECK_EQUAL( CountryCode("ZW").name(), "Zimbabwe" );
+  BOOST_CHECK_EQUAL( CountryCode("de").name(), name );
+  BOOST_CHECK_EQUAL( CountryCode("XX").name(), "Unknown country: 'XX'" );
 }
 
 BOOST_AUTO_TEST_CASE(locale)
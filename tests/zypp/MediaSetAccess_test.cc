@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <iostream>
+#include <fstream>
 #include <boost/test/auto_unit_test.hpp>
 #include <boost/test/parameterized_test.hpp>
 #include <boost/test/unit_test_log.hpp>
@@ -7,6 +8,9 @@
 #include "zypp/MediaSetAccess.h"
 #include "zypp/Url.h"
 #include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/ZConfig.h"
+#include "zypp/media/PeerCache.h"
 
 #include "WebServer.h"
 
@@ -263,5 +267,62 @@ BOOST_AUTO_TEST_CASE(msa_remote_tests)
   web.stop();
 }
 
+/*
+ * files provided by the peer cache
+ */
+BOOST_AUTO_TEST_CASE(msa_peer_cache)
+{
+  const CheckSum sha1( CheckSum::sha1("2616e23301d7fcf7ac3324142f8c748cd0b6692b") );		// test.txt
+  const CheckSum sha256( CheckSum::sha256("b0f3bb1d2fe8386cc3459776af3f2855fc060cb32330be083e14028256a864ce") );
+
+  // peer cache has test.txt under its sha1, but a corrupt file under its sha256
+  filesystem::TmpDir peerroot;
+  assert_dir( peerroot.path() / "sha1" );
+  assert_dir( peerroot.path() / "sha256" );
+  copy( DATADIR / "/src1/cd1/test.txt", peerroot.path() / "sha1" / sha1.checksum() );
+  std::ofstream( ( peerroot.path() / "sha256" / sha256.checksum() ).c_str() ) << "corrupt";
+
+  WebServer peer( peerroot.path(), 10003 );
+  peer.start();
+  WebServer web( DATADIR / "/src1/cd1", 10002 );
+  web.start();
+  ZConfig::instance().set_download_peer_cache( peer.url() );
+
+  MediaSetAccess setaccess( web.url(), "/" );
+
+  // not on the mirror, so it must come from the peer
+  Pathname local = setaccess.provideFile( OnMediaLocation( "/only-on-peer.txt" ).setChecksum( sha1 ) );
+  BOOST_CHECK( is_checksum( local, sha1 ) );
+
+  // corrupt on the peer: fall back to the mirror
+  local = setaccess.provideFile( OnMediaLocation( "/test.txt" ).setChecksum( sha256 ) );
+  BOOST_CHECK( is_checksum( local, sha256 ) );
+
+  // neither on the peer nor on the mirror
+  BOOST_CHECK_THROW( setaccess.provideFile( OnMediaLocation( "/testBADNAME.txt" ).setChecksum( CheckSum::sha1( std::string( 40, 'a' ) ) ) ),
+                     media::MediaFileNotFoundException );
+  BOOST_CHECK( media::PeerCache::instance().enabled() );
+
+  ZConfig::instance().set_default_download_peer_cache();
+  web.stop();
+  peer.stop();
+
+  // an unreachable peer is disabled after some failures
+  media::PeerCache unreachable( peer.url() );
+  for ( unsigned i = 0; i < media::PeerCache::maxFailures; ++i )
+  {
+    BOOST_CHECK( unreachable.enabled() );
+    BOOST_CHECK( ! unreachable.provide( sha1, peerroot.path() / "dest" ) );
+  }
+  BOOST_CHECK( ! unreachable.enabled() );
+  BOOST_CHECK( ! PathInfo( peerroot.path() / "dest" ).isExist() );
+
+  // a shared directory keeps its files
+  media::PeerCache shared( Url( "dir:" + peerroot.path().asString() ) );
+  BOOST_CHECK( shared.provide( sha1, peerroot.path() / "dest" ) );
+  BOOST_CHECK( is_checksum( peerroot.path() / "dest", sha1 ) );
+  BOOST_CHECK( is_checksum( peerroot.path() / "sha1" / sha1.checksum(), sha1 ) );
+}
+
 
 // vim: set ts=2 sts=2 sw=2 ai et:
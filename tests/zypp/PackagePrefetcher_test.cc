@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "TestSetup.h"
+#include "zypp/ZYppCallbacks.h"
+#include "zypp/ZYppFactory.h"
+#include "zypp/ZYppCommitPolicy.h"
+#include "zypp/ui/Selectable.h"
+#include "zypp/sat/Transaction.h"
+#include "zypp/target/PackagePrefetcher.h"
+
+using namespace std;
+using namespace zypp;
+
+// see tests/data/rpms/mkrpm.py
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/data/rpms")
+
+namespace
+{
+  filesystem::TmpDir lockroot;
+
+  Pathname lockFile()
+  { return lockroot.path() / "var/run/zypp.pid"; }
+
+  /** The pid in the zypp lock file, \c 0 if released. */
+  pid_t locker()
+  {
+    long pid = 0;
+    ifstream( lockFile().c_str() ) >> pid;
+    return pid;
+  }
+
+  long ioprio()
+  {
+#ifdef SYS_ioprio_get
+    return ::syscall( SYS_ioprio_get, 1/*IOPRIO_WHO_PROCESS*/, 0 );
+#else
+    return -1;
+#endif
+  }
+
+  /** Remember the environment the packages are downloaded in. */
+  struct DownloadReceiver : public callback::ReceiveReport<repo::DownloadResolvableReport>
+  {
+    virtual void start( Resolvable::constPtr, const Url & )
+    {
+      ++started;
+      lockerPid = locker();
+      speed = ZConfig::instance().download_max_download_speed();
+      ioprioClass = ioprio() >> 13;
+    }
+
+    unsigned started = 0;
+    pid_t lockerPid = -1;
+    long speed = -1;
+    long ioprioClass = -1;
+  };
+}
+
+BOOST_AUTO_TEST_CASE(relock)
+{
+  ::setenv( "ZYPP_LOCKFILE_ROOT", lockroot.path().c_str(), 1 );
+  ZYpp::Ptr zypp( getZYpp() );
+  if ( geteuid() != 0 )
+  {
+    BOOST_WARN_MESSAGE( false, "zypp lock is not used as non-root" );
+    return;
+  }
+  BOOST_CHECK_EQUAL( locker(), getpid() );
+
+  BOOST_CHECK( ZYppFactory::instance().releaseLock() );
+  BOOST_CHECK_EQUAL( locker(), 0 );
+  BOOST_CHECK( ! ZYppFactory::instance().releaseLock() );
+
+  // meanwhile a running application took the lock
+  ofstream( lockFile().c_str() ) << getppid() << endl;
+  BOOST_CHECK_THROW( ZYppFactory::instance().reacquireLock(), ZYppFactoryException );
+  BOOST_CHECK_EQUAL( locker(), getppid() );
+  // no commit without the lock
+  BOOST_CHECK_THROW( zypp->commit( ZYppCommitPolicy() ), ZYppFactoryException );
+  BOOST_CHECK_EQUAL( locker(), getppid() );
+
+  // and gave it up again
+  ofstream( lockFile().c_str() );
+  ZYppFactory::instance().reacquireLock();
+  BOOST_CHECK_EQUAL( locker(), getpid() );
+  // held again: nothing to reacquire
+  ZYppFactory::instance().reacquireLock();
+  BOOST_CHECK_EQUAL( locker(), getpid() );
+}
+
+BOOST_AUTO_TEST_CASE(prefetch)
+{
+  ::setenv( "ZYPP_LOCKFILE_ROOT", lockroot.path().c_str(), 1 );
+  ZYpp::Ptr zypp( getZYpp() );
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( DATADIR, "rpms" );
+
+  ui::Selectable::Ptr sel( ui::Selectable::get( "foo" ) );
+  BOOST_REQUIRE( sel );
+  PoolItem foo( sel->candidateObj() );
+  BOOST_REQUIRE( foo );
+  foo.status().setToBeInstalled( ResStatus::USER );
+  sat::Transaction trans( sat::Transaction::loadFromPool );
+
+  ZConfig::instance().set_download_max_download_speed( 1000000 );
+  long ioprioBefore = ioprio();
+  pid_t lockerBefore = locker();
+
+  DownloadReceiver receiver;
+  receiver.connect();
+  target::PackagePrefetcher prefetcher;
+  prefetcher.maxDownloadSpeed( 500000 );
+  target::PackagePrefetcher::Result res( prefetcher.prefetch( trans ) );
+  receiver.disconnect();
+
+  BOOST_CHECK( res.complete() );
+  BOOST_CHECK_EQUAL( res.downloaded, 1 );
+  BOOST_CHECK_EQUAL( res.cached, 0 );
+
+  // while downloading...
+  BOOST_CHECK_EQUAL( receiver.started, 1 );
+  BOOST_CHECK_EQUAL( receiver.speed, 500000 );
+  if ( geteuid() == 0 )
+    BOOST_CHECK_EQUAL( receiver.lockerPid, 0 );
+#ifdef SYS_ioprio_get
+  BOOST_CHECK_EQUAL( receiver.ioprioClass, 3 /*IOPRIO_CLASS_IDLE*/ );
+#endif
+
+  // ...and after
+  BOOST_CHECK_EQUAL( ZConfig::instance().download_max_download_speed(), 1000000 );
+  BOOST_CHECK_EQUAL( ioprio(), ioprioBefore );
+  BOOST_CHECK_EQUAL( locker(), lockerBefore );
+
+  // the second time the package is in the cache
+  res = prefetcher.prefetch( trans );
+  BOOST_CHECK( res.complete() );
+  BOOST_CHECK_EQUAL( res.downloaded, 0 );
+  BOOST_CHECK_EQUAL( res.cached, 1 );
+  BOOST_CHECK_EQUAL( locker(), lockerBefore );
+
+  ZConfig::instance().set_default_download_max_download_speed();
+}
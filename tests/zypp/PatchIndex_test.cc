@@ -0,0 +1,80 @@
+#include <algorithm>
+
+#include "TestSetup.h"
+#include "zypp/PatchIndex.h"
+#include "zypp/Patch.h"
+#include "zypp/sat/LookupAttr.h"
+
+#define BOOST_TEST_MODULE PatchIndex
+
+/////////////////////////////////////////////////////////////////////////////
+static TestSetup test( Arch_x86_64 );
+
+BOOST_AUTO_TEST_CASE(patch_index_init)
+{
+  test.loadRepo( TESTS_SRC_DIR "/data/11.0-update", "update" );
+}
+
+BOOST_AUTO_TEST_CASE(patch_index_matches_patch)
+{
+  const PatchIndex & index( PatchIndex::instance() );
+  PatchIndex::Result patches( index.patches() );
+  BOOST_CHECK_EQUAL( patches.size(), index.size() );
+
+  unsigned count = 0;
+  for_( it, test.pool().byKindBegin<Patch>(), test.pool().byKindEnd<Patch>() )
+  {
+    ++count;
+    Patch::constPtr patch( asKind<Patch>( *it ) );
+    BOOST_CHECK( index.contains( patch->satSolvable() ) );
+    BOOST_CHECK_EQUAL( index.category( patch->satSolvable() ), patch->categoryEnum() );
+    BOOST_CHECK_EQUAL( index.severity( patch->satSolvable() ), patch->severityFlag() );
+    BOOST_CHECK_EQUAL( index.interactiveFlags( patch->satSolvable() ), patch->interactiveFlags() );
+  }
+  BOOST_CHECK_EQUAL( count, index.size() );
+
+  for ( const sat::Solvable & solv : index.select( Patch::CAT_SECURITY ) )
+    BOOST_CHECK( make<Patch>( solv )->isCategory( Patch::CAT_SECURITY ) );
+
+  // not a patch
+  sat::Solvable pkg( *test.pool().byKindBegin<Package>() );
+  BOOST_CHECK( ! index.contains( pkg ) );
+  BOOST_CHECK_EQUAL( index.interactiveFlags( pkg ), Patch::NoFlags );
+}
+
+BOOST_AUTO_TEST_CASE(patch_index_lookup)
+{
+  const PatchIndex & index( PatchIndex::instance() );
+
+  PatchIndex::Result hits( index.byReference( "374318" ) );
+  BOOST_REQUIRE_EQUAL( hits.size(), 1 );
+  BOOST_CHECK_EQUAL( hits[0].ident(), IdString( "patch:xorg-x11-Xvnc" ) );
+  BOOST_CHECK_EQUAL( index.byReference( "374318", "bugzilla" ).size(), 1 );
+  BOOST_CHECK( index.byReference( "374318", "cve" ).empty() );
+  BOOST_CHECK( index.byReference( "no-such-id" ).empty() );
+
+  hits = index.byPackage( "xorg-x11-Xvnc" );
+  BOOST_CHECK( std::find( hits.begin(), hits.end(), index.byReference( "374318" )[0] ) != hits.end() );
+  for ( const sat::Solvable & solv : hits )
+  {
+    bool found = false;
+    sat::LookupAttr collection( sat::SolvAttr::updateCollectionName, sat::SolvAttr::updateCollection, solv );
+    for_( it, collection.begin(), collection.end() )
+      if ( it.asString() == "xorg-x11-Xvnc" )
+	found = true;
+    BOOST_CHECK( found );
+  }
+  BOOST_CHECK( index.byPackage( "no-such-package" ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE(patch_index_pool_change)
+{
+  const PatchIndex & index( PatchIndex::instance() );
+  BOOST_CHECK( index.size() > 0 );
+  sat::Pool::instance().reposErase( "update" );
+  BOOST_CHECK_EQUAL( index.size(), 0 );
+  BOOST_CHECK( index.byReference( "374318" ).empty() );
+
+  test.loadRepo( TESTS_SRC_DIR "/data/11.0-update", "update" );
+  BOOST_CHECK_EQUAL( index.byReference( "374318" ).size(), 1 );
+}
@@ -1,4 +1,6 @@
 
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <iostream>
 #include <fstream>
 #include <list>
@@ -210,3 +212,54 @@ BOOST_AUTO_TEST_CASE(test_exchange)
   BOOST_CHECK( PathInfo(a).isFile() );
   BOOST_CHECK( PathInfo(b).isDir() );
 }
+
+BOOST_AUTO_TEST_CASE(test_copy)
+{
+  TmpDir root;
+  Pathname src( root/"src" );
+  filesystem::assert_dir( src/"sub" );
+  ofstream( (src/"file").c_str() ) << "file content";
+  filesystem::chmod( src/"file", 0640 );
+  BOOST_CHECK_EQUAL( filesystem::hardlink( src/"file", src/"sub/link" ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::symlink( "../file", src/"sub/symlink" ), 0 );
+  struct timespec times[2] = { { 1000000000, 0 }, { 1000000000, 0 } };
+  ::utimensat( AT_FDCWD, (src/"file").c_str(), times, 0 );
+
+  // copy
+  Pathname file( root/"file" );
+  BOOST_CHECK_EQUAL( filesystem::copy( src/"nofile", file ), EINVAL );
+  BOOST_CHECK_EQUAL( filesystem::copy( src/"file", src/"sub" ), EISDIR );
+  BOOST_CHECK_EQUAL( filesystem::copy( src/"file", file ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::checksum( file, "sha1" ), filesystem::checksum( src/"file", "sha1" ) );
+  BOOST_CHECK_EQUAL( PathInfo( file ).perm(), 0640 );
+  BOOST_CHECK_EQUAL( PathInfo( file ).mtime(), 1000000000 );
+  // destination is replaced, not written through a hardlink
+  BOOST_CHECK_EQUAL( filesystem::hardlink( file, root/"otherlink" ), 0 );
+  ofstream( (src/"file").c_str() ) << "new content";
+  BOOST_CHECK_EQUAL( filesystem::copy( src/"file", file ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::checksum( file, "sha1" ), filesystem::checksum( src/"file", "sha1" ) );
+  BOOST_CHECK( filesystem::checksum( root/"otherlink", "sha1" ) != filesystem::checksum( file, "sha1" ) );
+
+  // copy_file2dir
+  BOOST_CHECK_EQUAL( filesystem::copy_file2dir( src/"file", file ), ENOTDIR );
+  BOOST_CHECK_EQUAL( filesystem::copy_file2dir( src/"file", root ), 0 );
+  BOOST_CHECK( PathInfo( root/"file" ).isFile() );
+
+  // copy_dir
+  Pathname dest( root/"dest" );
+  filesystem::assert_dir( dest );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, file ), ENOTDIR );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, src/"sub" ), EINVAL );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, dest ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, dest ), EEXIST );
+  BOOST_CHECK( PathInfo( dest/"src/file" ).isFile() );
+  BOOST_CHECK_EQUAL( PathInfo( dest/"src/file" ).ino(), PathInfo( dest/"src/sub/link" ).ino() );
+  BOOST_CHECK_EQUAL( filesystem::readlink( dest/"src/sub/symlink" ), Pathname( "../file" ) );
+
+  // copy_dir_content
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( src, src ), EEXIST );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( src, dest ), 0 );
+  BOOST_CHECK( PathInfo( dest/"sub/link" ).isFile() );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( src, dest ), 0 );	// merge into existing
+  BOOST_CHECK( PathInfo( dest/"sub/symlink", PathInfo::LSTAT ).isLink() );
+}
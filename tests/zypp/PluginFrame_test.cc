@@ -169,6 +169,24 @@ BOOST_AUTO_TEST_CASE(PluginScriptReceive)
   BOOST_CHECK_THROW(  scr.receive(), PluginScriptDiedUnexpectedly );
 }
 
+BOOST_AUTO_TEST_CASE(PluginScriptReceiveBuffered)
+{
+  // several frames pending: each receive returns just one
+  PluginFrame f1( "ONE" );
+  f1.setBody( std::string( 10000, '1' ) );
+  PluginFrame f2( "TWO", "two" );
+
+  PluginScript scr( "/bin/cat" );
+  scr.open();
+  scr.send( f1 );
+  scr.send( f2 );
+  scr.send( f2 );
+  BOOST_CHECK_EQUAL( scr.receive(), f1 );
+  BOOST_CHECK_EQUAL( scr.receive(), f2 );
+  BOOST_CHECK_EQUAL( scr.receive(), f2 );
+  BOOST_CHECK_THROW( scr.receive(), PluginScriptReceiveTimeout );
+}
+
 BOOST_AUTO_TEST_CASE(PluginExecutorTest)
 {
   PluginExecutor exec;
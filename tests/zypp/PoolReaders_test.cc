@@ -0,0 +1,155 @@
+#include <sstream>
+#include <thread>
+#include <atomic>
+
+#include "TestSetup.h"
+extern "C"
+{
+#include <solv/pool.h>
+}
+#include "zypp/PoolQuery.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/sat/WhatProvides.h"
+
+#define BOOST_TEST_MODULE PoolReaders
+
+/////////////////////////////////////////////////////////////////////////////
+static TestSetup test( Arch_x86_64 );
+
+namespace
+{
+  const unsigned readers = 8;
+  const unsigned rounds  = 20;
+
+  /** Some typical read only pool access, the result as string. */
+  std::string readPool()
+  {
+    std::ostringstream str;
+    ResPool pool( ResPool::instance() );
+
+    for ( const char * name : { "zypper", "glibc", "yast2", "kernel-default" } )
+    {
+      for ( const PoolItem & pi : pool.byIdent( ResKind::package, name ) )
+      {
+        str << pi.satSolvable().asString() << ": " << pi.summary() << endl;
+        for ( const Capability & cap : pi.requires() )
+          str << "  requires " << cap.asString() << endl;
+        str << "  location " << pi.satSolvable().lookupLocation() << endl;
+      }
+    }
+
+    for ( const char * cap : { "libc.so.6", "/bin/sh", "perl >= 5", "pattern() = base" } )
+    {
+      for ( sat::Solvable solv : sat::WhatProvides( Capability( cap ) ) )
+        str << cap << ": " << solv.asString() << endl;
+    }
+
+    PoolQuery q;
+    q.addString( "yast2-" );
+    q.addAttribute( sat::SolvAttr::name );
+    q.setMatchSubstring();
+    for ( sat::Solvable solv : q )
+      str << "query " << solv.asString() << endl;
+
+    for ( const PoolItem & pi : pool.byIdent( ResKind::package, "zypper" ) )
+    {
+      for ( sat::LookupAttr::iterator it = sat::LookupAttr( sat::SolvAttr::description, pi.satSolvable() ).begin(); ! it.atEnd(); ++it )
+        str << "description " << it.asString().size() << endl;
+    }
+    return str.str();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pool_readers_init)
+{
+  test.loadTargetRepo( TESTS_SRC_DIR "/data/obs_virtualbox_11_1" );
+  test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "opensuse" );
+  BOOST_REQUIRE( ! test.pool().empty() );
+  BOOST_CHECK( ! test.pool().frozen() );
+}
+
+BOOST_AUTO_TEST_CASE(pool_readers_frozen)
+{
+  // The result computed single threaded (and creating all strings needed).
+  const std::string expected( readPool() );
+  BOOST_REQUIRE( ! expected.empty() );
+
+  test.pool().freeze();
+  BOOST_CHECK( test.pool().frozen() );
+  const sat::detail::CPool * cpool( test.satpool().get() );
+  {
+    ResPool::ReadGuard guard;
+    // lookups don't rebuild the string hash
+    const Hashtable stringhashtbl( cpool->ss.stringhashtbl );
+    BOOST_CHECK( stringhashtbl );
+    BOOST_CHECK_EQUAL( readPool(), expected );
+
+    // Nothing is created while readers hold the pool...
+    BOOST_CHECK( ! IdString( "no-such-string-in-the-pool" ) );
+    BOOST_CHECK( ! Capability( "no-such-capability-in-the-pool > 1.0" ) );
+    BOOST_CHECK( test.pool().frozen() );
+    BOOST_CHECK( cpool->ss.stringhashtbl == stringhashtbl );
+  }
+  // ...but afterwards, e.g. for Resolver::addRequire
+  BOOST_CHECK( Capability( "no-such-capability-in-the-pool > 1.0" ) );
+  BOOST_CHECK( ! test.pool().frozen() );
+  {
+    // the next reader prepares the new ones
+    ResPool::ReadGuard guard;
+    BOOST_CHECK( test.pool().frozen() );
+    BOOST_CHECK( Capability( "no-such-capability-in-the-pool > 1.0" ) );
+  }
+  {
+    // and by a writer
+    ResPool::WriteGuard guard;
+    BOOST_CHECK( IdString( "no-such-string-written" ) );
+  }
+  BOOST_CHECK( IdString( "no-such-string-written" ) );
+
+  // Changing the pool thaws it.
+  test.satpool().addRequestedLocale( Locale( "de" ) );
+  BOOST_CHECK( ! test.pool().frozen() );
+  test.satpool().eraseRequestedLocale( Locale( "de" ) );
+}
+
+BOOST_AUTO_TEST_CASE(pool_readers_threads)
+{
+  const std::string expected( readPool() );
+  std::vector<std::string> results( readers * rounds );
+  std::atomic<bool> done( false );
+
+  // A writer adding dependencies and changing the requested locales
+  // while the readers are active.
+  std::thread writer( [&done]() {
+    for ( unsigned i = 0; ! done; ++i )
+    {
+      ResPool::WriteGuard guard;
+      Capability( "pool-readers-test-" + str::numstring( i ) );
+      if ( i % 2 )
+        sat::Pool::instance().addRequestedLocale( Locale( "de" ) );
+      else
+        sat::Pool::instance().eraseRequestedLocale( Locale( "de" ) );
+      std::this_thread::yield();
+    }
+  } );
+
+  std::vector<std::thread> threads;
+  for ( unsigned r = 0; r < readers; ++r )
+  {
+    threads.push_back( std::thread( [r,&results]() {
+      for ( unsigned i = 0; i < rounds; ++i )
+      {
+        ResPool::ReadGuard guard;
+        results[r*rounds+i] = readPool();
+      }
+    } ) );
+  }
+  for ( std::thread & thread : threads )
+    thread.join();
+  done = true;
+  writer.join();
+
+  for ( const std::string & result : results )
+    BOOST_CHECK( result == expected );
+  BOOST_CHECK( Capability( "pool-readers-test-0" ) );
+}
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <utime.h>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Exception.h"
@@ -21,6 +22,8 @@
 
 #include "KeyRingTestReceiver.h"
 
+#include "WebServer.h"
+
 using boost::unit_test::test_suite;
 using boost::unit_test::test_case;
 
@@ -255,6 +258,14 @@ BOOST_AUTO_TEST_CASE(repomanager_test)
   manager.buildCache(repo);
 
   manager.loadFromCache(repo);
+  unsigned loadedSize = sat::Pool::instance().reposFind( repo.alias() ).solvablesSize();
+  BOOST_CHECK( loadedSize );
+
+  // loading several repos at once replaces the loaded one, too
+  RepoInfoList toload;
+  toload.push_back( repo );
+  manager.loadFromCache( toload );
+  BOOST_CHECK_EQUAL( sat::Pool::instance().reposFind( repo.alias() ).solvablesSize(), loadedSize );
 
   if ( manager.isCached(repo ) )
   {
@@ -271,6 +282,60 @@ BOOST_AUTO_TEST_CASE(repomanager_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(load_several_one_failing)
+{
+  KeyRingTestReceiver keyring_callbacks;
+  KeyRingTestSignalReceiver receiver;
+
+  // disable sgnature checking
+  keyring_callbacks.answerAcceptKey(KeyRingReport::KEY_TRUST_TEMPORARILY);
+  keyring_callbacks.answerAcceptVerFailed(true);
+  keyring_callbacks.answerAcceptUnknownKey(true);
+
+  TmpDir tmpCachePath;
+  RepoManagerOptions opts( RepoManagerOptions::makeTestSetup( tmpCachePath ) );
+  RepoManager manager( opts );
+
+  RepoInfoList repos;
+  for ( const char * alias : { "first", "broken", "last" } )
+  {
+    RepoInfo repo;
+    repo.setAlias( alias );
+    repo.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/yum/data/10.2-updates-subset").asDirUrl() );
+    manager.buildCache( repo );
+    repos.push_back( repo );
+  }
+  sat::Pool pool( sat::Pool::instance() );
+  pool.reposEraseAll();
+  manager.loadFromCache( repos );
+  unsigned size = pool.reposFind( "first" ).solvablesSize();
+  BOOST_REQUIRE( size );
+
+  // a damaged solv file is rebuilt, the other repos are loaded as usual
+  Pathname brokenSolv( opts.repoSolvCachePath / "broken" / "solv" );
+  pool.reposEraseAll();
+  ofstream( brokenSolv.c_str() ) << "no solv file" << endl;
+  manager.loadFromCache( repos );
+  BOOST_CHECK_EQUAL( pool.reposSize(), 3 );
+  BOOST_CHECK_EQUAL( pool.reposFind( "first" ).solvablesSize(), size );
+  BOOST_CHECK_EQUAL( pool.reposFind( "broken" ).solvablesSize(), size );
+  BOOST_CHECK_EQUAL( pool.reposFind( "last" ).solvablesSize(), size );
+
+  // if it can not be rebuilt either, the error is passed on
+  pool.reposEraseAll();
+  ofstream( brokenSolv.c_str() ) << "no solv file" << endl;
+  BOOST_REQUIRE_EQUAL( recursive_rmdir( opts.repoRawCachePath / "broken" ), 0 );
+  RepoInfoList::iterator broken( repos.begin() );
+  ++broken;
+  broken->setBaseUrl( (tmpCachePath.path() / "nonexistent").asDirUrl() );
+  BOOST_CHECK_THROW( manager.loadFromCache( repos ), Exception );
+  BOOST_CHECK_EQUAL( pool.reposFind( "first" ).solvablesSize(), size );
+  BOOST_CHECK( ! pool.reposFind( "broken" ) );
+  BOOST_CHECK( ! pool.reposFind( "last" ) );
+
+  pool.reposEraseAll();
+}
+
 BOOST_AUTO_TEST_CASE(repo_seting_test)
 {
   RepoInfo repo;
@@ -279,6 +344,84 @@ BOOST_AUTO_TEST_CASE(repo_seting_test)
   BOOST_CHECK_MESSAGE( !repo.keepPackages(), "keepPackages must default to OFF");
 }
 
+namespace
+{
+  void setMtime( const Pathname & file_r, time_t mtime_r )
+  {
+    struct utimbuf times;
+    times.actime = times.modtime = mtime_r;
+    BOOST_REQUIRE_EQUAL( ::utime( file_r.c_str(), &times ), 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(refresh_check_conditional_request)
+{
+  KeyRingTestReceiver keyring_callbacks;
+  KeyRingTestSignalReceiver receiver;
+
+  // disable sgnature checking
+  keyring_callbacks.answerAcceptKey(KeyRingReport::KEY_TRUST_TEMPORARILY);
+  keyring_callbacks.answerAcceptVerFailed(true);
+  keyring_callbacks.answerAcceptUnknownKey(true);
+
+  TmpDir docroot;
+  BOOST_REQUIRE_EQUAL( copy_dir_content( Pathname(TESTS_SRC_DIR) / "/repo/yum/data/10.2-updates-subset", docroot.path() ), 0 );
+  Pathname repomd( docroot.path() / "repodata/repomd.xml" );
+  time_t mtime = Date::now() - 24*3600;
+  setMtime( repomd, mtime );
+
+  WebServer web( docroot.path(), 10001 );
+  web.start();
+
+  TmpDir tmpCachePath;
+  RepoManagerOptions opts( RepoManagerOptions::makeTestSetup( tmpCachePath ) );
+  RepoManager manager( opts );
+
+  RepoInfo repo;
+  repo.setAlias( "conditional" );
+  repo.setType( RepoType::RPMMD );
+  repo.setBaseUrl( web.url() );
+  RepoInfoList repos;
+  repos.push_back( repo );
+
+  // not cached: decided locally
+  std::map<std::string,RepoManager::RefreshCheckStatus> check( manager.checkIfToRefreshMetadata( repos, RepoManager::RefreshIfNeededIgnoreDelay ) );
+  BOOST_CHECK_EQUAL( check.size(), 1 );
+  BOOST_CHECK_EQUAL( check[repo.alias()], RepoManager::REFRESH_NEEDED );
+
+  manager.refreshMetadata( repo );
+
+  // no validators yet: the regular check decides and the validators are remembered
+  Pathname validators( opts.repoRawCachePath / repo.alias() / ".http_validators" );
+  BOOST_CHECK( ! PathInfo( validators ).isExist() );
+  check = manager.checkIfToRefreshMetadata( repos, RepoManager::RefreshIfNeededIgnoreDelay );
+  BOOST_CHECK_EQUAL( check[repo.alias()], RepoManager::REPO_UP_TO_DATE );
+  BOOST_CHECK( PathInfo( validators ).isFile() );
+
+  // delayed: no request at all
+  check = manager.checkIfToRefreshMetadata( repos, RepoManager::RefreshIfNeeded );
+  BOOST_CHECK_EQUAL( check[repo.alias()], RepoManager::REPO_CHECK_DELAYED );
+
+  // Change repomd.xml but keep it older than the remembered Last-Modified.
+  // The server answers 304 and the changed file is not even looked at.
+  ofstream( repomd.c_str(), std::ios::app ) << "<!-- changed -->" << endl;
+  setMtime( repomd, mtime - 3600 );
+  check = manager.checkIfToRefreshMetadata( repos, RepoManager::RefreshIfNeededIgnoreDelay );
+  BOOST_CHECK_EQUAL( check[repo.alias()], RepoManager::REPO_UP_TO_DATE );
+
+  // modified since: the regular check sees the change
+  setMtime( repomd, Date::now() );
+  check = manager.checkIfToRefreshMetadata( repos, RepoManager::RefreshIfNeededIgnoreDelay );
+  BOOST_CHECK_EQUAL( check[repo.alias()], RepoManager::REFRESH_NEEDED );
+
+  // disabled repos are not checked
+  repos.front().setEnabled( false );
+  check = manager.checkIfToRefreshMetadata( repos, RepoManager::RefreshIfNeededIgnoreDelay );
+  BOOST_CHECK( check.empty() );
+
+  web.stop();
+}
+
 //! \todo test this
 //BOOST_AUTO_TEST_CASE(repo_dont_overwrite_external_settings_test)
 //{
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <string>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/PublicKey.h"
+#include "zypp/TmpPath.h"
+#include "zypp/target/rpm/RpmDb.h"
+
+using boost::unit_test::test_case;
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::filesystem;
+using namespace zypp::target::rpm;
+
+// see tests/data/rpms/mkrpm.py
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/data/rpms")
+
+namespace
+{
+  /** Run rpm on \a root_r, like another process would do. */
+  int rpm( const Pathname & root_r, const ExternalProgram::Arguments & args_r )
+  {
+    ExternalProgram::Arguments argv { "rpm", "--root", root_r.asString(), "--dbpath", "/var/lib/rpm" };
+    argv.insert( argv.end(), args_r.begin(), args_r.end() );
+    ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
+    for ( string line = prog.receiveLine(); ! line.empty(); line = prog.receiveLine() )
+      cout << line;
+    return prog.close();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(checkPackage_follows_keyring)
+{
+  TmpDir root;
+  RpmDb rpmdb;
+  rpmdb.initDatabase( root.path() );
+  Pathname pkg( DATADIR / "foo-1.0-1.noarch.rpm" );
+
+  BOOST_CHECK_EQUAL( rpmdb.checkPackage( pkg ), RpmDb::CHK_NOKEY );
+  BOOST_CHECK_EQUAL( rpmdb.checkPackage( pkg ), RpmDb::CHK_NOKEY );
+
+  // keyring changed by rpm itself, not by this RpmDb
+  BOOST_REQUIRE_EQUAL( rpm( root.path(), { "--import", (DATADIR / "public.asc").asString() } ), 0 );
+  BOOST_CHECK_EQUAL( rpmdb.checkPackage( pkg ), RpmDb::CHK_OK );
+  BOOST_CHECK_EQUAL( rpmdb.checkPackage( pkg ), RpmDb::CHK_OK );
+
+  BOOST_REQUIRE_EQUAL( rpm( root.path(), { "-e", "--allmatches", "gpg-pubkey-e3826d62" } ), 0 );
+  BOOST_CHECK_EQUAL( rpmdb.checkPackage( pkg ), RpmDb::CHK_NOKEY );
+
+  // and by this RpmDb
+  rpmdb.importPubkey( PublicKey( DATADIR / "public.asc" ) );
+  BOOST_CHECK_EQUAL( rpmdb.checkPackage( pkg ), RpmDb::CHK_OK );
+  rpmdb.removePubkey( PublicKey( DATADIR / "public.asc" ) );
+  BOOST_CHECK_EQUAL( rpmdb.checkPackage( pkg ), RpmDb::CHK_NOKEY );
+
+  rpmdb.closeDatabase();
+}
+
+BOOST_AUTO_TEST_CASE(queries_follow_rpmdb)
+{
+  TmpDir root;
+  RpmDb rpmdb;
+  rpmdb.initDatabase( root.path() );
+
+  BOOST_CHECK( ! rpmdb.hasPackage( "foo" ) );
+  BOOST_CHECK( ! rpmdb.hasProvides( "foo-capability" ) );
+  BOOST_CHECK( ! rpmdb.hasRequiredBy( "bar-capability" ) );
+  BOOST_CHECK( ! rpmdb.hasConflicts( "foo-old" ) );
+
+  // installed by rpm itself, not by this RpmDb
+  BOOST_REQUIRE_EQUAL( rpm( root.path(), { "-i", "--justdb", "--nodeps", "--nosignature",
+                                           (DATADIR / "foo-1.0-1.noarch.rpm").asString() } ), 0 );
+  BOOST_CHECK( rpmdb.hasPackage( "foo" ) );
+  BOOST_CHECK( rpmdb.hasPackage( "foo", Edition( "1.0-1" ) ) );
+  BOOST_CHECK( ! rpmdb.hasPackage( "foo", Edition( "2.0-1" ) ) );
+  BOOST_CHECK( rpmdb.hasProvides( "foo-capability" ) );
+  BOOST_CHECK( rpmdb.hasRequiredBy( "bar-capability" ) );
+  BOOST_CHECK( rpmdb.hasConflicts( "foo-old" ) );
+  BOOST_CHECK( ! rpmdb.hasProvides( "bar-capability" ) );
+
+  RpmHeader::constPtr header;
+  rpmdb.getData( "foo", header );
+  BOOST_REQUIRE( header );
+  BOOST_CHECK_EQUAL( header->tag_edition(), Edition( "1.0-1" ) );
+
+  BOOST_REQUIRE_EQUAL( rpm( root.path(), { "-e", "--justdb", "--nodeps", "foo" } ), 0 );
+  BOOST_CHECK( ! rpmdb.hasPackage( "foo" ) );
+  BOOST_CHECK( ! rpmdb.hasProvides( "foo-capability" ) );
+  BOOST_CHECK( ! rpmdb.hasRequiredBy( "bar-capability" ) );
+  BOOST_CHECK( ! rpmdb.hasConflicts( "foo-old" ) );
+  rpmdb.getData( "foo", header );
+  BOOST_CHECK( ! header );
+
+  rpmdb.closeDatabase();
+}
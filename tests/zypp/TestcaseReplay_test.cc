@@ -0,0 +1,117 @@
+#include <fstream>
+#include "TestSetup.h"
+#include "zypp/ResPool.h"
+#include "zypp/misc/TestcaseReplay.h"
+
+#define BOOST_TEST_MODULE TestcaseReplay
+
+/////////////////////////////////////////////////////////////////////////////
+
+static TestSetup test;
+
+namespace
+{
+  /** The items transacting after a solver run. */
+  std::string transacting()
+  {
+    std::set<std::string> ret;
+    for ( const PoolItem & pi : test.pool() )
+    {
+      if ( pi.status().transacts() )
+        ret.insert( pi.satSolvable().asString() + ( pi.status().isToBeInstalled() ? " install" : " remove" ) );
+    }
+    return str::join( ret, "\n" );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(replay)
+{
+  test.loadTestcaseRepos( TESTS_SRC_DIR"/data/TCdup" );
+  BOOST_REQUIRE( test.resolver().doUpgrade() );
+  const std::string expected( transacting() );
+  BOOST_REQUIRE( ! expected.empty() );
+
+  solver::detail::SolverStats stats( test.resolver().solverStats() );
+  BOOST_CHECK( stats.rules > 0 );
+  BOOST_CHECK( stats.decisions > 0 );
+  BOOST_CHECK_EQUAL( stats.problems, 0 );
+
+  filesystem::TmpDir dir;
+  BOOST_REQUIRE( test.resolver().createSolverTestcase( dir.path().asString(), false ) );
+  BOOST_REQUIRE( misc::TestcaseReplay::isTestcase( dir.path() ) );
+  BOOST_CHECK( PathInfo( dir.path() / "solver-system.solv" ).isFile() );
+  BOOST_CHECK( PathInfo( dir.path() / "solver-system.xml.gz" ).isFile() );	// helix still written
+
+  misc::TestcaseReplay replay( dir.path() );
+  BOOST_CHECK_EQUAL( replay.missingItems(), 0 );
+  BOOST_CHECK( ! test.pool().empty() );
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    BOOST_CHECK( replay.solve() );
+    BOOST_CHECK_EQUAL( transacting(), expected );
+    BOOST_CHECK_EQUAL( replay.stats().decisions, stats.decisions );
+    BOOST_CHECK_EQUAL( replay.stats().problems, 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(replay_keep)
+{
+  // the pool replayed by the previous case
+  PoolItem kept;
+  for ( const PoolItem & pi : test.pool() )
+  {
+    pi.status().resetTransact( ResStatus::USER );
+    if ( ! kept && pi.status().isInstalled() )
+      kept = pi;
+  }
+  BOOST_REQUIRE( kept );
+  BOOST_REQUIRE( kept.status().setSoftLock( ResStatus::USER ) );
+  const std::string keptSolvable( kept.satSolvable().asString() );
+
+  filesystem::TmpDir dir;
+  BOOST_REQUIRE( test.resolver().createSolverTestcase( dir.path().asString(), false ) );
+  kept.status().resetTransact( ResStatus::USER );
+
+  misc::TestcaseReplay replay( dir.path() );
+  BOOST_CHECK_EQUAL( replay.missingItems(), 0 );
+  replay.solve();
+  kept = PoolItem();
+  for ( const PoolItem & pi : test.pool() )
+  {
+    if ( pi.status().isInstalled() && pi.satSolvable().asString() == keptSolvable )
+      kept = pi;
+  }
+  BOOST_REQUIRE( kept );
+  BOOST_CHECK( kept.status().isKept() );
+  BOOST_CHECK( ! kept.status().isBySolver() );
+}
+
+BOOST_AUTO_TEST_CASE(replay_without_system)
+{
+  // e.g. at installation time
+  sat::Pool::instance().findSystemRepo().eraseFromPool();
+  for ( const PoolItem & pi : test.pool() )
+    pi.status().resetTransact( ResStatus::USER );
+
+  filesystem::TmpDir dir;
+  BOOST_REQUIRE( test.resolver().createSolverTestcase( dir.path().asString(), false ) );
+  BOOST_CHECK( ! PathInfo( dir.path() / "solver-system.solv" ).isExist() );
+  misc::TestcaseReplay replay( dir.path() );
+  BOOST_CHECK( ! sat::Pool::instance().findSystemRepo() );
+  BOOST_CHECK( ! test.pool().empty() );
+}
+
+BOOST_AUTO_TEST_CASE(no_testcase)
+{
+  filesystem::TmpDir dir;
+  BOOST_CHECK( ! misc::TestcaseReplay::isTestcase( dir.path() ) );
+  BOOST_CHECK_THROW( misc::TestcaseReplay( dir.path() ), Exception );
+}
+
+BOOST_AUTO_TEST_CASE(missing_solv_file)
+{
+  filesystem::TmpDir dir;
+  std::ofstream( (dir.path() / "solver-test.job").c_str() ) << "version 1\nsystem solver-system.solv\n";
+  BOOST_REQUIRE( misc::TestcaseReplay::isTestcase( dir.path() ) );
+  BOOST_CHECK_THROW( misc::TestcaseReplay( dir.path() ), Exception );
+}
@@ -293,4 +293,39 @@ BOOST_AUTO_TEST_CASE(plugin_querystring_args)
   BOOST_CHECK_EQUAL( pm["o"], "" );
 }
 
+BOOST_AUTO_TEST_CASE(split_and_validate)
+{
+  Url u( "http://user:pass@[::1]:8080/a/b?x=1#frag" );
+  testUrlAuthority( u, "[::1]", "8080", "user", "pass" );
+  BOOST_CHECK_EQUAL( u.getScheme(),		"http" );
+  BOOST_CHECK_EQUAL( u.getPathName(),		"/a/b" );
+  BOOST_CHECK_EQUAL( u.getQueryString(),	"x=1" );
+  BOOST_CHECK_EQUAL( u.getFragment(),		"frag" );
+
+  u = Url( "http://host/some/path#frag?nq" );
+  BOOST_CHECK_EQUAL( u.getPathName(),		"/some/path" );
+  BOOST_CHECK_EQUAL( u.getQueryString(),	"" );
+  BOOST_CHECK_EQUAL( u.getFragment(),		"frag?nq" );
+
+  u = Url( "dir:/some/path" );
+  BOOST_CHECK_EQUAL( u.getScheme(),		"dir" );
+  BOOST_CHECK_EQUAL( u.getHost(),		"" );
+  BOOST_CHECK_EQUAL( u.getPathName(),		"/some/path" );
+
+  testUrlAuthority( Url( "http://192.168.0.1:21/" ),	"192.168.0.1", "21" );
+  testUrlAuthority( Url( "http://a-b.c9.example/" ),	"a-b.c9.example" );
+
+  BOOST_CHECK_THROW( Url( "1http://host/" ),		url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://bad..host/" ),	url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://-bad.host/" ),	url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://bad.host-/" ),	url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://bad_host/" ),		url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://[::1:/" ),		url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://[::g]/" ),		url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://host:0/" ),		url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://host:65536/" ),	url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://host:123456/" ),	url::UrlException );
+  BOOST_CHECK_THROW( Url( "http://host:8a/" ),		url::UrlException );
+}
+
 // vim: set ts=2 sts=2 sw=2 ai et:
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Trace.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ExternalProgram.h"
+
+using std::endl;
+using namespace zypp;
+using namespace zypp::debug;
+
+namespace
+{
+  std::string readFile( const Pathname & file_r )
+  {
+    std::ifstream in( file_r.c_str() );
+    return std::string( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+  }
+
+  bool contains( const std::string & str_r, const std::string & sub_r )
+  { return str_r.find( sub_r ) != std::string::npos; }
+}
+
+BOOST_AUTO_TEST_CASE(disabled)
+{
+  Trace::enable( Pathname() );
+  Trace::clear();
+  BOOST_CHECK( ! Trace::enabled() );
+  {
+    TraceSpan span( "solve" );
+  }
+  Trace::count( "cache_hits" );
+  std::ostringstream str;
+  Trace::dumpPrometheus( str );
+  BOOST_CHECK( str.str().empty() );
+  BOOST_CHECK( ! Trace::write() );
+}
+
+BOOST_AUTO_TEST_CASE(prometheus)
+{
+  filesystem::TmpDir dir;
+  Trace::enable( dir.path() / "metrics.prom" );
+  Trace::clear();
+  BOOST_CHECK( Trace::enabled() );
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    TraceSpan span( "solve" );
+  }
+  Trace::count( "download_bytes", 1000 );
+  Trace::count( "download_bytes", 24 );
+  Trace::count( "cache.hits" );
+
+  std::ostringstream str;
+  Trace::dumpPrometheus( str );
+  BOOST_CHECK( contains( str.str(), "zypp_span_calls_total{span=\"solve\"} 3\n" ) );
+  BOOST_CHECK( contains( str.str(), "zypp_span_seconds_total{span=\"solve\"} " ) );
+  BOOST_CHECK( contains( str.str(), "zypp_download_bytes_total 1024\n" ) );
+  BOOST_CHECK( contains( str.str(), "zypp_cache_hits_total 1\n" ) );
+
+  BOOST_REQUIRE( Trace::write() );
+  BOOST_CHECK_EQUAL( readFile( dir.path() / "metrics.prom" ), str.str() );
+  Trace::enable( Pathname() );
+}
+
+BOOST_AUTO_TEST_CASE(chrome_trace)
+{
+  filesystem::TmpDir dir;
+  Trace::enable( dir.path() / "trace.json" );
+  Trace::clear();
+  {
+    TraceSpan span( "refresh", "repo \"a\"" );
+    ExternalProgram( "/bin/true" ).close();
+  }
+
+  BOOST_REQUIRE( Trace::write() );
+  std::string json( readFile( dir.path() / "trace.json" ) );
+  BOOST_CHECK( contains( json, "\"traceEvents\":[" ) );
+  BOOST_CHECK( contains( json, "{\"name\":\"refresh\",\"cat\":\"zypp\",\"ph\":\"X\"" ) );
+  BOOST_CHECK( contains( json, "\"args\":{\"detail\":\"repo \\\"a\\\"\"}" ) );
+  BOOST_CHECK( contains( json, "{\"name\":\"processes_spawned\",\"cat\":\"zypp\",\"ph\":\"C\"" ) );
+  BOOST_CHECK( contains( json, "\"args\":{\"value\":1}" ) );
+  Trace::enable( Pathname() );
+}
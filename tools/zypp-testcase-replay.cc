@@ -0,0 +1,174 @@
+#define INCLUDE_TESTSETUP_WITHOUT_BOOST
+#include "zypp/../tests/lib/TestSetup.h"
+#undef  INCLUDE_TESTSETUP_WITHOUT_BOOST
+
+#include <algorithm>
+#include <chrono>
+#include <zypp/base/Json.h>
+#include <zypp/misc/TestcaseReplay.h>
+
+static std::string appname( "zypp-testcase-replay" );
+
+int usage( const std::string & msg_r = std::string(), int exit_r = 100 )
+{
+  if ( ! msg_r.empty() )
+  {
+    cerr << endl << msg_r << endl << endl;
+  }
+  cerr << "Usage: " << appname << " [--repeat N] [--json] TESTCASEDIR..." << endl;
+  cerr << "  Load each solv testcase (see misc::TestcaseReplay) once and solve it" << endl;
+  cerr << "  N times. Report load and solve times, rules and decisions per case." << endl;
+  cerr << "  --repeat N  Number of solver runs per testcase (default 5)." << endl;
+  cerr << "  --json      Write the report as JSON." << endl;
+  cerr << "" << endl;
+  return exit_r;
+}
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  inline double msSince( const Clock::time_point & start_r )
+  { return std::chrono::duration<double,std::milli>( Clock::now() - start_r ).count(); }
+
+  /** A time in ms, written as JSON number. */
+  struct Ms
+  {
+    Ms( double val_r ) : _val( val_r ) {}
+    std::string asJSON() const { return str::form( "%.3f", _val ); }
+    double _val;
+  };
+
+  struct Result
+  {
+    Result()
+    : ok( false ), missing( 0 ), loadTime( 0.0 )
+    {}
+
+    std::string	testcase;
+    bool	ok;
+    unsigned	missing;
+    double	loadTime;
+    std::vector<double> solveTimes;	// sat solver
+    std::vector<double> totalTimes;	// whole solve() call
+    solver::detail::SolverStats stats;
+
+    static double median( std::vector<double> val_r )
+    {
+      if ( val_r.empty() )
+        return 0.0;
+      std::sort( val_r.begin(), val_r.end() );
+      return val_r[val_r.size()/2];
+    }
+
+    std::string asJSON() const
+    {
+      json::Object ret;
+      ret.add( "testcase",		testcase );
+      ret.add( "ok",			ok );
+      ret.add( "missing_items",		missing );
+      ret.add( "load_ms",		Ms( loadTime ) );
+      ret.add( "solve_median_ms",	Ms( median( solveTimes ) ) );
+      ret.add( "solve_min_ms",		Ms( *std::min_element( solveTimes.begin(), solveTimes.end() ) ) );
+      ret.add( "solve_max_ms",		Ms( *std::max_element( solveTimes.begin(), solveTimes.end() ) ) );
+      ret.add( "total_median_ms",	Ms( median( totalTimes ) ) );
+      ret.add( "rules",			stats.rules );
+      ret.add( "decisions",		stats.decisions );
+      ret.add( "problems",		stats.problems );
+      return ret.asJSON();
+    }
+  };
+}
+
+/******************************************************************
+**
+**      FUNCTION NAME : main
+**      FUNCTION TYPE : int
+*/
+int main( int argc, char * argv[] )
+{
+  appname = Pathname::basename( argv[0] );
+  --argc,++argv;
+
+  unsigned repeat = 5;
+  bool asJson = false;
+  while ( argc && argv[0][0] == '-' )
+  {
+    std::string arg( argv[0] );
+    if ( arg == "--repeat" )
+    {
+      if ( argc < 2 || ! ( repeat = str::strtonum<unsigned>( argv[1] ) ) )
+        return usage( "--repeat needs a positive number" );
+      --argc,++argv;
+    }
+    else if ( arg == "--json" )
+      asJson = true;
+    else if ( arg == "--help" || arg == "-h" )
+      return usage( std::string(), 0 );
+    else
+      return usage( "Unknown option " + arg );
+    --argc,++argv;
+  }
+  if ( ! argc )
+    return usage( "No testcase given" );
+
+  // private root and lock
+  TestSetup test;
+
+  json::Array report;
+  int ret = 0;
+  for ( ; argc; --argc,++argv )
+  {
+    Pathname dir( argv[0] );
+    if ( ! misc::TestcaseReplay::isTestcase( dir ) )
+    {
+      cerr << dir << ": not a solv testcase" << endl;
+      ret = 1;
+      continue;
+    }
+
+    Result result;
+    result.testcase = dir.asString();
+    try
+    {
+      Clock::time_point start( Clock::now() );
+      misc::TestcaseReplay testcase( dir );
+      result.loadTime = msSince( start );
+      result.missing = testcase.missingItems();
+
+      for ( unsigned i = 0; i < repeat; ++i )
+      {
+        start = Clock::now();
+        result.ok = testcase.solve();
+        result.totalTimes.push_back( msSince( start ) );
+        result.stats = testcase.stats();
+        result.solveTimes.push_back( result.stats.solveTime );
+      }
+    }
+    catch ( const Exception & excpt )
+    {
+      ZYPP_CAUGHT( excpt );
+      cerr << dir << ": " << excpt.asUserHistory() << endl;
+      ret = 1;
+      continue;
+    }
+
+    if ( asJson )
+      report.add( result );
+    else
+      cout << str::form( "%-40s %-8s load %9.3fms  solve %9.3fms (total %9.3fms)  rules %8u  decisions %7u",
+                         result.testcase.c_str(),
+                         result.ok ? "ok" : "problems",
+                         result.loadTime,
+                         Result::median( result.solveTimes ),
+                         Result::median( result.totalTimes ),
+                         result.stats.rules,
+                         result.stats.decisions )
+           << ( result.missing ? str::form( "  (%u items missing)", result.missing ) : std::string() )
+           << endl;
+  }
+
+  if ( asJson )
+    cout << report << endl;
+  return ret;
+}
@@ -144,24 +144,28 @@ namespace zypp
       // First build the name, non-packages prefixed by kind
       sat::Solvable::SplitIdent split( kind_r, name_r );
       sat::detail::IdType nid( split.ident().id() );
+      // No new relations while readers hold the pool; unknown ones are Null.
+      bool create = ! sat::detail::PoolMember::myPool().readOnly();
+      if ( ! nid )
+        return nid;
 
       if ( split.kind() == ResKind::srcpackage )
       {
         // map 'kind srcpackage' to 'arch src', the pseudo architecture
         // libsolv uses.
-        nid = ::pool_rel2id( pool_r, nid, IdString(ARCH_SRC).id(), REL_ARCH, /*create*/true );
+        nid = ::pool_rel2id( pool_r, nid, IdString(ARCH_SRC).id(), REL_ARCH, create );
       }
 
       // Extend name by architecture, if provided and not a srcpackage
       if ( ! arch_r.empty() && kind_r != ResKind::srcpackage )
       {
-        nid = ::pool_rel2id( pool_r, nid, arch_r.id(), REL_ARCH, /*create*/true );
+        nid = ::pool_rel2id( pool_r, nid, arch_r.id(), REL_ARCH, create );
       }
 
       // Extend 'op edition', if provided
       if ( op_r != Rel::ANY && ed_r != Edition::noedition )
       {
-        nid = ::pool_rel2id( pool_r, nid, ed_r.id(), op_r.bits(), /*create*/true );
+        nid = ::pool_rel2id( pool_r, nid, ed_r.id(), op_r.bits(), create );
       }
 
       return nid;
@@ -304,12 +308,22 @@ namespace zypp
   ///////////////////////////////////////////////////////////////////
 
   Capability::Capability( ResolverNamespace namespace_r, IdString value_r )
-  : _id( ::pool_rel2id( myPool().getPool(), asIdString(namespace_r).id(), (value_r.empty() ? STRID_NULL : value_r.id() ), REL_NAMESPACE, /*create*/true ) )
+  : _id( ::pool_rel2id( myPool().getPool(), asIdString(namespace_r).id(), (value_r.empty() ? STRID_NULL : value_r.id() ), REL_NAMESPACE, /*create*/! myPool().readOnly() ) )
   {}
 
 
   const char * Capability::c_str() const
-  { return( _id ? ::pool_dep2str( myPool().getPool(), _id ) : "" ); }
+  {
+    auto lock( myPool().tmpspaceLock() );
+    return( _id ? ::pool_dep2str( myPool().getPool(), _id ) : "" );
+  }
+
+  std::string Capability::asString() const
+  {
+    // copy while holding the lock, c_str may point into the pools tmpspace
+    auto lock( myPool().tmpspaceLock() );
+    return( _id ? ::pool_dep2str( myPool().getPool(), _id ) : "" );
+  }
 
   CapMatch Capability::_doMatch( sat::detail::IdType lhs,  sat::detail::IdType rhs )
   {
@@ -151,12 +151,15 @@ namespace zypp
       { return( _id == sat::detail::emptyId || _id == sat::detail::noId ); }
 
     public:
-      /** Conversion to <tt>const char *</tt> */
+      /** Conversion to <tt>const char *</tt>
+       * \note The string may live in a temporary buffer of the pool,
+       * overwritten by later calls. Concurrent readers of a frozen pool
+       * (\ref sat::Pool::freeze) must use \ref asString.
+       */
       const char * c_str() const;
 
       /** \overload */
-      std::string asString() const
-      { return c_str(); }
+      std::string asString() const;
 
     public:
       /** Helper providing more detailed information about a \ref Capability. */
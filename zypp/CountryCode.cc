@@ -15,6 +15,7 @@
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Hash.h"
+#include "zypp/base/CodeTable.h"
 
 #include "zypp/CountryCode.h"
 
@@ -26,135 +27,17 @@ namespace zypp
   ///////////////////////////////////////////////////////////////////
   namespace
   {
-
-    /** Wrap static codemap data. */
-    struct CodeMaps // singleton
+    /** ISO 3166 code table entry. */
+    struct Init
     {
-      /** The singleton */
-      static CodeMaps & instance()
-      {
-	static CodeMaps _instance;
-	return _instance;
-      }
-
-      /** Lookup (translated) name for \a index_r.*/
-      std::string name( IdString index_r )
-      {
-	Link link( getIndex( index_r ) );
-
-	std::string ret;
-	if ( link->second )
-	{ ret = _(link->second); }
-	else
-	{
-	  ret = _("Unknown country: ");
-	  ret += "'";
-	  ret += index_r.c_str();
-	  ret += "'";
-	}
-	return ret;
-      }
-
-    private:
-      typedef std::unordered_map<std::string,const char *> CodeMap;
-      typedef CodeMap::const_iterator Link;
-
-      typedef std::unordered_map<IdString,Link> IndexMap;
-
-      /** Ctor initializes the code maps.
-       * http://www.iso.org/iso/en/prods-services/iso3166ma/02iso-3166-code-lists/list-en1.html
-       */
-      CodeMaps();
-
-      /** Return \ref Link for \a index_r, creating it if necessary. */
-      Link getIndex( IdString index_r )
-      {
-	auto it = _indexMap.find( index_r );
-	return( it != _indexMap.end()
-	      ? it->second
-	      : newIndex( index_r, index_r.asString() ) );
-      }
-
-      /** Return the CodeMap Index for \a code_r. */
-      Link newIndex( IdString index_r, const std::string & code_r )
-      {
-	Link link = _codeMap.find( code_r );
-	if ( link != _codeMap.end() )
-	  return (_indexMap[index_r] = link);
-
-	// not found: Remember a new code
-	CodeMap::value_type nval( code_r, nullptr );
-
-	if ( code_r.size() != 2 )
-	  WAR << "Malformed CountryCode '" << code_r << "' (expect 2-letter)" << endl;
-
-	std::string ucode( str::toUpper( code_r ) );
-	if ( ucode != code_r )
-	{
-	  WAR << "Malformed CountryCode '" << code_r << "' (not upper case)" << endl;
-	  // but maybe we're lucky with the lower case code
-	  // and find a language name.
-	  link = _codeMap.find( ucode );
-	  if ( link != _codeMap.end() )
-	  {
-	    nval.second = link->second;
-	  }
-	}
-	MIL << "Remember CountryCode '" << code_r << "': '" << nval.second << "'" << endl;
-	return (_indexMap[index_r] = _codeMap.insert( nval ).first);
-      }
-
-    private:
-      CodeMap _codeMap;
-      IndexMap _indexMap;
+      const char *iso3166;
+      const char *name;
     };
-  } // namespace
-  ///////////////////////////////////////////////////////////////////
-
-  ///////////////////////////////////////////////////////////////////
-  //	class CountryCode
-  ///////////////////////////////////////////////////////////////////
-
-  const CountryCode CountryCode::noCode;
-
-  CountryCode::CountryCode()
-  {}
-
-  CountryCode::CountryCode( IdString str_r )
-  : _str( str_r )
-  {}
-
-  CountryCode::CountryCode( const std::string & str_r )
-  : _str( str_r )
-  {}
-
-  CountryCode::CountryCode( const char * str_r )
-  : _str( str_r )
-  {}
-
-  CountryCode::~CountryCode()
-  {}
-
 
-  std::string CountryCode::name() const
-  { return CodeMaps::instance().name( _str ); }
-
-  ///////////////////////////////////////////////////////////////////
-  namespace
-  { /////////////////////////////////////////////////////////////////
-
-    CodeMaps::CodeMaps()
-    {
-      // Defined CountryCode constants
-      _codeMap[""]        = N_( "No Code" );
-
-      struct Init
-      {
-	  const char *iso3166;
-	  const char *name;
-      };
-
-      const Init init[] = {
+    /** ISO 3166 codes and (untranslated) names, sorted by code.
+     * http://www.iso.org/iso/en/prods-services/iso3166ma/02iso-3166-code-lists/list-en1.html
+     */
+    constexpr Init init[] = {
           {"AD", N_( "Andorra" ) }, 				// :AND:020:
           {"AE", N_( "United Arab Emirates" ) }, 		// :ARE:784:
           {"AF", N_( "Afghanistan" ) }, 			// :AFG:004:
@@ -372,10 +255,10 @@ namespace zypp
           {"TH", N_( "Thailand" ) }, 				// :THA:764:
           {"TJ", N_( "Tajikistan" ) }, 				// :TJK:762:
           {"TK", N_( "Tokelau" ) }, 				// :TKL:772:
+          {"TL", N_( "East Timor" ) }, 				// :TLS:626:
           {"TM", N_( "Turkmenistan" ) }, 			// :TKM:795:
           {"TN", N_( "Tunisia" ) }, 				// :TUN:788:
           {"TO", N_( "Tonga" ) }, 				// :TON:776:
-          {"TL", N_( "East Timor" ) }, 				// :TLS:626:
           {"TR", N_( "Turkey" ) }, 				// :TUR:792:
           {"TT", N_( "Trinidad and Tobago" ) }, 		// :TTO:780:
           {"TV", N_( "Tuvalu" ) }, 				// :TUV:798:
@@ -401,18 +284,83 @@ namespace zypp
           {"ZA", N_( "South Africa" ) }, 			// :ZAF:710:
           {"ZM", N_( "Zambia" ) }, 				// :ZMB:894:
           {"ZW", N_( "Zimbabwe" ) }, 				// :ZWE:716:
+    };
+    static_assert( base::codetable::isSorted( init, &Init::iso3166 ), "init[] must be sorted by iso3166 code" );
 
-	  { NULL, NULL }
-      };
-
-      for (const Init * i = init; i->iso3166 != NULL; ++i)
-	  _codeMap[i->iso3166] = i->name;
+    /** The (untranslated) name of \a code_r, or \c nullptr if unknown. */
+    const char * lookupName( const char * code_r )
+    {
+      if ( ! *code_r )
+	return N_( "No Code" );
+      const Init * entry = base::codetable::find( init, &Init::iso3166, code_r );
+      return entry ? entry->name : nullptr;
     }
 
-    /////////////////////////////////////////////////////////////////
+    /** Lookup (translated) name for \a index_r.*/
+    std::string codeName( IdString index_r )
+    {
+      const char * name = lookupName( index_r.c_str() );
+      if ( ! name )
+      {
+	std::string code( index_r.asString() );
+	std::string ucode( str::toUpper( code ) );
+	if ( ucode != code )
+	  name = lookupName( ucode.c_str() );	// maybe we're lucky with the upper case code
+
+	static std::unordered_set<IdString> _reported;	// report malformed codes just once
+	if ( _reported.insert( index_r ).second )
+	{
+	  if ( code.size() != 2 )
+	    WAR << "Malformed CountryCode '" << code << "' (expect 2-letter)" << endl;
+	  if ( ucode != code )
+	    WAR << "Malformed CountryCode '" << code << "' (not upper case)" << endl;
+	  MIL << "Remember CountryCode '" << code << "': '" << ( name ? name : "" ) << "'" << endl;
+	}
+      }
+
+      std::string ret;
+      if ( name )
+      { ret = _(name); }
+      else
+      {
+	ret = _("Unknown country: ");
+	ret += "'";
+	ret += index_r.c_str();
+	ret += "'";
+      }
+      return ret;
+    }
   } // namespace
   ///////////////////////////////////////////////////////////////////
 
+  ///////////////////////////////////////////////////////////////////
+  //	class CountryCode
+  ///////////////////////////////////////////////////////////////////
+
+  const CountryCode CountryCode::noCode;
+
+  CountryCode::CountryCode()
+  {}
+
+  CountryCode::CountryCode( IdString str_r )
+  : _str( str_r )
+  {}
+
+  CountryCode::CountryCode( const std::string & str_r )
+  : _str( str_r )
+  {}
+
+  CountryCode::CountryCode( const char * str_r )
+  : _str( str_r )
+  {}
+
+  CountryCode::~CountryCode()
+  {}
+
+
+  std::string CountryCode::name() const
+  { return codeName( _str ); }
+
   /////////////////////////////////////////////////////////////////
 } // namespace zypp
 ///////////////////////////////////////////////////////////////////
@@ -13,6 +13,9 @@
 */
 
 #include <cstdio> // snprintf
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 #include <openssl/evp.h>
 #include <openssl/conf.h>
 #include <openssl/engine.h>
@@ -26,6 +29,11 @@
 #include <fstream>
 #endif
 
+#ifdef ZYPP_USE_THREADS
+#include <thread>
+#include <atomic>
+#endif
+
 #include "zypp/Digest.h"
 
 namespace zypp {
@@ -275,6 +283,106 @@ namespace zypp {
       return digest( name, is, bufsize );
     }
 
+    namespace
+    {
+      /** Buffer size used for reading files; large enough to keep the digest busy. */
+      const size_t fileBufferSize = 256 * 1024;
+
+      /** Feed file content into an already created \a digest using \a buf. */
+      std::string digestFileUsing( Digest & digest, const Pathname & file, std::vector<char> & buf )
+      {
+        int fd = ::open( file.c_str(), O_RDONLY|O_CLOEXEC );
+        if ( fd == -1 )
+          return string();
+        ::posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+
+        bool ok = true;
+        while ( true )
+        {
+          ssize_t readed = ::read( fd, &buf[0], buf.size() );
+          if ( readed == 0 )
+            break;
+          if ( readed == -1 )
+          {
+            if ( errno == EINTR )
+              continue;
+            ok = false;
+            break;
+          }
+          if ( ! digest.update( &buf[0], readed ) )
+          {
+            ok = false;
+            break;
+          }
+        }
+        ::close( fd );
+        if ( ! ok )
+        {
+          digest.reset();
+          return string();
+        }
+        return digest.digest();
+      }
+    } // namespace
+
+    std::string Digest::digestFile( const std::string & name, const Pathname & file )
+    {
+      Digest digest;
+      if ( name.empty() || ! digest.create( name ) )
+        return string();
+
+      std::vector<char> buf( fileBufferSize );
+      return digestFileUsing( digest, file, buf );
+    }
+
+    std::vector<std::string> Digest::digestFiles( const std::string & name, const std::vector<Pathname> & files )
+    {
+      std::vector<std::string> ret( files.size() );
+      {
+        // also initializes openssl before any thread is started
+        Digest probe;
+        if ( name.empty() || ! probe.create( name ) )
+          return ret;
+      }
+
+#ifdef ZYPP_USE_THREADS
+      unsigned nworkers = std::thread::hardware_concurrency();
+      if ( nworkers > files.size() )
+        nworkers = files.size();
+      if ( nworkers > 1 )
+      {
+        std::atomic<size_t> next( 0 );
+        auto worker = [&]()
+        {
+          Digest digest;
+          digest.create( name );
+          std::vector<char> buf( fileBufferSize );
+          for ( size_t idx = next++; idx < files.size(); idx = next++ )
+          {
+            ret[idx] = digestFileUsing( digest, files[idx], buf );
+            digest.reset();
+          }
+        };
+        std::vector<std::thread> workers;
+        for ( unsigned i = 0; i < nworkers; ++i )
+          workers.push_back( std::thread( worker ) );
+        for ( auto & t : workers )
+          t.join();
+        return ret;
+      }
+#endif
+
+      Digest digest;
+      digest.create( name );
+      std::vector<char> buf( fileBufferSize );
+      for ( size_t idx = 0; idx < files.size(); ++idx )
+      {
+        ret[idx] = digestFileUsing( digest, files[idx], buf );
+        digest.reset();
+      }
+      return ret;
+    }
+
 #ifdef DIGEST_TESTSUITE
     int main(int argc, char *argv[])
     {
@@ -138,6 +138,28 @@ namespace zypp {
 
 	/** \overload Reading input data from \c string. */
     	static std::string digest( const std::string & name, const std::string & input, size_t bufsize = 4096 );
+
+    	/** \brief compute digest of a file. convenience function
+    	 *
+    	 * The file is read using large heap buffers, hinting sequential
+    	 * access to the kernel.
+    	 *
+    	 * @param name name of the digest algorithm, \see create
+    	 * @param file the file to read
+    	 * @return the digest or empty on error
+    	 * */
+    	static std::string digestFile( const std::string & name, const Pathname & file );
+
+    	/** \brief compute digests of many files at once
+    	 *
+    	 * Like \ref digestFile, but if libzypp is built with threads enabled
+    	 * (\c ZYPP_USE_THREADS) the files are spread across all cores.
+    	 *
+    	 * @param name name of the digest algorithm, \see create
+    	 * @param files the files to read
+    	 * @return the digests in the order of \a files; empty on error
+    	 * */
+    	static std::vector<std::string> digestFiles( const std::string & name, const std::vector<Pathname> & files );
     };
 
 } // namespace zypp
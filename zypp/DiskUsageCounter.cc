@@ -16,15 +16,18 @@ extern "C"
 
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
 
 #include "zypp/base/Easy.h"
 #include "zypp/base/LogTools.h"
 #include "zypp/base/DtorReset.h"
 #include "zypp/base/String.h"
+#include "zypp/base/SerialNumber.h"
 
 #include "zypp/DiskUsageCounter.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
 #include "zypp/sat/detail/PoolImpl.h"
 
 using std::endl;
@@ -37,22 +40,48 @@ namespace zypp
   namespace
   { /////////////////////////////////////////////////////////////////
 
-    DiskUsageCounter::MountPointSet calcDiskUsage( DiskUsageCounter::MountPointSet result, const Bitmap & installedmap_r )
+    /** Per mountpoint data size and number of files as computed by libsolv. */
+    struct DuSums
     {
-      if ( result.empty() )
+      DuSums( unsigned size_r = 0 )
+      : kbytes( size_r, 0 ), files( size_r, 0 )
+      {}
+
+      DuSums & operator+=( const DuSums & rhs )
       {
-        // partitioning is not set
-        return result;
+        for ( unsigned idx = 0; idx < kbytes.size(); ++idx )
+        {
+          kbytes[idx] += rhs.kbytes[idx];
+          files[idx] += rhs.files[idx];
+        }
+        return *this;
+      }
+
+      DuSums & operator-=( const DuSums & rhs )
+      {
+        for ( unsigned idx = 0; idx < kbytes.size(); ++idx )
+        {
+          kbytes[idx] -= rhs.kbytes[idx];
+          files[idx] -= rhs.files[idx];
+        }
+        return *this;
       }
 
+      std::vector<long long> kbytes;
+      std::vector<long long> files;
+    };
+
+    /** Let libsolv compute the disk usage changes of \a installedmap_r (relative to the installed repo, if any). */
+    DuSums calcDuSums( const DiskUsageCounter::MountPointSet & mps_r, const Bitmap & installedmap_r )
+    {
       sat::Pool satpool( sat::Pool::instance() );
 
       // init libsolv result vector with mountpoints
       static const ::DUChanges _initdu = { 0, 0, 0, 0 };
-      std::vector< ::DUChanges> duchanges( result.size(), _initdu );
+      std::vector< ::DUChanges> duchanges( mps_r.size(), _initdu );
       {
         unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
+        for_( it, mps_r.begin(), mps_r.end() )
         {
           duchanges[idx].path = it->dir.c_str();
 	  if ( it->growonly )
@@ -66,43 +95,224 @@ namespace zypp
                              &duchanges[0],
                              duchanges.size() );
 
-      // and process the result
+      DuSums ret( mps_r.size() );
+      for ( unsigned idx = 0; idx < duchanges.size(); ++idx )
       {
-        unsigned idx = 0;
-        for_( it, result.begin(), result.end() )
-        {
-	  // Limit estimated waste (half block per file) as it does not apply to
-	  // btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
-	  static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
-
-          it->pkg_size = it->used_size          // current usage
-                       + duchanges[idx].kbytes  // package data size
-                       + ( duchanges[idx].files * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
-          ++idx;
-        }
+        ret.kbytes[idx] = duchanges[idx].kbytes;
+        ret.files[idx] = duchanges[idx].files;
       }
+      return ret;
+    }
 
+    /** \ref calcDuSums but ignoring the installed repo (plain sum of the solvables in \a bitmap_r). */
+    DuSums calcDuSumsIgnoringInstalled( const DiskUsageCounter::MountPointSet & mps_r, const Bitmap & bitmap_r )
+    {
+      // temp. unset @system Repo
+      DtorReset tmp( sat::Pool::instance().get()->installed );
+      sat::Pool::instance().get()->installed = nullptr;
+
+      return calcDuSums( mps_r, bitmap_r );
+    }
+
+    /** Fill in the \c pkg_size of all mountpoints. */
+    DiskUsageCounter::MountPointSet applyDuSums( DiskUsageCounter::MountPointSet result, const DuSums & sums_r )
+    {
+      unsigned idx = 0;
+      for_( it, result.begin(), result.end() )
+      {
+	// Limit estimated waste (half block per file) as it does not apply to
+	// btrfs, which reports up to 64K blocksize (bsc#974275,bsc#965322)
+	static const ByteCount blockAdjust( 2, ByteCount::K ); // (files * blocksize) / 2 / 1K; result value in K!
+
+	it->pkg_size = it->used_size          // current usage
+		     + sums_r.kbytes[idx]     // package data size
+		     + ( sums_r.files[idx] * ( it->fstype == "btrfs" ? 4096 : it->block_size ) / blockAdjust ); // half block per file
+	++idx;
+      }
       return result;
     }
 
+    DiskUsageCounter::MountPointSet calcDiskUsage( DiskUsageCounter::MountPointSet result, const Bitmap & installedmap_r )
+    {
+      if ( result.empty() )
+      {
+        // partitioning is not set
+        return result;
+      }
+      return applyDuSums( result, calcDuSums( result, installedmap_r ) );
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace
   ///////////////////////////////////////////////////////////////////
 
-  DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( const ResPool & pool_r ) const
+  ///////////////////////////////////////////////////////////////////
+  /// \class DiskUsageCounter::Incremental
+  /// \brief Disk usage of the pools transaction, updated by the status changes.
+  ///
+  /// The disk usage libsolv computes is the sum of the disk usage of all
+  /// solvables getting installed minus the disk usage of all solvables
+  /// getting deleted (unless the mountpoint is \c growonly). So a status
+  /// change of a few solvables can be applied as delta to the previous
+  /// result. The changed ones are taken from \ref ResStatus::transactLog;
+  /// just if too many changes happened since the last update, all pool
+  /// items are checked.
+  ///
+  /// The only exception are uninstalled solvables without disk usage data:
+  /// libsolv then ignores the disk usage of the installed solvables they
+  /// replace. As long as such a solvable is about to be installed, or if it
+  /// changes its status, each update triggers a full computation.
+  ///////////////////////////////////////////////////////////////////
+  class DiskUsageCounter::Incremental
   {
-    Bitmap bitmap( Bitmap::poolSize );
+  public:
+    Incremental()
+    : _noDuDataOnSystem( false )
+    , _logEnd( 0 )
+    {}
 
-    // build installedmap (installed != transact)
-    // stays installed or gets installed
-    for_( it, pool_r.begin(), pool_r.end() )
+    MountPointSet update( const MountPointSet & mps_r, const ResPool & pool_r )
     {
-      if ( it->status().isInstalled() != it->status().transacts() )
+      if ( mps_r.empty() )
+        return mps_r;	// partitioning is not set
+
+      bool poolChanged = _poolWatcher.remember( pool_r.serial() );
+      bool statusChanged = _statusWatcher.remember( ResStatus::transactSerial() );
+      if ( poolChanged || _result.empty() )
+        return rebuild( mps_r, pool_r );
+      if ( ! statusChanged )
+        return _result;
+      if ( _noDuDataOnSystem )
+        return rebuild( mps_r, pool_r );
+
+      // collect the status changes
+      Changes changes;
+      const ResStatus::TransactLog & log( ResStatus::transactLog() );
+      if ( _logEnd < log.begin )
+      {
+        DBG << "Missed " << ( log.begin - _logEnd ) << " status changes, checking all." << endl;
+        for_( it, pool_r.begin(), pool_r.end() )
+        {
+          if ( ! collect( *it, changes ) )
+            return rebuild( mps_r, pool_r );
+        }
+      }
+      else
+      {
+        for_( it, log.entries.begin() + ( _logEnd - log.begin ), log.entries.end() )
+        {
+          std::unordered_map<const ResStatus *,PoolItem>::const_iterator item( _items.find( *it ) );
+          if ( item != _items.end() && ! collect( item->second, changes ) )
+            return rebuild( mps_r, pool_r );
+        }
+      }
+      _logEnd = log.end();
+      if ( ! changes.count )
+        return _result;
+
+      DuSums sums( _sums );
+      sums += calcDuSumsIgnoringInstalled( mps_r, changes.plus );
+      sums -= calcDuSumsIgnoringInstalled( mps_r, changes.minus );
+      DuSums installed( calcDuSumsIgnoringInstalled( mps_r, changes.plusInstalled ) );
+      installed -= calcDuSumsIgnoringInstalled( mps_r, changes.minusInstalled );
+      unsigned idx = 0;
+      for_( it, mps_r.begin(), mps_r.end() )
       {
-        bitmap.set( sat::asSolvable()(*it).id() );
+        if ( ! it->growonly )	// deleted solvables stay in the snapshot
+        {
+          sums.kbytes[idx] += installed.kbytes[idx];
+          sums.files[idx] += installed.files[idx];
+        }
+        ++idx;
       }
+      DBG << "Applied " << changes.count << " status changes." << endl;
+
+      _sums.kbytes.swap( sums.kbytes );
+      _sums.files.swap( sums.files );
+      _result = applyDuSums( mps_r, _sums );
+      return _result;
     }
-    return calcDiskUsage( _mps, bitmap );
+
+  private:
+    /** Solvables whose status changed since the last update. */
+    struct Changes
+    {
+      Changes()
+      : plus( Bitmap::poolSize ), minus( Bitmap::poolSize )
+      , plusInstalled( Bitmap::poolSize ), minusInstalled( Bitmap::poolSize )
+      , count( 0 )
+      {}
+      Bitmap plus;		///< uninstalled, now getting installed
+      Bitmap minus;		///< uninstalled, no longer getting installed
+      Bitmap plusInstalled;	///< installed, no longer getting deleted
+      Bitmap minusInstalled;	///< installed, now getting deleted
+      unsigned count;
+    };
+
+    /** Remember a status change of \a pi_r in \a changes_r.
+     * \returns \c false if a full computation is needed.
+     */
+    bool collect( const PoolItem & pi_r, Changes & changes_r )
+    {
+      sat::Solvable::IdType id( pi_r.satSolvable().id() );
+      bool onSystem( pi_r.status().onSystem() );
+      if ( onSystem == _onSystem.test( id ) )
+        return true;
+
+      ++changes_r.count;
+      _onSystem.assign( id, onSystem );
+      if ( pi_r.status().isInstalled() )
+      {
+        ( onSystem ? changes_r.plusInstalled : changes_r.minusInstalled ).set( id );
+      }
+      else
+      {
+        if ( sat::LookupAttr( sat::SolvAttr::diskusage, pi_r.satSolvable() ).empty() )
+          return false;	// no du data: libsolv computes it differently
+        ( onSystem ? changes_r.plus : changes_r.minus ).set( id );
+      }
+      return true;
+    }
+
+    MountPointSet rebuild( const MountPointSet & mps_r, const ResPool & pool_r )
+    {
+      // build installedmap (installed != transact)
+      // stays installed or gets installed
+      _onSystem = Bitmap( Bitmap::poolSize );
+      _noDuDataOnSystem = false;
+      _items.clear();
+      for_( it, pool_r.begin(), pool_r.end() )
+      {
+        _items[&it->status()] = *it;
+        if ( it->status().onSystem() )
+        {
+          _onSystem.set( sat::asSolvable()(*it).id() );
+          if ( ! ( _noDuDataOnSystem || it->status().isInstalled() ) )
+            _noDuDataOnSystem = sat::LookupAttr( sat::SolvAttr::diskusage, it->satSolvable() ).empty();
+        }
+      }
+      _logEnd = ResStatus::transactLog().end();
+      _sums = calcDuSums( mps_r, _onSystem );
+      _result = applyDuSums( mps_r, _sums );
+      return _result;
+    }
+
+  private:
+    SerialNumberWatcher _poolWatcher;
+    SerialNumberWatcher _statusWatcher;
+    Bitmap _onSystem;		///< solvables staying or getting installed
+    bool _noDuDataOnSystem;	///< some solvable without du data is getting installed
+    std::unordered_map<const ResStatus *,PoolItem> _items;	///< the pool items by their status
+    unsigned long long _logEnd;	///< the next \ref ResStatus::transactLog entry to check
+    DuSums _sums;
+    MountPointSet _result;
+  };
+
+  DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( const ResPool & pool_r ) const
+  {
+    if ( ! _incremental )
+      _incremental.reset( new Incremental );
+    return _incremental->update( _mps, pool_r );
   }
 
   DiskUsageCounter::MountPointSet DiskUsageCounter::disk_usage( sat::Solvable solv_r ) const
@@ -162,7 +162,7 @@ namespace zypp
 
     /** Set a MountPointSet to compute */
     void setMountPoints( const MountPointSet & mps_r )
-    { _mps = mps_r; }
+    { _mps = mps_r; _incremental.reset(); }
 
     /** Get the current MountPointSet */
     const MountPointSet & getMountPoints() const
@@ -179,7 +179,13 @@ namespace zypp
     static MountPointSet justRootPartition();
 
 
-    /** Compute disk usage if the current transaction woud be commited. */
+    /** Compute disk usage if the current transaction woud be commited.
+     * The result is maintained incrementally: If no \ref ResStatus changed
+     * its transact value since the last call (see \ref ResStatus::transactSerial),
+     * the previous result is returned. Otherwise only the disk usage of the
+     * solvables which changed their status is computed and applied to the
+     * previous result.
+     */
     MountPointSet disk_usage( const ResPool & pool ) const;
 
     /** Compute disk usage of a single Solvable */
@@ -206,6 +212,9 @@ namespace zypp
 
   private:
     MountPointSet _mps;
+    class Incremental;
+    /** Incrementally maintained pool disk usage */
+    mutable shared_ptr<Incremental> _incremental;
   };
   ///////////////////////////////////////////////////////////////////
 
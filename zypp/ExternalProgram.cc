@@ -14,24 +14,325 @@
 #include <signal.h>
 #include <errno.h>
 #include <unistd.h>
+#include <sched.h> // clone
+#include <pthread.h>
+#include <dirent.h>
 #include <sys/wait.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
 #include <pty.h> // openpty
-#include <stdlib.h> // setenv
+#include <stdlib.h> // getenv
 
 #include <cstring> // strsignal
 #include <iostream>
 #include <sstream>
+#include <memory>
+#include <algorithm>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
+#include "zypp/base/Trace.h"
 #include "zypp/ExternalProgram.h"
 
 using namespace std;
 
 namespace zypp {
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Where the child failed to start the program. */
+      enum SpawnStage { SPAWN_OK = 0, SPAWN_CHROOT, SPAWN_CHDIR, SPAWN_EXEC };
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class Spawner
+      /// \brief Start a child process sharing our memory until it execs.
+      ///
+      /// \c fork would copy the page tables of the whole (maybe huge) process
+      /// and let our threads fault in private copies of every page touched
+      /// until the child execs. We \c clone with \c CLONE_VM|CLONE_VFORK
+      /// instead: the child runs on a small stack of its own in our address
+      /// space, while we are suspended until it called \c exec or \c _exit.
+      ///
+      /// Therefore everything the child needs (environment, PATH lookup,
+      /// tty name,...) is prepared here in the parent. The child just does
+      /// async-signal-safe syscalls and reports a failure via \ref stage and
+      /// \ref err.
+      ///////////////////////////////////////////////////////////////////
+      struct Spawner
+      {
+	Spawner()
+	: usePty( false ), masterTty( -1 ), slaveTty( -1 )
+	, redirectStdin( nullptr ), redirectStdout( nullptr )
+	, stderrDisp( ExternalProgram::Normal_Stderr ), stderrFd( -1 )
+	, root( nullptr ), chdirTo( nullptr )
+	, stage( SPAWN_OK ), err( 0 )
+	, argv( nullptr )
+	{
+	  toExternal[0] = toExternal[1] = fromExternal[0] = fromExternal[1] = -1;
+	  ttyName[0] = '\0';
+	}
+
+	/** The childs environment: ours, overwritten by \a environment_r. */
+	void setEnvironment( const ExternalProgram::Environment & environment_r )
+	{
+	  envStrings.clear();
+	  for ( char ** e = environ; e && *e; ++e )
+	  {
+	    const char * eq = ::strchr( *e, '=' );
+	    if ( eq && environment_r.find( std::string( *e, eq - *e ) ) != environment_r.end() )
+	      continue;
+	    envStrings.push_back( *e );
+	  }
+	  for ( const auto & el : environment_r )
+	    envStrings.push_back( el.first + "=" + el.second );
+
+	  envp.clear();
+	  for ( const std::string & el : envStrings )
+	    envp.push_back( el.c_str() );
+	  envp.push_back( nullptr );
+	}
+
+	/** Lookup \c argv[0] like \c execvp does, using \a path_r as \c PATH. */
+	void setProgram( const char *const * argv_r, const char * path_r )
+	{
+	  argv = argv_r;
+	  candidates.clear();
+	  if ( ::strchr( argv[0], '/' ) )
+	    candidates.push_back( argv[0] );
+	  else
+	  {
+	    std::vector<std::string> dirs;
+	    str::split( path_r ? path_r : "/bin:/usr/bin", std::back_inserter( dirs ), ":" );
+	    for ( const std::string & dir : dirs )
+	      candidates.push_back( dir.empty() ? std::string( argv[0] ) : dir + "/" + argv[0] );
+	  }
+
+	  candidatesp.clear();
+	  for ( const std::string & el : candidates )
+	    candidatesp.push_back( el.c_str() );
+	  candidatesp.push_back( nullptr );
+
+	  // for a script without #!: "/bin/sh candidate argv[1]..." (see child)
+	  shArgv.assign( 1, "/bin/sh" );
+	  shArgv.push_back( nullptr );
+	  for ( const char *const * arg = argv + 1; *arg; ++arg )
+	    shArgv.push_back( *arg );
+	  shArgv.push_back( nullptr );
+	}
+
+	/** Start the child.
+	 * \return The childs pid or \c -1 and \c errno set.
+	 */
+	pid_t spawn()
+	{
+	  static const size_t stackSize = 64 * 1024;
+	  std::unique_ptr<char[]> stack( new char[stackSize] );
+
+	  // No signal handler must run in the child while it shares our memory.
+	  // It resets the handlers to default before it unblocks them again.
+	  sigset_t all;
+	  ::sigfillset( &all );
+	  ::pthread_sigmask( SIG_BLOCK, &all, &oldmask );
+	  int cancelstate;
+	  ::pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, &cancelstate );
+
+	  pid_t pid = ::clone( &Spawner::child, stack.get() + stackSize, CLONE_VM|CLONE_VFORK|SIGCHLD, this );
+	  int cloneErrno = errno;
+
+	  ::pthread_setcancelstate( cancelstate, nullptr );
+	  ::pthread_sigmask( SIG_SETMASK, &oldmask, nullptr );
+	  errno = cloneErrno;
+	  return pid;
+	}
+
+      private:
+	/** Close all filedesctiptors above stderr. */
+	static void closeFrom3()
+	{
+#ifdef SYS_close_range
+	  if ( ::syscall( SYS_close_range, 3U, ~0U, 0U ) == 0 )
+	    return;
+#endif
+	  // no close_range: close what's listed in /proc/self/fd, rather than
+	  // trying each fd up to a limit which may be huge (containers).
+	  int dfd = ::open( "/proc/self/fd", O_RDONLY|O_DIRECTORY|O_CLOEXEC );
+	  if ( dfd >= 0 )
+	  {
+	    alignas(struct dirent64) char buf[4096];
+	    for ( bool closed = true; closed; )
+	    {
+	      closed = false;
+	      for ( long n = ::syscall( SYS_getdents64, dfd, buf, sizeof(buf) ); n > 0; n = ::syscall( SYS_getdents64, dfd, buf, sizeof(buf) ) )
+	      {
+		for ( long pos = 0; pos < n; )
+		{
+		  struct dirent64 * entry = reinterpret_cast<struct dirent64 *>( buf + pos );
+		  pos += entry->d_reclen;
+		  int fd = 0;
+		  const char * p = entry->d_name;
+		  for ( ; *p >= '0' && *p <= '9'; ++p )
+		    fd = fd * 10 + ( *p - '0' );
+		  if ( *p == '\0' && p != entry->d_name && fd > 2 && fd != dfd )
+		  {
+		    ::close( fd );
+		    closed = true;
+		  }
+		}
+	      }
+	      // closing fds changes the directory we read: rescan until nothing left
+	      if ( closed )
+		::lseek( dfd, 0, SEEK_SET );
+	    }
+	    ::close( dfd );
+	    return;
+	  }
+	  for ( int i = ::getdtablesize() - 1; i > 2; --i )
+	    ::close( i );
+	}
+
+	/** Report a failure to the parent and exit. */
+	[[noreturn]] void fail( SpawnStage stage_r, int err_r, int status_r )
+	{
+	  stage = stage_r;
+	  err = err_r;
+	  ::_exit( status_r );
+	}
+
+	/** The childs code: async-signal-safe syscalls only! */
+	static int child( void * arg_r )
+	{
+	  Spawner & self( *static_cast<Spawner *>( arg_r ) );
+
+	  for ( int sig = 1; sig < _NSIG; ++sig )
+	  {
+	    struct sigaction sa;
+	    if ( ::sigaction( sig, nullptr, &sa ) == 0 && sa.sa_handler != SIG_IGN && sa.sa_handler != SIG_DFL )
+	    {
+	      sa.sa_handler = SIG_DFL;
+	      sa.sa_flags = 0;
+	      ::sigemptyset( &sa.sa_mask );
+	      ::sigaction( sig, &sa, nullptr );
+	    }
+	  }
+	  ::pthread_sigmask( SIG_SETMASK, &self.oldmask, nullptr );
+
+	  if ( self.usePty )
+	  {
+	    ::setsid();
+	    if ( self.slaveTty != 1 )
+	      ::dup2( self.slaveTty, 1 );		// set new stdout
+	    ExternalProgram::renumber_fd( self.slaveTty, 0 );	// set new stdin
+	    ::close( self.masterTty );			// Belongs to father process
+
+	    // We currently have no controlling terminal (due to setsid).
+	    // The first open call will also set the new ctty (due to historical
+	    // unix guru knowledge ;-) )
+	    ::close( ::open( self.ttyName, O_RDONLY ) );
+	  }
+	  else
+	  {
+	    ExternalProgram::renumber_fd( self.toExternal[0], 0 );	// set new stdin
+	    ::close( self.fromExternal[0] );				// Belongs to father process
+
+	    ExternalProgram::renumber_fd( self.fromExternal[1], 1 );	// set new stdout
+	    ::close( self.toExternal[1] );				// Belongs to father process
+	  }
+
+	  if ( self.redirectStdin )
+	  {
+	    ::close( 0 );
+	    int inp_fd = ::open( self.redirectStdin, O_RDONLY );
+	    ::dup2( inp_fd, 0 );
+	  }
+
+	  if ( self.redirectStdout )
+	  {
+	    ::close( 1 );
+	    int inp_fd = ::open( self.redirectStdout, O_WRONLY|O_CREAT|O_APPEND, 0600 );
+	    ::dup2( inp_fd, 1 );
+	  }
+
+	  // Handle stderr
+	  if ( self.stderrDisp == ExternalProgram::Discard_Stderr )
+	  {
+	    int null_fd = ::open( "/dev/null", O_WRONLY );
+	    ::dup2( null_fd, 2 );
+	    ::close( null_fd );
+	  }
+	  else if ( self.stderrDisp == ExternalProgram::Stderr_To_Stdout )
+	  {
+	    ::dup2( 1, 2 );
+	  }
+	  else if ( self.stderrDisp == ExternalProgram::Stderr_To_FileDesc )
+	  {
+	    // Note: We don't have to close anything regarding stderr_fd.
+	    // Our caller is responsible for that.
+	    ::dup2( self.stderrFd, 2 );
+	  }
+
+	  closeFrom3();
+
+	  if ( self.root && ::chroot( self.root ) == -1 )
+	    self.fail( SPAWN_CHROOT, errno, 128 );
+
+	  if ( self.chdirTo && ::chdir( self.chdirTo ) == -1 )
+	    self.fail( SPAWN_CHDIR, errno, 128 );
+
+	  int execErrno = ENOENT;
+	  for ( const char *const * path = &self.candidatesp[0]; *path; ++path )
+	  {
+	    ::execve( *path, const_cast<char *const *>( self.argv ), const_cast<char *const *>( &self.envp[0] ) );
+	    if ( errno == ENOEXEC )
+	    {
+	      // not an executable format: let the shell run it, like execvp does
+	      self.shArgv[1] = *path;
+	      ::execve( self.shArgv[0], const_cast<char *const *>( &self.shArgv[0] ), const_cast<char *const *>( &self.envp[0] ) );
+	      execErrno = errno;
+	      break;
+	    }
+	    if ( errno == EACCES )
+	      execErrno = EACCES;		// but continue search like execvp does
+	    else if ( errno != ENOENT && errno != ENOTDIR )
+	    {
+	      execErrno = errno;
+	      break;
+	    }
+	  }
+	  self.fail( SPAWN_EXEC, execErrno, 129 );
+	  return 129;
+	}
+
+      public:
+	bool usePty;
+	int masterTty;
+	int slaveTty;
+	char ttyName[512];
+	int toExternal[2];
+	int fromExternal[2];
+	const char * redirectStdin;
+	const char * redirectStdout;
+	ExternalProgram::Stderr_Disposition stderrDisp;
+	int stderrFd;
+	const char * root;
+	const char * chdirTo;
+
+	SpawnStage stage;	///< set by the child on failure
+	int err;		///< set by the child on failure
+
+      private:
+	const char *const * argv;
+	std::vector<std::string> envStrings;
+	std::vector<const char *> envp;
+	std::vector<std::string> candidates;
+	std::vector<const char *> candidatesp;
+	std::vector<const char *> shArgv;
+	sigset_t oldmask;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     ExternalProgram::ExternalProgram()
       : use_pty (false)
       , pid( -1 )
@@ -249,6 +550,8 @@ namespace zypp {
       DBG << "Executing " << _command << endl;
 
 
+      Spawner spawner;
+      spawner.usePty = use_pty;
       if (use_pty)
       {
     	// Create pair of ttys
@@ -260,6 +563,9 @@ namespace zypp {
           ERR << _execError << endl;
           return;
     	}
+	spawner.masterTty = master_tty;
+	spawner.slaveTty = slave_tty;
+	ttyname_r( slave_tty, spawner.ttyName, sizeof(spawner.ttyName) );
       }
       else
       {
@@ -271,112 +577,50 @@ namespace zypp {
           ERR << _execError << endl;
           return;
     	}
+	std::copy( to_external, to_external+2, spawner.toExternal );
+	std::copy( from_external, from_external+2, spawner.fromExternal );
       }
 
-      // Create module process
-      if ((pid = fork()) == 0)
+      spawner.redirectStdin = redirectStdin;
+      spawner.redirectStdout = redirectStdout;
+      spawner.stderrDisp = stderr_disp;
+      spawner.stderrFd = stderr_fd;
+      spawner.root = root;
+      spawner.chdirTo = ( root && ! chdirTo ) ? "/" : chdirTo;
       {
-        //////////////////////////////////////////////////////////////////////
-        // Don't write to the logfile after fork!
-        //////////////////////////////////////////////////////////////////////
-    	if (use_pty)
-    	{
-    	    setsid();
-    	    if(slave_tty != 1)
-    		dup2 (slave_tty, 1);	  // set new stdout
-    	    renumber_fd (slave_tty, 0);	  // set new stdin
-    	    ::close(master_tty);	  // Belongs to father process
-
-    	    // We currently have no controlling terminal (due to setsid).
-    	    // The first open call will also set the new ctty (due to historical
-    	    // unix guru knowledge ;-) )
-
-    	    char name[512];
-    	    ttyname_r(slave_tty, name, sizeof(name));
-    	    ::close(open(name, O_RDONLY));
-    	}
-    	else
-    	{
-    	    renumber_fd (to_external[0], 0); // set new stdin
-    	    ::close(from_external[0]);	  // Belongs to father process
-
-    	    renumber_fd (from_external[1], 1); // set new stdout
-    	    ::close(to_external	 [1]);	  // Belongs to father process
-    	}
-
-        if ( redirectStdin )
-        {
-          ::close( 0 );
-          int inp_fd = open( redirectStdin, O_RDONLY );
-          dup2( inp_fd, 0 );
-        }
-
-        if ( redirectStdout )
-        {
-          ::close( 1 );
-          int inp_fd = open( redirectStdout, O_WRONLY|O_CREAT|O_APPEND, 0600 );
-          dup2( inp_fd, 1 );
-        }
-
-    	// Handle stderr
-    	if (stderr_disp == Discard_Stderr)
-    	{
-    	    int null_fd = open("/dev/null", O_WRONLY);
-    	    dup2(null_fd, 2);
-    	    ::close(null_fd);
-    	}
-    	else if (stderr_disp == Stderr_To_Stdout)
-    	{
-    	    dup2(1, 2);
-    	}
-    	else if (stderr_disp == Stderr_To_FileDesc)
-    	{
-    	    // Note: We don't have to close anything regarding stderr_fd.
-    	    // Our caller is responsible for that.
-    	    dup2 (stderr_fd, 2);
-    	}
-
-    	for ( Environment::const_iterator it = environment.begin(); it != environment.end(); ++it ) {
-    	  setenv( it->first.c_str(), it->second.c_str(), 1 );
-    	}
-
-    	if(default_locale)
-    		setenv("LC_ALL","C",1);
-
-    	if(root)
-    	{
-    	    if(chroot(root) == -1)
-    	    {
-                _execError = str::form( _("Can't chroot to '%s' (%s)."), root, strerror(errno) );
-                std::cerr << _execError << endl;// After fork log on stderr too
-    		_exit (128);			// No sense in returning! I am forked away!!
-    	    }
-	    if ( ! chdirTo )
-	      chdirTo = "/";
-    	}
+	Environment env( environment );
+	if ( default_locale )
+	  env["LC_ALL"] = "C";
+	spawner.setEnvironment( env );
+	Environment::const_iterator path( env.find( "PATH" ) );
+	spawner.setProgram( argv, path != env.end() ? path->second.c_str() : ::getenv( "PATH" ) );
+      }
 
-	if ( chdirTo && chdir( chdirTo ) == -1 )
+      // Create module process
+      pid = spawner.spawn();
+      if ( pid > 0 )
+	debug::Trace::count( "processes_spawned" );
+      if ( pid > 0 && spawner.stage != SPAWN_OK )
+      {
+	// The child failed and exited. Its status is collected in close().
+	switch ( spawner.stage )
 	{
-	  _execError = root ? str::form( _("Can't chdir to '%s' inside chroot '%s' (%s)."), chdirTo, root, strerror(errno) )
-			    : str::form( _("Can't chdir to '%s' (%s)."), chdirTo, strerror(errno) );
-	  std::cerr << _execError << endl;// After fork log on stderr too
-	  _exit (128);			// No sense in returning! I am forked away!!
+	  case SPAWN_CHROOT:
+	    _execError = str::form( _("Can't chroot to '%s' (%s)."), root, strerror(spawner.err) );
+	    break;
+	  case SPAWN_CHDIR:
+	    _execError = root ? str::form( _("Can't chdir to '%s' inside chroot '%s' (%s)."), spawner.chdirTo, root, strerror(spawner.err) )
+			      : str::form( _("Can't chdir to '%s' (%s)."), spawner.chdirTo, strerror(spawner.err) );
+	    break;
+	  case SPAWN_EXEC:
+	  case SPAWN_OK:
+	    _execError = str::form( _("Can't exec '%s' (%s)."), argv[0], strerror(spawner.err) );
+	    break;
 	}
-
-    	// close all filedesctiptors above stderr
-    	for ( int i = ::getdtablesize() - 1; i > 2; --i ) {
-    	  ::close( i );
-    	}
-
-    	execvp(argv[0], const_cast<char *const *>(argv));
-        // don't want to get here
-        _execError = str::form( _("Can't exec '%s' (%s)."), argv[0], strerror(errno) );
-        std::cerr << _execError << endl;// After fork log on stderr too
-        _exit (129);			// No sense in returning! I am forked away!!
-        //////////////////////////////////////////////////////////////////////
+	ERR << _execError << endl;
       }
 
-      else if (pid == -1)	 // Fork failed, close everything.
+      if (pid == -1)	 // Fork failed, close everything.
       {
         _execError = str::form( _("Can't fork (%s)."), strerror(errno) );
         _exitStatus = 127;
@@ -27,9 +27,9 @@ namespace zypp {
     /**
      * @short Execute a program and give access to its io
      * An object of this class encapsulates the execution of
-     * an external program. It starts the program using fork
-     * and some exec.. call, gives you access to the program's
-     * stdio and closes the program after use.
+     * an external program. It starts the program using a vfork
+     * like clone and some exec.. call, gives you access to the
+     * program's stdio and closes the program after use.
      *
      * \code
      *
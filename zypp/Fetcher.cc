@@ -13,6 +13,7 @@
 #include <fstream>
 #include <list>
 #include <map>
+#include <vector>
 
 #include "zypp/base/Easy.h"
 #include "zypp/base/LogControl.h"
@@ -20,9 +21,11 @@
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/DefaultIntegral.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Trace.h"
 #include "zypp/Fetcher.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/CheckSum.h"
+#include "zypp/FileDigestCache.h"
 #include "zypp/base/UserRequestException.h"
 #include "zypp/parser/susetags/ContentFileReader.h"
 #include "zypp/parser/susetags/RepoIndex.h"
@@ -211,6 +214,11 @@ namespace zypp
                            MediaSetAccess &media,
                            const OnMediaLocation &resource,
                            const Pathname &dest_dir );
+      /**
+       * Batch compute the checksums of files already present in
+       * \ref dest_dir or the caches.
+       */
+      void prefetchCachedChecksums( const Pathname &dest_dir );
       /**
        * Provide the resource to \ref dest_dir
        */
@@ -332,6 +340,33 @@ namespace zypp
 
   }
 
+  // compute the checksums of all files already present in dest_dir or the
+  // cache paths in one batch, so provideFromCache does not need to read
+  // them one by one.
+  void Fetcher::Impl::prefetchCachedChecksums( const Pathname &dest_dir )
+  {
+    map<string, vector<Pathname> > candidates;	// per checksum type
+    for_( it_res, _resources.begin(), _resources.end() )
+    {
+      const OnMediaLocation & location( (*it_res)->location );
+      if ( ( (*it_res)->flags & FetcherJob::Directory ) || location.checksum().empty() )
+        continue;
+
+      vector<Pathname> & files( candidates[location.checksum().type()] );
+      Pathname dest_full_path( dest_dir + location.filename() );
+      if ( PathInfo( dest_full_path ).isExist() )
+        files.push_back( dest_full_path );
+      else
+      {
+        for_( it_cache, _caches.begin(), _caches.end() )
+          files.push_back( *it_cache + location.filename() );
+      }
+    }
+
+    for_( it, candidates.begin(), candidates.end() )
+      FileDigestCache::prefetch( it->second, it->first );
+  }
+
   // tries to provide resource to dest_dir from any of the configured additional
   // cache paths where the file may already be present. returns true if the
   // file was provided from the cache.
@@ -375,6 +410,7 @@ namespace zypp
             }
           }
           // found in cache
+          debug::Trace::count( "cache_hits" );
           return true;
         }
       }
@@ -386,6 +422,7 @@ namespace zypp
   {
     // no matter where did we got the file, try to validate it:
     Pathname localfile = dest_dir + resource.filename();
+    debug::TraceSpan span( "verify", resource.filename().asString() );
     // call the checker function
     try
     {
@@ -750,10 +787,12 @@ namespace zypp
                              MediaSetAccess &media,
                              const ProgressData::ReceiverFnc & progress_receiver )
   {
+    debug::TraceSpan span( "fetch" );
     ProgressData progress(_resources.size());
     progress.sendTo(progress_receiver);
 
     downloadAndReadIndexList(media, dest_dir);
+    prefetchCachedChecksums(dest_dir);
 
     for ( list<FetcherJob_Ptr>::const_iterator it_res = _resources.begin(); it_res != _resources.end(); ++it_res )
     {
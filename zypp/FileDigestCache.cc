@@ -0,0 +1,284 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/FileDigestCache.cc
+ *
+*/
+#include <sys/stat.h>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/thread/Mutex.h"
+#include "zypp/thread/MutexLock.h"
+#include "zypp/FileDigestCache.h"
+#include "zypp/Digest.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  { /////////////////////////////////////////////////////////////////
+
+    /** Upper bound for the number of files remembered; the least recently used are dropped if exceeded. */
+    const unsigned _maxEntries = 4096;
+
+    /** Identifies the file content by dev/ino, size and mtime (ns).
+     * A file modified in place gets a new key, so its outdated checksums
+     * are no longer found.
+     */
+    struct FileKey
+    {
+      explicit FileKey( const struct stat & st_r )
+      : dev( st_r.st_dev ), ino( st_r.st_ino ), size( st_r.st_size ), mtime_sec( st_r.st_mtim.tv_sec ), mtime_nsec( st_r.st_mtim.tv_nsec )
+      {}
+
+      bool operator<( const FileKey & rhs ) const
+      {
+	if ( ino != rhs.ino )
+	  return ino < rhs.ino;
+	if ( dev != rhs.dev )
+	  return dev < rhs.dev;
+	if ( size != rhs.size )
+	  return size < rhs.size;
+	if ( mtime_sec != rhs.mtime_sec )
+	  return mtime_sec < rhs.mtime_sec;
+	return mtime_nsec < rhs.mtime_nsec;
+      }
+
+      /** Same file (maybe modified). */
+      bool sameFile( const FileKey & rhs ) const
+      { return dev == rhs.dev && ino == rhs.ino; }
+
+      dev_t  dev;
+      ino_t  ino;
+      off_t  size;
+      time_t mtime_sec;
+      long   mtime_nsec;
+    };
+
+    /** The remembered checksums, least recently used first. */
+    class Cache
+    {
+    public:
+      typedef std::map<std::string,std::string> Checksums;	///< type -> checksum
+
+      /** The checksums remembered for \a key_r (or \c nullptr); marks them as used. */
+      Checksums * find( const FileKey & key_r )
+      {
+	Index::iterator it( _index.find( key_r ) );
+	if ( it == _index.end() )
+	  return nullptr;
+	_lru.splice( _lru.end(), _lru, it->second );
+	return &it->second->second;
+      }
+
+      /** The checksums remembered for \a key_r, created if missing. */
+      Checksums & get( const FileKey & key_r )
+      {
+	Checksums * ret( find( key_r ) );
+	if ( ret )
+	  return *ret;
+
+	// outdated checksums of the same file are useless
+	Index::iterator it( _index.lower_bound( key_r ) );
+	if ( it != _index.begin() && std::prev( it )->first.sameFile( key_r ) )
+	  erase( std::prev( it ) );
+	else if ( it != _index.end() && it->first.sameFile( key_r ) )
+	  erase( it );
+
+	if ( _index.size() >= _maxEntries )
+	  erase( _index.find( _lru.front().first ) );
+
+	_lru.push_back( Lru::value_type( key_r, Checksums() ) );
+	_index.insert( Index::value_type( key_r, std::prev( _lru.end() ) ) );
+	return _lru.back().second;
+      }
+
+      /** Forget all checksums of the file \a key_r refers to. */
+      void forget( const FileKey & key_r )
+      {
+	for ( Index::iterator it( _index.begin() ); it != _index.end(); )
+	{
+	  if ( it->first.sameFile( key_r ) )
+	    it = erase( it );
+	  else
+	    ++it;
+	}
+      }
+
+      void clear()
+      { _index.clear(); _lru.clear(); }
+
+    private:
+      typedef std::list<std::pair<FileKey,Checksums>> Lru;
+      typedef std::map<FileKey,Lru::iterator> Index;
+
+      Index::iterator erase( Index::iterator it_r )
+      {
+	_lru.erase( it_r->second );
+	return _index.erase( it_r );
+      }
+
+      Lru _lru;
+      Index _index;
+    };
+
+    /** The cache; downloads and lookups may happen in different threads. */
+    inline Cache & cache()
+    {
+      static Cache _cache;
+      return _cache;
+    }
+
+    inline thread::Mutex & cacheMutex()
+    {
+      static thread::Mutex _mutex;
+      return _mutex;
+    }
+
+    /** \c stat the file, \c false if it is not a regular file. */
+    inline bool statFile( const Pathname & file_r, struct stat & st_r )
+    { return ::stat( file_r.c_str(), &st_r ) == 0 && S_ISREG( st_r.st_mode ); }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  void FileDigestCache::remember( const Pathname & file_r, const CheckSum & checksum_r )
+  {
+    struct stat st;
+    if ( checksum_r.empty() || ! statFile( file_r, st ) )
+      return;
+
+    thread::MutexLock lock( cacheMutex() );
+    cache().get( FileKey( st ) )[checksum_r.type()] = checksum_r.checksum();
+  }
+
+  CheckSum FileDigestCache::lookup( const Pathname & file_r, const std::string & type_r )
+  {
+    struct stat st;
+    if ( ! statFile( file_r, st ) )
+      return CheckSum();
+
+    thread::MutexLock lock( cacheMutex() );
+    Cache::Checksums * checksums( cache().find( FileKey( st ) ) );
+    if ( ! checksums )
+      return CheckSum();
+
+    Cache::Checksums::const_iterator cit( checksums->find( str::toLower( type_r ) ) );
+    if ( cit == checksums->end() )
+      return CheckSum();
+
+    return CheckSum( cit->first, cit->second );
+  }
+
+  void FileDigestCache::prefetch( const std::vector<Pathname> & files_r, const std::string & type_r )
+  {
+    std::vector<Pathname> todo;
+    for ( const Pathname & file : files_r )
+    {
+      struct stat st;
+      if ( statFile( file, st ) && lookup( file, type_r ).empty() )
+	todo.push_back( file );
+    }
+    if ( todo.empty() )
+      return;
+
+    std::string type( str::toLower( type_r ) );
+    DBG << "Computing " << type << " of " << todo.size() << " files." << endl;
+    std::vector<std::string> sums( Digest::digestFiles( type, todo ) );
+    for ( unsigned i = 0; i < todo.size(); ++i )
+    {
+      if ( ! sums[i].empty() )
+	remember( todo[i], CheckSum( type, sums[i] ) );
+    }
+  }
+
+  void FileDigestCache::forget( const Pathname & file_r )
+  {
+    struct stat st;
+    if ( ! statFile( file_r, st ) )
+      return;
+
+    thread::MutexLock lock( cacheMutex() );
+    cache().forget( FileKey( st ) );
+  }
+
+  void FileDigestCache::clear()
+  {
+    thread::MutexLock lock( cacheMutex() );
+    cache().clear();
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class FileDigestCache::Builder::Impl
+  /// \brief FileDigestCache::Builder implementation.
+  ///////////////////////////////////////////////////////////////////
+  class FileDigestCache::Builder::Impl : private base::NonCopyable
+  {
+  public:
+    Impl()
+    { reset(); }
+
+    void update( const char * bytes_r, size_t len_r )
+    {
+      if ( ! len_r )
+	return;
+      _sha1.update( bytes_r, len_r );
+      _sha256.update( bytes_r, len_r );
+    }
+
+    void reset()
+    {
+      _sha1.create( Digest::sha1() );
+      _sha256.create( Digest::sha256() );
+    }
+
+    void commit( const Pathname & file_r )
+    {
+      std::string sha1( _sha1.digest() );
+      std::string sha256( _sha256.digest() );
+      if ( ! sha1.empty() )
+	FileDigestCache::remember( file_r, CheckSum( Digest::sha1(), sha1 ) );
+      if ( ! sha256.empty() )
+	FileDigestCache::remember( file_r, CheckSum( Digest::sha256(), sha256 ) );
+      reset();
+    }
+
+  private:
+    Digest _sha1;
+    Digest _sha256;
+  };
+
+  FileDigestCache::Builder::Builder()
+  : _pimpl( new Impl )
+  {}
+
+  FileDigestCache::Builder::~Builder()
+  {}
+
+  void FileDigestCache::Builder::update( const char * bytes_r, size_t len_r )
+  { _pimpl->update( bytes_r, len_r ); }
+
+  void FileDigestCache::Builder::reset()
+  { _pimpl->reset(); }
+
+  void FileDigestCache::Builder::commit( const Pathname & file_r )
+  { _pimpl->commit( file_r ); }
+
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,122 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/FileDigestCache.h
+ *
+*/
+#ifndef ZYPP_FILEDIGESTCACHE_H
+#define ZYPP_FILEDIGESTCACHE_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class FileDigestCache
+  /// \brief Remember checksums computed while a file was written.
+  ///
+  /// Downloads compute their checksums on the fly (see \ref Builder)
+  /// and remember them here. \ref filesystem::checksum looks up the
+  /// cache before it reads the file, so \ref ChecksumFileChecker and
+  /// friends are able to verify a freshly downloaded file without
+  /// reading it again.
+  ///
+  /// Entries are keyed by device, inode, size and mtime (in ns) of the
+  /// file. So they survive a \c rename or \ref filesystem::hardlinkCopy
+  /// of the file, but any modification invalidates them. The least
+  /// recently used entries are dropped if too many files are remembered.
+  ///
+  /// Only checksums computed by libzypp itself are remembered. The cache
+  /// may be used from multiple threads.
+  ///////////////////////////////////////////////////////////////////
+  class FileDigestCache : private base::NonCopyable
+  {
+  public:
+    /** Return the remembered checksum of type \a type_r or an empty \ref CheckSum. */
+    static CheckSum lookup( const Pathname & file_r, const std::string & type_r );
+
+    /** Compute and remember the \a type_r checksums of all \a files_r not yet known.
+     * The files are hashed by \ref Digest::digestFiles, i.e. in parallel if
+     * libzypp is built with threads enabled. Missing files are skipped.
+     */
+    static void prefetch( const std::vector<Pathname> & files_r, const std::string & type_r );
+
+    /** Drop all checksums remembered for \a file_r. */
+    static void forget( const Pathname & file_r );
+
+    /** Drop all entries. */
+    static void clear();
+
+  public:
+    class Builder;
+
+  private:
+    /** Remember \a checksum_r as \a file_r's checksum. */
+    static void remember( const Pathname & file_r, const CheckSum & checksum_r );
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class FileDigestCache::Builder
+  /// \brief Incrementally compute the checksums of a file being written.
+  ///
+  /// Feed all data written to the file via \ref update. Once the file
+  /// is complete and closed, \ref commit stores the result in the
+  /// \ref FileDigestCache. Computed are \c sha1 and \c sha256, which
+  /// cover almost all checksums used in repository metadata.
+  ///
+  /// \code
+  ///   FileDigestCache::Builder digests;
+  ///   while ( ... )
+  ///   {
+  ///     ::fwrite( buf, 1, len, file );
+  ///     digests.update( buf, len );
+  ///   }
+  ///   ::fclose( file );
+  ///   digests.commit( path );
+  /// \endcode
+  ///////////////////////////////////////////////////////////////////
+  class FileDigestCache::Builder : private base::NonCopyable
+  {
+  public:
+    /** Default ctor */
+    Builder();
+
+    /** Dtor */
+    ~Builder();
+
+  public:
+    /** Feed data into all digests. */
+    void update( const char * bytes_r, size_t len_r );
+
+    /** Restart all digests from scratch (e.g. if the file is rewritten). */
+    void reset();
+
+    /** Remember the computed checksums for \a file_r.
+     * Finalizes the digests; further updates start from scratch.
+     */
+    void commit( const Pathname & file_r );
+
+  public:
+    class Impl;		///< Implementation class.
+  private:
+    RW_pointer<Impl> _pimpl;	///< Pointer to implementation.
+  };
+
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_FILEDIGESTCACHE_H
@@ -27,6 +27,7 @@
 
 #include "zypp/HistoryLog.h"
 #include "zypp/HistoryLogData.h"
+#include "zypp/parser/HistoryLogIndex.h"
 
 using std::endl;
 using std::string;
@@ -126,6 +127,8 @@ namespace zypp
     {
       _log.clear();
       _log.close();
+      if ( ! _fname.empty() )
+        parser::HistoryLogIndex::update( _fname );
     }
 
     inline void refUp()
@@ -29,11 +29,11 @@ namespace zypp
   /////////////////////////////////////////////////////////////////
 
   IdString::IdString( const char * str_r )
-  : _id( ::pool_str2id( myPool().getPool(), str_r, /*create*/true ) )
+  : _id( ::pool_str2id( myPool().getPool(), str_r, /*create*/! myPool().readOnly() ) )
   {}
 
   IdString::IdString( const char * str_r, unsigned len_r )
-  : _id( ::pool_strn2id( myPool().getPool(), str_r, len_r, /*create*/true ) )
+  : _id( ::pool_strn2id( myPool().getPool(), str_r, len_r, /*create*/! myPool().readOnly() ) )
   {}
 
   IdString::IdString( const std::string & str_r )
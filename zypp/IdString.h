@@ -33,7 +33,9 @@ namespace zypp
   /** Access to the sat-pools string space.
    *
    * Construction from string will place a copy of the string in the
-   * string space, if it is not already present.
+   * string space, if it is not already present. While concurrent readers
+   * hold the pool (\ref ResPool::ReadGuard) no strings are added; an
+   * unknown string then results in \ref IdString::Null.
    *
    * While comparison differs between \ref IdString::Null and \ref IdString::Empty
    * ( \c NULL and \c "" ), both are represented by an empty string \c "".
@@ -10,11 +10,13 @@
  *
 */
 #include <iostream>
+#include <cstring>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Hash.h"
+#include "zypp/base/CodeTable.h"
 
 #include "zypp/LanguageCode.h"
 
@@ -26,137 +28,21 @@ namespace zypp
   ///////////////////////////////////////////////////////////////////
   namespace
   {
-    /** Wrap static codemap data. */
-    struct CodeMaps
+    /** ISO 639 code table entry. */
+    struct LangInit
     {
-      /** The singleton */
-      static CodeMaps & instance()
-      {
-	static CodeMaps _instance;
-	return _instance;
-      }
-
-      /** Lookup (translated) name for \a index_r.*/
-      std::string name( IdString index_r )
-      {
-	Link link( getIndex( index_r ) );
-
-	std::string ret;
-	if ( link->second )
-	{ ret = _(link->second); }
-	else
-	{
-	  ret = _("Unknown language: ");
-	  ret += "'";
-	  ret += index_r.c_str();
-	  ret += "'";
-	}
-	return ret;
-      }
-
-    private:
-      typedef std::unordered_map<std::string,const char *> CodeMap;
-      typedef CodeMap::const_iterator Link;
-
-      typedef std::unordered_map<IdString,Link> IndexMap;
-
-      /** Ctor initializes the code maps.
-       * http://www.loc.gov/standards/iso639-2/ISO-639-2_values_8bits.txt
-      */
-      CodeMaps();
-
-      /** Return \ref Link for \a index_r, creating it if necessary. */
-      Link getIndex( IdString index_r )
-      {
-	auto it = _indexMap.find( index_r );
-	return( it != _indexMap.end()
-	      ? it->second
-	      : newIndex( index_r, index_r.asString() ) );
-      }
-
-      /** Return the CodeMap Index for \a code_r. */
-      Link newIndex( IdString index_r, const std::string & code_r )
-      {
-	Link link = _codeMap.find( code_r );
-	if ( link != _codeMap.end() )
-	  return (_indexMap[index_r] = link);
-
-	// not found: Remember a new code
-	CodeMap::value_type nval( code_r, nullptr );
-
-	if ( code_r.size() > 3 || code_r.size() < 2 )
-	  WAR << "Malformed LanguageCode '" << code_r << "' (expect 2 or 3-letter)" << endl;
-
-	std::string lcode( str::toLower( code_r ) );
-	if ( lcode != code_r )
-	{
-	  WAR << "Malformed LanguageCode '" << code_r << "' (not lower case)" << endl;
-	  // but maybe we're lucky with the lower case code
-	  // and find a language name.
-	  link = _codeMap.find( lcode );
-	  if ( link != _codeMap.end() )
-	  {
-	    nval.second = link->second;
-	  }
-	}
-	MIL << "Remember LanguageCode '" << code_r << "': '" << nval.second << "'" << endl;
-	return (_indexMap[index_r] = _codeMap.insert( nval ).first);
-      }
-
-    private:
-      CodeMap _codeMap;
-      IndexMap _indexMap;
+      const char *iso639_2;
+      const char *iso639_1;
+      const char *name;
     };
-  } // namespace
-  ///////////////////////////////////////////////////////////////////
-
-  ///////////////////////////////////////////////////////////////////
-  //	class LanguageCode
-  ///////////////////////////////////////////////////////////////////
-
-  const LanguageCode LanguageCode::noCode;
-  //const LanguageCode LanguageCode::enCode("en");	in Locale.cc as Locale::enCode depends on it
-
-  LanguageCode::LanguageCode()
-  {}
-
-  LanguageCode::LanguageCode( IdString str_r )
-  : _str( str_r )
-  {}
-
-  LanguageCode::LanguageCode( const std::string & str_r )
-  : _str( str_r )
-  {}
-
-  LanguageCode::LanguageCode( const char * str_r )
-  : _str( str_r )
-  {}
-
-  LanguageCode::~LanguageCode()
-  {}
 
-
-  std::string LanguageCode::name() const
-  { return CodeMaps::instance().name( _str ); }
-
-  ///////////////////////////////////////////////////////////////////
-  namespace
-  {
-    CodeMaps::CodeMaps()
-    {
-      // Defined LanguageCode constants
-      _codeMap[""]        = N_("No Code");
-
-      struct LangInit
-      {
-	  const char *iso639_2;
-	  const char *iso639_1;
-	  const char *name;
-      };
-
-      // some languages have more than one iso639_2 code
-      // so there are items with duplicate names
-      const LangInit langInit[] = {
+    /** ISO 639 codes and (untranslated) names, sorted by iso639_2 code.
+     * http://www.loc.gov/standards/iso639-2/ISO-639-2_values_8bits.txt
+     *
+     * Some languages have more than one iso639_2 code,
+     * so there are items with duplicate names.
+     */
+    constexpr LangInit langInit[] = {
 	  // language code: aar aa
 	  { "aar", "aa", N_( "Afar" ) },
 	  // language code: abk ab
@@ -183,8 +69,6 @@ namespace zypp
 	  { "akk", NULL, N_( "Akkadian" ) },
 	  // language code: alb sqi sq
 	  { "alb", "sq", N_( "Albanian" ) },
-	  // language code: alb sqi sq
-	  { "sqi", NULL, N_( "Albanian" ) },
 	  // language code: ale
 	  { "ale", NULL, N_( "Aleut" ) },
 	  // language code: alg
@@ -205,8 +89,6 @@ namespace zypp
 	  { "arg", "an", N_( "Aragonese" ) },
 	  // language code: arm hye hy
 	  { "arm", "hy", N_( "Armenian" ) },
-	  // language code: arm hye hy
-	  { "hye", NULL, N_( "Armenian" ) },
 	  // language code: arn
 	  { "arn", NULL, N_( "Araucanian" ) },
 	  // language code: arp
@@ -247,8 +129,6 @@ namespace zypp
 	  { "ban", NULL, N_( "Balinese" ) },
 	  // language code: baq eus eu
 	  { "baq", "eu", N_( "Basque" ) },
-	  // language code: baq eus eu
-	  { "eus", NULL, N_( "Basque" ) },
 	  // language code: bas
 	  { "bas", NULL, N_( "Basa" ) },
 	  // language code: bat
@@ -277,6 +157,8 @@ namespace zypp
 	  { "bla", NULL, N_( "Siksika" ) },
 	  // language code: bnt
 	  { "bnt", NULL, N_( "Bantu (Other)" ) },
+	  // language code: tib bod bo
+	  { "bod", NULL, N_( "Tibetan" ) },
 	  // language code: bos bs
 	  { "bos", "bs", N_( "Bosnian" ) },
 	  // language code: bra
@@ -293,8 +175,6 @@ namespace zypp
 	  { "bul", "bg", N_( "Bulgarian" ) },
 	  // language code: bur mya my
 	  { "bur", "my", N_( "Burmese" ) },
-	  // language code: bur mya my
-	  { "mya", NULL, N_( "Burmese" ) },
 	  // language code: byn
 	  { "byn", NULL, N_( "Blin" ) },
 	  // language code: cad
@@ -311,6 +191,8 @@ namespace zypp
 	  { "ceb", NULL, N_( "Cebuano" ) },
 	  // language code: cel
 	  { "cel", NULL, N_( "Celtic (Other)" ) },
+	  // language code: cze ces cs
+	  { "ces", NULL, N_( "Czech" ) },
 	  // language code: cha ch
 	  { "cha", "ch", N_( "Chamorro" ) },
 	  // language code: chb
@@ -321,8 +203,6 @@ namespace zypp
 	  { "chg", NULL, N_( "Chagatai" ) },
 	  // language code: chi zho zh
 	  { "chi", "zh", N_( "Chinese" ) },
-	  // language code: chi zho zh
-	  { "zho", NULL, N_( "Chinese" ) },
 	  // language code: chk
 	  { "chk", NULL, N_( "Chuukese" ) },
 	  // language code: chm
@@ -365,10 +245,10 @@ namespace zypp
 	  { "csb", NULL, N_( "Kashubian" ) },
 	  // language code: cus
 	  { "cus", NULL, N_( "Cushitic (Other)" ) },
+	  // language code: wel cym cy
+	  { "cym", NULL, N_( "Welsh" ) },
 	  // language code: cze ces cs
 	  { "cze", "cs", N_( "Czech" ) },
-	  // language code: cze ces cs
-	  { "ces", NULL, N_( "Czech" ) },
 	  // language code: dak
 	  { "dak", NULL, N_( "Dakota" ) },
 	  // language code: dan da
@@ -381,6 +261,8 @@ namespace zypp
 	  { "del", NULL, N_( "Delaware" ) },
 	  // language code: den
 	  { "den", NULL, N_( "Slave (Athapascan)" ) },
+	  // language code: ger deu de
+	  { "deu", NULL, N_( "German" ) },
 	  // language code: dgr
 	  { "dgr", NULL, N_( "Dogrib" ) },
 	  // language code: din
@@ -399,8 +281,6 @@ namespace zypp
 	  { "dum", NULL, N_( "Dutch, Middle (ca.1050-1350)" ) },
 	  // language code: dut nld nl
 	  { "dut", "nl", N_( "Dutch" ) },
-	  // language code: dut nld nl
-	  { "nld", NULL, N_( "Dutch" ) },
 	  // language code: dyu
 	  { "dyu", NULL, N_( "Dyula" ) },
 	  // language code: dzo dz
@@ -411,6 +291,8 @@ namespace zypp
 	  { "egy", NULL, N_( "Egyptian (Ancient)" ) },
 	  // language code: eka
 	  { "eka", NULL, N_( "Ekajuk" ) },
+	  // language code: gre ell el
+	  { "ell", NULL, N_( "Greek, Modern (1453-)" ) },
 	  // language code: elx
 	  { "elx", NULL, N_( "Elamite" ) },
 	  // language code: eng en
@@ -421,6 +303,8 @@ namespace zypp
 	  { "epo", "eo", N_( "Esperanto" ) },
 	  // language code: est et
 	  { "est", "et", N_( "Estonian" ) },
+	  // language code: baq eus eu
+	  { "eus", NULL, N_( "Basque" ) },
 	  // language code: ewe ee
 	  { "ewe", "ee", N_( "Ewe" ) },
 	  // language code: ewo
@@ -429,6 +313,8 @@ namespace zypp
 	  { "fan", NULL, N_( "Fang" ) },
 	  // language code: fao fo
 	  { "fao", "fo", N_( "Faroese" ) },
+	  // language code: per fas fa
+	  { "fas", NULL, N_( "Persian" ) },
 	  // language code: fat
 	  { "fat", NULL, N_( "Fanti" ) },
 	  // language code: fij fj
@@ -442,9 +328,9 @@ namespace zypp
 	  // language code: fon
 	  { "fon", NULL, N_( "Fon" ) },
 	  // language code: fre fra fr
-	  { "fre", "fr", N_( "French" ) },
-	  // language code: fre fra fr
 	  { "fra", NULL, N_( "French" ) },
+	  // language code: fre fra fr
+	  { "fre", "fr", N_( "French" ) },
 	  // language code: frm
 	  { "frm", NULL, N_( "French, Middle (ca.1400-1600)" ) },
 	  // language code: fro
@@ -465,12 +351,8 @@ namespace zypp
 	  { "gem", NULL, N_( "Germanic (Other)" ) },
 	  // language code: geo kat ka
 	  { "geo", "ka", N_( "Georgian" ) },
-	  // language code: geo kat ka
-	  { "kat", NULL, N_( "Georgian" ) },
 	  // language code: ger deu de
 	  { "ger", "de", N_( "German" ) },
-	  // language code: ger deu de
-	  { "deu", NULL, N_( "German" ) },
 	  // language code: gez
 	  { "gez", NULL, N_( "Geez" ) },
 	  // language code: gil
@@ -499,8 +381,6 @@ namespace zypp
 	  { "grc", NULL, N_( "Greek, Ancient (to 1453)" ) },
 	  // language code: gre ell el
 	  { "gre", "el", N_( "Greek, Modern (1453-)" ) },
-	  // language code: gre ell el
-	  { "ell", NULL, N_( "Greek, Modern (1453-)" ) },
 	  // language code: grn gn
 	  { "grn", "gn", N_( "Guarani" ) },
 	  // language code: guj gu
@@ -531,20 +411,22 @@ namespace zypp
 	  { "hmn", NULL, N_( "Hmong" ) },
 	  // language code: hmo ho
 	  { "hmo", "ho", N_( "Hiri Motu" ) },
+	  // language code: scr hrv hr
+	  { "hrv", NULL, N_( "Croatian" ) },
 	  // language code: hsb
 	  { "hsb", NULL, N_( "Upper Sorbian" ) },
 	  // language code: hun hu
 	  { "hun", "hu", N_( "Hungarian" ) },
 	  // language code: hup
 	  { "hup", NULL, N_( "Hupa" ) },
+	  // language code: arm hye hy
+	  { "hye", NULL, N_( "Armenian" ) },
 	  // language code: iba
 	  { "iba", NULL, N_( "Iban" ) },
 	  // language code: ibo ig
 	  { "ibo", "ig", N_( "Igbo" ) },
 	  // language code: ice isl is
 	  { "ice", "is", N_( "Icelandic" ) },
-	  // language code: ice isl is
-	  { "isl", NULL, N_( "Icelandic" ) },
 	  // language code: ido io
 	  { "ido", "io", N_( "Ido" ) },
 	  // language code: iii ii
@@ -573,6 +455,8 @@ namespace zypp
 	  { "ira", NULL, N_( "Iranian (Other)" ) },
 	  // language code: iro
 	  { "iro", NULL, N_( "Iroquoian Languages" ) },
+	  // language code: ice isl is
+	  { "isl", NULL, N_( "Icelandic" ) },
 	  // language code: ita it
 	  { "ita", "it", N_( "Italian" ) },
 	  // language code: jav jv
@@ -601,6 +485,8 @@ namespace zypp
 	  { "kar", NULL, N_( "Karen" ) },
 	  // language code: kas ks
 	  { "kas", "ks", N_( "Kashmiri" ) },
+	  // language code: geo kat ka
+	  { "kat", NULL, N_( "Georgian" ) },
 	  // language code: kau kr
 	  { "kau", "kr", N_( "Kanuri" ) },
 	  // language code: kaw
@@ -693,8 +579,6 @@ namespace zypp
 	  { "lus", NULL, N_( "Lushai" ) },
 	  // language code: mac mkd mk
 	  { "mac", "mk", N_( "Macedonian" ) },
-	  // language code: mac mkd mk
-	  { "mkd", NULL, N_( "Macedonian" ) },
 	  // language code: mad
 	  { "mad", NULL, N_( "Madurese" ) },
 	  // language code: mag
@@ -711,8 +595,6 @@ namespace zypp
 	  { "man", NULL, N_( "Mandingo" ) },
 	  // language code: mao mri mi
 	  { "mao", "mi", N_( "Maori" ) },
-	  // language code: mao mri mi
-	  { "mri", NULL, N_( "Maori" ) },
 	  // language code: map
 	  { "map", NULL, N_( "Austronesian (Other)" ) },
 	  // language code: mar mr
@@ -721,8 +603,6 @@ namespace zypp
 	  { "mas", NULL, N_( "Masai" ) },
 	  // language code: may msa ms
 	  { "may", "ms", N_( "Malay" ) },
-	  // language code: may msa ms
-	  { "msa", NULL, N_( "Malay" ) },
 	  // language code: mdf
 	  { "mdf", NULL, N_( "Moksha" ) },
 	  // language code: mdr
@@ -737,6 +617,8 @@ namespace zypp
 	  { "min", NULL, N_( "Minangkabau" ) },
 	  // language code: mis
 	  { "mis", NULL, N_( "Miscellaneous Languages" ) },
+	  // language code: mac mkd mk
+	  { "mkd", NULL, N_( "Macedonian" ) },
 	  // language code: mkh
 	  { "mkh", NULL, N_( "Mon-Khmer (Other)" ) },
 	  // language code: mlg mg
@@ -757,6 +639,10 @@ namespace zypp
 	  { "mon", "mn", N_( "Mongolian" ) },
 	  // language code: mos
 	  { "mos", NULL, N_( "Mossi" ) },
+	  // language code: mao mri mi
+	  { "mri", NULL, N_( "Maori" ) },
+	  // language code: may msa ms
+	  { "msa", NULL, N_( "Malay" ) },
 	  // language code: mul
 	  { "mul", NULL, N_( "Multiple Languages" ) },
 	  // language code: mun
@@ -767,6 +653,8 @@ namespace zypp
 	  { "mwl", NULL, N_( "Mirandese" ) },
 	  // language code: mwr
 	  { "mwr", NULL, N_( "Marwari" ) },
+	  // language code: bur mya my
+	  { "mya", NULL, N_( "Burmese" ) },
 	  // language code: myn
 	  { "myn", NULL, N_( "Mayan Languages" ) },
 	  // language code: myv
@@ -799,6 +687,8 @@ namespace zypp
 	  { "nic", NULL, N_( "Niger-Kordofanian (Other)" ) },
 	  // language code: niu
 	  { "niu", NULL, N_( "Niuean" ) },
+	  // language code: dut nld nl
+	  { "nld", NULL, N_( "Dutch" ) },
 	  // language code: nno nn
 	  { "nno", "nn", N_( "Norwegian Nynorsk" ) },
 	  // language code: nob nb
@@ -859,8 +749,6 @@ namespace zypp
 	  { "peo", NULL, N_( "Persian, Old (ca.600-400 B.C.)" ) },
 	  // language code: per fas fa
 	  { "per", "fa", N_( "Persian" ) },
-	  // language code: per fas fa
-	  { "fas", NULL, N_( "Persian" ) },
 	  // language code: phi
 	  { "phi", NULL, N_( "Philippine (Other)" ) },
 	  // language code: phn
@@ -894,9 +782,9 @@ namespace zypp
 	  // language code: rom
 	  { "rom", NULL, N_( "Romany" ) },
 	  // language code: rum ron ro
-	  { "rum", "ro", N_( "Romanian" ) },
-	  // language code: rum ron ro
 	  { "ron", NULL, N_( "Romanian" ) },
+	  // language code: rum ron ro
+	  { "rum", "ro", N_( "Romanian" ) },
 	  // language code: run rn
 	  { "run", "rn", N_( "Rundi" ) },
 	  // language code: rus ru
@@ -921,16 +809,12 @@ namespace zypp
 	  { "sat", NULL, N_( "Santali" ) },
 	  // language code: scc srp sr
 	  { "scc", "sr", N_( "Serbian" ) },
-	  // language code: scc srp sr
-	  { "srp", NULL, N_( "Serbian" ) },
 	  // language code: scn
 	  { "scn", NULL, N_( "Sicilian" ) },
 	  // language code: sco
 	  { "sco", NULL, N_( "Scots" ) },
 	  // language code: scr hrv hr
 	  { "scr", "hr", N_( "Croatian" ) },
-	  // language code: scr hrv hr
-	  { "hrv", NULL, N_( "Croatian" ) },
 	  // language code: sel
 	  { "sel", NULL, N_( "Selkup" ) },
 	  // language code: sem
@@ -952,9 +836,9 @@ namespace zypp
 	  // language code: sla
 	  { "sla", NULL, N_( "Slavic (Other)" ) },
 	  // language code: slo slk sk
-	  { "slo", "sk", N_( "Slovak" ) },
-	  // language code: slo slk sk
 	  { "slk", NULL, N_( "Slovak" ) },
+	  // language code: slo slk sk
+	  { "slo", "sk", N_( "Slovak" ) },
 	  // language code: slv sl
 	  { "slv", "sl", N_( "Slovenian" ) },
 	  // language code: sma
@@ -987,8 +871,12 @@ namespace zypp
 	  { "sot", "st", N_( "Sotho, Southern" ) },
 	  // language code: spa es
 	  { "spa", "es", N_( "Spanish" ) },
+	  // language code: alb sqi sq
+	  { "sqi", NULL, N_( "Albanian" ) },
 	  // language code: srd sc
 	  { "srd", "sc", N_( "Sardinian" ) },
+	  // language code: scc srp sr
+	  { "srp", NULL, N_( "Serbian" ) },
 	  // language code: srr
 	  { "srr", NULL, N_( "Serer" ) },
 	  // language code: ssa
@@ -1033,8 +921,6 @@ namespace zypp
 	  { "tha", "th", N_( "Thai" ) },
 	  // language code: tib bod bo
 	  { "tib", "bo", N_( "Tibetan" ) },
-	  // language code: tib bod bo
-	  { "bod", NULL, N_( "Tibetan" ) },
 	  // language code: tig
 	  { "tig", NULL, N_( "Tigre" ) },
 	  // language code: tir ti
@@ -1113,8 +999,6 @@ namespace zypp
 	  { "was", NULL, N_( "Washo" ) },
 	  // language code: wel cym cy
 	  { "wel", "cy", N_( "Welsh" ) },
-	  // language code: wel cym cy
-	  { "cym", NULL, N_( "Welsh" ) },
 	  // language code: wen
 	  { "wen", NULL, N_( "Sorbian Languages" ) },
 	  // language code: wln wa
@@ -1141,25 +1025,170 @@ namespace zypp
 	  { "zen", NULL, N_( "Zenaga" ) },
 	  // language code: zha za
 	  { "zha", "za", N_( "Zhuang" ) },
+	  // language code: chi zho zh
+	  { "zho", NULL, N_( "Chinese" ) },
 	  // language code: znd
 	  { "znd", NULL, N_( "Zande" ) },
 	  // language code: zul zu
 	  { "zul", "zu", N_( "Zulu" ) },
 	  // language code: zun
 	  { "zun", NULL, N_( "Zuni" ) },
+    };
+    static_assert( base::codetable::isSorted( langInit, &LangInit::iso639_2 ), "langInit[] must be sorted by iso639_2 code" );
 
-	  { NULL, NULL, NULL }
-      };
+    /** ISO 639 code index entry. */
+    struct LangIndex
+    {
+      const char *iso639_1;
+      const char *iso639_2;
+    };
+
+    /** The iso639_2 code for each iso639_1 code in \ref langInit, sorted by iso639_1 code. */
+    constexpr LangIndex langIndex[] = {
+      { "aa", "aar" }, { "ab", "abk" }, { "ae", "ave" }, { "af", "afr" },
+      { "ak", "aka" }, { "am", "amh" }, { "an", "arg" }, { "ar", "ara" },
+      { "as", "asm" }, { "av", "ava" }, { "ay", "aym" }, { "az", "aze" },
+      { "ba", "bak" }, { "be", "bel" }, { "bg", "bul" }, { "bh", "bih" },
+      { "bi", "bis" }, { "bm", "bam" }, { "bn", "ben" }, { "bo", "tib" },
+      { "br", "bre" }, { "bs", "bos" }, { "ca", "cat" }, { "ce", "che" },
+      { "ch", "cha" }, { "co", "cos" }, { "cr", "cre" }, { "cs", "cze" },
+      { "cu", "chu" }, { "cv", "chv" }, { "cy", "wel" }, { "da", "dan" },
+      { "de", "ger" }, { "dv", "div" }, { "dz", "dzo" }, { "ee", "ewe" },
+      { "el", "gre" }, { "en", "eng" }, { "eo", "epo" }, { "es", "spa" },
+      { "et", "est" }, { "eu", "baq" }, { "fa", "per" }, { "ff", "ful" },
+      { "fi", "fin" }, { "fj", "fij" }, { "fo", "fao" }, { "fr", "fre" },
+      { "fy", "fry" }, { "ga", "gle" }, { "gd", "gla" }, { "gl", "glg" },
+      { "gn", "grn" }, { "gu", "guj" }, { "gv", "glv" }, { "ha", "hau" },
+      { "he", "heb" }, { "hi", "hin" }, { "ho", "hmo" }, { "hr", "scr" },
+      { "ht", "hat" }, { "hu", "hun" }, { "hy", "arm" }, { "hz", "her" },
+      { "ia", "ina" }, { "id", "ind" }, { "ie", "ile" }, { "ig", "ibo" },
+      { "ii", "iii" }, { "ik", "ipk" }, { "io", "ido" }, { "is", "ice" },
+      { "it", "ita" }, { "iu", "iku" }, { "ja", "jpn" }, { "jv", "jav" },
+      { "ka", "geo" }, { "kg", "kon" }, { "ki", "kik" }, { "kj", "kua" },
+      { "kk", "kaz" }, { "kl", "kal" }, { "km", "khm" }, { "kn", "kan" },
+      { "ko", "kor" }, { "kr", "kau" }, { "ks", "kas" }, { "ku", "kur" },
+      { "kv", "kom" }, { "kw", "cor" }, { "ky", "kir" }, { "la", "lat" },
+      { "lb", "ltz" }, { "lg", "lug" }, { "li", "lim" }, { "ln", "lin" },
+      { "lo", "lao" }, { "lt", "lit" }, { "lu", "lub" }, { "lv", "lav" },
+      { "mg", "mlg" }, { "mh", "mah" }, { "mi", "mao" }, { "mk", "mac" },
+      { "ml", "mal" }, { "mn", "mon" }, { "mo", "mol" }, { "mr", "mar" },
+      { "ms", "may" }, { "mt", "mlt" }, { "my", "bur" }, { "na", "nau" },
+      { "nb", "nob" }, { "nd", "nde" }, { "ne", "nep" }, { "ng", "ndo" },
+      { "nl", "dut" }, { "nn", "nno" }, { "no", "nor" }, { "nr", "nbl" },
+      { "nv", "nav" }, { "ny", "nya" }, { "oc", "oci" }, { "oj", "oji" },
+      { "om", "orm" }, { "or", "ori" }, { "os", "oss" }, { "pa", "pan" },
+      { "pi", "pli" }, { "pl", "pol" }, { "ps", "pus" }, { "pt", "por" },
+      { "qu", "que" }, { "rm", "roh" }, { "rn", "run" }, { "ro", "rum" },
+      { "ru", "rus" }, { "rw", "kin" }, { "sa", "san" }, { "sc", "srd" },
+      { "sd", "snd" }, { "se", "sme" }, { "sg", "sag" }, { "si", "sin" },
+      { "sk", "slo" }, { "sl", "slv" }, { "sm", "smo" }, { "sn", "sna" },
+      { "so", "som" }, { "sq", "alb" }, { "sr", "scc" }, { "ss", "ssw" },
+      { "st", "sot" }, { "su", "sun" }, { "sv", "swe" }, { "sw", "swa" },
+      { "ta", "tam" }, { "te", "tel" }, { "tg", "tgk" }, { "th", "tha" },
+      { "ti", "tir" }, { "tk", "tuk" }, { "tl", "tgl" }, { "tn", "tsn" },
+      { "to", "ton" }, { "tr", "tur" }, { "ts", "tso" }, { "tt", "tat" },
+      { "tw", "twi" }, { "ty", "tah" }, { "ug", "uig" }, { "uk", "ukr" },
+      { "ur", "urd" }, { "uz", "uzb" }, { "ve", "ven" }, { "vi", "vie" },
+      { "vo", "vol" }, { "wa", "wln" }, { "wo", "wol" }, { "xh", "xho" },
+      { "yi", "yid" }, { "yo", "yor" }, { "za", "zha" }, { "zh", "chi" },
+      { "zu", "zul" },
+    };
+    static_assert( base::codetable::isSorted( langIndex, &LangIndex::iso639_1 ), "langIndex[] must be sorted by iso639_1 code" );
+
+    /** Whether <tt>langIndex[begin_r,end_r)</tt> refers to the \ref langInit entries listing the iso639_1 code. */
+    constexpr bool indexMatches( unsigned begin_r, unsigned end_r )
+    {
+      return( end_r - begin_r == 1
+              ? base::codetable::indexOf( langInit, &LangInit::iso639_2, langIndex[begin_r].iso639_2 ) < sizeof(langInit)/sizeof(*langInit)
+                && langInit[base::codetable::indexOf( langInit, &LangInit::iso639_2, langIndex[begin_r].iso639_2 )].iso639_1
+                && base::codetable::compare( langInit[base::codetable::indexOf( langInit, &LangInit::iso639_2, langIndex[begin_r].iso639_2 )].iso639_1,
+                                             langIndex[begin_r].iso639_1 ) == 0
+              : indexMatches( begin_r, begin_r + (end_r-begin_r)/2 ) && indexMatches( begin_r + (end_r-begin_r)/2, end_r ) );
+    }
+    static_assert( indexMatches( 0, sizeof(langIndex)/sizeof(*langIndex) ), "langIndex[] does not match langInit[]" );
 
-      for (const LangInit * i = langInit; i->iso639_2 != NULL; ++i)
+    /** The (untranslated) name of \a code_r, or \c nullptr if unknown. */
+    const char * lookupName( const char * code_r )
+    {
+      if ( ! *code_r )
+	return N_( "No Code" );
+
+      if ( ::strlen( code_r ) == 2 )
       {
-	  const char * name( i->name );
-	  _codeMap[i->iso639_2] = name;
-	  if (i->iso639_1 != NULL)
-	      _codeMap[i->iso639_1] = name;
+	const LangIndex * idx = base::codetable::find( langIndex, &LangIndex::iso639_1, code_r );
+	if ( ! idx )
+	  return nullptr;
+	code_r = idx->iso639_2;
       }
+      const LangInit * entry = base::codetable::find( langInit, &LangInit::iso639_2, code_r );
+      return entry ? entry->name : nullptr;
+    }
+
+    /** Lookup (translated) name for \a index_r.*/
+    std::string codeName( IdString index_r )
+    {
+      const char * name = lookupName( index_r.c_str() );
+      if ( ! name )
+      {
+	std::string code( index_r.asString() );
+	std::string lcode( str::toLower( code ) );
+	if ( lcode != code )
+	  name = lookupName( lcode.c_str() );	// maybe we're lucky with the lower case code
+
+	static std::unordered_set<IdString> _reported;	// report malformed codes just once
+	if ( _reported.insert( index_r ).second )
+	{
+	  if ( code.size() > 3 || code.size() < 2 )
+	    WAR << "Malformed LanguageCode '" << code << "' (expect 2 or 3-letter)" << endl;
+	  if ( lcode != code )
+	    WAR << "Malformed LanguageCode '" << code << "' (not lower case)" << endl;
+	  MIL << "Remember LanguageCode '" << code << "': '" << ( name ? name : "" ) << "'" << endl;
+	}
+      }
+
+      std::string ret;
+      if ( name )
+      { ret = _(name); }
+      else
+      {
+	ret = _("Unknown language: ");
+	ret += "'";
+	ret += index_r.c_str();
+	ret += "'";
+      }
+      return ret;
     }
   } // namespace
   ///////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  //	class LanguageCode
+  ///////////////////////////////////////////////////////////////////
+
+  const LanguageCode LanguageCode::noCode;
+  //const LanguageCode LanguageCode::enCode("en");	in Locale.cc as Locale::enCode depends on it
+
+  LanguageCode::LanguageCode()
+  {}
+
+  LanguageCode::LanguageCode( IdString str_r )
+  : _str( str_r )
+  {}
+
+  LanguageCode::LanguageCode( const std::string & str_r )
+  : _str( str_r )
+  {}
+
+  LanguageCode::LanguageCode( const char * str_r )
+  : _str( str_r )
+  {}
+
+  LanguageCode::~LanguageCode()
+  {}
+
+
+  std::string LanguageCode::name() const
+  { return codeName( _str ); }
+
 } // namespace zypp
 ///////////////////////////////////////////////////////////////////
@@ -16,6 +16,7 @@
 #include "zypp/ZYppCallbacks.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/PathInfo.h"
+#include "zypp/media/PeerCache.h"
 //#include "zypp/source/MediaSetAccessReportReceivers.h"
 
 using namespace std;
@@ -108,9 +109,19 @@ IMPL_PTR_TYPE(MediaSetAccess);
   struct ProvideFileOperation
   {
     Pathname result;
+    CheckSum checksum;	// if known, the peer cache is asked first
     void operator()( media::MediaAccessId media, const Pathname &file )
     {
       media::MediaManager media_mgr;
+      if ( ! checksum.empty() && media_mgr.downloads(media) && media::PeerCache::instance().enabled() )
+      {
+        Pathname local( media_mgr.localPath(media, file) );
+        if ( media::PeerCache::instance().provide( checksum, local ) )
+        {
+          result = local;
+          return;
+        }
+      }
       media_mgr.provideFile(media, file);
       result = media_mgr.localPath(media, file);
     }
@@ -157,6 +168,7 @@ IMPL_PTR_TYPE(MediaSetAccess);
   Pathname MediaSetAccess::provideFile( const OnMediaLocation & resource, ProvideFileOptions options, const Pathname &deltafile )
   {
     ProvideFileOperation op;
+    op.checksum = resource.checksum();
     provide( boost::ref(op), resource, options, deltafile );
     return op.result;
   }
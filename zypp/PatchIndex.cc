@@ -0,0 +1,329 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/PatchIndex.cc
+ *
+*/
+extern "C"
+{
+#include <solv/repo.h>
+}
+#include <iostream>
+#include <map>
+#include <algorithm>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/Hash.h"
+#include "zypp/base/SerialNumber.h"
+
+#include "zypp/PatchIndex.h"
+#include "zypp/Repository.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    /** Index of the patches in one repository. */
+    struct RepoIndex
+    {
+      /** A referenced issue. */
+      struct Reference
+      {
+	Reference( unsigned idx_r, const std::string & type_r )
+	: idx( idx_r ), type( type_r )
+	{}
+	unsigned    idx;	///< index into \ref patches
+	std::string type;
+      };
+
+      /** Category and severity flags packed into one word. */
+      static uint16_t pack( Patch::Category category_r, Patch::SeverityFlag severity_r )
+      { return uint16_t(category_r) | uint16_t(severity_r) << 8; }
+
+      Patch::Category category( unsigned idx_r ) const
+      { return Patch::Category( bits[idx_r] & 0xff ); }
+
+      Patch::SeverityFlag severity( unsigned idx_r ) const
+      { return Patch::SeverityFlag( bits[idx_r] >> 8 ); }
+
+      /** Whether \a repo_r still has the content indexed.
+       * Repo ids and solvable ranges get reused if a repo is reloaded,
+       * so the patches name and edition are compared as well.
+       */
+      bool upToDate( const Repository & repo_r ) const
+      {
+	sat::detail::CRepo * crepo( repo_r.get() );
+	if ( crepo->start != start || crepo->end != end || crepo->nsolvables != nsolvables )
+	  return false;
+	unsigned i = 0;
+	for ( const sat::Solvable & solv : repo_r.solvables() )
+	{
+	  if ( ! solv.isKind<Patch>() )
+	    continue;
+	  if ( i == patches.size() || patches[i] != solv || idents[i] != solv.ident() || editions[i] != solv.edition() )
+	    return false;
+	  ++i;
+	}
+	return i == patches.size();
+      }
+
+      explicit RepoIndex( const Repository & repo_r )
+      {
+	sat::detail::CRepo * crepo( repo_r.get() );
+	start      = crepo->start;
+	end        = crepo->end;
+	nsolvables = crepo->nsolvables;
+
+	for ( const sat::Solvable & solv : repo_r.solvables() )
+	{
+	  if ( ! solv.isKind<Patch>() )
+	    continue;
+	  slot[solv] = patches.size();
+	  patches.push_back( solv );
+	  idents.push_back( solv.ident() );
+	  editions.push_back( solv.edition() );
+	  bits.push_back( pack( Patch::categoryEnum( solv.lookupStrAttribute( sat::SolvAttr::patchcategory ) ),
+				Patch::severityFlag( solv.lookupStrAttribute( sat::SolvAttr::severity ) ) ) );
+	}
+	if ( patches.empty() )
+	  return;
+
+	// One pass over all update collections and references of the repo.
+	sat::LookupAttr collections( sat::SolvAttr::updateCollection, repo_r );
+	for_( it, collections.begin(), collections.end() )
+	{
+	  IdString name( it.subFind( sat::SolvAttr::updateCollectionName ).idStr() );
+	  auto pos( slot.find( it.inSolvable() ) );
+	  if ( name.empty() || pos == slot.end() )
+	    continue;
+	  std::vector<unsigned> & hits( byPackage[name] );
+	  if ( hits.empty() || hits.back() != pos->second )	// same name, several archs
+	    hits.push_back( pos->second );
+	}
+
+	sat::LookupAttr references( sat::SolvAttr::updateReference, repo_r );
+	for_( it, references.begin(), references.end() )
+	{
+	  std::string id( it.subFind( sat::SolvAttr::updateReferenceId ).asString() );
+	  auto pos( slot.find( it.inSolvable() ) );
+	  if ( id.empty() || pos == slot.end() )
+	    continue;
+	  byReference.insert( std::make_pair( id, Reference( pos->second, it.subFind( sat::SolvAttr::updateReferenceType ).asString() ) ) );
+	}
+      }
+
+      int      start;
+      int      end;
+      int      nsolvables;
+
+      std::vector<sat::Solvable>				patches;	///< in pool order
+      std::vector<IdString>					idents;
+      std::vector<Edition>					editions;
+      std::vector<uint16_t>					bits;		///< packed category and severity
+      std::unordered_map<sat::Solvable,unsigned>		slot;		///< patch -> index
+      std::unordered_map<IdString,std::vector<unsigned>>	byPackage;
+      std::unordered_multimap<std::string,Reference>		byReference;
+    };
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class PatchIndex::Impl
+  /// \brief PatchIndex implementation.
+  ///////////////////////////////////////////////////////////////////
+  class PatchIndex::Impl : private base::NonCopyable
+  {
+  public:
+    typedef std::map<Repository::IdType,shared_ptr<RepoIndex>> RepoIndices;
+
+    /** The repo indices, updated if the pool has changed. */
+    const RepoIndices & repos() const
+    {
+      if ( _watcher.remember( sat::Pool::instance().serial() ) )
+      {
+	_interactive.clear();
+
+	RepoIndices current;
+	unsigned built = 0;
+	for ( const Repository & repo : sat::Pool::instance().repos() )
+	{
+	  auto old( _repos.find( repo.id() ) );
+	  if ( old != _repos.end() && old->second->upToDate( repo ) )
+	  {
+	    current[repo.id()] = old->second;
+	  }
+	  else
+	  {
+	    current[repo.id()].reset( new RepoIndex( repo ) );
+	    ++built;
+	  }
+	}
+	_repos.swap( current );
+	if ( built )
+	  DBG << "Indexed patches of " << built << " repos: " << size() << " patches total." << endl;
+      }
+      return _repos;
+    }
+
+    /** The index of the repo providing \a patch_r and the patches position in it. */
+    const RepoIndex * locate( sat::Solvable patch_r, unsigned & idx_r ) const
+    {
+      const RepoIndices & indices( repos() );
+      auto rit( indices.find( patch_r.repository().id() ) );
+      if ( rit == indices.end() )
+	return nullptr;
+      auto sit( rit->second->slot.find( patch_r ) );
+      if ( sit == rit->second->slot.end() )
+	return nullptr;
+      idx_r = sit->second;
+      return rit->second.get();
+    }
+
+    Patch::InteractiveFlags interactiveFlags( sat::Solvable patch_r ) const
+    {
+      unsigned idx = 0;
+      if ( ! locate( patch_r, idx ) )
+	return Patch::NoFlags;
+
+      // depends on the installed packages; forgotten as the pool changes
+      auto it( _interactive.find( patch_r ) );
+      if ( it == _interactive.end() )
+	it = _interactive.insert( std::make_pair( patch_r, make<Patch>( patch_r )->interactiveFlags() ) ).first;
+      return it->second;
+    }
+
+    unsigned size() const
+    {
+      unsigned ret = 0;
+      for ( const auto & repo : _repos )
+	ret += repo.second->patches.size();
+      return ret;
+    }
+
+  private:
+    SerialNumberWatcher _watcher;
+    mutable RepoIndices _repos;
+    mutable std::unordered_map<sat::Solvable,Patch::InteractiveFlags> _interactive;
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  // class PatchIndex
+  ///////////////////////////////////////////////////////////////////
+
+  PatchIndex & PatchIndex::instance()
+  {
+    static PatchIndex _instance;
+    return _instance;
+  }
+
+  PatchIndex::PatchIndex()
+  : _pimpl( new Impl )
+  {}
+
+  PatchIndex::~PatchIndex()
+  {}
+
+  PatchIndex::Result PatchIndex::patches() const
+  {
+    Result ret;
+    for ( const auto & repo : _pimpl->repos() )
+      ret.insert( ret.end(), repo.second->patches.begin(), repo.second->patches.end() );
+    return ret;
+  }
+
+  unsigned PatchIndex::size() const
+  {
+    _pimpl->repos();
+    return _pimpl->size();
+  }
+
+  bool PatchIndex::contains( sat::Solvable patch_r ) const
+  {
+    unsigned idx = 0;
+    return _pimpl->locate( patch_r, idx );
+  }
+
+  Patch::Category PatchIndex::category( sat::Solvable patch_r ) const
+  {
+    unsigned idx = 0;
+    const RepoIndex * repo( _pimpl->locate( patch_r, idx ) );
+    return repo ? repo->category( idx ) : Patch::CAT_OTHER;
+  }
+
+  Patch::SeverityFlag PatchIndex::severity( sat::Solvable patch_r ) const
+  {
+    unsigned idx = 0;
+    const RepoIndex * repo( _pimpl->locate( patch_r, idx ) );
+    return repo ? repo->severity( idx ) : Patch::SEV_OTHER;
+  }
+
+  Patch::InteractiveFlags PatchIndex::interactiveFlags( sat::Solvable patch_r ) const
+  { return _pimpl->interactiveFlags( patch_r ); }
+
+  PatchIndex::Result PatchIndex::select( Patch::Categories categories_r, Patch::SeverityFlags severities_r ) const
+  {
+    Result ret;
+    for ( const auto & repo : _pimpl->repos() )
+    {
+      const RepoIndex & idx( *repo.second );
+      for ( unsigned i = 0; i < idx.patches.size(); ++i )
+      {
+	if ( categories_r.testFlag( idx.category( i ) ) && severities_r.testFlag( idx.severity( i ) ) )
+	  ret.push_back( idx.patches[i] );
+      }
+    }
+    return ret;
+  }
+
+  PatchIndex::Result PatchIndex::byPackage( IdString name_r ) const
+  {
+    Result ret;
+    for ( const auto & repo : _pimpl->repos() )
+    {
+      const RepoIndex & idx( *repo.second );
+      auto hits( idx.byPackage.find( name_r ) );
+      if ( hits != idx.byPackage.end() )
+      {
+	for ( unsigned i : hits->second )
+	  ret.push_back( idx.patches[i] );
+      }
+    }
+    return ret;
+  }
+
+  PatchIndex::Result PatchIndex::byReference( const std::string & id_r, const std::string & type_r ) const
+  {
+    Result ret;
+    for ( const auto & repo : _pimpl->repos() )
+    {
+      const RepoIndex & idx( *repo.second );
+      auto hits( idx.byReference.equal_range( id_r ) );
+      unsigned first = ret.size();
+      for_( it, hits.first, hits.second )
+      {
+	if ( type_r.empty() || it->second.type == type_r )
+	  ret.push_back( idx.patches[it->second.idx] );
+      }
+      // a patch may refer to the same id more than once (bugzilla and cve)
+      std::sort( ret.begin() + first, ret.end() );
+      ret.erase( std::unique( ret.begin() + first, ret.end() ), ret.end() );
+    }
+    return ret;
+  }
+
+  std::ostream & operator<<( std::ostream & str, const PatchIndex & obj )
+  { return str << "PatchIndex(" << obj.size() << " patches)"; }
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,112 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/PatchIndex.h
+ *
+*/
+#ifndef ZYPP_PATCHINDEX_H
+#define ZYPP_PATCHINDEX_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/base/NonCopyable.h"
+#include "zypp/sat/Solvable.h"
+#include "zypp/Patch.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class PatchIndex
+  /// \brief Index of the patches (updateinfo) available in the pool.
+  ///
+  /// Answers the questions usually asked when listing patches without
+  /// parsing the patches attribute strings or walking their update
+  /// collections over and over again:
+  /// \li a patches \ref Patch::Category, \ref Patch::SeverityFlag and
+  ///     \ref Patch::InteractiveFlags
+  /// \li the patches mentioning a package in their update collection
+  /// \li the patches mentioning a bugzilla or CVE id in their references
+  ///
+  /// An index is kept per repository and built on the first query after
+  /// the repo was loaded. Whenever the pools serial number changes, the
+  /// indices of removed or reloaded repos are dropped. As the interactive
+  /// flags depend on the installed packages, they are computed on demand
+  /// and remembered until the pool changes.
+  ///
+  /// \code
+  ///   for ( const sat::Solvable & patch : PatchIndex::instance().byReference( "CVE-2016-1234", "cve" ) )
+  ///     cout << patch << endl;
+  ///
+  ///   PatchIndex::Result critical( PatchIndex::instance().select( Patch::CAT_SECURITY, Patch::SEV_CRITICAL ) );
+  /// \endcode
+  ///
+  /// \note Not thread safe; like \ref PoolQuery it is meant to be used
+  /// from the thread owning the pool.
+  ///////////////////////////////////////////////////////////////////
+  class PatchIndex : private base::NonCopyable
+  {
+  public:
+    /** Query results in pool order. */
+    typedef std::vector<sat::Solvable> Result;
+
+  public:
+    /** The index for the current pool content. */
+    static PatchIndex & instance();
+
+  public:
+    /** All patches in the pool. */
+    Result patches() const;
+
+    /** Number of patches in the pool. */
+    unsigned size() const;
+
+    /** Whether \a patch_r is a patch known to the index. */
+    bool contains( sat::Solvable patch_r ) const;
+
+    /** \ref Patch::categoryEnum of \a patch_r (\c CAT_OTHER if not a patch). */
+    Patch::Category category( sat::Solvable patch_r ) const;
+
+    /** \ref Patch::severityFlag of \a patch_r (\c SEV_OTHER if not a patch). */
+    Patch::SeverityFlag severity( sat::Solvable patch_r ) const;
+
+    /** \ref Patch::interactiveFlags of \a patch_r (\c NoFlags if not a patch). */
+    Patch::InteractiveFlags interactiveFlags( sat::Solvable patch_r ) const;
+
+    /** Patches matching any of the \a categories_r and any of the \a severities_r. */
+    Result select( Patch::Categories categories_r,
+                   Patch::SeverityFlags severities_r = Patch::SeverityFlags( ~0 ) ) const;
+
+    /** Patches mentioning package \a name_r in their update collection. */
+    Result byPackage( IdString name_r ) const;
+    /** \overload */
+    Result byPackage( const std::string & name_r ) const
+    { return byPackage( IdString( name_r ) ); }
+
+    /** Patches referring to issue \a id_r (e.g. \c "CVE-2016-1234" or a bugzilla number).
+     * If \a type_r is not empty, only references of this type (\c bugzilla, \c cve,...) match.
+     */
+    Result byReference( const std::string & id_r, const std::string & type_r = std::string() ) const;
+
+  public:
+    class Impl;              ///< Implementation class.
+  private:
+    PatchIndex();
+    ~PatchIndex();
+    RW_pointer<Impl> _pimpl; ///< Pointer to implementation.
+  };
+
+  /** \relates PatchIndex Stream output */
+  std::ostream & operator<<( std::ostream & str, const PatchIndex & obj );
+
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_PATCHINDEX_H
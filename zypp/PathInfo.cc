@@ -13,10 +13,16 @@
 #include <sys/types.h> // for ::minor, ::major macros
 #include <utime.h>     // for ::utime
 #include <sys/statvfs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>   // for FICLONE
+#include <fcntl.h>
 
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <map>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
@@ -25,9 +31,9 @@
 #include "zypp/base/Errno.h"
 
 #include "zypp/AutoDispose.h"
-#include "zypp/ExternalProgram.h"
 #include "zypp/PathInfo.h"
 #include "zypp/Digest.h"
+#include "zypp/FileDigestCache.h"
 #include "zypp/TmpPath.h"
 
 using std::endl;
@@ -447,6 +453,279 @@ namespace zypp
       return logResult( recursive_rmdir_1( path, false/* don't remove path itself */ ) );
     }
 
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	copy engine used by copy, copy_dir, copy_dir_content and copy_file2dir
+    //
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Files seen with more than one link: (dev,ino) -> first copy. */
+      typedef std::map<std::pair<dev_t,ino_t>,Pathname> CopiedLinks;
+
+      /** Call \a fnc_r for each entry in \a dir_r except '.' and '..' (unlike \ref dirForEach not logging).
+       * \return 0 on success, errno if \a dir_r can't be read.
+       */
+      int forEachEntry( const Pathname & dir_r, function<void(const Pathname &)> fnc_r )
+      {
+	AutoDispose<DIR *> dir( ::opendir( dir_r.c_str() ),
+				[]( DIR * dir_r ) { if ( dir_r ) ::closedir( dir_r ); } );
+	if ( ! dir )
+	  return errno;
+
+	for ( struct dirent * entry = ::readdir( dir ); entry; entry = ::readdir( dir ) )
+	{
+	  if ( entry->d_name[0] == '.' && ( entry->d_name[1] == '\0' || ( entry->d_name[1] == '.' && entry->d_name[2] == '\0' ) ) )
+	    continue; // omitt . and ..
+	  fnc_r( dir_r / entry->d_name );
+	}
+	return 0;
+      }
+
+      /** Canonical absolute \a path_r (\a path_r itself if it can not be resolved). */
+      Pathname canonicalPath( const Pathname & path_r )
+      {
+	AutoDispose<char *> res( ::realpath( path_r.c_str(), NULL ), ::free );
+	return res ? Pathname( res.value() ) : path_r;
+      }
+
+      /** Whether \a path_r is \a dir_r or located below it (both canonical). */
+      bool isBelow( const Pathname & path_r, const Pathname & dir_r )
+      {
+	const std::string & path( path_r.asString() );
+	const std::string & dir( dir_r.asString() );
+	return str::hasPrefix( path, dir ) && ( path.size() == dir.size() || path[dir.size()] == '/' || dir == "/" );
+      }
+
+      /** Copy the remaining data of \a src_r to \a dst_r.
+       * Try a reflink, \c copy_file_range and \c sendfile before falling back
+       * to a plain read/write loop. Each method continues at the current file
+       * offsets the previous one stopped at.
+       * \return 0 on success, errno on failure.
+       */
+      int copyData( int src_r, int dst_r, const struct stat & st_r )
+      {
+	if ( st_r.st_size == 0 )
+	  goto readwrite;	// maybe a /proc or /sys file lying about its size
+
+#ifdef FICLONE
+	if ( ::ioctl( dst_r, FICLONE, src_r ) == 0 )
+	  return 0;
+#endif
+
+#ifdef SYS_copy_file_range
+	for ( ;; )
+	{
+	  ssize_t res = ::syscall( SYS_copy_file_range, src_r, NULL, dst_r, NULL, size_t(1)<<30, 0U );
+	  if ( res > 0 )
+	    continue;
+	  if ( res == 0 )
+	    return 0;
+	  if ( errno == EINTR )
+	    continue;
+	  if ( errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP && errno != EBADF )
+	    return errno;
+	  break;	// not supported here
+	}
+#endif
+
+	for ( ;; )
+	{
+	  ssize_t res = ::sendfile( dst_r, src_r, NULL, size_t(1)<<30 );
+	  if ( res > 0 )
+	    continue;
+	  if ( res == 0 )
+	    return 0;
+	  if ( errno == EINTR )
+	    continue;
+	  if ( errno != ENOSYS && errno != EINVAL )
+	    return errno;
+	  break;	// not supported here
+	}
+
+      readwrite:
+	char buf[64*1024];
+	for ( ;; )
+	{
+	  ssize_t res = ::read( src_r, buf, sizeof(buf) );
+	  if ( res == 0 )
+	    return 0;
+	  if ( res < 0 )
+	  {
+	    if ( errno == EINTR )
+	      continue;
+	    return errno;
+	  }
+	  for ( char * p = buf; res; )
+	  {
+	    ssize_t w = ::write( dst_r, p, res );
+	    if ( w < 0 )
+	    {
+	      if ( errno == EINTR )
+		continue;
+	      return errno;
+	    }
+	    p += w;
+	    res -= w;
+	  }
+	}
+      }
+
+      /** Mode to apply to a copy (no setuid/setgid; ownership is not preserved). */
+      inline mode_t copyMode( const struct stat & st_r )
+      { return st_r.st_mode & ( S_ISVTX | S_IRWXU | S_IRWXG | S_IRWXO ); }
+
+      /** Remove \a dest_r unless it's a directory.
+       * \return 0 on success or if \a dest_r does not exist, errno on failure.
+       */
+      int removeDestination( const Pathname & dest_r, bool srcIsDir_r )
+      {
+	struct stat st;
+	if ( ::lstat( dest_r.c_str(), &st ) == -1 )
+	  return errno == ENOENT ? 0 : errno;
+	if ( S_ISDIR( st.st_mode ) )
+	  return srcIsDir_r ? 0 : EISDIR;
+	if ( srcIsDir_r )
+	  return ENOTDIR;
+	return ::unlink( dest_r.c_str() ) == -1 ? errno : 0;
+      }
+
+      /** Copy regular file \a src_r to \a dest_r (replaced if it exists).
+       * Mode and timestamps are preserved.
+       * \return 0 on success, errno on failure.
+       */
+      int copyFile( const Pathname & src_r, const Pathname & dest_r )
+      {
+	AutoDispose<int> src( ::open( src_r.c_str(), O_RDONLY|O_CLOEXEC ), ::close );
+	if ( src == -1 )
+	{
+	  src.resetDispose();
+	  return errno;
+	}
+	struct stat st;
+	if ( ::fstat( src, &st ) == -1 )
+	  return errno;
+	if ( ! S_ISREG( st.st_mode ) )
+	  return EINVAL;
+
+	int ret = removeDestination( dest_r, false );
+	if ( ret )
+	  return ret;
+
+	AutoDispose<int> dst( ::open( dest_r.c_str(), O_WRONLY|O_CREAT|O_EXCL|O_CLOEXEC, S_IRUSR|S_IWUSR ), ::close );
+	if ( dst == -1 )
+	{
+	  dst.resetDispose();
+	  return errno;
+	}
+
+	ret = copyData( src, dst, st );
+	if ( ret == 0 )
+	{
+	  const struct timespec times[2] = { st.st_atim, st.st_mtim };
+	  if ( ::fchmod( dst, copyMode( st ) ) == -1 || ::futimens( dst, times ) == -1 )
+	    ret = errno;
+	}
+	if ( ::close( dst ) == -1 && ret == 0 )
+	  ret = errno;	// e.g. NFS reports write errors late
+	dst.resetDispose();
+
+	if ( ret )
+	  ::unlink( dest_r.c_str() );
+	return ret;
+      }
+
+      /** Like 'cp -dR src_r dest_r' (but preserving mode and timestamps).
+       * Symlinks are copied as symlinks; files hardlinked within the copied
+       * tree are hardlinked in the copy too. An existing directory \a dest_r
+       * is merged, other existing files are replaced.
+       * \return 0 on success, otherwise the first errno encountered (copying
+       * continues like \c cp does).
+       */
+      int copyTree( const Pathname & src_r, const Pathname & dest_r, CopiedLinks & links_r )
+      {
+	struct stat st;
+	if ( ::lstat( src_r.c_str(), &st ) == -1 )
+	  return errno;
+
+	int ret = removeDestination( dest_r, S_ISDIR( st.st_mode ) );
+	if ( ret )
+	{
+	  WAR << "  can't copy " << src_r << " -> " << dest_r << ": " << str::strerror( ret ) << endl;
+	  return ret;
+	}
+
+	if ( ! S_ISDIR( st.st_mode ) && st.st_nlink > 1 )
+	{
+	  std::pair<CopiedLinks::iterator,bool> res( links_r.insert( std::make_pair( std::make_pair( st.st_dev, st.st_ino ), dest_r ) ) );
+	  if ( ! res.second )
+	    return ::link( res.first->second.c_str(), dest_r.c_str() ) == -1 ? errno : 0;
+	}
+
+	const struct timespec times[2] = { st.st_atim, st.st_mtim };
+	if ( S_ISDIR( st.st_mode ) )
+	{
+	  bool created = ( ::mkdir( dest_r.c_str(), S_IRWXU ) == 0 );
+	  if ( ! created && errno != EEXIST )
+	    return errno;
+
+	  int err = forEachEntry( src_r, [&]( const Pathname & entry_r )
+	  {
+	    int res = copyTree( entry_r, dest_r / entry_r.basename(), links_r );
+	    if ( res && ! ret )
+	      ret = res;
+	  } );
+	  if ( err && ! ret )
+	    ret = err;
+
+	  // existing directories are merged, but not changed
+	  if ( created && ( ::chmod( dest_r.c_str(), copyMode( st ) ) == -1 || ::utimensat( AT_FDCWD, dest_r.c_str(), times, 0 ) == -1 ) && ! ret )
+	    ret = errno;
+	}
+	else if ( S_ISREG( st.st_mode ) )
+	{
+	  ret = copyFile( src_r, dest_r );
+	}
+	else if ( S_ISLNK( st.st_mode ) )
+	{
+	  Pathname target;
+	  ret = readlink( src_r, target );
+	  if ( ret == 0 )
+	  {
+	    if ( ::symlink( target.c_str(), dest_r.c_str() ) == -1 )
+	      ret = errno;
+	    else
+	      ::utimensat( AT_FDCWD, dest_r.c_str(), times, AT_SYMLINK_NOFOLLOW );	// not supported everywhere
+	  }
+	}
+	else // fifo, socket, device
+	{
+	  if ( ::mknod( dest_r.c_str(), ( st.st_mode & S_IFMT ) | copyMode( st ), st.st_rdev ) == -1
+	    || ::utimensat( AT_FDCWD, dest_r.c_str(), times, 0 ) == -1 )
+	    ret = errno;
+	}
+
+	if ( ret )
+	  WAR << "  can't copy " << src_r << " -> " << dest_r << ": " << str::strerror( ret ) << endl;
+	return ret;
+      }
+
+      /** Copy the content of directory \a src_r into directory \a dest_r. */
+      int copyContent( const Pathname & src_r, const Pathname & dest_r )
+      {
+	CopiedLinks links;
+	int ret = 0;
+	int err = forEachEntry( src_r, [&]( const Pathname & entry_r )
+	{
+	  int res = copyTree( entry_r, dest_r / entry_r.basename(), links );
+	  if ( res && ! ret )
+	    ret = res;
+	} );
+	return err ? err : ret;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     ///////////////////////////////////////////////////////////////////
     //
     //	METHOD NAME : copy_dir
@@ -471,21 +750,12 @@ namespace zypp
         return logResult( EEXIST );
       }
 
-
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        srcpath.asString().c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
+      if ( isBelow( canonicalPath( destpath ), canonicalPath( srcpath ) ) ) {
+        return logResult( EINVAL ); // can't copy a directory into itself
       }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+
+      CopiedLinks links;
+      return logResult( copyTree( srcpath, tp.path(), links ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -511,22 +781,11 @@ namespace zypp
         return logResult( EEXIST );
       }
 
-      std::string src( srcpath.asString());
-      src += "/.";
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        src.c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
+      if ( isBelow( canonicalPath( destpath ), canonicalPath( srcpath ) ) ) {
+        return logResult( EINVAL ); // can't copy a directory into itself
       }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+
+      return logResult( copyContent( srcpath, destpath ) );
     }
 
     ///////////////////////////////////////////////////////////////////////
@@ -756,20 +1015,7 @@ namespace zypp
         return logResult( EISDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--remove-destination",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( copyFile( file, dest ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -924,19 +1170,7 @@ namespace zypp
         return logResult( ENOTDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( copyFile( file, dest / file.basename() ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -976,11 +1210,12 @@ namespace zypp
       if ( ! PathInfo( file ).isFile() ) {
         return string();
       }
-      std::ifstream istr( file.asString().c_str() );
-      if ( ! istr ) {
-        return string();
+      // computed while downloading?
+      CheckSum known( FileDigestCache::lookup( file, algorithm ) );
+      if ( ! known.empty() ) {
+        return known.checksum();
       }
-      return Digest::digest( algorithm, istr );
+      return Digest::digestFile( algorithm, file );
     }
 
     bool is_checksum( const Pathname & file, const CheckSum &checksum )
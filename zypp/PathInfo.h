@@ -438,8 +438,12 @@ namespace zypp
      * Like 'cp -a srcpath destpath'. Copy directory tree. srcpath/destpath must be
      * directories. 'basename srcpath' must not exist in destpath.
      *
+     * Symlinks are copied as symlinks, hardlinks within the tree are kept.
+     * Mode and timestamps are preserved, ownership is not.
+     *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory, EEXIST if
-     * 'basename srcpath' exists in destpath, otherwise the commands return value.
+     * 'basename srcpath' exists in destpath, EINVAL if destpath is inside srcpath,
+     * otherwise the first errno encountered.
      **/
     int copy_dir( const Pathname & srcpath, const Pathname & destpath );
 
@@ -448,8 +452,8 @@ namespace zypp
      * into destpath. Both \p srcpath and \p destpath has to exists.
      *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory,
-     * EEXIST if srcpath and destpath are equal, otherwise the commands
-     * return value.
+     * EEXIST if srcpath and destpath are equal, EINVAL if destpath is inside
+     * srcpath, otherwise the first errno encountered.
      */
     int copy_dir_content( const Pathname & srcpath, const Pathname & destpath);
 
@@ -635,8 +639,13 @@ namespace zypp
     /**
      * Like 'cp file dest'. Copy file to destination file.
      *
+     * The copy is done in-process (reflink if possible, otherwise
+     * \c copy_file_range, \c sendfile or read/write). An existing \a dest
+     * is replaced rather than overwritten, so files hardlinked to it are
+     * not changed. Mode and timestamps are preserved.
+     *
      * @return 0 on success, EINVAL if file is not a file, EISDIR if
-     * destiantion is a directory, otherwise the commands return value.
+     * destiantion is a directory, otherwise errno.
      **/
     int copy( const Pathname & file, const Pathname & dest );
 
@@ -696,7 +705,7 @@ namespace zypp
      * Like 'cp file dest'. Copy file to dest dir.
      *
      * @return 0 on success, EINVAL if file is not a file, ENOTDIR if dest
-     * is no directory, otherwise the commands return value.
+     * is no directory, otherwise errno.
      **/
     int copy_file2dir( const Pathname & file, const Pathname & dest );
     //@}
@@ -724,6 +733,9 @@ namespace zypp
     /**
      * Compute a files checksum
      *
+     * Checksums already computed while the file was downloaded
+     * are taken from the \ref FileDigestCache.
+     *
      * @return the files checksum on success, otherwise an empty string..
      **/
     std::string checksum( const Pathname & file, const std::string &algorithm );
@@ -9,6 +9,7 @@
 /** \file	zypp/PluginExecutor.cc
  */
 #include <iostream>
+#include <vector>
 #include "zypp/base/LogTools.h"
 #include "zypp/base/NonCopyable.h"
 
@@ -83,9 +84,18 @@ namespace zypp
     void send( const PluginFrame & frame_r )
     {
       DBG << "+++++++++++++++ send " << frame_r << endl;
-      for ( auto it = _scripts.begin(); it != _scripts.end(); )
+      // Deliver the frame to all plugins before waiting for the 1st
+      // response, so they process it concurrently. Each plugins
+      // response is then collected within its own receive timeout.
+      std::vector<bool> sent;
+      sent.reserve( _scripts.size() );
+      for ( PluginScript & script : _scripts )
+	sent.push_back( doSendFrame( script, frame_r ) );
+
+      unsigned idx = 0;
+      for ( auto it = _scripts.begin(); it != _scripts.end(); ++idx )
       {
-	doSend( *it, frame_r );
+	doReceiveResponse( *it, frame_r, sent[idx] );
 	if ( it->isOpen() )
 	  ++it;
 	else
@@ -121,18 +131,39 @@ namespace zypp
     }
 
     PluginFrame doSend( PluginScript & script_r, const PluginFrame & frame_r )
-    {
-      PluginFrame ret;
+    { return doReceiveResponse( script_r, frame_r, doSendFrame( script_r, frame_r ) ); }
 
+    /** Send \a frame_r, but don't wait for the response. */
+    bool doSendFrame( PluginScript & script_r, const PluginFrame & frame_r )
+    {
       try {
 	script_r.send( frame_r );
-	ret = script_r.receive();
+	return true;
       }
       catch( const zypp::Exception & e )
       {
 	ZYPP_CAUGHT(e);
 	WAR << e.asUserHistory() << endl;
       }
+      return false;
+    }
+
+    /** Receive the response to \a frame_r (if \a sent_r); close the plugin unless it's an ACK. */
+    PluginFrame doReceiveResponse( PluginScript & script_r, const PluginFrame & frame_r, bool sent_r )
+    {
+      PluginFrame ret;
+
+      if ( sent_r )
+      {
+	try {
+	  ret = script_r.receive();
+	}
+	catch( const zypp::Exception & e )
+	{
+	  ZYPP_CAUGHT(e);
+	  WAR << e.asUserHistory() << endl;
+	}
+      }
 
       // Allow using "/bin/cat" as reflector-script for testing
       if ( ! ( ret.isAckCommand() || ret.isEnomethodCommand() || ( script_r.script() == "/bin/cat" && frame_r.command() != "ERROR" ) ) )
@@ -144,6 +175,7 @@ namespace zypp
 
       return ret;
     }
+
   private:
     std::list<PluginScript> _scripts;
   };
@@ -163,6 +163,7 @@ namespace zypp
       scoped_ptr<ExternalProgramWithStderr> _cmd;
       DefaultIntegral<int,0> _lastReturn;
       std::string _lastExecError;
+      mutable std::string _receiveBuffer;	///< data read beyond the last frame received
   };
   ///////////////////////////////////////////////////////////////////
 
@@ -218,6 +219,7 @@ namespace zypp
     _args = args_r;
     _lastReturn.reset();
     _lastExecError.clear();
+    _receiveBuffer.clear();
 
     dumpRangeLine( DBG << *this, _args.begin(), _args.end() ) << endl;
   }
@@ -362,20 +364,32 @@ namespace zypp
     if ( fd == -1 )
       ZYPP_THROW( PluginScriptException( "Bad file descriptor" ) );
 
-    ::clearerr( filep );
     std::string data;
     {
       PluginDebugBuffer _debug( data ); // dump receive buffer if PLUGIN_DEBUG
       PluginDumpStderr _dump( *_cmd ); // dump scripts stderr before leaving
+
+      // Read blockwise; a frame ends at the 1st NUL. Data following it
+      // (a script sending ahead) is kept for the next receive.
+      std::string::size_type scanned = 0;
+      data.swap( _receiveBuffer );
       do {
-	int ch = fgetc( filep );
-	if ( ch != EOF )
+	std::string::size_type eof = data.find( '\0', scanned );
+	if ( eof != std::string::npos )
+	{
+	  _receiveBuffer.assign( data, eof+1, std::string::npos );
+	  data.erase( eof+1 );
+	  break;
+	}
+	scanned = data.size();
+
+	char buffer[4096];
+	ssize_t ret = ::read( fd, buffer, sizeof(buffer) );
+	if ( ret > 0 )
 	{
-	  data.push_back( ch );
-	  if ( ch == '\0' )
-	    break;
+	  data.append( buffer, ret );
 	}
-	else if ( ::feof( filep ) )
+	else if ( ret == 0 )
 	{
 	  WAR << "Unexpected EOF" << endl;
 	  ZYPP_THROW( PluginScriptDiedUnexpectedly( "Receive: script died unexpectedly", str::Str() << Errno() ) );
@@ -394,22 +408,15 @@ namespace zypp
 	    tv.tv_usec = 0;
 
 	    int retval = select( fd+1, &rfds, NULL, NULL, &tv );
-	    if ( retval > 0 )	// FD_ISSET( fd, &rfds ) will be true.
-	    {
-	      ::clearerr( filep );
-	    }
-	    else if ( retval == 0 )
+	    if ( retval == 0 )
 	    {
 	      WAR << "Not ready to read within timeout." << endl;
 	      ZYPP_THROW( PluginScriptReceiveTimeout( "Not ready to read within timeout." ) );
 	    }
-	    else // ( retval == -1 )
+	    else if ( retval == -1 && errno != EINTR )
 	    {
-	      if ( errno != EINTR )
-	      {
-		ERR << "select(): " << Errno() << endl;
-		ZYPP_THROW( PluginScriptException( "Error waiting on file descriptor", str::Str() << Errno() ) );
-	      }
+	      ERR << "select(): " << Errno() << endl;
+	      ZYPP_THROW( PluginScriptException( "Error waiting on file descriptor", str::Str() << Errno() ) );
 	    }
 	  }
 	  else
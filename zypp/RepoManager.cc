@@ -17,6 +17,10 @@
 #include <list>
 #include <map>
 #include <algorithm>
+#ifdef ZYPP_USE_THREADS
+#include <atomic>
+#include <thread>
+#endif
 
 #include "zypp/base/InputStream.h"
 #include "zypp/base/LogTools.h"
@@ -24,6 +28,7 @@
 #include "zypp/base/DefaultIntegral.h"
 #include "zypp/base/Function.h"
 #include "zypp/base/Regex.h"
+#include "zypp/base/Trace.h"
 #include "zypp/PathInfo.h"
 #include "zypp/TmpPath.h"
 
@@ -33,6 +38,7 @@
 
 #include "zypp/media/MediaManager.h"
 #include "zypp/media/CredentialManager.h"
+#include "zypp/media/MediaCurl.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/ManagedFile.h"
@@ -43,6 +49,8 @@
 #include "zypp/repo/yum/Downloader.h"
 #include "zypp/repo/susetags/Downloader.h"
 #include "zypp/repo/PluginServices.h"
+#include "zypp/repo/PackageStore.h"
+#include "zypp/repo/PlaindirIndex.h"
 
 #include "zypp/Target.h" // for Target::targetDistribution() for repo index services
 #include "zypp/ZYppFactory.h" // to get the Target from ZYpp instance
@@ -581,6 +589,18 @@ namespace zypp
 
     RefreshCheckStatus checkIfToRefreshMetadata( const RepoInfo & info, const Url & url, RawMetadataRefreshPolicy policy );
 
+    std::map<std::string,RefreshCheckStatus> checkIfToRefreshMetadata( const RepoInfoList & repos, RawMetadataRefreshPolicy policy );
+
+    /** \ref checkIfToRefreshMetadata trying all baseurls, \ref REFRESH_NEEDED if all fail. */
+    RefreshCheckStatus checkIfToRefreshMetadataAnyUrl( const RepoInfo & info, RawMetadataRefreshPolicy policy );
+
+    /** The part of \ref checkIfToRefreshMetadata not accessing the repo.
+     * Returns \c true if \a result was decided. \a policy may be adjusted
+     * and \a oldstatus is set to the status of the cached metadata.
+     */
+    bool checkIfToRefreshMetadataLocally( const RepoInfo & info, const Url & url, RawMetadataRefreshPolicy & policy,
+					  RepoStatus & oldstatus, RefreshCheckStatus & result );
+
     void refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, OPT_PROGRESS );
 
     void cleanMetadata( const RepoInfo & info, OPT_PROGRESS );
@@ -603,6 +623,7 @@ namespace zypp
     { return RepoStatus::fromCookieFile(solv_path_for_repoinfo(_options, info) / "cookie"); }
 
     void loadFromCache( const RepoInfo & info, OPT_PROGRESS );
+    void loadFromCache( const RepoInfoList & infos, OPT_PROGRESS );
 
     void addRepository( const RepoInfo & info, OPT_PROGRESS );
 
@@ -947,65 +968,79 @@ namespace zypp
   }
 
 
-  RepoManager::RefreshCheckStatus RepoManager::Impl::checkIfToRefreshMetadata( const RepoInfo & info, const Url & url, RawMetadataRefreshPolicy policy )
+  bool RepoManager::Impl::checkIfToRefreshMetadataLocally( const RepoInfo & info, const Url & url, RawMetadataRefreshPolicy & policy,
+							    RepoStatus & oldstatus, RefreshCheckStatus & result )
   {
-    assert_alias(info);
-    try
-    {
-      MIL << "Going to try to check whether refresh is needed for " << url << endl;
+    // first check old (cached) metadata
+    Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
+    filesystem::assert_dir( mediarootpath );
+    oldstatus = metadataStatus( info );
 
-      // first check old (cached) metadata
-      Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
-      filesystem::assert_dir( mediarootpath );
-      RepoStatus oldstatus = metadataStatus( info );
+    if ( oldstatus.empty() )
+    {
+      MIL << "No cached metadata, going to refresh" << endl;
+      result = REFRESH_NEEDED;
+      return true;
+    }
 
-      if ( oldstatus.empty() )
+    {
+      if ( url.schemeIsVolatile() )
       {
-        MIL << "No cached metadata, going to refresh" << endl;
-        return REFRESH_NEEDED;
+	MIL << "never refresh CD/DVD" << endl;
+	result = REPO_UP_TO_DATE;
+	return true;
+      }
+      if ( url.schemeIsLocal() )
+      {
+	policy = RefreshIfNeededIgnoreDelay;
       }
+    }
+
+    // now we've got the old (cached) status, we can decide repo.refresh.delay
+    if (policy != RefreshForced && policy != RefreshIfNeededIgnoreDelay)
+    {
+      // difference in seconds
+      double diff = difftime(
+	(Date::ValueType)Date::now(),
+	(Date::ValueType)oldstatus.timestamp()) / 60;
+
+      DBG << "oldstatus: " << (Date::ValueType)oldstatus.timestamp() << endl;
+      DBG << "current time: " << (Date::ValueType)Date::now() << endl;
+      DBG << "last refresh = " << diff << " minutes ago" << endl;
 
+      if ( diff < ZConfig::instance().repo_refresh_delay() )
       {
-        if ( url.schemeIsVolatile() )
+	if ( diff < 0 )
 	{
-	  MIL << "never refresh CD/DVD" << endl;
-          return REPO_UP_TO_DATE;
+	  WAR << "Repository '" << info.alias() << "' was refreshed in the future!" << endl;
 	}
-	if ( url.schemeIsLocal() )
+	else
 	{
-	  policy = RefreshIfNeededIgnoreDelay;
+	  MIL << "Repository '" << info.alias()
+	      << "' has been refreshed less than repo.refresh.delay ("
+	      << ZConfig::instance().repo_refresh_delay()
+	      << ") minutes ago. Advising to skip refresh" << endl;
+	  result = REPO_CHECK_DELAYED;
+	  return true;
 	}
       }
+    }
+    return false;
+  }
 
-      // now we've got the old (cached) status, we can decide repo.refresh.delay
-      if (policy != RefreshForced && policy != RefreshIfNeededIgnoreDelay)
-      {
-        // difference in seconds
-        double diff = difftime(
-          (Date::ValueType)Date::now(),
-          (Date::ValueType)oldstatus.timestamp()) / 60;
-
-        DBG << "oldstatus: " << (Date::ValueType)oldstatus.timestamp() << endl;
-        DBG << "current time: " << (Date::ValueType)Date::now() << endl;
-        DBG << "last refresh = " << diff << " minutes ago" << endl;
+  RepoManager::RefreshCheckStatus RepoManager::Impl::checkIfToRefreshMetadata( const RepoInfo & info, const Url & url, RawMetadataRefreshPolicy policy )
+  {
+    assert_alias(info);
+    try
+    {
+      MIL << "Going to try to check whether refresh is needed for " << url << endl;
 
-        if ( diff < ZConfig::instance().repo_refresh_delay() )
-        {
-	  if ( diff < 0 )
-	  {
-	    WAR << "Repository '" << info.alias() << "' was refreshed in the future!" << endl;
-	  }
-	  else
-	  {
-	    MIL << "Repository '" << info.alias()
-		<< "' has been refreshed less than repo.refresh.delay ("
-		<< ZConfig::instance().repo_refresh_delay()
-		<< ") minutes ago. Advising to skip refresh" << endl;
-	    return REPO_CHECK_DELAYED;
-	  }
-        }
-      }
+      RepoStatus oldstatus;
+      RefreshCheckStatus result;
+      if ( checkIfToRefreshMetadataLocally( info, url, policy, oldstatus, result ) )
+	return result;
 
+      Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
       repo::RepoType repokind = info.type();
       // if unknown: probe it
       if ( repokind == RepoType::NONE )
@@ -1073,8 +1108,180 @@ namespace zypp
   }
 
 
+  namespace
+  {
+    /** The HTTP cache validators of a repos index file remembered in the raw cache.
+     * Valid as long as the raw metadata match the remembered \ref RepoStatus.
+     */
+    struct HttpValidators
+    {
+      static Pathname file( const Pathname & mediarootpath_r )
+      { return mediarootpath_r / ".http_validators"; }
+
+      /** line := RepoStatus cookie, followed by "ETag: " and "Last-Modified: " lines */
+      static HttpValidators read( const Pathname & mediarootpath_r )
+      {
+	HttpValidators ret;
+	Pathname path( file( mediarootpath_r ) );
+	if ( ! PathInfo( path ).isFile() )
+	  return ret;
+
+	ret.status = RepoStatus::fromCookieFile( path );
+	std::ifstream in( path.c_str() );
+	std::string line( str::getline( in ) );	// the cookie
+	while ( in )
+	{
+	  line = str::getline( in );
+	  if ( str::startsWith( line, "ETag: " ) )
+	    ret.etag = line.substr( 6 );
+	  else if ( str::startsWith( line, "Last-Modified: " ) )
+	    ret.lastModified = line.substr( 15 );
+	}
+	return ret;
+      }
+
+      void write( const Pathname & mediarootpath_r ) const
+      {
+	Pathname path( file( mediarootpath_r ) );
+	try
+	{
+	  status.saveToCookieFile( path );
+	  std::ofstream out( path.c_str(), std::ios::out|std::ios::app );
+	  if ( ! etag.empty() )
+	    out << "ETag: " << etag << endl;
+	  if ( ! lastModified.empty() )
+	    out << "Last-Modified: " << lastModified << endl;
+	}
+	catch ( const Exception & excpt )
+	{
+	  ZYPP_CAUGHT( excpt );
+	  filesystem::unlink( path );
+	}
+      }
+
+      RepoStatus status;
+      std::string etag;
+      std::string lastModified;
+    };
+  } // namespace
+
+  RepoManager::RefreshCheckStatus RepoManager::Impl::checkIfToRefreshMetadataAnyUrl( const RepoInfo & info, RawMetadataRefreshPolicy policy )
+  {
+    for_( it, info.baseUrlsBegin(), info.baseUrlsEnd() )
+    {
+      try
+      {
+	return checkIfToRefreshMetadata( info, *it, policy );
+      }
+      catch ( const Exception & excpt )
+      {
+	ZYPP_CAUGHT( excpt );
+	ERR << *it << " doesn't look good. Trying another url." << endl;
+      }
+    }
+    // Let the refresh report the error.
+    return REFRESH_NEEDED;
+  }
+
+  std::map<std::string,RepoManager::RefreshCheckStatus> RepoManager::Impl::checkIfToRefreshMetadata( const RepoInfoList & repos, RawMetadataRefreshPolicy policy_r )
+  {
+    std::map<std::string,RefreshCheckStatus> ret;
+    std::vector<media::MediaCurl::ConditionalRequest> requests;
+    std::vector<const RepoInfo *> requested;	// RepoInfo of requests[i]
+    std::vector<const RepoInfo *> sequential;
+
+    for ( const RepoInfo & info : repos )
+    {
+      if ( ! info.enabled() || info.baseUrlsEmpty() )
+	continue;
+      assert_alias( info );
+
+      Url url( info.url() );
+      RawMetadataRefreshPolicy policy( policy_r );
+      try
+      {
+	RepoStatus oldstatus;
+	RefreshCheckStatus result;
+	if ( checkIfToRefreshMetadataLocally( info, url, policy, oldstatus, result ) )
+	{
+	  ret[info.alias()] = result;
+	  continue;
+	}
+
+	// Only rpm-md repos are tracked by a single index file.
+	if ( policy != RefreshForced && info.type() == RepoType::RPMMD
+	  && ( url.getScheme() == "http" || url.getScheme() == "https" ) )
+	{
+	  media::MediaCurl::ConditionalRequest request( url, info.path() / "repodata/repomd.xml" );
+	  HttpValidators validators( HttpValidators::read( rawcache_path_for_repoinfo( _options, info ) ) );
+	  if ( ! validators.status.empty() && validators.status == oldstatus )
+	  {
+	    request.etag = validators.etag;
+	    request.lastModified = validators.lastModified;
+	  }
+	  requests.push_back( request );
+	  requested.push_back( &info );
+	  continue;
+	}
+      }
+      catch ( const Exception & excpt )
+      {
+	ZYPP_CAUGHT( excpt );
+      }
+      sequential.push_back( &info );
+    }
+
+    if ( ! requests.empty() )
+    {
+      MIL << "Sending " << requests.size() << " conditional requests." << endl;
+      try
+      {
+	media::MediaCurl::checkModified( requests );
+      }
+      catch ( const Exception & excpt )
+      {
+	ZYPP_CAUGHT( excpt );	// all requests remain unanswered
+      }
+
+      for ( unsigned i = 0; i < requests.size(); ++i )
+      {
+	const media::MediaCurl::ConditionalRequest & request( requests[i] );
+	const RepoInfo & info( *requested[i] );
+	if ( request.httpCode == 304 )
+	{
+	  MIL << "Repository '" << info.alias() << "' not modified (304)" << endl;
+	  touchIndexFile( info );
+	  ret[info.alias()] = REPO_UP_TO_DATE;
+	  continue;
+	}
+
+	if ( ! request.error.empty() )
+	  WAR << "Conditional request for '" << info.alias() << "' failed: " << request.error << endl;
+
+	RefreshCheckStatus result = checkIfToRefreshMetadataAnyUrl( info, policy_r );
+	if ( result == REPO_UP_TO_DATE && request.httpCode == 200
+	  && ! ( request.newEtag.empty() && request.newLastModified.empty() ) )
+	{
+	  // Remember the validators for the next check.
+	  HttpValidators validators;
+	  validators.status = metadataStatus( info );
+	  validators.etag = request.newEtag;
+	  validators.lastModified = request.newLastModified;
+	  validators.write( rawcache_path_for_repoinfo( _options, info ) );
+	}
+	ret[info.alias()] = result;
+      }
+    }
+
+    for ( const RepoInfo * info : sequential )
+      ret[info->alias()] = checkIfToRefreshMetadataAnyUrl( *info, policy_r );
+
+    return ret;
+  }
+
   void RepoManager::Impl::refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progress )
   {
+    debug::TraceSpan span( "refresh", info.alias() );
     assert_alias(info);
     assert_urls(info);
 
@@ -1225,12 +1432,15 @@ namespace zypp
     progress.sendTo(progressfnc);
 
     filesystem::recursive_rmdir(packagescache_path_for_repoinfo(_options, info));
+    // drop shared packages no longer kept by any repo
+    repo::PackageStore( repo::PackageStore::defaultRoot( _options.repoPackagesCachePath ) ).collectGarbage();
     progress.toMax();
   }
 
 
   void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   {
+    debug::TraceSpan span( "solv_build", info.alias() );
     assert_alias(info);
     Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
     Pathname productdatapath = rawproductdata_path_for_repoinfo( _options, info );
@@ -1282,7 +1492,24 @@ namespace zypp
     progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
     progress.toMin();
 
-    if (needs_cleaning)
+    // do we have type?
+    repo::RepoType repokind = info.type();
+
+    // if the type is unknown, try probing.
+    switch ( repokind.toEnum() )
+    {
+      case RepoType::NONE_e:
+        // unknown, probe the local metadata
+        repokind = probeCache( productdatapath );
+      break;
+      default:
+      break;
+    }
+
+    MIL << "repo type is " << repokind << endl;
+
+    // plaindir solv files are updated incrementally (see repo::PlaindirIndex)
+    if ( needs_cleaning && repokind != RepoType::RPMPLAINDIR )
     {
       cleanCache(info);
     }
@@ -1304,31 +1531,29 @@ namespace zypp
     }
     Pathname solvfile = base / "solv";
 
-    // do we have type?
-    repo::RepoType repokind = info.type();
-
-    // if the type is unknown, try probing.
     switch ( repokind.toEnum() )
     {
-      case RepoType::NONE_e:
-        // unknown, probe the local metadata
-        repokind = probeCache( productdatapath );
-      break;
-      default:
-      break;
-    }
-
-    MIL << "repo type is " << repokind << endl;
+      case RepoType::RPMPLAINDIR_e :
+      {
+        // Take care we unlink the solvfile on exception
+        ManagedFile guard( solvfile, filesystem::unlink );
+        // FIXME this does only work form dir: URLs
+        MediaMounter forPlainDirs( *info.baseUrlsBegin() );
+        repo::PlaindirIndex index( forPlainDirs.getPathName( info.path() ), solvfile );
+        if ( policy == BuildForced )
+          filesystem::unlink( repo::PlaindirIndex::cacheFile( solvfile ) );	// read all packages again
+        index.update();
 
-    switch ( repokind.toEnum() )
-    {
+        // We keep it.
+        guard.resetDispose();
+	sat::updateSolvFileIndex( solvfile );	// content digest for zypper bash completion
+      }
+      break;
       case RepoType::RPMMD_e :
       case RepoType::YAST2_e :
-      case RepoType::RPMPLAINDIR_e :
       {
         // Take care we unlink the solvfile on exception
         ManagedFile guard( solvfile, filesystem::unlink );
-        scoped_ptr<MediaMounter> forPlainDirs;
 
         ExternalProgram::Arguments cmd;
         cmd.push_back( "repo2solv.sh" );
@@ -1336,17 +1561,7 @@ namespace zypp
         cmd.push_back( "-o" );
         cmd.push_back( solvfile.asString() );
 	cmd.push_back( "-X" );	// autogenerate pattern from pattern-package
-
-        if ( repokind == RepoType::RPMPLAINDIR )
-        {
-          forPlainDirs.reset( new MediaMounter( *info.baseUrlsBegin() ) );
-          // recusive for plaindir as 2nd arg!
-          cmd.push_back( "-R" );
-          // FIXME this does only work form dir: URLs
-          cmd.push_back( forPlainDirs->getPathName( info.path() ).c_str() );
-        }
-        else
-          cmd.push_back( productdatapath.asString() );
+        cmd.push_back( productdatapath.asString() );
 
         ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
         std::string errdetail;
@@ -1542,6 +1757,8 @@ namespace zypp
       else
         progress.set( progress.val() + 100 );
     }
+    // the package store is not a repo dir; just drop the unreferenced packages
+    repo::PackageStore( repo::PackageStore::defaultRoot( _options.repoPackagesCachePath ) ).collectGarbage();
     progress.toMax();
   }
 
@@ -1561,18 +1778,80 @@ namespace zypp
 
   ////////////////////////////////////////////////////////////////////////////
 
-  void RepoManager::Impl::loadFromCache( const RepoInfo & info, const ProgressData::ReceiverFnc & progressrcv )
+  namespace
   {
-    assert_alias(info);
-    Pathname solvfile = solv_path_for_repoinfo(_options, info) / "solv";
+    /** Max. number of solv files staged in memory by \ref RepoManager::Impl::loadFromCache. */
+    const size_t solvStageBatch = 8;
 
-    if ( ! PathInfo(solvfile).isExist() )
-      ZYPP_THROW(RepoNotCachedException(info));
+    /** Read the content of a solv file; an empty string on error. */
+    std::string readSolvFile( const Pathname & file_r )
+    {
+      std::string ret;
+      std::ifstream in( file_r.c_str(), std::ios::binary );
+      PathInfo pi( file_r );
+      if ( in && pi.isFile() && pi.size() )
+      {
+        ret.resize( pi.size() );
+        if ( ! in.read( &ret[0], ret.size() ) )
+          ret.clear();
+      }
+      return ret;
+    }
 
-    sat::Pool::instance().reposErase( info.alias() );
-    try
+    /** Read the content of all \a files_r into memory.
+     * If libzypp is built with threads enabled (\c ZYPP_USE_THREADS) the
+     * files are read in parallel. Files that can't be read yield an empty
+     * string.
+     */
+    std::vector<std::string> readSolvFiles( const std::vector<Pathname> & files_r )
+    {
+      std::vector<std::string> ret( files_r.size() );
+#ifdef ZYPP_USE_THREADS
+      unsigned nworkers = std::thread::hardware_concurrency();
+      if ( nworkers > files_r.size() )
+        nworkers = files_r.size();
+      if ( nworkers > 1 )
+      {
+        std::atomic<size_t> next( 0 );
+        auto worker = [&]()
+        {
+          for ( size_t idx = next++; idx < files_r.size(); idx = next++ )
+            ret[idx] = readSolvFile( files_r[idx] );
+        };
+        std::vector<std::thread> workers;
+        for ( unsigned i = 0; i < nworkers; ++i )
+          workers.push_back( std::thread( worker ) );
+        for ( auto & t : workers )
+          t.join();
+        return ret;
+      }
+#endif
+      for ( size_t idx = 0; idx < files_r.size(); ++idx )
+        ret[idx] = readSolvFile( files_r[idx] );
+      return ret;
+    }
+
+    /** Add the repos \a solvfile_r (or its already \a staged_r content) to the pool.
+     * \throws Exception if the solv file can't be used and needs to be rebuilt.
+     */
+    void addRepoSolvChecked( const RepoInfo & info_r, const Pathname & solvfile_r, const std::string & staged_r )
     {
-      Repository repo = sat::Pool::instance().addRepoSolv( solvfile, info );
+      Repository repo;
+      if ( staged_r.empty() )
+      {
+        repo = sat::Pool::instance().addRepoSolv( solvfile_r, info_r );
+      }
+      else
+      {
+        // Using a temporay repo! (The additional parenthesis are required.)
+        AutoDispose<Repository> tmprepo( (Repository::EraseFromPool()) );
+        *tmprepo = sat::Pool::instance().reposInsert( info_r.alias() );
+        tmprepo->addSolvData( staged_r, solvfile_r.asString() );
+        tmprepo->setInfo( info_r );
+        tmprepo.resetDispose();
+        repo = tmprepo;
+      }
+
       // test toolversion in order to rebuild solv file in case
       // it was written by an old libsolv-tool parser.
       //
@@ -1588,6 +1867,22 @@ namespace zypp
       }
       // else: up-to-date (or even newer).
     }
+  } // namespace
+
+  void RepoManager::Impl::loadFromCache( const RepoInfo & info, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    debug::TraceSpan span( "pool_load", info.alias() );
+    assert_alias(info);
+    Pathname solvfile = solv_path_for_repoinfo(_options, info) / "solv";
+
+    if ( ! PathInfo(solvfile).isExist() )
+      ZYPP_THROW(RepoNotCachedException(info));
+
+    sat::Pool::instance().reposErase( info.alias() );
+    try
+    {
+      addRepoSolvChecked( info, solvfile, std::string() );
+    }
     catch ( const Exception & exp )
     {
       ZYPP_CAUGHT( exp );
@@ -1599,6 +1894,58 @@ namespace zypp
     }
   }
 
+  void RepoManager::Impl::loadFromCache( const RepoInfoList & infos, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    debug::TraceSpan span( "pool_load" );
+    std::vector<RepoInfo> todo( infos.begin(), infos.end() );
+    std::vector<Pathname> solvfiles;
+    for ( const RepoInfo & info : todo )
+    {
+      assert_alias(info);
+      solvfiles.push_back( solv_path_for_repoinfo(_options, info) / "solv" );
+      if ( ! PathInfo(solvfiles.back()).isExist() )
+        ZYPP_THROW(RepoNotCachedException(info));
+    }
+
+    ProgressData progress( todo.size() );
+    progress.sendTo( progressrcv );
+    progress.toMin();
+
+    // Reading the solv files is done in parallel, but adding them to
+    // the pool must be serialized (libsolv interns all strings and
+    // relations in the pools global tables).
+    for ( size_t first = 0; first < todo.size(); first += solvStageBatch )
+    {
+      size_t last = std::min( first + solvStageBatch, todo.size() );
+      std::vector<std::string> staged( readSolvFiles( std::vector<Pathname>( solvfiles.begin()+first, solvfiles.begin()+last ) ) );
+
+      for ( size_t idx = first; idx < last; ++idx )
+      {
+        const RepoInfo & info( todo[idx] );
+        const Pathname & solvfile( solvfiles[idx] );
+        std::string data;
+        data.swap( staged[idx-first] );	// release the buffer when done
+
+        sat::Pool::instance().reposErase( info.alias() );
+        try
+        {
+          addRepoSolvChecked( info, solvfile, data );
+        }
+        catch ( const Exception & exp )
+        {
+          ZYPP_CAUGHT( exp );
+          MIL << "Try to handle exception by rebuilding the solv-file" << endl;
+          cleanCache( info );
+          buildCache( info, BuildIfNeeded );
+
+          sat::Pool::instance().addRepoSolv( solvfile, info );
+        }
+        progress.incr();
+      }
+    }
+    progress.toMax();
+  }
+
   ////////////////////////////////////////////////////////////////////////////
 
   void RepoManager::Impl::addRepository( const RepoInfo & info, const ProgressData::ReceiverFnc & progressrcv )
@@ -2536,6 +2883,9 @@ namespace zypp
   RepoManager::RefreshCheckStatus RepoManager::checkIfToRefreshMetadata( const RepoInfo &info, const Url &url, RawMetadataRefreshPolicy policy )
   { return _pimpl->checkIfToRefreshMetadata( info, url, policy ); }
 
+  std::map<std::string,RepoManager::RefreshCheckStatus> RepoManager::checkIfToRefreshMetadata( const RepoInfoList & repos, RawMetadataRefreshPolicy policy )
+  { return _pimpl->checkIfToRefreshMetadata( repos, policy ); }
+
   Pathname RepoManager::metadataPath( const RepoInfo &info ) const
   { return _pimpl->metadataPath( info ); }
 
@@ -2566,6 +2916,9 @@ namespace zypp
   void RepoManager::loadFromCache( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->loadFromCache( info, progressrcv ); }
 
+  void RepoManager::loadFromCache( const RepoInfoList & infos, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->loadFromCache( infos, progressrcv ); }
+
   void RepoManager::cleanCacheDirGarbage( const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanCacheDirGarbage( progressrcv ); }
 
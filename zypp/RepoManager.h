@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <list>
+#include <map>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/Iterator.h"
@@ -256,6 +257,25 @@ namespace zypp
                                    const Url &url,
                                    RawMetadataRefreshPolicy policy = RefreshIfNeeded);
 
+    /**
+     * Checks whether to refresh metadata for all enabled \a repos.
+     *
+     * Like \ref checkIfToRefreshMetadata, but for rpm-md repos available
+     * via http(s) a conditional request for \c repomd.xml is sent to all
+     * of them at once. If the server tells the file was not modified
+     * since the last check (HTTP 304), the repo is up to date without
+     * further download. The \c ETag and \c Last-Modified validators
+     * needed for this are stored in the raw metadata cache. All other
+     * repos (and if the conditional request was not answered with 304)
+     * are checked the usual way, trying all baseurls.
+     *
+     * \return The \ref RefreshCheckStatus per repo alias. If checking a
+     * repo failed for all its baseurls, \ref REFRESH_NEEDED is returned,
+     * so the refresh will report the error.
+     */
+    std::map<std::string,RefreshCheckStatus> checkIfToRefreshMetadata( const RepoInfoList & repos,
+                                                                       RawMetadataRefreshPolicy policy = RefreshIfNeeded );
+
     /**
      * \short Path where the metadata is downloaded and kept
      *
@@ -384,6 +404,28 @@ namespace zypp
    void loadFromCache( const RepoInfo &info,
                        const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Load the resolvables of several repositories into the pool
+    *
+    * Same as calling \ref loadFromCache for each repo in \a infos, but
+    * the solv files are read ahead. Adding them to the pool is still done
+    * one by one, in the order of \a infos. \a progressrcv is advanced per repo.
+    *
+    * The solv files are read in parallel only if libzypp is built with
+    * threads enabled (\c ENABLE_USE_THREADS, which is off by default).
+    * Otherwise they are read one after the other.
+    *
+    * A damaged solv file is rebuilt, just like \ref loadFromCache does.
+    * If this fails, the exception is passed on. The repos before the
+    * failing one stay loaded, the ones after it are not loaded.
+    *
+    * \throws repo::RepoNoAliasException if can't figure an alias to look in cache
+    * \throw RepoNotCachedException When one of the sources is not cached.
+    * Nothing is loaded in this case.
+    */
+   void loadFromCache( const RepoInfoList &infos,
+                       const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * Remove any subdirectories of cache directories which no longer belong
     * to any of known repositories.
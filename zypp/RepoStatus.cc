@@ -9,11 +9,14 @@
 /** \file	zypp/RepoStatus.cc
  *
 */
+#include <dirent.h>
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
+#include "zypp/base/Errno.h"
+#include "zypp/AutoDispose.h"
 #include "zypp/RepoStatus.h"
 #include "zypp/PathInfo.h"
 
@@ -34,16 +37,29 @@ namespace zypp
     string _checksum;
     Date _timestamp;
 
-    /** Recursive computation of max dir timestamp. */
+    /** Recursive computation of max dir timestamp.
+     * Hidden entries are skipped. The entries type is taken from the
+     * directory, so just the subdirectories need to be lstat'ed (large
+     * plaindir repos contain many files, but few directories).
+     */
     static void recursive_timestamp( const Pathname & dir_r, time_t & max_r )
     {
-      std::list<std::string> dircontent;
-      if ( filesystem::readdir( dircontent, dir_r, false/*no dots*/ ) != 0 )
-	return; // readdir logged the error
+      AutoDispose<DIR *> dir( ::opendir( dir_r.c_str() ),
+			      []( DIR * dir_r ) { if ( dir_r ) ::closedir( dir_r ); } );
+      if ( ! dir )
+      {
+	WAR << "Can't read " << dir_r << ": " << Errno() << endl;
+	return;
+      }
 
-      for_( it, dircontent.begin(), dircontent.end() )
+      for ( struct dirent * entry = ::readdir( dir ); entry; entry = ::readdir( dir ) )
       {
-	PathInfo pi( dir_r + *it, PathInfo::LSTAT );
+	if ( entry->d_name[0] == '.' )
+	  continue; // no dots
+	if ( entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN )
+	  continue;
+
+	PathInfo pi( dir_r + entry->d_name, PathInfo::LSTAT );
 	if ( pi.isDir() )
 	{
 	  if ( pi.mtime() > max_r )
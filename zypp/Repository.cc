@@ -336,6 +336,25 @@ namespace zypp
       MIL << *this << " after adding " << file_r << endl;
     }
 
+    void Repository::addSolvData( const std::string & data_r, const std::string & name_r )
+    {
+      NO_REPOSITORY_THROW( Exception( "Can't add solvables to norepo." ) );
+
+      AutoDispose<FILE*> file( data_r.empty() ? NULL : ::fmemopen( const_cast<char*>( data_r.data() ), data_r.size(), "r" ), ::fclose );
+      if ( file == NULL )
+      {
+        file.resetDispose();
+        ZYPP_THROW( Exception( "Can't open solv-data: "+name_r ) );
+      }
+
+      if ( myPool()._addSolv( _repo, file ) != 0 )
+      {
+        ZYPP_THROW( Exception( "Error reading solv-data: "+name_r ) );
+      }
+
+      MIL << *this << " after adding " << name_r << endl;
+    }
+
     void Repository::addHelix( const Pathname & file_r )
     {
       NO_REPOSITORY_THROW( Exception( "Can't add solvables to norepo." ) );
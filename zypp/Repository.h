@@ -284,6 +284,14 @@ namespace zypp
          */
         void addSolv( const Pathname & file_r );
 
+        /** Load \ref Solvables from the content of a solv-file held in memory.
+         * \a name_r is used in messages only.
+         * In case of an exception the repository remains in the \ref Pool.
+         * \throws Exception if this is \ref noRepository
+         * \throws Exception if loading the solv-data fails.
+         */
+        void addSolvData( const std::string & data_r, const std::string & name_r );
+
          /** Load \ref Solvables from a helix-file.
          * Supports loading of gzip compressed files (.gz). In case of an exception
          * the repository remains in the \ref Pool.
@@ -13,11 +13,13 @@
 //#include "zypp/base/Logger.h"
 
 #include "zypp/base/SerialNumber.h"
+#include "zypp/thread/RWMutex.h"
 
 #include "zypp/ZYppFactory.h"
 #include "zypp/ResPool.h"
 #include "zypp/pool/PoolImpl.h"
 #include "zypp/pool/PoolStats.h"
+#include "zypp/sat/detail/PoolImpl.h"
 
 using std::endl;
 
@@ -60,6 +62,12 @@ namespace zypp
   const SerialNumber & ResPool::serial() const
   { return _pimpl->serial(); }
 
+  void ResPool::freeze() const
+  { _pimpl->freeze(); }
+
+  bool ResPool::frozen() const
+  { return _pimpl->satpool().frozen(); }
+
   bool ResPool::empty() const
   { return _pimpl->empty(); }
 
@@ -134,6 +142,55 @@ namespace zypp
   bool ResPool::isAvailableLocale( const Locale & locale_r ) const
   { return sat::Pool::instance().isAvailableLocale( locale_r ); }
 
+  ///////////////////////////////////////////////////////////////////
+  //
+  //	CLASS NAME : ResPool::ReadGuard, ResPool::WriteGuard
+  //
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    /** Coordinates the \ref ResPool::ReadGuard and \ref ResPool::WriteGuard. */
+    inline thread::RWMutex & poolMutex()
+    {
+      static thread::RWMutex _mutex;
+      return _mutex;
+    }
+  } // namespace
+
+  ResPool::ReadGuard::ReadGuard()
+  {
+    thread::RWMutex & mutex( poolMutex() );
+    mutex.lockRead();
+    while ( ! ResPool::instance().frozen() )
+    {
+      // The first reader after a change freezes the pool exclusively.
+      mutex.unlock();
+      {
+        thread::WriteLock lock( mutex );
+        if ( ! ResPool::instance().frozen() )
+          ResPool::instance().freeze();
+      }
+      mutex.lockRead();
+    }
+    sat::detail::PoolMember::myPool().addReader( true );
+  }
+
+  ResPool::ReadGuard::~ReadGuard()
+  {
+    sat::detail::PoolMember::myPool().addReader( false );
+    try { poolMutex().unlock(); }
+    catch( ... ) {} // don't let exceptions escape
+  }
+
+  ResPool::WriteGuard::WriteGuard()
+  { poolMutex().lockWrite(); }
+
+  ResPool::WriteGuard::~WriteGuard()
+  {
+    try { poolMutex().unlock(); }
+    catch( ... ) {} // don't let exceptions escape
+  }
+
   /******************************************************************
   **
   **	FUNCTION NAME : operator<<
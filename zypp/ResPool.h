@@ -16,6 +16,7 @@
 
 #include "zypp/APIConfig.h"
 #include "zypp/base/Iterator.h"
+#include "zypp/base/NonCopyable.h"
 
 #include "zypp/pool/PoolTraits.h"
 #include "zypp/PoolItem.h"
@@ -85,6 +86,54 @@ namespace zypp
        */
       const SerialNumber & serial() const;
 
+    public:
+      /** \name Concurrent readers.
+       *
+       * Once all lazily built data are computed (\ref freeze), multiple
+       * threads may read the pool at the same time: iterate and find
+       * \ref PoolItem, query \ref sat::WhatProvides, \ref PoolQuery or
+       * \ref sat::LookupAttr, retrieve \ref Solvable attributes...
+       * Nobody must change the pool meanwhile.
+       *
+       * \ref ReadGuard and \ref WriteGuard take care of this:
+       * \code
+       *   // any number of threads:
+       *   {
+       *     ResPool::ReadGuard guard;	// the first one freezes the pool
+       *     for ( const PoolItem & pi : ResPool::instance().byIdent( ident ) )
+       *     { ... }
+       *   }
+       *
+       *   // changing the pool (load repos, set requested locales, ...):
+       *   {
+       *     ResPool::WriteGuard guard;	// waits for the readers to leave
+       *     ...
+       *   }
+       * \endcode
+       *
+       * \note While a \ref ReadGuard is held no new strings or dependencies
+       * are created. An \ref IdString or \ref Capability built from unknown
+       * text is \c Null, so e.g. a \ref PoolQuery for something unknown simply
+       * finds nothing. Create them under a \ref WriteGuard if needed.
+       *
+       * \note Readers must not use the \ref ResPoolProxy, change any
+       * \ref ResStatus or run the solver. Use \c asString instead of \c c_str
+       * on \ref Capability and \ref sat::LookupAttr results, as these may
+       * point into a temporary buffer shared by all threads.
+       */
+      //@{
+      /** Compute all lazily built data, so concurrent readers can access the pool.
+       * \see \ref sat::Pool::freeze
+       */
+      void freeze() const;
+
+      /** Whether the pool is frozen (unchanged since the last \ref freeze). */
+      bool frozen() const;
+
+      class ReadGuard;
+      class WriteGuard;
+      //@}
+
     public:
       /**  */
       bool empty() const;
@@ -425,6 +474,37 @@ namespace zypp
   /** \relates ResPool Stream output */
   std::ostream & operator<<( std::ostream & str, const ResPool & obj );
 
+  ///////////////////////////////////////////////////////////////////
+  /// \class ResPool::ReadGuard
+  /// \brief Shared access to the \ref ResPool while in scope.
+  ///
+  /// Any number of threads may hold a ReadGuard at the same time. The
+  /// first one after a change freezes the pool (\ref ResPool::freeze).
+  /// Not recursive: don't create a \ref WriteGuard while holding one.
+  ///////////////////////////////////////////////////////////////////
+  class ResPool::ReadGuard : private base::NonCopyable
+  {
+  public:
+    ReadGuard();
+    ~ReadGuard();
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class ResPool::WriteGuard
+  /// \brief Exclusive access to the \ref ResPool while in scope.
+  ///
+  /// Waits until all \ref ReadGuard are released. New strings and
+  /// dependencies may be created while holding it. If the pool was not
+  /// changed otherwise, the next \ref ReadGuard prepares just the new
+  /// ones for the readers.
+  ///////////////////////////////////////////////////////////////////
+  class ResPool::WriteGuard : private base::NonCopyable
+  {
+  public:
+    WriteGuard();
+    ~WriteGuard();
+  };
+
   /////////////////////////////////////////////////////////////////
 } // namespace zypp
 ///////////////////////////////////////////////////////////////////
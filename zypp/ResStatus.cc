@@ -20,6 +20,24 @@ using std::endl;
 namespace zypp
 { /////////////////////////////////////////////////////////////////
 
+  SerialNumber ResStatus::_transactSerial;
+  ResStatus::TransactLog ResStatus::_transactLog;
+
+  void ResStatus::transactChanged() const
+  {
+    _transactSerial.setDirty();
+    std::vector<const ResStatus *> & entries( _transactLog.entries );
+    if ( ! entries.empty() && entries.back() == this )
+      return;
+    if ( entries.size() == 4096 )
+    {
+      // keep it small; consumers lagging behind check all statuses
+      _transactLog.begin += entries.size();
+      entries.clear();
+    }
+    entries.push_back( this );
+  }
+
   const ResStatus ResStatus::toBeInstalled		 (UNINSTALLED, UNDETERMINED, TRANSACT);
   const ResStatus ResStatus::toBeUninstalled		 (INSTALLED,   UNDETERMINED, TRANSACT);
   const ResStatus ResStatus::toBeUninstalledDueToUpgrade (INSTALLED,   UNDETERMINED, TRANSACT, EXPLICIT_INSTALL, DUE_TO_UPGRADE);
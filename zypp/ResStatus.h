@@ -14,7 +14,10 @@
 
 #include <inttypes.h>
 #include <iosfwd>
+#include <type_traits>
+#include <vector>
 #include "zypp/Bit.h"
+#include "zypp/base/SerialNumber.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -162,6 +165,19 @@ namespace zypp
     /** Dtor. */
     ~ResStatus();
 
+    ResStatus( const ResStatus & ) = default;
+
+    /** Assignment records a change of the status (\ref transactLog). */
+    ResStatus & operator=( const ResStatus & rhs )
+    {
+      if ( _bitfield != rhs._bitfield )
+      {
+        _bitfield = rhs._bitfield;
+        transactChanged();
+      }
+      return *this;
+    }
+
     /** Debug helper returning the bitfield.
      * It's save to expose the bitfield, as it can't be used to
      * recreate a ResStatus. So it is not possible to bypass
@@ -645,9 +661,37 @@ namespace zypp
 
       // Ok, we take it all..
       _bitfield = newStatus_r._bitfield;
+      transactChanged();
       return true;
     }
 
+    /** Serial number changing whenever some ResStatus may have changed its
+     * transact value. Allows data computed from the pools transaction (e.g.
+     * by \ref DiskUsageCounter) to tell whether they need to be updated.
+     */
+    static const SerialNumber & transactSerial()
+    { return _transactSerial; }
+
+    /** The ResStatus objects which may have changed their transact value, oldest first.
+     * Change number \c n is stored in <tt>entries[n-begin]</tt>. Just the latest
+     * changes are kept: if \c begin moved past the change a consumer expects
+     * next, it missed some and must check all statuses.
+     */
+    struct TransactLog
+    {
+      TransactLog() : begin( 0 ) {}
+      /** Number of the next change. */
+      unsigned long long end() const
+      { return begin + entries.size(); }
+
+      unsigned long long begin;
+      std::vector<const ResStatus *> entries;
+    };
+
+    /** \see \ref TransactLog */
+    static const TransactLog & transactLog()
+    { return _transactLog; }
+
     /** \name Builtin ResStatus constants. */
     //@{
     static const ResStatus toBeInstalled;
@@ -674,7 +718,11 @@ namespace zypp
     */
     template<class TField>
       void fieldValueAssign( FieldType val_r )
-    { _bitfield.assign<TField>( val_r ); }
+    {
+      _bitfield.assign<TField>( val_r );
+      if ( std::is_same<TField,TransactField>::value )
+        transactChanged();
+    }
 
     /** compare two values.
     */
@@ -689,6 +737,10 @@ namespace zypp
   private:
     friend class resstatus::StatusBackup;
     BitFieldType _bitfield;
+    /** Bump \ref transactSerial and log this status in \ref transactLog. */
+    void transactChanged() const;
+    static SerialNumber _transactSerial;
+    static TransactLog _transactLog;
   };
   ///////////////////////////////////////////////////////////////////
 
@@ -726,7 +778,13 @@ namespace zypp
         {}
 
         void replay()
-        { if ( _status ) _status->_bitfield = _bitfield; }
+        {
+          if ( _status )
+          {
+            _status->_bitfield = _bitfield;
+            _status->transactChanged();
+          }
+        }
 
       private:
         ResStatus *             _status;
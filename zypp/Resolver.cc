@@ -141,6 +141,9 @@ namespace zypp
   std::list<PoolItem> Resolver::problematicUpdateItems() const
   { return _pimpl->problematicUpdateItems(); }
 
+  solver::detail::SolverStats Resolver::solverStats() const
+  { return _pimpl->solverStats(); }
+
   bool Resolver::createSolverTestcase( const std::string & dumpPath, bool runSolver )
   {
     solver::detail::Testcase testcase (dumpPath);
@@ -153,6 +153,13 @@ namespace zypp
      **/
     std::list<PoolItem> problematicUpdateItems() const;
 
+    /**
+     * Number of rules, decisions and problems and the time spent
+     * in the sat solver during the last solver run.
+     * All \c 0 if the solver did not run yet.
+     **/
+    solver::detail::SolverStats solverStats() const;
+
     /**
      * Return the dependency problems found by the last call to
      * resolveDependencies(). If there were no problems, the returned
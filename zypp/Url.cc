@@ -17,6 +17,7 @@
 #include "zypp/base/Regex.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
 
 
 //////////////////////////////////////////////////////////////////////
@@ -369,41 +370,64 @@ namespace zypp
   UrlRef
   Url::parseUrl(const std::string &encodedUrl)
   {
-    UrlRef      url;
-    str::smatch out;
-    bool        ret = false;
+    // Hand-written equivalent of matching RX_SPLIT_URL, which
+    // matches any string (up to an embedded NUL).
+    std::string::size_type end = encodedUrl.find('\0');
+    if (end == std::string::npos)
+      end = encodedUrl.size();
 
-    try
+    std::string::size_type pos = encodedUrl.find_first_of(":/?#");
+    std::string::size_type beg = 0;
+
+    // scheme: "^([^:/?#]+:|)"
+    std::string scheme;
+    if (pos != std::string::npos && pos > 0 && pos < end && encodedUrl[pos] == ':')
     {
-      str::regex  rex(RX_SPLIT_URL);
-      ret = str::regex_match(encodedUrl, out, rex);
+      scheme = encodedUrl.substr(0, pos);
+      beg = pos + 1;
     }
-    catch( ... )
-    {}
 
-    if(ret && out.size() == 6)
+    // authority: "(//[^/?#]*|)"
+    std::string authority;
+    if (end - beg >= 2 && encodedUrl[beg] == '/' && encodedUrl[beg+1] == '/')
     {
-      std::string scheme = out[1];
-      if (scheme.size() > 1)
-        scheme = scheme.substr(0, scheme.size()-1);
-      std::string authority = out[2];
-      if (authority.size() >= 2)
-        authority = authority.substr(2);
-      std::string query = out[4];
+      pos = std::min(encodedUrl.find_first_of("/?#", beg+2), end);
+      authority = encodedUrl.substr(beg+2, pos-beg-2);
+      beg = pos;
+    }
+
+    // path: "([^?#]*)"
+    pos = std::min(encodedUrl.find_first_of("?#", beg), end);
+    std::string path(encodedUrl.substr(beg, pos-beg));
+    beg = pos;
+
+    // query: "([?][^#]*|)"
+    std::string query;
+    if (beg < end && encodedUrl[beg] == '?')
+    {
+      pos = std::min(encodedUrl.find('#', beg), end);
+      query = encodedUrl.substr(beg, pos-beg);
       if (query.size() > 1)
         query = query.substr(1);
-      std::string fragment = out[5];
+      beg = pos;
+    }
+
+    // fragment: "(#.*|)"
+    std::string fragment;
+    if (beg < end)
+    {
+      fragment = encodedUrl.substr(beg, end-beg);
       if (fragment.size() > 1)
         fragment = fragment.substr(1);
+    }
 
-      url = g_urlSchemeRepository().getUrlByScheme(scheme);
-      if( !url)
-      {
-        url.reset( new UrlBase());
-      }
-      url->init(scheme, authority, out[3],
-                query, fragment);
+    UrlRef url( g_urlSchemeRepository().getUrlByScheme(scheme));
+    if( !url)
+    {
+      url.reset( new UrlBase());
     }
+    url->init(scheme, authority, path,
+              query, fragment);
     return url;
   }
 
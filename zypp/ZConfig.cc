@@ -317,6 +317,7 @@ namespace zypp
         , download_use_deltarpm_always  ( false )
         , download_media_prefer_download( true )
 	, download_mediaMountdir	( "/var/adm/mount" )
+	, download_peer_cache		( Url() )
         , download_max_concurrent_connections( 5 )
         , download_min_download_speed	( 0 )
         , download_max_download_speed	( 0 )
@@ -444,6 +445,19 @@ namespace zypp
 		  download_mediaMountdir.restoreToDefault( Pathname(value) );
                 }
 
+		else if ( entry == "download.peer_cache" )
+                {
+		  try
+		  {
+		    download_peer_cache.restoreToDefault( Url(value) );
+		  }
+		  catch ( const Exception & excpt )
+		  {
+		    ZYPP_CAUGHT( excpt );
+		    WAR << "Ignore invalid download.peer_cache '" << value << "'" << endl;
+		  }
+                }
+
                 else if ( entry == "download.max_concurrent_connections" )
                 {
                   str::strtonum(value, download_max_concurrent_connections);
@@ -454,7 +468,7 @@ namespace zypp
                 }
                 else if ( entry == "download.max_download_speed" )
                 {
-                  str::strtonum(value, download_max_download_speed);
+                  download_max_download_speed.restoreToDefault( str::strtonum<long>(value) );
                 }
                 else if ( entry == "download.max_silent_tries" )
                 {
@@ -642,10 +656,11 @@ namespace zypp
     bool download_use_deltarpm_always;
     DefaultOption<bool> download_media_prefer_download;
     DefaultOption<Pathname> download_mediaMountdir;
+    DefaultOption<Url> download_peer_cache;
 
     int download_max_concurrent_connections;
     int download_min_download_speed;
-    int download_max_download_speed;
+    DefaultOption<long> download_max_download_speed;
     int download_max_silent_tries;
     int download_transfer_timeout;
 
@@ -987,6 +1002,12 @@ namespace zypp
   long ZConfig::download_max_download_speed() const
   { return _pimpl->download_max_download_speed; }
 
+  void ZConfig::set_download_max_download_speed( long newval_r )
+  { _pimpl->download_max_download_speed.set( newval_r ); }
+
+  void ZConfig::set_default_download_max_download_speed()
+  { _pimpl->download_max_download_speed.restoreToDefault(); }
+
   long ZConfig::download_max_silent_tries() const
   { return _pimpl->download_max_silent_tries; }
 
@@ -997,6 +1018,10 @@ namespace zypp
   void ZConfig::set_download_mediaMountdir( Pathname newval_r )	{ _pimpl->download_mediaMountdir.set( std::move(newval_r) ); }
   void ZConfig::set_default_download_mediaMountdir()		{ _pimpl->download_mediaMountdir.restoreToDefault(); }
 
+  Url ZConfig::download_peer_cache() const			{ return _pimpl->download_peer_cache; }
+  void ZConfig::set_download_peer_cache( Url newval_r )		{ _pimpl->download_peer_cache.set( std::move(newval_r) ); }
+  void ZConfig::set_default_download_peer_cache()		{ _pimpl->download_peer_cache.restoreToDefault(); }
+
   DownloadMode ZConfig::commit_downloadMode() const
   { return _pimpl->commit_downloadMode; }
 
@@ -23,6 +23,7 @@
 #include "zypp/Arch.h"
 #include "zypp/Locale.h"
 #include "zypp/Pathname.h"
+#include "zypp/Url.h"
 #include "zypp/IdString.h"
 #include "zypp/TriBool.h"
 
@@ -218,6 +219,12 @@ namespace zypp
        * Maximum download speed (bytes per second)
        */
       long download_max_download_speed() const;
+      /** Set \ref download_max_download_speed (e.g. for background downloads).
+       * Takes effect for media attached afterwards.
+       */
+      void set_download_max_download_speed( long newval_r );
+      /** Reset \ref download_max_download_speed to the \c zypp.conf default. */
+      void set_default_download_max_download_speed();
 
       /**
        * Maximum silent tries
@@ -268,6 +275,17 @@ namespace zypp
       /** Reset to zypp.cong default. */
       void set_default_download_mediaMountdir();
 
+      /** Local cache (e.g. an HTTP cache on the same subnet) asked for files before the repos mirror.
+       * Files are requested by checksum as <tt>url/<type>/<checksum></tt>. Empty if not configured.
+       * Config option <tt>download.peer_cache</tt>
+       * \see \ref media::PeerCache
+       */
+      Url download_peer_cache() const;
+      /** Set \ref download_peer_cache to a specific value (an empty Url disables it). */
+      void set_download_peer_cache( Url newval_r );
+      /** Set \ref download_peer_cache to the configfiles default. */
+      void set_default_download_peer_cache();
+
       /**
        * Commit download policy to use as default.
        */
@@ -101,6 +101,12 @@ namespace zypp
     }
 
     ~ZYppGlobalLock()
+    { releaseLock(); }
+
+    /** Give up the lock we hold (if any).
+     * \return Whether the lock was released.
+     */
+    bool releaseLock()
     {
 	if ( _cleanLock )
 	try {
@@ -112,9 +118,12 @@ namespace zypp
 	    // still use it to synchronsize.
 	    ftruncate( fileno(_zyppLockFile), 0 );
 	  }
+	  _cleanLock = false;
 	  MIL << "Cleanned lock file. (" << getpid() << ")" << std::endl;
+	  return true;
 	}
 	catch(...) {} // let no exception escape.
+	return false;
     }
 
     pid_t lockerPid() const
@@ -287,6 +296,7 @@ namespace zypp
   {
     static weak_ptr<ZYpp>		_theZYppInstance;
     static scoped_ptr<ZYppGlobalLock>	_theGlobalLock;		// on/off in sync with _theZYppInstance
+    static bool				_theLockReleased = false;	// until reacquireLock succeeds
 
     ZYppGlobalLock & globalLock()
     {
@@ -415,6 +425,40 @@ namespace zypp
   bool ZYppFactory::haveZYpp() const
   { return !_theZYppInstance.expired(); }
 
+  ///////////////////////////////////////////////////////////////////
+  //
+  bool ZYppFactory::releaseLock() const
+  {
+    if ( ! haveZYpp() || ! _theGlobalLock || ! _theGlobalLock->releaseLock() )
+      return false;
+    _theLockReleased = true;
+    return true;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  //
+  void ZYppFactory::reacquireLock() const
+  {
+    if ( ! _theLockReleased )
+      return;
+    if ( ! haveZYpp() || geteuid() != 0 || zypp_readonly_hack::active )
+    {
+      _theLockReleased = false;
+      return;
+    }
+
+    if ( globalLock().zyppLocked() )
+    {
+      std::string t = str::form(_("System management is locked by the application with pid %d (%s).\n"
+				  "Close this application before trying again."),
+				  globalLock().lockerPid(),
+				  globalLock().lockerName().c_str()
+				);
+      ZYPP_THROW(ZYppFactoryException(t, globalLock().lockerPid(), globalLock().lockerName() ));
+    }
+    _theLockReleased = false;
+  }
+
   /******************************************************************
   **
   **	FUNCTION NAME : operator<<
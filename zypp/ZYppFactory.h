@@ -59,6 +59,24 @@ namespace zypp
     /** Whether the ZYpp instance is already created.*/
     bool haveZYpp() const;
 
+    /** Temporarily release the global lock held by the ZYpp instance.
+     * Long running tasks not modifying the system (e.g. downloading
+     * packages, see \ref target::PackagePrefetcher) may release the
+     * lock, so other applications are not blocked meanwhile. Use
+     * \ref reacquireLock before modifying the system again.
+     * \return Whether a lock was released.
+     */
+    bool releaseLock() const;
+
+    /** Reacquire the global lock after \ref releaseLock.
+     * Does nothing if the lock was not released. Until this succeeds
+     * \ref ZYpp::commit refuses to run (it calls reacquireLock itself).
+     * \note Another application may have held the lock meanwhile, so the
+     * pool and the rpm database may be outdated. Reload them if needed.
+     * \throw ZYppFactoryException If meanwhile another application holds the lock.
+     */
+    void reacquireLock() const;
+
   private:
     /** Default ctor. */
     ZYppFactory();
@@ -0,0 +1,100 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/base/CodeTable.h
+ */
+#ifndef ZYPP_BASE_CODETABLE_H
+#define ZYPP_BASE_CODETABLE_H
+
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace base
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \brief Lookup in \c constexpr tables of string codes.
+    ///
+    /// Static code tables (e.g. ISO language or country codes) are
+    /// defined as \c constexpr arrays sorted by code. They live in read
+    /// only data and need no initialization at runtime. \ref isSorted
+    /// allows to \c static_assert the order at compile time, \ref find
+    /// performs a binary search.
+    ///
+    /// \code
+    ///   struct Init { const char * code; const char * name; };
+    ///   constexpr Init init[] = { { "AD", N_("Andorra") }, ... };
+    ///   static_assert( codetable::isSorted( init, &Init::code ), "init[] must be sorted by code" );
+    ///
+    ///   const Init * hit = codetable::find( init, &Init::code, "AD" );
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    namespace codetable
+    {
+      /** \c constexpr \c strcmp (sign only). */
+      constexpr int compare( const char * lhs, const char * rhs )
+      {
+	return( *lhs != *rhs ? ( (unsigned char)*lhs < (unsigned char)*rhs ? -1 : 1 )
+	                     : ( *lhs ? compare( lhs+1, rhs+1 ) : 0 ) );
+      }
+
+      /** Whether <tt>table_r[begin_r,end_r)</tt> is strictly ascending by \a key_r.
+       * Bisects the range to keep the \c constexpr recursion depth low.
+       */
+      template <class Tp>
+      constexpr bool isSorted( const Tp * table_r, const char * const Tp::* key_r, unsigned begin_r, unsigned end_r )
+      {
+	return( end_r - begin_r < 2
+	        || ( isSorted( table_r, key_r, begin_r, begin_r + (end_r-begin_r)/2 )
+	             && isSorted( table_r, key_r, begin_r + (end_r-begin_r)/2, end_r )
+	             && compare( table_r[begin_r + (end_r-begin_r)/2 - 1].*key_r,
+	                         table_r[begin_r + (end_r-begin_r)/2].*key_r ) < 0 ) );
+      }
+
+      /** \overload for the whole array */
+      template <class Tp, unsigned N>
+      constexpr bool isSorted( const Tp (&table_r)[N], const char * const Tp::* key_r )
+      { return isSorted( table_r, key_r, 0, N ); }
+
+      /** Index of the first entry in <tt>table_r[begin_r,end_r)</tt> whose \a key_r is not less than \a code_r.
+       * The range must be sorted by \a key_r.
+       */
+      template <class Tp>
+      constexpr unsigned lowerBound( const Tp * table_r, const char * const Tp::* key_r, const char * code_r, unsigned begin_r, unsigned end_r )
+      {
+	return( begin_r == end_r ? begin_r
+	        : compare( table_r[begin_r + (end_r-begin_r)/2].*key_r, code_r ) < 0
+	          ? lowerBound( table_r, key_r, code_r, begin_r + (end_r-begin_r)/2 + 1, end_r )
+	          : lowerBound( table_r, key_r, code_r, begin_r, begin_r + (end_r-begin_r)/2 ) );
+      }
+
+      /** Index of the entry whose \a key_r equals \a code_r, or \c N if there is none. */
+      template <class Tp, unsigned N>
+      constexpr unsigned indexOf( const Tp (&table_r)[N], const char * const Tp::* key_r, const char * code_r )
+      {
+	return( lowerBound( table_r, key_r, code_r, 0, N ) < N
+	        && compare( table_r[lowerBound( table_r, key_r, code_r, 0, N )].*key_r, code_r ) == 0
+	        ? lowerBound( table_r, key_r, code_r, 0, N ) : N );
+      }
+
+      /** The entry whose \a key_r equals \a code_r, or \c nullptr. */
+      template <class Tp, unsigned N>
+      const Tp * find( const Tp (&table_r)[N], const char * const Tp::* key_r, const char * code_r )
+      {
+	unsigned idx = lowerBound( table_r, key_r, code_r, 0, N );
+	return( idx < N && ::strcmp( table_r[idx].*key_r, code_r ) == 0 ? table_r + idx : nullptr );
+      }
+    } // namespace codetable
+    ///////////////////////////////////////////////////////////////////
+  } // namespace base
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_BASE_CODETABLE_H
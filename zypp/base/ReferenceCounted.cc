@@ -48,7 +48,7 @@ namespace zypp
     std::ostream & ReferenceCounted::dumpOn( std::ostream & str ) const
     {
       return str << "ReferenceCounted(@" << (const void *)this
-                 << "<=" << _counter << ")";
+                 << "<=" << refCount() << ")";
     }
 
     /////////////////////////////////////////////////////////////////
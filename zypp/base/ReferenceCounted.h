@@ -13,6 +13,7 @@
 #define ZYPP_BASE_REFERENCECOUNTED_H
 
 #include <iosfwd>
+#include <atomic>
 
 #include "zypp/base/PtrTypes.h"
 
@@ -28,7 +29,8 @@ namespace zypp
     //	CLASS NAME : ReferenceCounted
     //
     /** Base class for reference counted objects.
-     * \todo Make counter thread safe.
+     * The counter is atomic, so different threads may hold references
+     * to the same object.
     */
     class ReferenceCounted
     {
@@ -74,8 +76,8 @@ namespace zypp
       {
         if ( !_counter )
           unrefException(); // will throw!
-        if ( --_counter )
-          unref_to( _counter );
+        if ( unsigned cnt = --_counter )
+          unref_to( cnt );
         else
           delete this;
       }
@@ -107,7 +109,7 @@ namespace zypp
 
     private:
       /** The reference counter. */
-      mutable unsigned _counter;
+      mutable std::atomic<unsigned> _counter;
 
       /** Throws Exception on unref. */
       void unrefException() const;
@@ -0,0 +1,304 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/base/Trace.cc
+ *
+*/
+extern "C"
+{
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Json.h"
+#include "zypp/base/Trace.h"
+#include "zypp/PathInfo.h"
+
+using std::endl;
+
+#undef ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "Trace"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace debug
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      typedef std::chrono::steady_clock Clock;
+
+      /** A span (\c dur >= 0) or counter update. */
+      struct Event
+      {
+	const char *	name;
+	std::string	detail;
+	long long	ts;	///< us since trace start
+	long long	dur;	///< us, -1 for a counter update
+	long long	value;	///< counters value after the update
+	long		tid;
+      };
+
+      inline long threadId()
+      { return ::syscall( SYS_gettid ); }
+
+      /** The file requested by \c ZYPP_TRACE. */
+      Pathname fileFromEnv()
+      {
+	const char * envp = ::getenv( "ZYPP_TRACE" );
+	if ( ! envp || ! *envp || str::strToFalse( envp ) )
+	  return Pathname();
+	std::string val( envp );
+	if ( val == "json" || str::strToTrue( val ) )
+	  return Pathname( "/var/log/zypp" ) / str::form( "trace-%d.json", int(::getpid()) );
+	if ( val == "prom" )
+	  return Pathname( "/var/log/zypp" ) / str::form( "metrics-%d.prom", int(::getpid()) );
+	return val;
+      }
+
+      /** Prometheus metric names allow just <tt>[a-zA-Z0-9_:]</tt>. */
+      std::string metricName( const std::string & name_r )
+      {
+	std::string ret( name_r );
+	for ( char & ch : ret )
+	{
+	  if ( ! ( ::isalnum( (unsigned char)ch ) || ch == '_' || ch == ':' ) )
+	    ch = '_';
+	}
+	return ret;
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class TraceData
+      /// \brief The data collected; written at exit.
+      ///////////////////////////////////////////////////////////////////
+      struct TraceData
+      {
+	TraceData()
+	: _start( Clock::now() )
+	, _pid( ::getpid() )
+	, _file( fileFromEnv() )
+	, _enabled( ! _file.empty() )
+	{}
+
+	~TraceData()
+	{
+	  // Loggers may already be gone, so quietly.
+	  if ( ! _file.empty() && ! ( _events.empty() && _counters.empty() ) )
+	    writeFile();
+	}
+
+	long long now() const
+	{ return std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - _start ).count(); }
+
+	void add( Event && event_r )
+	{
+	  std::lock_guard<std::mutex> lock( _mutex );
+	  _events.push_back( std::move(event_r) );
+	}
+
+	bool writeFile()
+	{
+	  Pathname file;
+	  {
+	    std::lock_guard<std::mutex> lock( _mutex );
+	    file = _file;
+	  }
+	  if ( file.empty() )
+	    return false;
+	  filesystem::assert_dir( file.dirname() );
+	  std::ofstream out( file.c_str() );
+	  if ( file.extension() == ".json" )
+	    dumpChromeTrace( out );
+	  else
+	    dumpPrometheus( out );
+	  return bool(out);
+	}
+
+	std::ostream & dumpChromeTrace( std::ostream & str )
+	{
+	  std::lock_guard<std::mutex> lock( _mutex );
+	  str << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	  const char * sep = "\n";
+	  for ( const Event & ev : _events )
+	  {
+	    str << sep << "{\"name\":" << json::String( ev.name ).asJSON()
+	        << ",\"cat\":\"zypp\",\"ph\":\"" << ( ev.dur < 0 ? "C" : "X" )
+	        << "\",\"ts\":" << ev.ts;
+	    if ( ev.dur >= 0 )
+	      str << ",\"dur\":" << ev.dur;
+	    str << ",\"pid\":" << _pid << ",\"tid\":" << ev.tid;
+	    if ( ev.dur < 0 )
+	      str << ",\"args\":{\"value\":" << ev.value << "}";
+	    else if ( ! ev.detail.empty() )
+	      str << ",\"args\":{\"detail\":" << json::String( ev.detail ).asJSON() << "}";
+	    str << "}";
+	    sep = ",\n";
+	  }
+	  return str << "\n]}" << endl;
+	}
+
+	std::ostream & dumpPrometheus( std::ostream & str )
+	{
+	  std::lock_guard<std::mutex> lock( _mutex );
+	  std::map<std::string,std::pair<long long,unsigned>> spans;	// name: us, calls
+	  for ( const Event & ev : _events )
+	  {
+	    if ( ev.dur < 0 )
+	      continue;
+	    std::pair<long long,unsigned> & span( spans[ev.name] );
+	    span.first += ev.dur;
+	    span.second += 1;
+	  }
+	  if ( ! spans.empty() )
+	  {
+	    str << "# HELP zypp_span_seconds_total Time spent in a span." << endl;
+	    str << "# TYPE zypp_span_seconds_total counter" << endl;
+	    for ( const auto & span : spans )
+	      str << "zypp_span_seconds_total{span=\"" << span.first << "\"} " << str::form( "%.6f", span.second.first / 1000000.0 ) << endl;
+	    str << "# HELP zypp_span_calls_total Number of times a span was entered." << endl;
+	    str << "# TYPE zypp_span_calls_total counter" << endl;
+	    for ( const auto & span : spans )
+	      str << "zypp_span_calls_total{span=\"" << span.first << "\"} " << span.second.second << endl;
+	  }
+	  for ( const auto & counter : _counters )
+	  {
+	    std::string name( "zypp_" + metricName( counter.first ) + "_total" );
+	    str << "# TYPE " << name << " counter" << endl;
+	    str << name << " " << counter.second << endl;
+	  }
+	  return str;
+	}
+
+	std::mutex				_mutex;
+	const Clock::time_point			_start;
+	const pid_t				_pid;
+	Pathname				_file;
+	std::atomic<bool>			_enabled;
+	std::vector<Event>			_events;
+	std::map<std::string,long long>	_counters;
+      };
+
+      inline TraceData & traceData()
+      {
+	static TraceData _data;
+	return _data;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //	class Trace
+    ///////////////////////////////////////////////////////////////////
+
+    bool Trace::enabled()
+    { return traceData()._enabled; }
+
+    void Trace::enable( const Pathname & file_r )
+    {
+      TraceData & data( traceData() );
+      {
+	std::lock_guard<std::mutex> lock( data._mutex );
+	data._file = file_r;
+      }
+      data._enabled = ! file_r.empty();
+      MIL << ( file_r.empty() ? "Tracing disabled" : "Tracing to " ) << file_r << endl;
+    }
+
+    Pathname Trace::file()
+    {
+      TraceData & data( traceData() );
+      std::lock_guard<std::mutex> lock( data._mutex );
+      return data._file;
+    }
+
+    void Trace::count( const char * name_r, long long value_r )
+    {
+      TraceData & data( traceData() );
+      if ( ! data._enabled )
+	return;
+      long long ts = data.now();
+      std::lock_guard<std::mutex> lock( data._mutex );
+      long long & counter( data._counters[name_r] );
+      counter += value_r;
+      data._events.push_back( Event{ name_r, std::string(), ts, -1, counter, threadId() } );
+    }
+
+    bool Trace::write()
+    {
+      Pathname file( Trace::file() );
+      if ( file.empty() )
+	return false;
+      bool ret = traceData().writeFile();
+      if ( ret )
+	MIL << "Trace written to " << file << endl;
+      else
+	WAR << "Unable to write trace to " << file << endl;
+      return ret;
+    }
+
+    std::ostream & Trace::dumpChromeTrace( std::ostream & str )
+    { return traceData().dumpChromeTrace( str ); }
+
+    std::ostream & Trace::dumpPrometheus( std::ostream & str )
+    { return traceData().dumpPrometheus( str ); }
+
+    void Trace::clear()
+    {
+      TraceData & data( traceData() );
+      std::lock_guard<std::mutex> lock( data._mutex );
+      data._events.clear();
+      data._counters.clear();
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    //	class TraceSpan
+    ///////////////////////////////////////////////////////////////////
+
+    TraceSpan::TraceSpan( const char * name_r )
+    : _name( name_r )
+    , _start( Trace::enabled() ? traceData().now() : -1 )
+    {}
+
+    TraceSpan::TraceSpan( const char * name_r, const std::string & detail_r )
+    : _name( name_r )
+    , _start( Trace::enabled() ? traceData().now() : -1 )
+    {
+      if ( _start >= 0 )
+	_detail = detail_r;
+    }
+
+    TraceSpan::~TraceSpan()
+    {
+      if ( _start < 0 )
+	return;
+      try
+      {
+	TraceData & data( traceData() );
+	long long now = data.now();
+	data.add( Event{ _name, std::move(_detail), _start, now - _start, 0, threadId() } );
+      }
+      catch ( ... )
+      {} // don't let exceptions escape
+    }
+
+  } // namespace debug
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
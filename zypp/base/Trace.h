@@ -0,0 +1,117 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/base/Trace.h
+ *
+*/
+#ifndef ZYPP_BASE_TRACE_H
+#define ZYPP_BASE_TRACE_H
+
+#include <iosfwd>
+#include <string>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace debug
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class Trace
+    /// \brief Collect timed spans and counters in machine readable form.
+    ///
+    /// Unlike \ref Measure, which just logs the times, the data collected
+    /// here are exported to a file when the process exits (or on \ref write):
+    /// \li <tt>*.json</tt>: Chrome trace event format (\c chrome://tracing,
+    ///     \c https://ui.perfetto.dev). Spans are complete events per thread,
+    ///     counters are counter events.
+    /// \li anything else: Prometheus text format. Spans are summarized as
+    ///     \c zypp_span_seconds_total and \c zypp_span_calls_total per span
+    ///     name, counters as \c zypp_<name>_total.
+    ///
+    /// Tracing is compiled in but disabled by default. It is enabled by
+    /// \ref enable or via the environment:
+    /// \code
+    ///   ZYPP_TRACE=1       # /var/log/zypp/trace-<pid>.json
+    ///   ZYPP_TRACE=prom    # /var/log/zypp/metrics-<pid>.prom
+    ///   ZYPP_TRACE=<path>  # format by extension
+    /// \endcode
+    /// While disabled a \ref TraceSpan or \ref count costs just a test of a flag.
+    ///
+    /// Span and counter names are expected to be string literals.
+    ///
+    /// \code
+    ///   {
+    ///     debug::TraceSpan span( "solve" );
+    ///     ...
+    ///   }
+    ///   debug::Trace::count( "download_bytes", size );
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    struct Trace
+    {
+      /** Whether spans and counters are collected. */
+      static bool enabled();
+
+      /** Collect spans and counters and write them to \a file_r.
+       * An empty \a file_r disables tracing (data collected so far are kept).
+       */
+      static void enable( const Pathname & file_r );
+
+      /** The file the data are written to. */
+      static Pathname file();
+
+      /** Add \a value_r to counter \a name_r. */
+      static void count( const char * name_r, long long value_r = 1 );
+
+      /** Write the data collected so far to \ref file.
+       * Also done when the process exits. Returns \c false on error.
+       */
+      static bool write();
+
+      /** Write the data collected in Chrome trace event format to \a str. */
+      static std::ostream & dumpChromeTrace( std::ostream & str );
+
+      /** Write the data collected in Prometheus text format to \a str. */
+      static std::ostream & dumpPrometheus( std::ostream & str );
+
+      /** Forget the data collected so far. */
+      static void clear();
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class TraceSpan
+    /// \brief Record the time spent in a scope as span \a name_r.
+    ///
+    /// An optional \a detail_r (e.g. the repo alias or file name) is
+    /// attached to the span in the Chrome trace. Spans are collected only
+    /// if \ref Trace::enabled at the time the span is created.
+    ///////////////////////////////////////////////////////////////////
+    class TraceSpan : private base::NonCopyable
+    {
+    public:
+      explicit TraceSpan( const char * name_r );
+
+      TraceSpan( const char * name_r, const std::string & detail_r );
+
+      ~TraceSpan();
+
+    private:
+      const char *	_name;
+      std::string	_detail;
+      long long		_start;	///< us since trace start, -1 if disabled
+    };
+
+  } // namespace debug
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_BASE_TRACE_H
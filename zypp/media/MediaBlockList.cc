@@ -11,6 +11,10 @@
  */
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +24,10 @@
 #include <iostream>
 #include <fstream>
 
+#ifdef ZYPP_USE_THREADS
+#include <thread>
+#endif
+
 #include "zypp/media/MediaBlockList.h"
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
@@ -30,6 +38,130 @@ using namespace zypp::base;
 namespace zypp {
   namespace media {
 
+namespace {
+
+  /**
+   * compute the rolling checksum sums of len bytes: a is the plain sum,
+   * b the sum weighted by the distance to the end. Both are accumulated
+   * in 32bit lanes (the compiler vectorizes this loop), only the lower
+   * 16bit are significant.
+   **/
+  inline void rsumSums(const unsigned char *p, size_t len, unsigned int &a, unsigned int &b)
+  {
+    unsigned int s = 0;
+    unsigned int m = 0;
+    for (size_t i = 0; i < len; i++)
+      {
+	s += p[i];
+	m += (unsigned int)(len - i) * p[i];
+      }
+    a = s;
+    b = m;
+  }
+
+  /**
+   * the rolling checksum value stored in the blocklist
+   **/
+  inline unsigned int rsumValue(int rsumlen, unsigned int a, unsigned int b)
+  {
+    if (rsumlen == 1)
+      return b & 255;
+    else if (rsumlen == 2)
+      return b & 65535;
+    else if (rsumlen == 3)
+      return (a & 255) << 16 | (b & 65535);
+    return (a & 65535) << 16 | (b & 65535);
+  }
+
+  /**
+   * the file scanned by reuseBlocks, mapped into memory if possible.
+   * windows reaching beyond the end of the file are padded with zeros.
+   **/
+  class ScanData {
+  public:
+    ScanData(FILE *fp, size_t blksize)
+    : _data(0)
+    , _size(0)
+    , _blksize(blksize)
+    , _mapped(false)
+    , _tailstart(0)
+    {
+      struct stat st;
+      int fd = fileno(fp);
+      if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size)
+	return;
+      _size = st.st_size;
+      void *p = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED)
+	{
+	  madvise(p, _size, MADV_SEQUENTIAL);
+	  _data = (const unsigned char *)p;
+	  _mapped = true;
+	}
+      else
+	{
+	  _read.resize(_size);
+	  size_t l = 0;
+	  while (l < _size)
+	    {
+	      ssize_t r = pread(fd, &_read[l], _size - l, l);
+	      if (r < 0 && errno == EINTR)
+		continue;
+	      if (r <= 0)
+		break;
+	      l += r;
+	    }
+	  _size = l;
+	  _data = _read.empty() ? 0 : &_read[0];
+	}
+      // the last blksize bytes followed by blksize zeros
+      _tailstart = _size > blksize ? _size - blksize : 0;
+      _tail.resize(2 * blksize);
+      if (_size)
+	memcpy(&_tail[0], _data + _tailstart, _size - _tailstart);
+    }
+
+    ~ScanData()
+    {
+      if (_mapped)
+	munmap((void *)_data, _size);
+    }
+
+    size_t size() const
+    { return _size; }
+
+    /** the byte at pos, 0 beyond the end of the file */
+    unsigned char at(size_t pos) const
+    { return pos < _size ? _data[pos] : 0; }
+
+    /** blksize bytes starting at pos */
+    const unsigned char *window(size_t pos) const
+    { return pos + _blksize <= _size ? _data + pos : &_tail[pos - _tailstart]; }
+
+  private:
+    const unsigned char *_data;
+    size_t _size;
+    size_t _blksize;
+    bool _mapped;
+    std::vector<unsigned char> _read;
+    std::vector<unsigned char> _tail;
+    size_t _tailstart;
+  };
+
+  /**
+   * a run of count consecutive blocks, starting with blkno, found at offset pos
+   **/
+  struct BlockRun {
+    size_t pos;
+    size_t blkno;
+    size_t count;
+  };
+
+  /** do not split the scan into segments smaller than this */
+  const size_t minScanSegment = 1024 * 1024;
+
+} // namespace
+
 MediaBlockList::MediaBlockList(off_t size)
 {
   filesize = size;
@@ -137,20 +269,26 @@ MediaBlockList::verifyDigest(size_t blkno, Digest &digest) const
   return memcmp(&dig[0], &chksums[chksumlen * blkno], chksumlen) ? false : true;
 }
 
+std::string
+MediaBlockList::getChecksum(size_t blkno) const
+{
+  if (!haveChecksum(blkno))
+    return std::string();
+  std::string s = chksumtype + ":";
+  for (size_t j = 0; j < size_t(chksumlen); j++)
+    s += zypp::str::form("%02hhx", chksums[blkno * chksumlen + j]);
+  return s;
+}
+
 unsigned int
 MediaBlockList::updateRsum(unsigned int rs, const char* bytes, size_t len) const
 {
   if (!len)
     return rs;
-  unsigned short s, m;
-  s = (rs >> 16) & 65535;
-  m = rs & 65535;
-  for (; len > 0 ; len--)
-    {
-      unsigned short c = (unsigned char)*bytes++;
-      s += c;
-      m += s;
-    }
+  unsigned int s, m;
+  rsumSums((const unsigned char *)bytes, len, s, m);
+  m += (rs & 65535) + len * ((rs >> 16) & 65535);
+  s += (rs >> 16) & 65535;
   return (s & 65535) << 16 | (m & 65535);
 }
 
@@ -174,10 +312,13 @@ MediaBlockList::verifyRsum(size_t blkno, unsigned int rs) const
     {
     case 3:
       rs &= 0xffffff;
+      break;
     case 2:
       rs &= 0xffff;
+      break;
     case 1:
       rs &= 0xff;
+      break;
     default:
       break;
     }
@@ -245,33 +386,6 @@ MediaBlockList::writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, siz
   found[blocks.size()] = true;
 }
 
-static size_t
-fetchnext(FILE *fp, unsigned char *bp, size_t blksize, size_t pushback, unsigned char *pushbackp)
-{
-  size_t l = blksize;
-  int c;
-
-  if (pushback)
-    {
-      if (pushbackp != bp)
-        memmove(bp, pushbackp, pushback);
-      bp += pushback;
-      l -= pushback;
-    }
-  while (l)
-    {
-      c = getc(fp);
-      if (c == EOF)
-        break;
-      *bp++ = c;
-      l--;
-    }
-  if (l)
-    memset(bp, 0, l);
-  return blksize - l;
-}
-
-
 void
 MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 {
@@ -308,121 +422,116 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 	  ht[h] = i + 1;
 	}
 
-      unsigned char *buf = new unsigned char[blksize];
-      unsigned char *buf2 = new unsigned char[blksize];
-      size_t pushback = 0;
-      unsigned char *pushbackp = 0;
       int bshift = 0;
       if ((blksize & (blksize - 1)) == 0)
 	for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
 	  ;
-      unsigned short a, b;
-      a = b = 0;
-      memset(buf, 0, blksize);
-      bool eof = 0;
-      bool init = 1;
       int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
-      while (!eof)
+
+      ScanData data(fp, blksize);
+      // window start positions to check
+      size_t end = data.size();
+      if (sql == 2)
+	end = end >= blksize ? end - blksize + 1 : 0;
+
+      // scan the windows starting in [begin, end), remember the block runs found
+      auto scan = [&](size_t segbegin, size_t segend, vector<BlockRun> &runs)
 	{
-	  for (size_t i = 0; i < blksize; i++)
+	  vector<bool> seen(nblks);
+	  size_t pos = segbegin;
+	  while (pos < segend)
 	    {
-	      int c;
-	      if (eof)
-		c = 0;
-	      else
-		{
-		   if (pushback)
-		    {
-		      c = *pushbackp++;
-		      pushback--;
-		    }
-		  else
-		    c = getc(fp);
-		  if (c == EOF)
-		    {
-		      eof = true;
-		      c = 0;
-		      if (!i || sql == 2)
-			break;
-		    }
-		}
-	      int oc = buf[i];
-	      buf[i] = c;
-	      a += c - oc;
-	      if (bshift)
-		b += a - (oc << bshift);
-	      else
-		b += a - oc * blksize;
-	      if (init)
+	      unsigned int a, b;
+	      rsumSums(data.window(pos), blksize, a, b);
+	      bool matched = false;
+	      for (;;)
 		{
-		  if (size_t(i) != blksize - 1)
-		    continue;
-		  init = 0;
-		}
-	      unsigned int r;
-	      if (rsumlen == 1)
-		r = ((unsigned int)b & 255);
-	      else if (rsumlen == 2)
-		r = ((unsigned int)b & 65535);
-	      else if (rsumlen == 3)
-		r = ((unsigned int)a & 255) << 16 | ((unsigned int)b & 65535);
-	      else
-		r = ((unsigned int)a & 65535) << 16 | ((unsigned int)b & 65535);
-	      unsigned int h = r & hm;
-	      unsigned int hh = 7;
-	      for (; ht[h]; h = (h + hh++) & hm)
-		{
-		  size_t blkno = ht[h] - 1;
-		  if (rsums[blkno] != r)
-		    continue;
-		  if (found[blkno])
-		    continue;
-		  if (sql == 2)
+		  unsigned int r = rsumValue(rsumlen, a, b);
+		  unsigned int h = r & hm;
+		  unsigned int hh = 7;
+		  for (; ht[h]; h = (h + hh++) & hm)
 		    {
-		      if (eof || blkno + 1 >= nblks)
+		      size_t blkno = ht[h] - 1;
+		      if (rsums[blkno] != r)
 			continue;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
+		      if (seen[blkno])
 			continue;
-		      if (!checkRsum(blkno + 1, buf2, blksize))
+		      if (sql == 2)
+			{
+			  if (blkno + 1 >= nblks || pos + blksize >= data.size())
+			    continue;
+			  if (!checkRsum(blkno + 1, data.window(pos + blksize), blksize))
+			    continue;
+			}
+		      if (!checkChecksum(blkno, data.window(pos), blksize))
 			continue;
+		      if (sql == 2 && !checkChecksum(blkno + 1, data.window(pos + blksize), blksize))
+			continue;
+		      BlockRun run = { pos, blkno, size_t(sql) };
+		      // the following blocks are likely to be unchanged, too
+		      while (pos + run.count * blksize < data.size())
+			{
+			  const unsigned char *next = data.window(pos + run.count * blksize);
+			  if (!checkRsum(blkno + run.count, next, blksize))
+			    break;
+			  if (!checkChecksum(blkno + run.count, next, blksize))
+			    break;
+			  run.count++;
+			}
+		      for (size_t i = 0; i < run.count; i++)
+			seen[blkno + i] = true;
+		      runs.push_back(run);
+		      pos += run.count * blksize;
+		      matched = true;
+		      break;
 		    }
-		  if (!checkChecksumRotated(blkno, buf, blksize, i + 1))
-		    continue;
-		  if (sql == 2 && !checkChecksum(blkno + 1, buf2, blksize))
-		    continue;
-		  writeBlock(blkno, wfp, buf, blksize, i + 1, found);
-		  if (sql == 2)
-		    {
-		      writeBlock(blkno + 1, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
-		      blkno++;
-		    }
-		  while (!eof)
-		    {
-		      blkno++;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
-			break;
-		      if (!checkRsum(blkno, buf2, blksize))
-			break;
-		      if (!checkChecksum(blkno, buf2, blksize))
-			break;
-		      writeBlock(blkno, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
-		    }
-		  init = false;
-		  memset(buf, 0, blksize);
-	 	  a = b = 0;
-		  i = size_t(-1);	// start with 0 on next iteration
-		  break;
+		  if (matched || ++pos >= segend)
+		    break;
+		  // roll the window by one byte
+		  unsigned int oc = data.at(pos - 1);
+		  a += data.at(pos - 1 + blksize) - oc;
+		  if (bshift)
+		    b += a - (oc << bshift);
+		  else
+		    b += a - oc * blksize;
 		}
 	    }
+	};
+
+      // split large files into segments scanned in parallel. a segment
+      // includes the windows starting in it, so they overlap by blksize.
+      size_t nsegs = 1;
+#ifdef ZYPP_USE_THREADS
+      nsegs = std::thread::hardware_concurrency();
+      if (nsegs > end / minScanSegment)
+	nsegs = end / minScanSegment;
+      if (!nsegs)
+	nsegs = 1;
+#endif
+      vector<vector<BlockRun> > runs(nsegs);
+      size_t seglen = (end + nsegs - 1) / nsegs;
+      if (nsegs > 1)
+	{
+#ifdef ZYPP_USE_THREADS
+	  // also initializes the digests before any thread is started
+	  Digest probe;
+	  createDigest(probe);
+	  vector<std::thread> workers;
+	  for (size_t i = 0; i < nsegs; i++)
+	    workers.push_back(std::thread(scan, i * seglen, std::min(end, (i + 1) * seglen), std::ref(runs[i])));
+	  for (auto & t : workers)
+	    t.join();
+#endif
 	}
-      delete[] buf2;
-      delete[] buf;
+      else
+	scan(0, end, runs[0]);
+
+      // write the blocks found, the first match wins
+      for (size_t i = 0; i < nsegs; i++)
+	for (const BlockRun & run : runs[i])
+	  for (size_t j = 0; j < run.count; j++)
+	    if (!found[run.blkno + j])
+	      writeBlock(run.blkno + j, wfp, data.window(run.pos + j * blksize), blksize, 0, found);
       delete[] ht;
     }
   else if (chksumlen >= 16)
@@ -458,16 +567,23 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 	  off += blksize;
 	}
     }
+  fclose(fp);
   if (!found[nblks])
     return;
   // now throw out all of the blocks we found
+  removeBlocks(found);
+}
+
+void
+MediaBlockList::removeBlocks(const std::vector<bool> &found)
+{
   std::vector<MediaBlock> nblocks;
   std::vector<unsigned char> nchksums;
   std::vector<unsigned int> nrsums;
 
   for (size_t blkno = 0; blkno < blocks.size(); ++blkno)
     {
-      if (!found[blkno])
+      if (blkno >= found.size() || !found[blkno])
 	{
 	  // still need it
 	  nblocks.push_back(blocks[blkno]);
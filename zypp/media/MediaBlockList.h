@@ -93,6 +93,10 @@ public:
   bool checkChecksum(size_t blkno, const unsigned char *buf, size_t bufl) const;
   bool createDigest(Digest &digest) const;
   bool verifyDigest(size_t blkno, Digest &digest) const;
+  /**
+   * return the checksum of block blkno as "type:hexdigits" (empty if none)
+   **/
+  std::string getChecksum(size_t blkno) const;
   inline bool haveChecksum(size_t blkno) const {
     return chksumlen && chksums.size() >= chksumlen * (blkno + 1);
   }
@@ -110,10 +114,16 @@ public:
 
   /**
    * scan a file for blocks from our blocklist. if we find a suitable block,
-   * it is removed from the list
+   * it is removed from the list. the file is mapped into memory; large
+   * files are scanned in parallel segments if built with threads.
    **/
   void reuseBlocks(FILE *wfp, std::string filename);
 
+  /**
+   * remove the blocks with found[blkno] set from the list
+   **/
+  void removeBlocks(const std::vector<bool> &found);
+
   /**
    * return block list as string
    **/
@@ -12,12 +12,15 @@
 
 #include <iostream>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 #include "zypp/base/Logger.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Sysconfig.h"
+#include "zypp/base/Trace.h"
 #include "zypp/base/Gettext.h"
 
 #include "zypp/media/MediaCurl.h"
@@ -25,6 +28,7 @@
 #include "zypp/media/MediaUserAuth.h"
 #include "zypp/media/CredentialManager.h"
 #include "zypp/media/CurlConfig.h"
+#include "zypp/media/PartFile.h"
 #include "zypp/thread/Once.h"
 #include "zypp/Target.h"
 #include "zypp/ZYppFactory.h"
@@ -194,6 +198,153 @@ namespace zypp {
 
     ///////////////////////////////////////////////////////////////////
 
+    /** CURLOPT_WRITEDATA for \ref writeCallback. */
+    struct WriteData
+    {
+      WriteData( FILE * file_r, FileDigestCache::Builder * digests_r, PartFile * part_r = 0 )
+        : file( file_r )
+        , digests( digests_r )
+        , part( part_r )
+        , resumed( false )
+        , started( false )
+        , changed( false )
+      {}
+      FILE                     *file;
+      FileDigestCache::Builder *digests;
+      PartFile                 *part;		///< resumable download to record
+      bool                      resumed;	///< continuing a \ref PartFile
+      bool                      started;	///< data arrived
+      bool                      changed;	///< the file changed since the \ref PartFile was started
+      std::string               etag;		///< validators sent by the server
+      std::string               lastModified;
+    };
+
+    /** Whether the validators sent by the server differ from the ones recorded in \a part_r. */
+    inline bool validatorsChanged( const PartFile & part_r, const WriteData & data_r )
+    {
+      if ( ! part_r.etag().empty() && ! data_r.etag.empty() )
+        return part_r.etag() != data_r.etag;
+      if ( ! part_r.lastModified().empty() && ! data_r.lastModified.empty() )
+        return part_r.lastModified() != data_r.lastModified;
+      return false;
+    }
+
+    /** Whether the data in \a part_r can be continued.
+     * Only if the server is asked to send the remainder just for an unchanged
+     * file (\c If-Range). Otherwise a file changed on the server would be
+     * spliced onto the old data, unnoticed unless a checksum is verified.
+     */
+    inline bool canResume( const PartFile & part_r )
+    {
+      if ( ! part_r.resumeOffset() )
+        return true;	// nothing to continue
+      if ( ! part_r.ifRange().empty() && part_r.url().getScheme() != "ftp" )
+        return true;
+      MIL << "No validator for " << part_r << ", not resumed." << endl;
+      return false;
+    }
+
+    /** CURLOPT_WRITEFUNCTION writing to file and feeding the digests on the fly. */
+    size_t writeCallback( char *ptr, size_t size, size_t nmemb, void *userdata )
+    {
+      WriteData *data = reinterpret_cast<WriteData *>( userdata );
+      if ( data->part && ! data->started )
+      {
+        data->started = true;
+        if ( data->resumed && validatorsChanged( *data->part, *data ) )
+        {
+          // server ignored If-Range; abort and restart from scratch
+          data->changed = true;
+          return 0;
+        }
+        // ranges are recorded when interrupted; until then the data files size counts
+        data->part->setValidators( data->etag, data->lastModified );
+        data->part->clearRanges();
+        data->part->save();
+      }
+      size_t cnt = ::fwrite( ptr, 1, size * nmemb, data->file );
+      if ( cnt && data->digests )
+        data->digests->update( ptr, cnt );
+      return cnt;
+    }
+
+    /** CURLOPT_HEADERFUNCTION remembering the validators of a download into a \ref PartFile. */
+    size_t partHeaderCallback( char *ptr, size_t size, size_t nmemb, void *userdata )
+    {
+      WriteData *data = reinterpret_cast<WriteData *>( userdata );
+      std::string line( ptr, size * nmemb );
+      if ( str::startsWith( line, "HTTP/" ) )
+      {
+        // new response (e.g. after redirect)
+        data->etag.clear();
+        data->lastModified.clear();
+      }
+      else
+      {
+        std::string::size_type sep = line.find( ':' );
+        if ( sep != std::string::npos )
+        {
+          std::string name( str::toLower( line.substr( 0, sep ) ) );
+          if ( name == "etag" )
+            data->etag = str::trim( line.substr( sep + 1 ) );
+          else if ( name == "last-modified" )
+            data->lastModified = str::trim( line.substr( sep + 1 ) );
+        }
+      }
+      return size * nmemb;
+    }
+
+    /** Continue writing \a file_r at \a offset_r, feeding the data already there into \a digests_r. */
+    bool resumeAt( FILE * file_r, off_t offset_r, FileDigestCache::Builder & digests_r )
+    {
+      if ( ::ftruncate( ::fileno( file_r ), offset_r ) != 0 )
+        return false;
+      std::vector<char> buf( 65536 );
+      for ( off_t left = offset_r; left; )
+      {
+        size_t l = ::fread( &buf[0], 1, std::min( off_t(buf.size()), left ), file_r );
+        if ( ! l )
+          return false;
+        digests_r.update( &buf[0], l );
+        left -= l;
+      }
+      return ::fseeko( file_r, offset_r, SEEK_SET ) == 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+
+    /** CURLOPT_HEADERFUNCTION remembering the validators of a \ref MediaCurl::ConditionalRequest. */
+    size_t conditionalHeaderCallback( char *ptr, size_t size, size_t nmemb, void *userdata )
+    {
+      MediaCurl::ConditionalRequest *req = reinterpret_cast<MediaCurl::ConditionalRequest *>( userdata );
+      std::string line( ptr, size * nmemb );
+      if ( str::startsWith( line, "HTTP/" ) )
+      {
+        // new response (e.g. after redirect)
+        req->newEtag.clear();
+        req->newLastModified.clear();
+      }
+      else
+      {
+        std::string::size_type sep = line.find( ':' );
+        if ( sep != std::string::npos )
+        {
+          std::string name( str::toLower( line.substr( 0, sep ) ) );
+          if ( name == "etag" )
+            req->newEtag = str::trim( line.substr( sep + 1 ) );
+          else if ( name == "last-modified" )
+            req->newLastModified = str::trim( line.substr( sep + 1 ) );
+        }
+      }
+      return size * nmemb;
+    }
+
+    /** CURLOPT_WRITEFUNCTION aborting the transfer as soon as the body arrives. */
+    size_t discardBodyCallback( char *ptr, size_t size, size_t nmemb, void *userdata )
+    { return 0; }
+
+    ///////////////////////////////////////////////////////////////////
+
     inline void escape( string & str_r,
                         const char char_r, const string & escaped_r ) {
       for ( string::size_type pos = str_r.find( char_r );
@@ -847,6 +998,129 @@ void MediaCurl::disconnectFrom()
 
 ///////////////////////////////////////////////////////////////////
 
+void MediaCurl::checkModified( std::vector<ConditionalRequest> & requests_r )
+{
+  if ( requests_r.empty() )
+    return;
+
+  globalInitOnce();
+  CURLM *multi = curl_multi_init();
+  if ( !multi )
+    ZYPP_THROW(MediaCurlInitException(requests_r.front().url));
+
+  std::vector<shared_ptr<MediaCurl> > handlers;
+  handlers.reserve( requests_r.size() );
+  for ( ConditionalRequest & req : requests_r )
+  {
+    req.httpCode = 0;
+    req.newEtag.clear();
+    req.newLastModified.clear();
+    req.error.clear();
+    try
+    {
+      shared_ptr<MediaCurl> handler( new MediaCurl( req.url, Pathname() ) );
+      handler->checkProtocol( req.url );
+      handler->_curl = curl_easy_init();
+      if ( !handler->_curl )
+        ZYPP_THROW(MediaCurlInitException(req.url));
+      handler->setupEasy();
+
+      CURL *curl = handler->_curl;
+      if ( ! req.etag.empty() )
+        handler->_customHeaders = curl_slist_append( handler->_customHeaders, ( "If-None-Match: " + req.etag ).c_str() );
+      if ( ! req.lastModified.empty() )
+        handler->_customHeaders = curl_slist_append( handler->_customHeaders, ( "If-Modified-Since: " + req.lastModified ).c_str() );
+      curl_easy_setopt( curl, CURLOPT_HTTPHEADER, handler->_customHeaders );
+
+      Url url( handler->clearQueryString( handler->getFileUrl( req.file ) ) );
+      curl_easy_setopt( curl, CURLOPT_URL, url.asString().c_str() );
+      curl_easy_setopt( curl, CURLOPT_HEADERFUNCTION, &conditionalHeaderCallback );
+      curl_easy_setopt( curl, CURLOPT_HEADERDATA, &req );
+      curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, &discardBodyCallback );
+      curl_easy_setopt( curl, CURLOPT_WRITEDATA, NULL );
+      curl_easy_setopt( curl, CURLOPT_NOPROGRESS, 1L );
+      curl_easy_setopt( curl, CURLOPT_PRIVATE, &req );
+      // There is no progress callback enforcing the timeout here; abort stalled
+      // requests instead of limiting the total transfer time.
+      if ( handler->_settings.timeout() && ! handler->_settings.minDownloadSpeed() )
+      {
+        curl_easy_setopt( curl, CURLOPT_LOW_SPEED_LIMIT, 1L );
+        curl_easy_setopt( curl, CURLOPT_LOW_SPEED_TIME, handler->_settings.timeout() );
+      }
+
+      if ( curl_multi_add_handle( multi, curl ) != CURLM_OK )
+        ZYPP_THROW(MediaCurlInitException(req.url));
+      handlers.push_back( handler );
+    }
+    catch ( const MediaException & excpt )
+    {
+      ZYPP_CAUGHT( excpt );
+      req.error = excpt.asString();
+    }
+  }
+
+  int running = 0;
+  do
+  {
+    CURLMcode mcode;
+    do {
+      mcode = curl_multi_perform( multi, &running );
+    } while ( mcode == CURLM_CALL_MULTI_PERFORM );
+    if ( mcode != CURLM_OK || !running )
+      break;
+
+    fd_set rset, wset, xset;
+    int maxfd = -1;
+    FD_ZERO(&rset);
+    FD_ZERO(&wset);
+    FD_ZERO(&xset);
+    curl_multi_fdset( multi, &rset, &wset, &xset, &maxfd );
+
+    long timeout = -1;
+    curl_multi_timeout( multi, &timeout );
+    if ( timeout < 0 || timeout > 200 )
+      timeout = 200;
+    timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = timeout * 1000;
+    if ( select( maxfd + 1, &rset, &wset, &xset, &tv ) == -1 && errno != EINTR )
+      break;
+  } while ( running );
+
+  CURLMsg *msg;
+  int nqueue;
+  while ( ( msg = curl_multi_info_read( multi, &nqueue ) ) != 0 )
+  {
+    if ( msg->msg != CURLMSG_DONE )
+      continue;
+    ConditionalRequest *req = 0;
+    curl_easy_getinfo( msg->easy_handle, CURLINFO_PRIVATE, &req );
+    if ( !req )
+      continue;
+
+    long httpCode = 0;
+    curl_easy_getinfo( msg->easy_handle, CURLINFO_RESPONSE_CODE, &httpCode );
+    // CURLE_WRITE_ERROR: body discarded on purpose
+    if ( msg->data.result == CURLE_OK || ( msg->data.result == CURLE_WRITE_ERROR && httpCode == 200 ) )
+      req->httpCode = httpCode;
+    else
+      req->error = curl_easy_strerror( msg->data.result );
+  }
+
+  for ( const shared_ptr<MediaCurl> & handler : handlers )
+  {
+    ConditionalRequest *req = 0;
+    curl_easy_getinfo( handler->_curl, CURLINFO_PRIVATE, &req );
+    if ( req && !req->httpCode && req->error.empty() )
+      req->error = "Request did not complete";
+    curl_multi_remove_handle( multi, handler->_curl );
+    handler->disconnectFrom();
+  }
+  curl_multi_cleanup( multi );
+}
+
+///////////////////////////////////////////////////////////////////
+
 void MediaCurl::releaseFrom( const std::string & ejectDev )
 {
   disconnect();
@@ -879,6 +1153,7 @@ void MediaCurl::getFile( const Pathname & filename ) const
 
 void MediaCurl::getFileCopy( const Pathname & filename , const Pathname & target) const
 {
+  debug::TraceSpan span( "download", filename.asString() );
   callback::SendReport<DownloadProgressReport> report;
 
   Url fileurl(getFileUrl(filename));
@@ -913,6 +1188,11 @@ void MediaCurl::getFileCopy( const Pathname & filename , const Pathname & target
   }
   while (retry);
 
+  if ( debug::Trace::enabled() )
+  {
+    debug::Trace::count( "download_files" );
+    debug::Trace::count( "download_bytes", PathInfo( target ).size() );
+  }
   report->finish(fileurl, zypp::media::DownloadProgressReport::NO_ERROR, "");
 }
 
@@ -1281,38 +1561,71 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
       Url url(getFileUrl(filename));
       ZYPP_THROW( MediaSystemException(url, "System error on " + dest.dirname().asString()) );
     }
-    string destNew = target.asString() + ".new.zypp.XXXXXX";
-    char *buf = ::strdup( destNew.c_str());
-    if( !buf)
+
+    // resumable downloads are kept in a PartFile until complete
+    PartFile part( clearQueryString( getFileUrl( filename ) ), PartFile::dirFor( dest ) );
+    bool keepPart = PartFile::resumable( part.url() ) && part.lock() && ( ( part.load() && ! part.metalink() && canResume( part ) ) || part.reset() );
+    off_t resumeFrom = 0;
+    FileDigestCache::Builder digests;
+
+    string destNew;
+    FILE *file = 0;
+    if ( keepPart )
     {
-      ERR << "out of memory for temp file name" << endl;
-      Url url(getFileUrl(filename));
-      ZYPP_THROW(MediaSystemException(url, "out of memory for temp file name"));
+      destNew = part.path().asString();
+      resumeFrom = part.resumeOffset();
+      file = ::fopen( destNew.c_str(), resumeFrom ? "r+e" : "w+e" );
+      if ( file && resumeFrom && ! resumeAt( file, resumeFrom, digests ) )
+      {
+        WAR << "Can't resume " << part << endl;
+        ::fclose( file );
+        resumeFrom = 0;
+        digests.reset();
+        file = ::fopen( destNew.c_str(), "w+e" );
+      }
+      if ( !file ) {
+        part.remove();
+        ERR << "fopen failed for file '" << destNew << "'" << endl;
+        ZYPP_THROW(MediaWriteException(destNew));
+      }
+      if ( resumeFrom )
+        MIL << "Resume " << part << endl;
     }
-
-    int tmp_fd = ::mkostemp( buf, O_CLOEXEC );
-    if( tmp_fd == -1)
+    else
     {
+      destNew = target.asString() + ".new.zypp.XXXXXX";
+      char *buf = ::strdup( destNew.c_str());
+      if( !buf)
+      {
+        ERR << "out of memory for temp file name" << endl;
+        Url url(getFileUrl(filename));
+        ZYPP_THROW(MediaSystemException(url, "out of memory for temp file name"));
+      }
+
+      int tmp_fd = ::mkostemp( buf, O_CLOEXEC );
+      if( tmp_fd == -1)
+      {
+        free( buf);
+        ERR << "mkstemp failed for file '" << destNew << "'" << endl;
+        ZYPP_THROW(MediaWriteException(destNew));
+      }
+      destNew = buf;
       free( buf);
-      ERR << "mkstemp failed for file '" << destNew << "'" << endl;
-      ZYPP_THROW(MediaWriteException(destNew));
-    }
-    destNew = buf;
-    free( buf);
 
-    FILE *file = ::fdopen( tmp_fd, "we" );
-    if ( !file ) {
-      ::close( tmp_fd);
-      filesystem::unlink( destNew );
-      ERR << "fopen failed for file '" << destNew << "'" << endl;
-      ZYPP_THROW(MediaWriteException(destNew));
+      file = ::fdopen( tmp_fd, "we" );
+      if ( !file ) {
+        ::close( tmp_fd);
+        filesystem::unlink( destNew );
+        ERR << "fopen failed for file '" << destNew << "'" << endl;
+        ZYPP_THROW(MediaWriteException(destNew));
+      }
     }
 
     DBG << "dest: " << dest << endl;
     DBG << "temp: " << destNew << endl;
 
     // set IFMODSINCE time condition (no download if not modified)
-    if( PathInfo(target).isExist() && !(options & OPTION_NO_IFMODSINCE) )
+    if( PathInfo(target).isExist() && !(options & OPTION_NO_IFMODSINCE) && !resumeFrom )
     {
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_IFMODSINCE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, (long)PathInfo(target).mtime());
@@ -1324,12 +1637,25 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
     }
     try
     {
-      doGetFileCopyFile(filename, dest, file, report, options);
+      doGetFileCopyFile(filename, dest, file, report, options, &digests, keepPart ? &part : 0);
     }
     catch (Exception &e)
     {
-      ::fclose( file );
-      filesystem::unlink( destNew );
+      if ( keepPart && ::fflush( file ) == 0 && ::ftello( file ) > 0 )
+      {
+        // keep what we got for the next attempt
+        part.addRange( 0, ::ftello( file ) );
+        part.save();
+        ::fclose( file );
+        MIL << "Keep " << part << endl;
+      }
+      else
+      {
+        ::fclose( file );
+        filesystem::unlink( destNew );
+        if ( keepPart )
+          part.remove();
+      }
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
       ZYPP_RETHROW(e);
@@ -1366,19 +1692,25 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
       if (::fclose( file ))
       {
         ERR << "Fclose failed for file '" << destNew << "'" << endl;
+        if ( keepPart )
+          part.remove();
         ZYPP_THROW(MediaWriteException(destNew));
       }
       // move the temp file into dest
-      if ( rename( destNew, dest ) != 0 ) {
+      if ( ( keepPart ? part.commit( dest ) : rename( destNew, dest ) ) != 0 ) {
         ERR << "Rename failed" << endl;
         ZYPP_THROW(MediaWriteException(dest));
       }
+      // checksums computed while downloading; spares FileCheckers to reread the file
+      digests.commit( dest );
     }
     else
     {
       // close and remove the temp file
       ::fclose( file );
       filesystem::unlink( destNew );
+      if ( keepPart )
+        part.remove();
     }
 
     DBG << "done: " << PathInfo(dest) << endl;
@@ -1386,7 +1718,7 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
 
 ///////////////////////////////////////////////////////////////////
 
-void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
+void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options, FileDigestCache::Builder * digests, PartFile * part ) const
 {
     DBG << filename.asString() << endl;
 
@@ -1420,7 +1752,58 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
 
-    ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    WriteData writeData( file, digests, part );
+    off_t resumeFrom = 0;
+    curl_slist *partHeaders = 0;
+    // On any return or exception: no curl option may point to the stack
+    // (writeData, progressData) or keep the settings for this download.
+    shared_ptr<void> resetCurlOptions( static_cast<void*>(0), [&]( void* ) {
+      if ( curl_easy_setopt( _curl, CURLOPT_PROGRESSDATA, NULL ) != 0 ) {
+        WAR << "Can't unset CURLOPT_PROGRESSDATA: " << _curlError << endl;;
+      }
+      if ( digests || part )
+      {
+        // back to curls default fwrite
+        curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, NULL );
+        curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+      }
+      if ( part )
+      {
+        curl_easy_setopt( _curl, CURLOPT_RESUME_FROM_LARGE, curl_off_t(0) );
+        curl_easy_setopt( _curl, CURLOPT_HEADERFUNCTION, log_redirects_curl );
+        curl_easy_setopt( _curl, CURLOPT_HEADERDATA, NULL );
+        if ( partHeaders )
+        {
+          curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, _customHeaders );
+          curl_slist_free_all( partHeaders );
+        }
+      }
+    } );
+    if ( part )
+    {
+      // continue at the end of file, if the servers file is still the same
+      resumeFrom = ::ftello( file );
+      writeData.resumed = resumeFrom > 0;
+      curl_easy_setopt( _curl, CURLOPT_RESUME_FROM_LARGE, curl_off_t(resumeFrom) );
+      std::string ifRange( part->ifRange() );
+      if ( resumeFrom && ! ifRange.empty() && url.getScheme() != "ftp" )
+      {
+        for ( curl_slist *h = _customHeaders; h; h = h->next )
+          partHeaders = curl_slist_append( partHeaders, h->data );
+        partHeaders = curl_slist_append( partHeaders, ( "If-Range: " + ifRange ).c_str() );
+        curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, partHeaders );
+      }
+      curl_easy_setopt( _curl, CURLOPT_HEADERFUNCTION, &partHeaderCallback );
+      curl_easy_setopt( _curl, CURLOPT_HEADERDATA, &writeData );
+    }
+    if ( digests || part )
+    {
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, &writeCallback );
+      if ( ret == 0 )
+        ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, &writeData );
+    }
+    else
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
     if ( ret != 0 ) {
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
@@ -1434,6 +1817,27 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
     }
 
     ret = curl_easy_perform( _curl );
+    if ( resumeFrom )
+    {
+      long httpReturnCode = 0;
+      curl_easy_getinfo( _curl, CURLINFO_RESPONSE_CODE, &httpReturnCode );
+      if ( writeData.changed || ret == CURLE_RANGE_ERROR || httpReturnCode == 416 )
+      {
+        // file changed on the server or range not supported
+        WAR << "Can't resume " << url << " at " << resumeFrom << " (" << ret << "/" << httpReturnCode << "), restart." << endl;
+        ::fflush( file );
+        if ( ::ftruncate( ::fileno( file ), 0 ) != 0 || ::fseeko( file, 0, SEEK_SET ) != 0 )
+          ZYPP_THROW(MediaWriteException(dest));
+        if ( digests )
+          digests->reset();
+        part->setValidators( std::string(), std::string() );
+        part->clearRanges();
+        writeData.resumed = writeData.started = writeData.changed = false;
+        curl_easy_setopt( _curl, CURLOPT_RESUME_FROM_LARGE, curl_off_t(0) );
+        curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, _customHeaders );
+        ret = curl_easy_perform( _curl );
+      }
+    }
 #if CURLVERSION_AT_LEAST(7,19,4)
     // bnc#692260: If the client sends a request with an If-Modified-Since header
     // with a future date for the server, the server may respond 200 sending a
@@ -1456,9 +1860,7 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
     }
 #endif
 
-    if ( curl_easy_setopt( _curl, CURLOPT_PROGRESSDATA, NULL ) != 0 ) {
-      WAR << "Can't unset CURLOPT_PROGRESSDATA: " << _curlError << endl;;
-    }
+    resetCurlOptions.reset();
 
     if ( ret != 0 )
     {
@@ -16,12 +16,15 @@
 #include "zypp/media/TransferSettings.h"
 #include "zypp/media/MediaHandler.h"
 #include "zypp/ZYppCallbacks.h"
+#include "zypp/FileDigestCache.h"
 
 #include <curl/curl.h>
 
 namespace zypp {
   namespace media {
 
+class PartFile;
+
 ///////////////////////////////////////////////////////////////////
 //
 //	CLASS NAME : MediaCurl
@@ -105,6 +108,32 @@ class MediaCurl : public MediaHandler
 
     static void setCookieFile( const Pathname & );
 
+    /** A conditional GET request for \ref checkModified. */
+    struct ConditionalRequest
+    {
+      ConditionalRequest( const Url & url_r, const Pathname & file_r )
+      : url( url_r ), file( file_r ), httpCode( 0 )
+      {}
+
+      Url         url;			///< base url
+      Pathname    file;			///< file to check, relative to \c url
+      std::string etag;			///< send \c If-None-Match if not empty
+      std::string lastModified;		///< send \c If-Modified-Since if not empty
+
+      long        httpCode;		///< response code, \c 304 if not modified, \c 0 on error
+      std::string newEtag;		///< \c ETag sent by the server
+      std::string newLastModified;	///< \c Last-Modified sent by the server
+      std::string error;		///< error message if the request failed
+    };
+
+    /** Send all \a requests_r concurrently over one curl multi handle.
+     * Each request uses the same settings as a \ref MediaCurl for its
+     * \c url would. The response bodies are not downloaded. Failing
+     * requests just remember their error. No authentication is
+     * performed, so protected urls will report \c 401.
+     */
+    static void checkModified( std::vector<ConditionalRequest> & requests_r );
+
     class Callbacks
     {
       public:
@@ -148,7 +177,16 @@ class MediaCurl : public MediaHandler
      */
     void evaluateCurlCode( const zypp::Pathname &filename, CURLcode code, bool timeout ) const;
 
-    void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
+    /**
+     * Download \a srcFilename into the open \a file.
+     * If \a digests is not \c NULL, all data written to \a file are
+     * fed into \a digests too.
+     * If \a part is not \c NULL, \a file is its data file and the download
+     * continues at the current position of \a file (\c Range, \c If-Range).
+     * If this is not possible, \a file is truncated and the download starts
+     * from scratch. The state of \a part is saved as soon as data arrive.
+     */
+    void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE, FileDigestCache::Builder * digests = 0, PartFile * part = 0 ) const;
 
   private:
     /**
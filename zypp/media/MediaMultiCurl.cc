@@ -26,6 +26,7 @@
 #include "zypp/base/Logger.h"
 #include "zypp/media/MediaMultiCurl.h"
 #include "zypp/media/MetaLinkParser.h"
+#include "zypp/media/PartFile.h"
 
 using namespace std;
 using namespace zypp::base;
@@ -1290,31 +1291,65 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
     Url url(getFileUrl(filename));
     ZYPP_THROW( MediaSystemException(url, "System error on " + dest.dirname().asString()) );
   }
-  string destNew = target.asString() + ".new.zypp.XXXXXX";
-  char *buf = ::strdup( destNew.c_str());
-  if( !buf)
+
+  // An interrupted plain download is simply continued. For an interrupted
+  // metalink download the metalink is fetched again and the blocks recorded
+  // in the PartFile are reused.
+  PartFile part( clearQueryString( getFileUrl( filename ) ), PartFile::dirFor( dest ) );
+  bool keepPart = PartFile::resumable( part.url() ) && part.lock();
+  if ( keepPart && part.load() && ! part.metalink() )
   {
-    ERR << "out of memory for temp file name" << endl;
-    Url url(getFileUrl(filename));
-    ZYPP_THROW(MediaSystemException(url, "out of memory for temp file name"));
+    part.unlock();	// taken again by MediaCurl
+    curl_easy_setopt(_curl, CURLOPT_PROGRESSFUNCTION, &MediaCurl::progressCallback);
+    MediaCurl::doGetFileCopy( filename, target, report, options );
+    return;
   }
-
-  int tmp_fd = ::mkostemp( buf, O_CLOEXEC );
-  if( tmp_fd == -1)
+  bool resumeMetalink = keepPart && part.metalink();
+  if ( keepPart && ! resumeMetalink )
+    keepPart = part.reset();
+  // the request may as well return the file itself
+  bool probeToPart = keepPart && ! resumeMetalink;
+
+  string destNew;
+  FILE *file = 0;
+  if ( probeToPart )
   {
-    free( buf);
-    ERR << "mkstemp failed for file '" << destNew << "'" << endl;
-    ZYPP_THROW(MediaWriteException(destNew));
+    destNew = part.path().asString();
+    file = ::fopen( destNew.c_str(), "w+e" );
+    if ( !file ) {
+      part.remove();
+      ERR << "fopen failed for file '" << destNew << "'" << endl;
+      ZYPP_THROW(MediaWriteException(destNew));
+    }
   }
-  destNew = buf;
-  free( buf);
-
-  FILE *file = ::fdopen( tmp_fd, "we" );
-  if ( !file ) {
-    ::close( tmp_fd);
-    filesystem::unlink( destNew );
-    ERR << "fopen failed for file '" << destNew << "'" << endl;
-    ZYPP_THROW(MediaWriteException(destNew));
+  else
+  {
+    destNew = target.asString() + ".new.zypp.XXXXXX";
+    char *buf = ::strdup( destNew.c_str());
+    if( !buf)
+    {
+      ERR << "out of memory for temp file name" << endl;
+      Url url(getFileUrl(filename));
+      ZYPP_THROW(MediaSystemException(url, "out of memory for temp file name"));
+    }
+
+    int tmp_fd = ::mkostemp( buf, O_CLOEXEC );
+    if( tmp_fd == -1)
+    {
+      free( buf);
+      ERR << "mkstemp failed for file '" << destNew << "'" << endl;
+      ZYPP_THROW(MediaWriteException(destNew));
+    }
+    destNew = buf;
+    free( buf);
+
+    file = ::fdopen( tmp_fd, "we" );
+    if ( !file ) {
+      ::close( tmp_fd);
+      filesystem::unlink( destNew );
+      ERR << "fopen failed for file '" << destNew << "'" << endl;
+      ZYPP_THROW(MediaWriteException(destNew));
+    }
   }
   DBG << "dest: " << dest << endl;
   DBG << "temp: " << destNew << endl;
@@ -1335,14 +1370,28 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
   // change to our own progress funcion
   curl_easy_setopt(_curl, CURLOPT_PROGRESSFUNCTION, &progressCallback);
   curl_easy_setopt(_curl, CURLOPT_PRIVATE, file);
+  FileDigestCache::Builder digests;
   try
     {
-      MediaCurl::doGetFileCopyFile(filename, dest, file, report, options);
+      MediaCurl::doGetFileCopyFile(filename, dest, file, report, options, &digests, probeToPart ? &part : 0);
     }
   catch (Exception &ex)
     {
-      ::fclose(file);
-      filesystem::unlink(destNew);
+      if ( probeToPart && ::fflush( file ) == 0 && ::ftello( file ) > 0 )
+	{
+	  // keep what we got for the next attempt
+	  part.addRange( 0, ::ftello( file ) );
+	  part.save();
+	  ::fclose( file );
+	  MIL << "Keep " << part << endl;
+	}
+      else
+	{
+	  ::fclose( file );
+	  filesystem::unlink( destNew );
+	  if ( probeToPart )
+	    part.remove();
+	}
       curl_easy_setopt(_curl, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE);
       curl_easy_setopt(_curl, CURLOPT_TIMEVALUE, 0L);
       curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _customHeaders);
@@ -1362,6 +1411,10 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	 || ( httpReturnCode == 213 && _url.getScheme() == "ftp" ) ) // not modified
     {
       DBG << "not modified: " << PathInfo(dest) << endl;
+      ::fclose(file);
+      filesystem::unlink(destNew);
+      if ( keepPart )
+	part.remove();
       return;
     }
   }
@@ -1394,7 +1447,9 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
       bool userabort = false;
       fclose(file);
       file = NULL;
+      digests.reset();	// we got the metalink, not the file
       Pathname failedFile = ZConfig::instance().repoCachePath() / "MultiCurl.failed";
+      MediaBlockList fullbl;	// as in the metalink, to record the blocks present on failure
       try
 	{
 	  MetaLinkParser mlp;
@@ -1402,9 +1457,33 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	  MediaBlockList bl = mlp.getBlockList();
 	  vector<Url> urls = mlp.getUrls();
 	  XXX << bl << endl;
-	  file = fopen(destNew.c_str(), "w+e");
-	  if (!file)
-	    ZYPP_THROW(MediaWriteException(destNew));
+	  if (keepPart)
+	    {
+	      // download the blocks into the PartFile
+	      if (!probeToPart)
+		filesystem::unlink(destNew);
+	      destNew = part.path().asString();
+	      file = fopen(destNew.c_str(), resumeMetalink ? "r+e" : "w+e");
+	      if (!file)
+		ZYPP_THROW(MediaWriteException(destNew));
+	      part.setMetalink(true);
+	      fullbl = bl;
+	      if (resumeMetalink)
+		{
+		  if (part.blocks().empty())
+		    part.recordBlocks(bl, file);	// no record written (crashed)
+		  MIL << "Resume " << part << ": reusing " << part.reuseBlocks(bl) << " blocks" << endl;
+		}
+	      part.save();
+	      if (bl.haveFilesize() && ::ftruncate(::fileno(file), bl.getFilesize()) != 0)
+		WAR << "Can't truncate " << destNew << " to " << bl.getFilesize() << endl;
+	    }
+	  else
+	    {
+	      file = fopen(destNew.c_str(), "w+e");
+	      if (!file)
+		ZYPP_THROW(MediaWriteException(destNew));
+	    }
 	  if (PathInfo(target).isExist())
 	    {
 	      XXX << "reusing blocks from file " << target << endl;
@@ -1427,7 +1506,7 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	    }
 	  try
 	    {
-	      multifetch(filename, file, &urls, &report, &bl);
+	      multifetch(filename, file, &urls, &report, &bl, off_t(-1), &digests);
 	    }
 	  catch (MediaCurlException &ex)
 	    {
@@ -1439,7 +1518,16 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	{
 	  // something went wrong. fall back to normal download
 	  if (file)
-	    fclose(file);
+	    {
+	      if (keepPart && fullbl.numBlocks())
+		{
+		  // remember the blocks we got for the next attempt
+		  part.recordBlocks(fullbl, file);
+		  part.save();
+		  MIL << "Keep " << part << endl;
+		}
+	      fclose(file);
+	    }
 	  file = NULL;
 	  if (PathInfo(destNew).size() >= 63336)
 	    {
@@ -1448,15 +1536,58 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	    }
 	  if (userabort)
 	    {
-	      filesystem::unlink(destNew);
+	      if (!keepPart)
+		filesystem::unlink(destNew);
 	      ZYPP_RETHROW(ex);
 	    }
+	  if (keepPart)
+	    {
+	      if (destNew != part.path().asString())
+		{
+		  filesystem::unlink(destNew);	// the metalink
+		  destNew = part.path().asString();
+		}
+	      keepPart = part.reset();
+	    }
+	  // don't truncate the data just linked to failedFile
+	  filesystem::unlink(destNew);
 	  file = fopen(destNew.c_str(), "w+e");
 	  if (!file)
-	    ZYPP_THROW(MediaWriteException(destNew));
-	  MediaCurl::doGetFileCopyFile(filename, dest, file, report, options | OPTION_NO_REPORT_START);
+	    {
+	      if (keepPart)
+		part.remove();
+	      ZYPP_THROW(MediaWriteException(destNew));
+	    }
+	  digests.reset();
+	  try
+	    {
+	      MediaCurl::doGetFileCopyFile(filename, dest, file, report, options | OPTION_NO_REPORT_START, &digests, keepPart ? &part : 0);
+	    }
+	  catch (Exception &ex2)
+	    {
+	      if ( keepPart && ::fflush( file ) == 0 && ::ftello( file ) > 0 )
+		{
+		  part.addRange( 0, ::ftello( file ) );
+		  part.save();
+		  MIL << "Keep " << part << endl;
+		}
+	      else
+		{
+		  filesystem::unlink( destNew );
+		  if ( keepPart )
+		    part.remove();
+		}
+	      ::fclose( file );
+	      ZYPP_RETHROW(ex2);
+	    }
 	}
     }
+  else if (resumeMetalink)
+    {
+      // the server sent the file itself this time
+      part.remove();
+      keepPart = false;
+    }
 
   if (::fchmod( ::fileno(file), filesystem::applyUmaskTo( 0644 )))
     {
@@ -1465,18 +1596,21 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
   if (::fclose(file))
     {
       filesystem::unlink(destNew);
+      if ( keepPart )
+	part.remove();
       ERR << "Fclose failed for file '" << destNew << "'" << endl;
       ZYPP_THROW(MediaWriteException(destNew));
     }
-  if ( rename( destNew, dest ) != 0 )
+  if ( ( destNew == part.path().asString() ? part.commit( dest ) : rename( destNew, dest ) ) != 0 )
     {
       ERR << "Rename failed" << endl;
       ZYPP_THROW(MediaWriteException(dest));
     }
+  digests.commit(dest);
   DBG << "done: " << PathInfo(dest) << endl;
 }
 
-void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report, MediaBlockList *blklist, off_t filesize) const
+void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report, MediaBlockList *blklist, off_t filesize, FileDigestCache::Builder *digests) const
 {
   Url baseurl(getFileUrl(filename));
   if (blklist && filesize == off_t(-1) && blklist->haveFilesize())
@@ -1485,7 +1619,7 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     blklist = 0;
   if (blklist && (filesize == 0 || !blklist->numBlocks()))
     {
-      checkFileDigest(baseurl, fp, blklist);
+      checkFileDigest(baseurl, fp, blklist, digests);
       return;
     }
   if (filesize == 0)
@@ -1524,22 +1658,33 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
   if (!myurllist.size())
     myurllist.push_back(baseurl);
   req.run(myurllist);
-  checkFileDigest(baseurl, fp, blklist);
+  checkFileDigest(baseurl, fp, blklist, digests);
 }
 
-void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist) const
+void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist, FileDigestCache::Builder *digests) const
 {
-  if (!blklist || !blklist->haveFileChecksum())
+  // blocks arrive out of order, so the digests are computed
+  // in the same pass that verifies the metalink file checksum
+  bool verify = blklist && blklist->haveFileChecksum();
+  if (!verify && !digests)
     return;
   if (fseeko(fp, off_t(0), SEEK_SET))
     ZYPP_THROW(MediaCurlException(url, "fseeko", "seek error"));
   Digest dig;
-  blklist->createFileDigest(dig);
-  char buf[4096];
+  if (verify)
+    blklist->createFileDigest(dig);
+  if (digests)
+    digests->reset();
+  char buf[65536];
   size_t l;
   while ((l = fread(buf, 1, sizeof(buf), fp)) > 0)
-    dig.update(buf, l);
-  if (!blklist->verifyFileDigest(dig))
+    {
+      if (verify)
+        dig.update(buf, l);
+      if (digests)
+        digests->update(buf, l);
+    }
+  if (verify && !blklist->verifyFileDigest(dig))
     ZYPP_THROW(MediaCurlException(url, "file verification failed", "checksum error"));
 }
 
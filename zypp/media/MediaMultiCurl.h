@@ -47,7 +47,7 @@ public:
 
   virtual void doGetFileCopy( const Pathname & srcFilename, const Pathname & targetFilename, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
 
-  void multifetch(const Pathname &filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report = 0, MediaBlockList *blklist = 0, off_t filesize = off_t(-1)) const;
+  void multifetch(const Pathname &filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report = 0, MediaBlockList *blklist = 0, off_t filesize = off_t(-1), FileDigestCache::Builder *digests = 0) const;
 
 protected:
 
@@ -58,7 +58,7 @@ protected:
   void toEasyPool(const std::string &host, CURL *easy) const;
 
   virtual void setupEasy();
-  void checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist) const;
+  void checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist, FileDigestCache::Builder *digests = 0) const;
   static int progressCallback( void *clientp, double dltotal, double dlnow, double ultotal, double ulnow );
 
 private:
@@ -0,0 +1,420 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/PartFile.cc
+ *
+*/
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
+#include "zypp/PathInfo.h"
+#include "zypp/Digest.h"
+#include "zypp/ZConfig.h"
+
+#include "zypp/media/PartFile.h"
+#include "zypp/media/MediaBlockList.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Partial downloads not touched for a week are dropped. */
+      const time_t staleAge = 7 * 24 * 60 * 60;
+
+      /** Read \a size_r bytes at \a off_r. */
+      bool readAt( int fd_r, char * buf_r, size_t size_r, off_t off_r )
+      {
+	while ( size_r )
+	{
+	  ssize_t r = ::pread( fd_r, buf_r, size_r, off_r );
+	  if ( r < 0 && errno == EINTR )
+	    continue;
+	  if ( r <= 0 )
+	    return false;
+	  buf_r += r;
+	  size_r -= r;
+	  off_r += r;
+	}
+	return true;
+      }
+
+      /** Open and exclusively lock \a lockPath_r (created if missing).
+       * Returns the locked fd, or \c -1 if the lock is held by someone else
+       * or the file can't be created.
+       */
+      int tryLock( const Pathname & lockPath_r )
+      {
+	while ( true )
+	{
+	  int fd = ::open( lockPath_r.c_str(), O_RDWR|O_CREAT|O_CLOEXEC, 0644 );
+	  if ( fd < 0 )
+	    return -1;
+	  if ( ::flock( fd, LOCK_EX|LOCK_NB ) != 0 )
+	  {
+	    ::close( fd );
+	    return -1;
+	  }
+	  // The previous owner may have removed the file after we opened it.
+	  // Then the lock is worthless and we retry with the new file.
+	  struct stat fst;
+	  struct stat st;
+	  if ( ::fstat( fd, &fst ) == 0 && ::stat( lockPath_r.c_str(), &st ) == 0
+	       && fst.st_dev == st.st_dev && fst.st_ino == st.st_ino )
+	    return fd;
+	  ::close( fd );
+	}
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    Pathname PartFile::defaultDir()
+    { return ZConfig::instance().repoCachePath() / "partial"; }
+
+    Pathname PartFile::dirFor( const Pathname & dest_r )
+    {
+      dev_t dev = PathInfo( dest_r.dirname() ).dev();
+      Pathname candidates[] = { defaultDir(), ZConfig::instance().download_mediaMountdir() / "partial" };
+      for ( const Pathname & dir : candidates )
+      {
+	// the parent directory must exist, the partial dir is created on demand
+	PathInfo pi( PathInfo( dir ).isExist() ? dir : dir.dirname() );
+	if ( pi.isDir() && pi.dev() == dev )
+	  return dir;
+      }
+      DBG << "No partial download dir on the filesystem of " << dest_r << endl;
+      return defaultDir();
+    }
+
+    bool PartFile::resumable( const Url & url_r )
+    {
+      const std::string & scheme( url_r.getScheme() );
+      return scheme == "http" || scheme == "https" || scheme == "ftp";
+    }
+
+    unsigned PartFile::removeStale( const Pathname & dir_r, time_t maxAge_r )
+    {
+      unsigned removed = 0;
+      time_t now = ::time( 0 );
+      filesystem::dirForEach( dir_r, [&]( const Pathname & dir, const char *const name_r )->bool
+      {
+	if ( ! str::hasSuffix( name_r, ".part" ) )
+	  return true;
+	Pathname data( dir / name_r );
+	Pathname state( data.extend( ".state" ) );
+	time_t mtime = std::max( PathInfo( data ).mtime(), PathInfo( state ).mtime() );
+	if ( now - mtime > maxAge_r )
+	{
+	  Pathname lockPath( data.extend( ".lock" ) );
+	  int fd = tryLock( lockPath );
+	  if ( fd < 0 )
+	    return true;	// in use
+	  filesystem::unlink( state );
+	  if ( filesystem::unlink( data ) == 0 )
+	    ++removed;
+	  filesystem::unlink( lockPath );
+	  ::close( fd );
+	}
+	return true;
+      } );
+      if ( removed )
+	MIL << "Removed " << removed << " stale partial downloads in " << dir_r << endl;
+      return removed;
+    }
+
+    PartFile::PartFile( const Url & url_r, const Pathname & dir_r )
+    : _url( url_r )
+    , _lockFd( -1 )
+    , _metalink( false )
+    {
+      std::string key( Digest::digest( "sha1", _url.asString() ) );
+      _path = dir_r / ( key + ".part" );
+      _statePath = _path.extend( ".state" );
+      _lockPath = _path.extend( ".lock" );
+    }
+
+    PartFile::~PartFile()
+    { unlock(); }
+
+    bool PartFile::lock()
+    {
+      if ( locked() )
+	return true;
+      if ( filesystem::assert_dir( _path.dirname() ) != 0 )
+	return false;
+      _lockFd = tryLock( _lockPath );
+      if ( ! locked() )
+      {
+	MIL << "Partial download " << _path << " is in use, not resumable." << endl;
+	return false;
+      }
+      return true;
+    }
+
+    void PartFile::unlock()
+    {
+      if ( ! locked() )
+	return;
+      // removed while locked, so no one else may use the file meanwhile
+      if ( ! PathInfo( _path ).isExist() )
+	filesystem::unlink( _lockPath );
+      ::close( _lockFd );
+      _lockFd = -1;
+    }
+
+    bool PartFile::load()
+    {
+      _metalink = false;
+      _etag.clear();
+      _lastModified.clear();
+      _ranges.clear();
+      _blocks.clear();
+
+      if ( ! PathInfo( _statePath ).isFile() || ! PathInfo( _path ).isFile() )
+      {
+	remove();
+	return false;
+      }
+
+      std::string url;
+      iostr::forEachLine( InputStream( _statePath ), [&]( int, std::string line_r )->bool
+      {
+	std::string::size_type sep = line_r.find( ' ' );
+	std::string key( line_r.substr( 0, sep ) );
+	std::string value( sep == std::string::npos ? std::string() : line_r.substr( sep + 1 ) );
+	if ( key == "url" )
+	  url = value;
+	else if ( key == "metalink" )
+	  _metalink = true;
+	else if ( key == "etag" )
+	  _etag = value;
+	else if ( key == "lastmodified" )
+	  _lastModified = value;
+	else if ( key == "range" || key == "block" )
+	{
+	  std::vector<std::string> words;
+	  str::split( value, std::back_inserter( words ) );
+	  if ( key == "range" && words.size() == 2 )
+	    addRange( str::strtonum<off_t>( words[0] ), str::strtonum<off_t>( words[1] ) );
+	  else if ( key == "block" && words.size() == 3 )
+	    _blocks.push_back( Block( str::strtonum<off_t>( words[0] ), str::strtonum<size_t>( words[1] ), words[2] ) );
+	}
+	return true;
+      } );
+
+      if ( url != _url.asString() )
+      {
+	WAR << "Drop partial download " << _path << " of " << url << " (expected " << _url << ")" << endl;
+	remove();
+	return false;
+      }
+      MIL << "Found " << *this << endl;
+      return true;
+    }
+
+    bool PartFile::reset()
+    {
+      remove();
+      _metalink = false;
+      _etag.clear();
+      _lastModified.clear();
+      _ranges.clear();
+      _blocks.clear();
+
+      Pathname dir( _path.dirname() );
+      if ( filesystem::assert_dir( dir ) != 0 || ::access( dir.c_str(), W_OK ) != 0 )
+      {
+	DBG << "Can't keep partial downloads in " << dir << endl;
+	return false;
+      }
+      static bool staleRemoved = false;
+      if ( ! staleRemoved )
+      {
+	staleRemoved = true;
+	removeStale( dir, staleAge );
+      }
+      return true;
+    }
+
+    bool PartFile::save() const
+    {
+      Pathname tmp( _statePath.extend( ".new" ) );
+      {
+	std::ofstream out( tmp.c_str() );
+	out << "url " << _url.asString() << endl;
+	if ( _metalink )
+	  out << "metalink" << endl;
+	if ( ! _etag.empty() )
+	  out << "etag " << _etag << endl;
+	if ( ! _lastModified.empty() )
+	  out << "lastmodified " << _lastModified << endl;
+	for ( const Range & range : _ranges )
+	  out << "range " << range.first << " " << range.second << endl;
+	for ( const Block & block : _blocks )
+	  out << "block " << block.off << " " << block.size << " " << block.checksum << endl;
+	if ( ! out )
+	{
+	  ERR << "Can't write " << tmp << endl;
+	  filesystem::unlink( tmp );
+	  return false;
+	}
+      }
+      if ( filesystem::rename( tmp, _statePath ) != 0 )
+      {
+	filesystem::unlink( tmp );
+	return false;
+      }
+      return true;
+    }
+
+    void PartFile::remove( bool keepData_r ) const
+    {
+      filesystem::unlink( _statePath );
+      if ( ! keepData_r )
+	filesystem::unlink( _path );
+    }
+
+    int PartFile::commit( const Pathname & dest_r ) const
+    {
+      int ret = filesystem::rename( _path, dest_r );
+      if ( ret == EXDEV )
+	ret = filesystem::copy( _path, dest_r );
+      remove();
+      return ret;
+    }
+
+    std::string PartFile::ifRange() const
+    {
+      if ( ! _etag.empty() && ! str::startsWith( _etag, "W/" ) )
+	return _etag;
+      return _lastModified;
+    }
+
+    void PartFile::addRange( off_t begin_r, off_t end_r )
+    {
+      if ( begin_r >= end_r )
+	return;
+      std::vector<Range> ranges;
+      ranges.reserve( _ranges.size() + 1 );
+      for ( const Range & range : _ranges )
+      {
+	if ( range.second < begin_r || range.first > end_r )
+	  ranges.push_back( range );
+	else
+	{
+	  // overlapping or adjacent: merge
+	  begin_r = std::min( begin_r, range.first );
+	  end_r = std::max( end_r, range.second );
+	}
+      }
+      ranges.push_back( Range( begin_r, end_r ) );
+      std::sort( ranges.begin(), ranges.end() );
+      _ranges.swap( ranges );
+    }
+
+    off_t PartFile::resumeOffset() const
+    {
+      off_t size = PathInfo( _path ).size();
+      if ( _ranges.empty() )
+	return size;
+      if ( _ranges.front().first != 0 )
+	return 0;
+      return std::min( _ranges.front().second, size );
+    }
+
+    size_t PartFile::recordBlocks( const MediaBlockList & bl_r, FILE * fp_r )
+    {
+      if ( ::fflush( fp_r ) != 0 )
+	return 0;
+      int fd = ::fileno( fp_r );
+      struct stat st;
+      if ( ::fstat( fd, &st ) != 0 )
+	return 0;
+
+      std::vector<Block> blocks;
+      std::vector<char> buf;
+      std::vector<Block>::const_iterator recorded( _blocks.begin() );
+      for ( size_t blkno = 0; blkno < bl_r.numBlocks(); ++blkno )
+      {
+	MediaBlock blk( bl_r.getBlock( blkno ) );
+	if ( ! blk.size || blk.off + off_t(blk.size) > st.st_size || ! bl_r.haveChecksum( blkno ) )
+	  continue;
+	std::string checksum( bl_r.getChecksum( blkno ) );
+
+	while ( recorded != _blocks.end() && recorded->off < blk.off )
+	  ++recorded;
+	if ( recorded != _blocks.end() && recorded->off == blk.off && recorded->size == blk.size && recorded->checksum == checksum )
+	{
+	  blocks.push_back( *recorded );	// verified before
+	  continue;
+	}
+
+	buf.resize( blk.size );
+	if ( readAt( fd, &buf[0], blk.size, blk.off )
+	     && bl_r.checkChecksum( blkno, (const unsigned char *)&buf[0], blk.size ) )
+	  blocks.push_back( Block( blk.off, blk.size, checksum ) );
+      }
+      _blocks.swap( blocks );
+      DBG << _blocks.size() << "/" << bl_r.numBlocks() << " blocks present in " << _path << endl;
+      return _blocks.size();
+    }
+
+    size_t PartFile::reuseBlocks( MediaBlockList & bl_r ) const
+    {
+      size_t nblks = bl_r.numBlocks();
+      std::vector<bool> found( nblks );
+      size_t cnt = 0;
+      std::vector<Block>::const_iterator recorded( _blocks.begin() );
+      for ( size_t blkno = 0; blkno < nblks && recorded != _blocks.end(); ++blkno )
+      {
+	MediaBlock blk( bl_r.getBlock( blkno ) );
+	while ( recorded != _blocks.end() && recorded->off < blk.off )
+	  ++recorded;
+	if ( recorded != _blocks.end() && recorded->off == blk.off && recorded->size == blk.size
+	     && recorded->checksum == bl_r.getChecksum( blkno ) )
+	{
+	  found[blkno] = true;
+	  ++cnt;
+	}
+      }
+      if ( cnt )
+	bl_r.removeBlocks( found );
+      return cnt;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PartFile & obj )
+    {
+      str << "PartFile(" << obj.path() << " " << obj.url();
+      if ( obj.metalink() )
+	str << " " << obj.blocks().size() << " blocks";
+      else
+	str << " from " << obj.resumeOffset();
+      return str << ")";
+    }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,235 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/PartFile.h
+ *
+*/
+#ifndef ZYPP_MEDIA_PARTFILE_H
+#define ZYPP_MEDIA_PARTFILE_H
+
+#include <stdio.h>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/Url.h"
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    class MediaBlockList;
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class PartFile
+    /// \brief Persistent state of an interrupted download.
+    ///
+    /// The data received from an url are kept in a <tt>.part</tt> file below
+    /// \ref defaultDir, named after the urls checksum. Next to it a
+    /// <tt>.part.state</tt> file records what is needed to continue the
+    /// download in a later attempt or a later run:
+    /// \li the url,
+    /// \li the validators (\c ETag, \c Last-Modified) sent by the server,
+    ///     so \c Range requests can be guarded by \c If-Range,
+    /// \li the byte ranges known to be received,
+    /// \li for files downloaded blockwise via a metalink, the blocks found
+    ///     intact in the partial file together with their checksum.
+    ///
+    /// The state is written as soon as data arrive and again if the transfer
+    /// is interrupted. Without recorded ranges (e.g. the process crashed) a
+    /// sequential download continues at the end of the data written.
+    ///
+    /// Data taken from a partial file are not trusted otherwise: the completed
+    /// file is validated like any other download (\ref FileChecker).
+    ///
+    /// Processes downloading the same url share the partial download. Only
+    /// the one holding the \ref lock may touch it; the others download to a
+    /// private temp file as before.
+    ///////////////////////////////////////////////////////////////////
+    class PartFile : private base::NonCopyable
+    {
+    public:
+      /** Bytes \c [first,second) received. */
+      typedef std::pair<off_t,off_t> Range;
+
+      /** A block found intact in the partial file. */
+      struct Block
+      {
+	Block( off_t off_r, size_t size_r, const std::string & checksum_r )
+	: off( off_r ), size( size_r ), checksum( checksum_r )
+	{}
+	off_t       off;
+	size_t      size;
+	std::string checksum;	///< as \ref MediaBlockList::getChecksum
+      };
+
+      /** Directory below \ref ZConfig::repoCachePath holding the partial downloads. */
+      static Pathname defaultDir();
+
+      /** Directory holding the partial downloads completed to \a dest_r.
+       * The first of \ref defaultDir and \c partial below
+       * \ref ZConfig::download_mediaMountdir which is on the same filesystem
+       * as \a dest_r, so \ref commit just renames the file. If there is none,
+       * \ref defaultDir (the completed file is copied).
+       */
+      static Pathname dirFor( const Pathname & dest_r );
+
+      /** Whether downloads from \a url_r can be continued (\c http, \c https, \c ftp). */
+      static bool resumable( const Url & url_r );
+
+      /** Remove partial downloads in \a dir_r not touched for \a maxAge_r seconds.
+       * Downloads currently locked are kept. Returns the number of downloads removed.
+       */
+      static unsigned removeStale( const Pathname & dir_r, time_t maxAge_r );
+
+      /** The partial download of \a url_r in \a dir_r. */
+      explicit PartFile( const Url & url_r, const Pathname & dir_r = defaultDir() );
+
+      /** Dtor releases the \ref lock. */
+      ~PartFile();
+
+    public:
+      /** The url downloaded. */
+      const Url & url() const
+      { return _url; }
+
+      /** The file holding the data received. */
+      const Pathname & path() const
+      { return _path; }
+
+      /** The file holding the state. */
+      const Pathname & statePath() const
+      { return _statePath; }
+
+      /** The file locked while the partial download is in use. */
+      const Pathname & lockPath() const
+      { return _lockPath; }
+
+      /** Take the exclusive lock on the partial download (creating the directory).
+       * Returns \c false if it is in use by another process (or another
+       * \c PartFile), or the directory is not writable. The partial download
+       * must not be touched then.
+       */
+      bool lock();
+
+      /** Release the \ref lock (done by the dtor).
+       * The lock file is removed if no data file is left.
+       */
+      void unlock();
+
+      /** Whether we hold the \ref lock. */
+      bool locked() const
+      { return _lockFd >= 0; }
+
+      /** Read the state left by a previous attempt.
+       * Returns \c false if there is none or it is not usable. Unusable
+       * leftovers are removed.
+       */
+      bool load();
+
+      /** Start from scratch.
+       * Removes any data and state left and creates the directory.
+       * Returns \c false if the directory is not writable, so the
+       * download can't be made resumable.
+       */
+      bool reset();
+
+      /** Write the state (atomically). */
+      bool save() const;
+
+      /** Remove the state and (unless \a keepData_r) the data file. */
+      void remove( bool keepData_r = false ) const;
+
+      /** Move the completed data file to \a dest_r and remove the state.
+       * Across filesystems the file is copied; \ref dirFor avoids this.
+       * Returns \c 0 on success, otherwise an \c errno and the partial download is removed.
+       */
+      int commit( const Pathname & dest_r ) const;
+
+    public:
+      /** Whether the file is downloaded blockwise via a metalink. */
+      bool metalink() const
+      { return _metalink; }
+
+      void setMetalink( bool yesno_r )
+      { _metalink = yesno_r; }
+
+      /** \c ETag sent by the server. */
+      const std::string & etag() const
+      { return _etag; }
+
+      /** \c Last-Modified sent by the server. */
+      const std::string & lastModified() const
+      { return _lastModified; }
+
+      void setValidators( const std::string & etag_r, const std::string & lastModified_r )
+      { _etag = etag_r; _lastModified = lastModified_r; }
+
+      /** Value for an \c If-Range header: a strong \c ETag or \c Last-Modified (empty if none). */
+      std::string ifRange() const;
+
+    public:
+      /** The ranges received (ordered, not overlapping). */
+      const std::vector<Range> & ranges() const
+      { return _ranges; }
+
+      /** Remember \c [begin_r,end_r) as received. */
+      void addRange( off_t begin_r, off_t end_r );
+
+      /** Forget the ranges received (the data files size is used instead). */
+      void clearRanges()
+      { _ranges.clear(); }
+
+      /** Where a sequential download continues.
+       * The end of the range starting at \c 0, or the size of the data
+       * file if no ranges are recorded.
+       */
+      off_t resumeOffset() const;
+
+    public:
+      /** The blocks recorded to be intact in the partial file. */
+      const std::vector<Block> & blocks() const
+      { return _blocks; }
+
+      /** Record the blocks of \a bl_r present at their offset in \a fp_r.
+       * Blocks already recorded with the same checksum are not read again.
+       * Returns the number of blocks recorded.
+       */
+      size_t recordBlocks( const MediaBlockList & bl_r, FILE * fp_r );
+
+      /** Remove the blocks recorded as present (same offset, size and checksum) from \a bl_r.
+       * Returns the number of blocks removed.
+       */
+      size_t reuseBlocks( MediaBlockList & bl_r ) const;
+
+    private:
+      Url                _url;
+      Pathname           _path;
+      Pathname           _statePath;
+      Pathname           _lockPath;
+      int                _lockFd;
+      bool               _metalink;
+      std::string        _etag;
+      std::string        _lastModified;
+      std::vector<Range> _ranges;
+      std::vector<Block> _blocks;
+    };
+
+    /** \relates PartFile Stream output */
+    std::ostream & operator<<( std::ostream & str, const PartFile & obj );
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_PARTFILE_H
@@ -0,0 +1,159 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/PeerCache.cc
+ *
+*/
+#include <cctype>
+#include <iostream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+
+#include "zypp/media/PeerCache.h"
+#include "zypp/media/MediaManager.h"
+#include "zypp/media/MediaException.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PeerCache::Impl
+    /// \brief PeerCache implementation.
+    ///////////////////////////////////////////////////////////////////
+    class PeerCache::Impl : private base::NonCopyable
+    {
+    public:
+      explicit Impl( const Url & url_r )
+      : _url( url_r )
+      , _media( 0 )
+      , _failures( 0 )
+      {}
+
+      ~Impl()
+      {
+	if ( _media )
+	{
+	  try { MediaManager().close( _media ); }
+	  catch ( const Exception & excpt ) { ZYPP_CAUGHT( excpt ); }
+	}
+      }
+
+      bool enabled() const
+      { return _url.isValid() && _failures < maxFailures; }
+
+      bool provide( const CheckSum & checksum_r, const Pathname & dest_r )
+      {
+	if ( ! enabled() || checksum_r.empty() )
+	  return false;
+
+	std::string sum( str::toLower( checksum_r.checksum() ) );
+	for ( char ch : sum )
+	{
+	  if ( ! ::isxdigit( (unsigned char)ch ) )
+	    return false;
+	}
+	Pathname file( Pathname( "/" ) / checksum_r.type() / sum );
+
+	MediaManager mgr;
+	try
+	{
+	  if ( ! _media )
+	    _media = mgr.open( _url );
+	  if ( ! mgr.isAttached( _media ) )
+	    mgr.attach( _media );
+	  mgr.provideFile( _media, file );
+	}
+	catch ( const MediaFileNotFoundException & excpt )
+	{
+	  ZYPP_CAUGHT( excpt );
+	  _failures = 0;	// reachable, but does not have it
+	  DBG << "Not in " << _url << ": " << file << endl;
+	  return false;
+	}
+	catch ( const Exception & excpt )
+	{
+	  ZYPP_CAUGHT( excpt );
+	  if ( ++_failures == maxFailures )
+	    WAR << "Disable unreachable peer cache " << _url << endl;
+	  return false;
+	}
+	_failures = 0;
+
+	bool ret = false;
+	Pathname local( mgr.localPath( _media, file ) );
+	if ( ! filesystem::is_checksum( local, checksum_r ) )
+	{
+	  WAR << "Ignore " << _url << file << ": checksum mismatch" << endl;
+	}
+	else if ( filesystem::assert_dir( dest_r.dirname() ) == 0
+		  // a downloaded copy may be moved, a shared directory must be kept
+		  && ( ( mgr.downloads( _media ) && filesystem::rename( local, dest_r ) == 0 )
+		       || filesystem::copy( local, dest_r ) == 0 ) )
+	{
+	  MIL << "Provided " << dest_r << " from peer cache " << _url << endl;
+	  ret = true;
+	}
+
+	try { mgr.releaseFile( _media, file ); }
+	catch ( const Exception & excpt ) { ZYPP_CAUGHT( excpt ); }
+	return ret;
+      }
+
+    public:
+      Url		_url;
+      MediaAccessId	_media;
+      unsigned		_failures;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    // class PeerCache
+    ///////////////////////////////////////////////////////////////////
+
+    PeerCache & PeerCache::instance()
+    {
+      static PeerCache _instance( (Url()) );
+      const Url & url( ZConfig::instance().download_peer_cache() );
+      if ( url != _instance.url() )	// (re)configured
+      {
+	MIL << "Using peer cache " << url << endl;
+	_instance._pimpl.reset( new Impl( url ) );
+      }
+      return _instance;
+    }
+
+    PeerCache::PeerCache( const Url & url_r )
+    : _pimpl( new Impl( url_r ) )
+    {}
+
+    PeerCache::~PeerCache()
+    {}
+
+    const Url & PeerCache::url() const
+    { return _pimpl->_url; }
+
+    bool PeerCache::enabled() const
+    { return _pimpl->enabled(); }
+
+    bool PeerCache::provide( const CheckSum & checksum_r, const Pathname & dest_r )
+    { return _pimpl->provide( checksum_r, dest_r ); }
+
+    std::ostream & operator<<( std::ostream & str, const PeerCache & obj )
+    { return str << "PeerCache(" << obj.url() << ( obj.enabled() ? ")" : " disabled)" ); }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
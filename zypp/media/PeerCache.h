@@ -0,0 +1,84 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/PeerCache.h
+ *
+*/
+#ifndef ZYPP_MEDIA_PEERCACHE_H
+#define ZYPP_MEDIA_PEERCACHE_H
+
+#include <iosfwd>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Url.h"
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PeerCache
+    /// \brief Local cache asked for files before the repos mirror.
+    ///
+    /// A peer cache is e.g. a caching HTTP proxy or a directory shared by
+    /// the hosts on a subnet. Files are requested by the checksum the repo
+    /// metadata provide for them as <tt>url/<type>/<checksum></tt> and are
+    /// accepted only if they match this checksum. \ref MediaSetAccess asks
+    /// the configured cache (\ref ZConfig::download_peer_cache) before
+    /// downloading a file with known checksum from the repos media.
+    ///
+    /// If the cache can not be reached several times in a row, it is
+    /// disabled for the rest of the process lifetime, so an unreachable
+    /// cache does not delay every download.
+    ///////////////////////////////////////////////////////////////////
+    class PeerCache : private base::NonCopyable
+    {
+    public:
+      /** Number of consecutive failures to reach the cache disabling it. */
+      static const unsigned maxFailures = 3;
+
+      /** The cache configured in \ref ZConfig::download_peer_cache. */
+      static PeerCache & instance();
+
+      /** A cache located at \a url_r (an empty Url disables it). */
+      explicit PeerCache( const Url & url_r );
+
+      ~PeerCache();
+
+    public:
+      /** The caches base Url. */
+      const Url & url() const;
+
+      /** Whether the cache is configured and was not disabled due to failures. */
+      bool enabled() const;
+
+      /** Provide the file matching \a checksum_r from the cache as \a dest_r.
+       * Returns \c false if the cache does not have (a valid copy of) the file
+       * or is not reachable. \a dest_r is not touched in this case.
+       */
+      bool provide( const CheckSum & checksum_r, const Pathname & dest_r );
+
+    public:
+      class Impl;              ///< Implementation class.
+    private:
+      RW_pointer<Impl> _pimpl; ///< Pointer to implementation.
+    };
+
+    /** \relates PeerCache Stream output */
+    std::ostream & operator<<( std::ostream & str, const PeerCache & obj );
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_PEERCACHE_H
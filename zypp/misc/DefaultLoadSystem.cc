@@ -21,6 +21,7 @@
 #include "zypp/Target.h"
 #include "zypp/RepoManager.h"
 #include "zypp/sat/Pool.h"
+#include "zypp/sat/PoolSnapshot.h"
 
 using std::endl;
 
@@ -34,6 +35,19 @@ namespace zypp
   namespace misc
   { /////////////////////////////////////////////////////////////////
 
+    namespace
+    {
+      /** The \ref sat::PoolSnapshot stamp for \a repos_r (in this order). */
+      std::string snapshotStamp( RepoManager & repoManager_r, const RepoInfoList & repos_r )
+      {
+        str::Str stamp;
+        stamp << "rpmdb " << Date::ValueType( getZYpp()->target()->timestamp() ) << endl;
+        for_( it, repos_r.begin(), repos_r.end() )
+          stamp << it->alias() << " " << repoManager_r.cacheStatus( *it ) << endl;
+        return stamp;
+      }
+    } // namespace
+
     void defaultLoadSystem( const Pathname & sysRoot_r, LoadSystemFlags flags_r )
     {
       MIL << str::form( "*** Load system at '%s' (%lx)", sysRoot_r.c_str(), (unsigned long)flags_r ) << endl;
@@ -59,8 +73,17 @@ namespace zypp
 
       if ( 1 )
       {
-        RepoManager repoManager( sysRoot_r );
+        RepoManagerOptions repoOptions( sysRoot_r );
+        RepoManager repoManager( repoOptions );
         RepoInfoList repos = repoManager.knownRepositories();
+
+        // check all repos at once
+        std::map<std::string,RepoManager::RefreshCheckStatus> refreshCheck;
+        if ( ! flags_r.testFlag( LS_NOREFRESH ) )
+          refreshCheck = repoManager.checkIfToRefreshMetadata( repos );
+
+        // refresh and build the caches first...
+        RepoInfoList enabledRepos;
         for_( it, repos.begin(), repos.end() )
         {
           RepoInfo & nrepo( *it );
@@ -70,9 +93,17 @@ namespace zypp
 
           if ( ! flags_r.testFlag( LS_NOREFRESH ) )
           {
-            if ( repoManager.isCached( nrepo )
-               && ( nrepo.type() == repo::RepoType::RPMPLAINDIR // refreshes always
-                  || repoManager.checkIfToRefreshMetadata( nrepo, nrepo.url() ) == RepoManager::REFRESH_NEEDED ) )
+            bool refresh = ( nrepo.type() == repo::RepoType::RPMPLAINDIR ); // refreshes always
+            if ( ! refresh && repoManager.isCached( nrepo ) )
+            {
+              std::map<std::string,RepoManager::RefreshCheckStatus>::const_iterator check( refreshCheck.find( nrepo.alias() ) );
+              if ( check != refreshCheck.end() )
+                refresh = ( check->second == RepoManager::REFRESH_NEEDED );
+              else // not covered by the bulk check
+                refresh = ( repoManager.checkIfToRefreshMetadata( nrepo, nrepo.url() ) == RepoManager::REFRESH_NEEDED );
+            }
+
+            if ( refresh && repoManager.isCached( nrepo ) )
             {
               MIL << str::form( "*** clean cache for repo '%s'\t", nrepo.name().c_str() ) << endl;
               repoManager.cleanCache( nrepo );
@@ -86,18 +117,60 @@ namespace zypp
             MIL << str::form( "*** build cache for repo '%s'\t", nrepo.name().c_str() ) << endl;
             repoManager.buildCache( nrepo );
           }
+          enabledRepos.push_back( nrepo );
+        }
 
-          MIL << str::form( "*** load repo '%s'\t", nrepo.name().c_str() ) << std::flush;
+        // ...then load them; from the snapshot if it is still valid.
+        Pathname snapshotFile;
+        if ( flags_r.testFlag( LS_SNAPSHOT ) )
+        {
+          snapshotFile = repoOptions.repoSolvCachePath / "@PoolSnapshot";
+          std::vector<Repository> loaded( sat::PoolSnapshot::load( snapshotFile, snapshotStamp( repoManager, enabledRepos ) ) );
+          if ( ! loaded.empty() )
+          {
+            for_( it, enabledRepos.begin(), enabledRepos.end() )
+            {
+              Repository repo( satpool.reposFind( it->alias() ) );
+              repo.setInfo( *it );
+              MIL << str::form( "*** load repo '%s'\t", it->name().c_str() ) << repo << endl;
+            }
+            enabledRepos.clear();	// done
+          }
+        }
+
+        bool loadedRepos = ! enabledRepos.empty();
+        if ( loadedRepos )
+        {
+          MIL << "*** load " << enabledRepos.size() << " repos" << endl;
           try
           {
-            repoManager.loadFromCache( nrepo );
-            MIL << satpool.reposFind( nrepo.alias() ) << endl;
+            repoManager.loadFromCache( enabledRepos );
           }
           catch ( const Exception & exp )
           {
             ERR << "*** load repo failed: " << exp.asString() + "\n" + exp.historyAsString() << endl;
             ZYPP_RETHROW ( exp );
           }
+          for_( it, enabledRepos.begin(), enabledRepos.end() )
+            MIL << str::form( "*** load repo '%s'\t", it->name().c_str() ) << satpool.reposFind( it->alias() ) << endl;
+        }
+
+        if ( loadedRepos && ! snapshotFile.empty() )
+        {
+          // Store exactly the repos the stamp describes; leave out those that
+          // failed to load and anything else in the pool.
+          RepoInfoList storedInfos;
+          std::vector<Repository> stored;
+          for_( it, enabledRepos.begin(), enabledRepos.end() )
+          {
+            Repository repo( satpool.reposFind( it->alias() ) );
+            if ( repo )
+            {
+              storedInfos.push_back( *it );
+              stored.push_back( repo );
+            }
+          }
+          sat::PoolSnapshot::store( snapshotFile, snapshotStamp( repoManager, storedInfos ), stored );
         }
       }
       MIL << str::form( "*** Read system at '%s'", sysRoot_r.c_str() ) << endl;
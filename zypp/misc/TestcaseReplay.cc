@@ -0,0 +1,326 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/misc/TestcaseReplay.cc
+ *
+*/
+#include <iostream>
+#include <vector>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Exception.h"
+#include "zypp/base/IOStream.h"
+#include "zypp/base/InputStream.h"
+
+#include "zypp/misc/TestcaseReplay.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+#include "zypp/ZYppFactory.h"
+#include "zypp/ResPool.h"
+#include "zypp/Resolver.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/target/modalias/Modalias.h"
+
+using std::endl;
+
+#undef ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::misc"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace misc
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      const std::string jobFile( "solver-test.job" );
+
+      /** Split \a line_r into the first word and the remainder. */
+      std::string splitWord( const std::string & line_r, std::string & rest_r )
+      {
+	std::string::size_type sep = line_r.find( ' ' );
+	if ( sep == std::string::npos )
+	{
+	  rest_r.clear();
+	  return line_r;
+	}
+	rest_r = str::trim( line_r.substr( sep+1 ) );
+	return line_r.substr( 0, sep );
+      }
+
+      /** The item <tt>ident edition arch repoalias</tt>. */
+      PoolItem findItem( const std::string & spec_r )
+      {
+	std::string rest;
+	std::string ident( splitWord( spec_r, rest ) );
+	std::string edition( splitWord( rest, rest ) );
+	std::string arch( splitWord( rest, rest ) );
+	for ( const PoolItem & pi : ResPool::instance().byIdent( IdString( ident ) ) )
+	{
+	  if ( pi.edition().asString() == edition && pi.arch().asString() == arch && pi.repository().alias() == rest )
+	    return pi;
+	}
+	return PoolItem();
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class TestcaseReplay::Impl
+    /// \brief TestcaseReplay implementation.
+    ///////////////////////////////////////////////////////////////////
+    class TestcaseReplay::Impl
+    {
+    public:
+      Impl( const Pathname & dir_r )
+      : _dir( dir_r )
+      , _forceResolve( false )
+      , _onlyRequires( false )
+      , _ignoreAlreadyRecommended( false )
+      , _missing( 0 )
+      { load(); }
+
+    public:
+      bool solve()
+      {
+	ResPool pool( ResPool::instance() );
+	for ( const PoolItem & pi : pool )
+	{
+	  pi.status().resetTransact( ResStatus::USER );
+	  pi.status().setLock( false, ResStatus::USER );
+	}
+	for ( const PoolItem & pi : _install )
+	  pi.status().setToBeInstalled( ResStatus::USER );
+	for ( const PoolItem & pi : _lock )
+	  pi.status().setLock( true, ResStatus::USER );
+	for ( const PoolItem & pi : _uninstall )
+	  pi.status().setToBeUninstalled( ResStatus::USER );
+	// the reset leaves them kept by the solver, which the resolver ignores
+	for ( const PoolItem & pi : _keep )
+	  pi.status().setSoftLock( ResStatus::USER );
+
+	Resolver & resolver( *getZYpp()->resolver() );
+	resolver.reset();
+	resolver.setUpgradeMode( false );
+	resolver.removeUpgradeRepos();
+	resolver.setForceResolve( _forceResolve );
+	resolver.setOnlyRequires( _onlyRequires );
+	resolver.setIgnoreAlreadyRecommended( _ignoreAlreadyRecommended );
+	for ( const Capability & cap : _requires )
+	  resolver.addRequire( cap );
+	for ( const Capability & cap : _conflicts )
+	  resolver.addConflict( cap );
+	for ( const Repository & repo : _upgradeRepos )
+	  resolver.addUpgradeRepo( repo );
+
+	if ( _mode == "distupgrade" )
+	  return resolver.doUpgrade();
+	if ( _mode == "update" )
+	{
+	  resolver.doUpdate();
+	  return true;
+	}
+	if ( _mode == "verify" )
+	  return resolver.verifySystem();
+	return resolver.resolvePool();
+      }
+
+    private:
+      /** The solv file \a name_r referenced in \a job_r, which must exist. */
+      Pathname solvFile( const Pathname & job_r, const std::string & name_r ) const
+      {
+	Pathname ret( _dir / name_r );
+	if ( ! PathInfo( ret ).isFile() )
+	  ZYPP_THROW( Exception( str::Str() << job_r << ": missing solv file " << name_r ) );
+	return ret;
+      }
+
+      void load()
+      {
+	Pathname file( _dir / jobFile );
+	if ( ! PathInfo( file ).isFile() )
+	  ZYPP_THROW( Exception( str::Str() << "No solv testcase in " << _dir ) );
+	MIL << "Loading solv testcase " << _dir << endl;
+
+	sat::Pool satpool( sat::Pool::instance() );
+	satpool.reposEraseAll();
+
+	LocaleSet requested;
+	LocaleSet added;
+	LocaleSet removed;
+	sat::StringQueue autoinst;
+	target::Modalias::ModaliasList modalias;
+	std::set<std::string> multiversion;
+	std::vector<std::pair<std::vector<PoolItem>*,std::string>> items;
+	std::vector<std::string> upgradeRepos;
+
+	InputStream in( file );
+	for ( iostr::EachLine line( in ); line; line.next() )
+	{
+	  std::string val;
+	  std::string key( splitWord( str::trim( *line ), val ) );
+	  if ( key.empty() || key[0] == '#' )
+	    continue;
+
+	  if ( key == "version" )
+	  {
+	    if ( val != "1" )
+	      ZYPP_THROW( Exception( str::Str() << file << ": unsupported version " << val ) );
+	  }
+	  else if ( key == "arch" )
+	    ZConfig::instance().setSystemArchitecture( Arch( val ) );
+	  else if ( key == "system" )
+	    satpool.addRepoSolv( solvFile( file, val ), sat::Pool::systemRepoAlias() );
+	  else if ( key == "repo" )
+	  {
+	    std::string alias;
+	    std::string solv( splitWord( val, alias ) );
+	    std::string prio( splitWord( alias, alias ) );
+	    RepoInfo info;
+	    info.setAlias( alias );
+	    info.setPriority( str::strtonum<unsigned>( prio ) );
+	    satpool.addRepoSolv( solvFile( file, solv ), info );
+	  }
+	  else if ( key == "locale" )
+	  {
+	    std::string fate;
+	    Locale locale( splitWord( val, fate ) );
+	    if ( fate == "removed" )
+	      removed.insert( locale );
+	    else
+	    {
+	      requested.insert( locale );
+	      if ( fate == "added" )
+		added.insert( locale );
+	    }
+	  }
+	  else if ( key == "autoinst" )
+	    autoinst.push_back( IdString( val ).id() );
+	  else if ( key == "modalias" )
+	    modalias.push_back( val );
+	  else if ( key == "multiversion" )
+	    multiversion.insert( val );
+	  else if ( key == "flag" )
+	  {
+	    if ( val == "forceResolve" )
+	      _forceResolve = true;
+	    else if ( val == "onlyRequires" )
+	      _onlyRequires = true;
+	    else if ( val == "ignorealreadyrecommended" )
+	      _ignoreAlreadyRecommended = true;
+	    else
+	      WAR << file << ": ignore unknown flag " << val << endl;
+	  }
+	  else if ( key == "install" )
+	    items.push_back( std::make_pair( &_install, val ) );
+	  else if ( key == "lock" )
+	    items.push_back( std::make_pair( &_lock, val ) );
+	  else if ( key == "keep" )
+	    items.push_back( std::make_pair( &_keep, val ) );
+	  else if ( key == "uninstall" )
+	    items.push_back( std::make_pair( &_uninstall, val ) );
+	  else if ( key == "require" )
+	    _requires.insert( Capability( val ) );
+	  else if ( key == "conflict" )
+	    _conflicts.insert( Capability( val ) );
+	  else if ( key == "upgraderepo" )
+	    upgradeRepos.push_back( val );
+	  else if ( key == "mode" )
+	    _mode = val;
+	  else
+	    WAR << file << ": ignore unknown line " << *line << endl;
+	}
+
+	// The locales fates are derived from the previous set.
+	LocaleSet initial( requested );
+	for ( const Locale & locale : added )
+	  initial.erase( locale );
+	initial.insert( removed.begin(), removed.end() );
+	satpool.setRequestedLocales( initial );
+	satpool.setRequestedLocales( requested );
+
+	satpool.setAutoInstalled( autoinst );
+	target::Modalias::instance().modaliasList( modalias );
+	ZConfig::instance().multiversionSpec( multiversion );
+
+	for ( const auto & item : items )
+	{
+	  PoolItem pi( findItem( item.second ) );
+	  if ( pi )
+	    item.first->push_back( pi );
+	  else
+	  {
+	    WAR << file << ": no item " << item.second << endl;
+	    ++_missing;
+	  }
+	}
+	for ( const std::string & alias : upgradeRepos )
+	{
+	  Repository repo( satpool.reposFind( alias ) );
+	  if ( repo )
+	    _upgradeRepos.push_back( repo );
+	  else
+	    WAR << file << ": no upgrade repo " << alias << endl;
+	}
+	MIL << "Loaded solv testcase " << _dir << " (" << satpool.solvablesSize() << " solvables, "
+	    << items.size() << " items in job, " << _missing << " missing)" << endl;
+      }
+
+    public:
+      Pathname _dir;
+      bool _forceResolve;
+      bool _onlyRequires;
+      bool _ignoreAlreadyRecommended;
+      std::string _mode;
+      std::vector<PoolItem> _install;
+      std::vector<PoolItem> _lock;
+      std::vector<PoolItem> _keep;
+      std::vector<PoolItem> _uninstall;
+      CapabilitySet _requires;
+      CapabilitySet _conflicts;
+      std::vector<Repository> _upgradeRepos;
+      unsigned _missing;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    //	class TestcaseReplay
+    ///////////////////////////////////////////////////////////////////
+
+    bool TestcaseReplay::isTestcase( const Pathname & dir_r )
+    { return PathInfo( dir_r / jobFile ).isFile(); }
+
+    TestcaseReplay::TestcaseReplay( const Pathname & dir_r )
+    : _pimpl( new Impl( dir_r ) )
+    {}
+
+    TestcaseReplay::~TestcaseReplay()
+    {}
+
+    const Pathname & TestcaseReplay::dir() const
+    { return _pimpl->_dir; }
+
+    unsigned TestcaseReplay::missingItems() const
+    { return _pimpl->_missing; }
+
+    bool TestcaseReplay::solve()
+    { return _pimpl->solve(); }
+
+    solver::detail::SolverStats TestcaseReplay::stats() const
+    { return getZYpp()->resolver()->solverStats(); }
+
+    std::ostream & operator<<( std::ostream & str, const TestcaseReplay & obj )
+    { return str << "TestcaseReplay(" << obj.dir() << ")"; }
+
+  } // namespace misc
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,108 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/misc/TestcaseReplay.h
+ *
+*/
+#ifndef ZYPP_MISC_TESTCASEREPLAY_H
+#define ZYPP_MISC_TESTCASEREPLAY_H
+
+#include <iosfwd>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Pathname.h"
+#include "zypp/solver/detail/Types.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace misc
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class TestcaseReplay
+    /// \brief Load a solver testcase from solv files and solve it repeatedly.
+    ///
+    /// Besides the helix files, \ref Resolver::createSolverTestcase writes
+    /// the repos as solv files and the job as compact \c solver-test.job.
+    /// Loading these is much faster than parsing the helix XML, so this is
+    /// the preferred way of replaying testcases for regression and speed
+    /// checks.
+    ///
+    /// The job file contains one directive per line (\c # starts a comment):
+    /// \code
+    ///   version 1
+    ///   arch x86_64
+    ///   system solver-system.solv
+    ///   repo <solvfile> <priority> <alias>
+    ///   locale <name> [added|removed]
+    ///   autoinst <name>
+    ///   modalias <name>
+    ///   multiversion <spec>
+    ///   flag forceResolve|onlyRequires|ignorealreadyrecommended
+    ///   install|lock|keep|uninstall <ident> <edition> <arch> <repoalias>
+    ///   require|conflict <capability>
+    ///   upgraderepo <alias>
+    ///   mode distupgrade|update|verify
+    /// \endcode
+    ///
+    /// \code
+    ///   misc::TestcaseReplay testcase( "/var/log/YaST2/solverTestcase" );
+    ///   for ( unsigned i = 0; i < 10; ++i )
+    ///   {
+    ///     testcase.solve();
+    ///     USR << testcase.stats().solveTime << endl;
+    ///   }
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class TestcaseReplay
+    {
+    public:
+      /** Whether \a dir_r contains a solv testcase. */
+      static bool isTestcase( const Pathname & dir_r );
+
+    public:
+      /** Load the testcase in \a dir_r.
+       * All repos are removed from the pool and the testcases system
+       * and repos are loaded. The system architecture, requested locales,
+       * autoinstalled and multiversion settings are set as recorded.
+       * \throws Exception if the testcase can not be loaded.
+       */
+      explicit TestcaseReplay( const Pathname & dir_r );
+
+      ~TestcaseReplay();
+
+    public:
+      /** The testcase directory. */
+      const Pathname & dir() const;
+
+      /** Number of items the job refers to, but which are not in the pool. */
+      unsigned missingItems() const;
+
+      /** Reset all items to their initial state, apply the job and run the solver.
+       * Returns the solvers result.
+       */
+      bool solve();
+
+      /** Rules, decisions and solve time of the last \ref solve. */
+      solver::detail::SolverStats stats() const;
+
+    public:
+      class Impl;              ///< Implementation class.
+    private:
+      RW_pointer<Impl> _pimpl; ///< Pointer to implementation.
+    };
+
+    /** \relates TestcaseReplay Stream output */
+    std::ostream & operator<<( std::ostream & str, const TestcaseReplay & obj );
+
+  } // namespace misc
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MISC_TESTCASEREPLAY_H
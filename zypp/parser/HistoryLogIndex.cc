@@ -0,0 +1,389 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+
+/** \file zypp/parser/HistoryLogIndex.cc
+ *
+ */
+#include <cstring>
+#include <iostream>
+#include <fstream>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/parser/HistoryLogIndex.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace parser
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Sidecar file header; followed by \c count \ref HistoryLogIndex::Block. */
+      struct IndexHeader
+      {
+	char     magic[8];
+	uint64_t ino;
+	uint64_t size;
+	uint32_t lines;
+	uint32_t headLen;
+	uint32_t headHash;
+	uint32_t count;
+	uint32_t blockSize;
+	uint32_t reserved;
+      };
+
+      const char _magic[8] = { 'Z', 'Y', 'P', 'P', 'H', 'I', 'X', '1' };
+
+      /** FNV-1a */
+      inline uint64_t fnv1a( const char * s, size_t len )
+      {
+	uint64_t ret = 14695981039346656037ULL;
+	for ( const char * e = s + len; s != e; ++s )
+	{
+	  ret ^= (unsigned char)*s;
+	  ret *= 1099511628211ULL;
+	}
+	return ret;
+      }
+
+      /** Quick check for a \c HISTORY_LOG_DATE_FORMAT date at the beginning of \a line_r.
+       * Dates in this format compare like strings, so only the block's latest date
+       * needs to be converted into a \ref Date.
+       */
+      inline bool hasDate( const std::string & line_r )
+      {
+	static const char _shape[] = "dddd-dd-dd dd:dd:dd";
+	if ( line_r.size() < sizeof(_shape)-1 )
+	  return false;
+	for ( unsigned i = 0; i < sizeof(_shape)-1; ++i )
+	{
+	  if ( _shape[i] == 'd' ? ! ::isdigit( line_r[i] ) : line_r[i] != _shape[i] )
+	    return false;
+	}
+	return true;
+      }
+
+      /** Read and check the \ref IndexHeader. */
+      inline bool readHeader( std::istream & idx_r, IndexHeader & hdr_r )
+      {
+	return idx_r.read( reinterpret_cast<char*>(&hdr_r), sizeof(hdr_r) )
+	    && ::memcmp( hdr_r.magic, _magic, sizeof(_magic) ) == 0
+	    && hdr_r.blockSize == HistoryLogIndex::blockSize;
+      }
+
+      inline bool readHeader( const Pathname & idx_r, IndexHeader & hdr_r )
+      {
+	std::ifstream idx( idx_r.c_str(), std::ios::in|std::ios::binary );
+	return readHeader( idx, hdr_r );
+      }
+
+      /** Hash of the first line of \a file_r, if it is \a len_r bytes long. */
+      inline uint32_t headHash( std::istream & file_r, uint32_t len_r )
+      {
+	std::string head( len_r, '\0' );
+	file_r.seekg( 0 );
+	if ( ! file_r.read( &head[0], len_r ) )
+	  return 0;
+	return uint32_t( fnv1a( head.data(), head.size() ) );
+      }
+
+      /** Accumulates the lines of a block. */
+      struct BlockBuilder
+      {
+	BlockBuilder( int64_t offset_r, uint32_t lineNo_r )
+	: _lines( 0 )
+	{ _block.offset = offset_r; _block.lineNo = lineNo_r; }
+
+	void addLine( const std::string & line_r )
+	{
+	  ++_lines;
+	  if ( line_r.empty() || line_r[0] == '#' || ! hasDate( line_r ) )
+	    return;
+
+	  if ( _maxDate.empty() || line_r.compare( 0, _maxDate.size(), _maxDate ) > 0 )
+	    _maxDate.assign( line_r, 0, 19 );
+
+	  std::string::size_type beg = line_r.find( '|' );
+	  if ( beg == std::string::npos )
+	    return;
+	  std::string::size_type end = line_r.find( '|', ++beg );
+	  HistoryActionID action( str::trim( line_r.substr( beg, end == std::string::npos ? end : end - beg ) ) );
+	  _block.actions |= HistoryLogIndex::actionBit( action );
+
+	  if ( ( action == HistoryActionID::INSTALL || action == HistoryActionID::REMOVE ) && end != std::string::npos )
+	  {
+	    beg = end + 1;
+	    end = line_r.find( '|', beg );
+	    if ( end != std::string::npos )
+	      _block.names |= HistoryLogIndex::nameBits( line_r.substr( beg, end - beg ) );
+	  }
+	}
+
+	uint32_t lines() const
+	{ return _lines; }
+
+	int64_t offset() const
+	{ return _block.offset; }
+
+	HistoryLogIndex::Block finish()
+	{
+	  if ( ! _maxDate.empty() )
+	  {
+	    try
+	    {
+	      _block.maxDate = Date( _maxDate, HISTORY_LOG_DATE_FORMAT );
+	    }
+	    catch ( const DateFormatException & excpt )
+	    {
+	      WAR << "Bad date in history log block at offset " << _block.offset << ": " << excpt << endl;
+	    }
+	  }
+	  return _block;
+	}
+
+      private:
+	HistoryLogIndex::Block _block;
+	std::string _maxDate;
+	uint32_t _lines;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    HistoryLogIndex::HistoryLogIndex( const Pathname & historyFile_r )
+    : _file( historyFile_r )
+    , _valid( false )
+    , _ino( 0 )
+    , _size( 0 )
+    , _lines( 0 )
+    , _headLen( 0 )
+    , _headHash( 0 )
+    {
+      struct stat st;
+      if ( ::stat( _file.c_str(), &st ) != 0 || ! S_ISREG( st.st_mode ) )
+	return;
+      if ( filesystem::zipType( _file ) != filesystem::ZT_NONE )
+      {
+	DBG << "Not indexing compressed history file " << _file << endl;
+	return;
+      }
+      _valid = true;
+
+      if ( ! load( st ) )
+      {
+	_blocks.clear();
+	_ino = st.st_ino;
+	_size = 0;
+	_lines = 0;
+	_headLen = _headHash = 0;
+      }
+
+      if ( _size != st.st_size )
+	scan( st );
+    }
+
+    Pathname HistoryLogIndex::indexFile( const Pathname & historyFile_r )
+    { return historyFile_r.extend( ".idx" ); }
+
+    uint64_t HistoryLogIndex::nameBits( const std::string & name_r )
+    {
+      uint64_t h = fnv1a( name_r.data(), name_r.size() );
+      return ( uint64_t(1) << ( h & 63 ) ) | ( uint64_t(1) << ( ( h >> 6 ) & 63 ) );
+    }
+
+    void HistoryLogIndex::update( const Pathname & historyFile_r )
+    {
+      // HistoryLog closes the file after each entry. Don't rescan the last
+      // block each time; readers catch up on a small unindexed tail themselves.
+      struct stat st;
+      IndexHeader hdr;
+      if ( ::stat( historyFile_r.c_str(), &st ) == 0
+	&& readHeader( indexFile( historyFile_r ), hdr )
+	&& hdr.ino == uint64_t(st.st_ino)
+	&& hdr.size <= uint64_t(st.st_size)
+	&& uint64_t(st.st_size) - hdr.size < uint64_t(blockSize) )
+	return;
+
+      HistoryLogIndex index( historyFile_r );
+      index.store();
+    }
+
+    unsigned HistoryLogIndex::firstBlockAfter( const Date & date_r ) const
+    {
+      unsigned idx = 0;
+      for ( ; idx < _blocks.size(); ++idx )
+      {
+	if ( _blocks[idx].maxDate > int64_t(Date::ValueType(date_r)) )
+	  break;
+      }
+      return idx;
+    }
+
+    unsigned HistoryLogIndex::firstBlockFrom( const Date & date_r ) const
+    {
+      unsigned idx = 0;
+      for ( ; idx < _blocks.size(); ++idx )
+      {
+	if ( _blocks[idx].maxDate >= int64_t(Date::ValueType(date_r)) )
+	  break;
+      }
+      return idx;
+    }
+
+    bool HistoryLogIndex::load( const struct stat & st_r )
+    {
+      std::ifstream idx( indexFile( _file ).c_str(), std::ios::in|std::ios::binary );
+      IndexHeader hdr;
+      if ( ! readHeader( idx, hdr ) )
+      {
+	if ( idx.is_open() )
+	  WAR << "Ignore unknown history index format " << indexFile( _file ) << endl;
+	return false;
+      }
+
+      if ( hdr.ino != uint64_t(st_r.st_ino) || hdr.size > uint64_t(st_r.st_size) )
+      {
+	MIL << "History file " << _file << " was rotated or truncated. Rebuilding the index." << endl;
+	return false;
+      }
+
+      if ( hdr.headLen )
+      {
+	std::ifstream file( _file.c_str(), std::ios::in|std::ios::binary );
+	if ( headHash( file, hdr.headLen ) != hdr.headHash )
+	{
+	  MIL << "History file " << _file << " was rewritten. Rebuilding the index." << endl;
+	  return false;
+	}
+      }
+
+      std::vector<Block> blocks( hdr.count );
+      if ( hdr.count && ! idx.read( reinterpret_cast<char*>(&blocks[0]), hdr.count * sizeof(Block) ) )
+      {
+	WAR << "Truncated history index " << indexFile( _file ) << endl;
+	return false;
+      }
+
+      _ino = hdr.ino;
+      _size = hdr.size;
+      _lines = hdr.lines;
+      _headLen = hdr.headLen;
+      _headHash = hdr.headHash;
+      _blocks.swap( blocks );
+      return true;
+    }
+
+    void HistoryLogIndex::scan( const struct stat & st_r )
+    {
+      std::ifstream file( _file.c_str(), std::ios::in|std::ios::binary );
+      if ( ! file )
+      {
+	_valid = false;
+	return;
+      }
+
+      // The last block may be incomplete: rescan it.
+      int64_t offset = 0;
+      uint32_t lineNo = 0;
+      if ( ! _blocks.empty() )
+      {
+	offset = _blocks.back().offset;
+	lineNo = _blocks.back().lineNo;
+	_blocks.pop_back();
+      }
+      DBG << "Indexing " << _file << " from offset " << offset << endl;
+
+      file.seekg( offset );
+      BlockBuilder block( offset, lineNo );
+      std::string line;
+      while ( std::getline( file, line ) )
+      {
+	if ( file.eof() )
+	  break;	// incomplete last line: still being written
+
+	if ( offset == 0 )
+	{
+	  std::string head( line + '\n' );
+	  _headLen = head.size();
+	  _headHash = uint32_t( fnv1a( head.data(), head.size() ) );
+	}
+
+	if ( block.lines() && offset - block.offset() >= blockSize )
+	{
+	  _blocks.push_back( block.finish() );
+	  block = BlockBuilder( offset, lineNo );
+	}
+	block.addLine( line );
+	offset += line.size() + 1;
+	++lineNo;
+      }
+      if ( block.lines() )
+	_blocks.push_back( block.finish() );
+
+      _ino = st_r.st_ino;
+      _size = offset;
+      _lines = lineNo;
+    }
+
+    void HistoryLogIndex::store() const
+    {
+      if ( ! _valid )
+	return;
+
+      Pathname target( indexFile( _file ) );
+      Pathname tmp( target.extend( ".new" ) );
+      {
+	std::ofstream idx( tmp.c_str(), std::ios::out|std::ios::binary|std::ios::trunc );
+	if ( ! idx )
+	{
+	  DBG << "Can not write history index " << tmp << "; keep it in memory." << endl;
+	  return;
+	}
+
+	IndexHeader hdr;
+	::memcpy( hdr.magic, _magic, sizeof(_magic) );
+	hdr.ino = _ino;
+	hdr.size = _size;
+	hdr.lines = _lines;
+	hdr.headLen = _headLen;
+	hdr.headHash = _headHash;
+	hdr.count = _blocks.size();
+	hdr.blockSize = blockSize;
+	hdr.reserved = 0;
+	idx.write( reinterpret_cast<const char*>(&hdr), sizeof(hdr) );
+	if ( ! _blocks.empty() )
+	  idx.write( reinterpret_cast<const char*>(&_blocks[0]), _blocks.size() * sizeof(Block) );
+	if ( ! idx.flush() )
+	{
+	  WAR << "Error writing history index " << tmp << endl;
+	  idx.close();
+	  filesystem::unlink( tmp );
+	  return;
+	}
+      }
+      if ( filesystem::rename( tmp, target ) != 0 )
+	filesystem::unlink( tmp );
+    }
+
+    std::ostream & operator<<( std::ostream & str, const HistoryLogIndex & obj )
+    {
+      return str << "HistoryLogIndex(" << (obj.valid() ? "" : "invalid, ")
+                 << obj.blocks().size() << " blocks, " << obj.indexedSize() << " bytes)";
+    }
+
+  } // namespace parser
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,163 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+
+/** \file zypp/parser/HistoryLogIndex.h
+ *
+ */
+#ifndef ZYPP_PARSER_HISTORYLOGINDEX_H_
+#define ZYPP_PARSER_HISTORYLOGINDEX_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/Pathname.h"
+#include "zypp/Date.h"
+#include "zypp/HistoryLogData.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace parser
+  {
+  ///////////////////////////////////////////////////////////////////
+  /// \class HistoryLogIndex
+  /// \brief Sparse index of a zypp history log file.
+  /// \ingroup g_ZyppHistory
+  ///
+  /// The history file is split into blocks of about \ref blockSize bytes,
+  /// each starting at a line boundary. For each block the index remembers
+  /// the byte offset and line number it starts at, the latest date found
+  /// in the block, the \ref HistoryActionID values it contains and a small
+  /// bloom filter of the package names mentioned in install and remove
+  /// lines. \ref HistoryLogReader uses this to seek to a date range or to
+  /// skip blocks not mentioning a certain action or package.
+  ///
+  /// The index is stored in a binary sidecar file next to the history
+  /// file (see \ref indexFile). Only \ref update, called by \ref HistoryLog
+  /// when writing the file, creates or changes the sidecar file. Readers
+  /// use it if present and bring the index up to date in memory on
+  /// construction, scanning just the lines appended since the last update.
+  /// If the history file was rotated or truncated (inode changed, file
+  /// shrunk or the head of the file differs) the index is rebuilt from
+  /// scratch.
+  ///
+  /// Compressed history files are not indexed (\ref valid returns \c false).
+  ///////////////////////////////////////////////////////////////////
+  class HistoryLogIndex
+  {
+  public:
+    /** Approximate size of an indexed block. */
+    static const off_t blockSize = 64 * 1024;
+
+    /** Index data for a block of lines. */
+    struct Block
+    {
+      Block()
+      : maxDate( 0 ), offset( 0 ), lineNo( 0 ), actions( 0 ), names( 0 )
+      {}
+
+      /** Whether the block may contain lines for action \a action_r. */
+      bool mayContain( const HistoryActionID & action_r ) const
+      { return actions & actionBit( action_r ); }
+
+      /** Whether the block may contain install or remove lines for package \a name_r. */
+      bool mayContain( const std::string & name_r ) const
+      { uint64_t bits( nameBits( name_r ) ); return ( names & bits ) == bits; }
+
+      int64_t  maxDate;	///< latest date found in block (time_t)
+      int64_t  offset;	///< byte offset of the block's first line
+      uint32_t lineNo;	///< number of lines preceding the block
+      uint32_t actions;	///< OR'ed \ref actionBit of all lines in block
+      uint64_t names;	///< OR'ed \ref nameBits of all package names in block
+    };
+
+  public:
+    /** Load the index for \a historyFile_r and bring it up to date in memory.
+     * The sidecar file is not written.
+     */
+    explicit HistoryLogIndex( const Pathname & historyFile_r );
+
+  public:
+    /** Whether the history file could be indexed. */
+    bool valid() const
+    { return _valid; }
+
+    /** The indexed blocks in file order. */
+    const std::vector<Block> & blocks() const
+    { return _blocks; }
+
+    /** Number of bytes covered by the index (always ends at a line boundary). */
+    off_t indexedSize() const
+    { return _size; }
+
+    /** Number of lines covered by the index. */
+    unsigned indexedLines() const
+    { return _lines; }
+
+    /** Index of the first block containing a line dated after \a date_r.
+     * Returns \c blocks().size() if there is none.
+     */
+    unsigned firstBlockAfter( const Date & date_r ) const;
+
+    /** Index of the first block containing a line dated \a date_r or later.
+     * Returns \c blocks().size() if there is none.
+     */
+    unsigned firstBlockFrom( const Date & date_r ) const;
+
+    /** Byte offset where block \a idx_r ends (start of the next block or \ref indexedSize). */
+    off_t blockEnd( unsigned idx_r ) const
+    { return idx_r + 1 < _blocks.size() ? _blocks[idx_r+1].offset : _size; }
+
+  public:
+    /** Bring the sidecar index of \a historyFile_r up to date.
+     * Called by \ref HistoryLog after appending to the file. If the sidecar
+     * file can not be written, readers index the file in memory.
+     */
+    static void update( const Pathname & historyFile_r );
+
+    /** The sidecar file used for \a historyFile_r. */
+    static Pathname indexFile( const Pathname & historyFile_r );
+
+    /** The \ref Block::actions bit representing \a action_r. */
+    static uint32_t actionBit( const HistoryActionID & action_r )
+    { return 1U << action_r.toEnum(); }
+
+    /** The \ref Block::names bits representing \a name_r. */
+    static uint64_t nameBits( const std::string & name_r );
+
+  private:
+    bool load( const struct stat & st_r );
+    void scan( const struct stat & st_r );
+    void store() const;
+
+  private:
+    Pathname		_file;
+    bool		_valid;
+    uint64_t		_ino;
+    off_t		_size;
+    uint32_t		_lines;
+    uint32_t		_headLen;
+    uint32_t		_headHash;
+    std::vector<Block>	_blocks;
+  };
+
+  /** \relates HistoryLogIndex Stream output */
+  std::ostream & operator<<( std::ostream & str, const HistoryLogIndex & obj );
+
+  ///////////////////////////////////////////////////////////////////
+  } // namespace parser
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif /* ZYPP_PARSER_HISTORYLOGINDEX_H_ */
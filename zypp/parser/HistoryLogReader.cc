@@ -11,11 +11,14 @@
  *
  */
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 
 #include "zypp/base/InputStream.h"
 #include "zypp/base/IOStream.h"
 #include "zypp/base/Logger.h"
 #include "zypp/parser/ParseException.h"
+#include "zypp/parser/HistoryLogIndex.h"
 
 #include "zypp/parser/HistoryLogReader.h"
 
@@ -46,10 +49,27 @@ namespace zypp
     void readAll( const ProgressData::ReceiverFnc & progress_r );
     void readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r );
     void readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r );
+    void readAction( const HistoryActionID & action_r, const ProgressData::ReceiverFnc & progress_r );
+    void readPackage( const std::string & name_r, const ProgressData::ReceiverFnc & progress_r );
+
+    /** Read the lines accepted by \a line_r in all blocks accepted by \a block_r. */
+    void readMatching( const function<bool(const HistoryLogIndex::Block &)> & block_r,
+		       const function<bool(const std::string &)> & line_r,
+		       const ProgressData::ReceiverFnc & progress_r );
+
+    /** Stream positioned at the first line of \a index_r's block \a block_r.
+     * \a lineNo_r is set to the number of lines preceding the position. If
+     * \a block_r is past the last block, the stream is positioned at the end
+     * of the indexed part. Without valid index the stream starts at the
+     * beginning of the (maybe compressed) file.
+     */
+    std::istream & openAt( const HistoryLogIndex & index_r, unsigned block_r, unsigned & lineNo_r );
 
     Pathname _filename;
     Options  _options;
     ProcessData _callback;
+    std::ifstream _stream;	///< seekable stream for indexed files
+    InputStream _gzstream;	///< for files without index
   };
 
   bool HistoryLogReader::Impl::parseLine( const std::string & line_r, unsigned lineNr_r )
@@ -114,10 +134,44 @@ namespace zypp
     pd.toMax();
   }
 
+  std::istream & HistoryLogReader::Impl::openAt( const HistoryLogIndex & index_r, unsigned block_r, unsigned & lineNo_r )
+  {
+    lineNo_r = 0;
+    if ( ! index_r.valid() )
+    {
+      _gzstream = InputStream( _filename );
+      return _gzstream.stream();
+    }
+
+    off_t offset = 0;
+    if ( block_r < index_r.blocks().size() )
+    {
+      offset = index_r.blocks()[block_r].offset;
+      lineNo_r = index_r.blocks()[block_r].lineNo;
+    }
+    else
+    {
+      offset = index_r.indexedSize();
+      lineNo_r = index_r.indexedLines();
+    }
+
+    _stream.close();
+    _stream.clear();
+    _stream.open( _filename.c_str() );
+    if ( offset )
+    {
+      DBG << "Seek to line " << lineNo_r << " at offset " << offset << " in " << _filename << endl;
+      _stream.seekg( offset );
+    }
+    return _stream;
+  }
+
   void HistoryLogReader::Impl::readFrom( const Date & date_r, const ProgressData::ReceiverFnc & progress_r )
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
+    HistoryLogIndex index( _filename );
+    unsigned lineNo = 0;
+    std::istream & is( openAt( index, index.firstBlockAfter( date_r ), lineNo ) );
+    iostr::EachLine line( is, lineNo );
 
     ProgressData pd;
     pd.sendTo( progress_r );
@@ -154,8 +208,11 @@ namespace zypp
 
   void HistoryLogReader::Impl::readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r )
   {
-    InputStream is( _filename );
-    iostr::EachLine line( is );
+    // A line at or past toDate stops reading, even if it precedes fromDate.
+    HistoryLogIndex index( _filename );
+    unsigned lineNo = 0;
+    std::istream & is( openAt( index, std::min( index.firstBlockAfter( fromDate_r ), index.firstBlockFrom( toDate_r ) ), lineNo ) );
+    iostr::EachLine line( is, lineNo );
 
     ProgressData pd;
     pd.sendTo( progress_r );
@@ -190,6 +247,102 @@ namespace zypp
     pd.toMax();
   }
 
+  void HistoryLogReader::Impl::readMatching( const function<bool(const HistoryLogIndex::Block &)> & block_r,
+					     const function<bool(const std::string &)> & line_r,
+					     const ProgressData::ReceiverFnc & progress_r )
+  {
+    HistoryLogIndex index( _filename );
+    const std::vector<HistoryLogIndex::Block> & blocks( index.blocks() );
+
+    ProgressData pd;
+    pd.sendTo( progress_r );
+    pd.toMin();
+
+    // Without index we read the whole file as one block. The last
+    // block also covers lines appended after the index was written.
+    unsigned blockCount = index.valid() ? blocks.size() + 1 : 1;
+    for ( unsigned blk = 0; blk < blockCount; ++blk )
+    {
+      bool tail = ( blk + 1 == blockCount );
+      if ( ! tail && ! block_r( blocks[blk] ) )
+	continue;
+
+      unsigned lineNo = 0;
+      std::istream & is( openAt( index, blk, lineNo ) );
+      off_t pos = ( index.valid() ? ( tail ? index.indexedSize() : blocks[blk].offset ) : 0 );
+      off_t end = ( tail ? -1 : index.blockEnd( blk ) );
+
+      for ( iostr::EachLine line( is, lineNo ); line; line.next(), pd.tick() )
+      {
+	const std::string & s = *line;
+	if ( end >= 0 )
+	{
+	  if ( pos >= end )
+	    break;
+	  pos += s.size() + 1;
+	}
+
+	// ignore comments
+	if ( s[0] == '#' || ! line_r( s ) )
+	  continue;
+
+	if ( ! parseLine( s, line.lineNo() ) )
+	{
+	  pd.toMax();
+	  return;	// requested by consumer callback
+	}
+      }
+    }
+
+    pd.toMax();
+  }
+
+  namespace
+  {
+    /** Field \a idx_r of history \a line_r; just for filtering, so no unescaping. */
+    inline std::string rawField( const std::string & line_r, unsigned idx_r )
+    {
+      std::string::size_type beg = 0;
+      for ( ; idx_r; --idx_r )
+      {
+	beg = line_r.find( '|', beg );
+	if ( beg == std::string::npos )
+	  return std::string();
+	++beg;
+      }
+      std::string::size_type end = line_r.find( '|', beg );
+      return line_r.substr( beg, end == std::string::npos ? end : end - beg );
+    }
+
+    inline HistoryActionID rawAction( const std::string & line_r )
+    { return HistoryActionID( str::trim( rawField( line_r, 1 ) ) ); }
+  } // namespace
+
+  void HistoryLogReader::Impl::readAction( const HistoryActionID & action_r, const ProgressData::ReceiverFnc & progress_r )
+  {
+    readMatching( [&action_r]( const HistoryLogIndex::Block & block_r )->bool {
+		    return block_r.mayContain( action_r );
+		  },
+		  [&action_r]( const std::string & line_r )->bool {
+		    return rawAction( line_r ) == action_r;
+		  },
+		  progress_r );
+  }
+
+  void HistoryLogReader::Impl::readPackage( const std::string & name_r, const ProgressData::ReceiverFnc & progress_r )
+  {
+    readMatching( [&name_r]( const HistoryLogIndex::Block & block_r )->bool {
+		    return block_r.mayContain( name_r );
+		  },
+		  [&name_r]( const std::string & line_r )->bool {
+		    if ( rawField( line_r, 2 ) != name_r )
+		      return false;
+		    HistoryActionID action( rawAction( line_r ) );
+		    return action == HistoryActionID::INSTALL || action == HistoryActionID::REMOVE;
+		  },
+		  progress_r );
+  }
+
   /////////////////////////////////////////////////////////////////////
   //
   //	class HistoryLogReader
@@ -218,6 +371,12 @@ namespace zypp
   void HistoryLogReader::readFromTo( const Date & fromDate_r, const Date & toDate_r, const ProgressData::ReceiverFnc & progress_r )
   { _pimpl->readFromTo( fromDate_r, toDate_r, progress_r ); }
 
+  void HistoryLogReader::readAction( const HistoryActionID & action_r, const ProgressData::ReceiverFnc & progress_r )
+  { _pimpl->readAction( action_r, progress_r ); }
+
+  void HistoryLogReader::readPackage( const std::string & name_r, const ProgressData::ReceiverFnc & progress_r )
+  { _pimpl->readPackage( name_r, progress_r ); }
+
   } // namespace parser
   ///////////////////////////////////////////////////////////////////
 } // namespace zypp
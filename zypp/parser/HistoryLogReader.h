@@ -62,6 +62,9 @@ namespace zypp
   /// \endcode
   /// \see \ref HistoryLogData for how to access the individual data fields.
   ///
+  /// \ref readFrom, \ref readFromTo, \ref readAction and \ref readPackage
+  /// use a \ref HistoryLogIndex to skip the parts of the file not of interest.
+  ///
   ///////////////////////////////////////////////////////////////////
   class HistoryLogReader
   {
@@ -125,6 +128,22 @@ namespace zypp
      */
     void readFromTo( const Date & fromDate, const Date & toDate, const ProgressData::ReceiverFnc & progress = ProgressData::ReceiverFnc() );
 
+    /**
+     * Read all log entries of action \a action.
+     *
+     * \param action   The \ref HistoryActionID to look for.
+     * \param progress An optional progress data receiver function.
+     */
+    void readAction( const HistoryActionID & action, const ProgressData::ReceiverFnc & progress = ProgressData::ReceiverFnc() );
+
+    /**
+     * Read all install and remove entries of package \a name.
+     *
+     * \param name     The package name to look for.
+     * \param progress An optional progress data receiver function.
+     */
+    void readPackage( const std::string & name, const ProgressData::ReceiverFnc & progress = ProgressData::ReceiverFnc() );
+
     /**
      * Set the reader to ignore invalid log entries and continue with the rest.
      *
@@ -376,6 +376,16 @@ namespace zypp
 	  return _id2item;
 	}
 
+        /** Build the \ref PoolItem store and indices and freeze the sat pool.
+         * \see \ref ResPool::freeze
+         */
+        void freeze() const
+        {
+          store();
+          id2item();
+          satpool().freeze();
+        }
+
         ///////////////////////////////////////////////////////////////////
         //
         ///////////////////////////////////////////////////////////////////
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <sstream>
 #include "zypp/repo/PackageDelta.h"
+#include "zypp/repo/PackageStore.h"
 #include "zypp/base/Logger.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/UserRequestException.h"
@@ -288,7 +289,7 @@ namespace zypp
 	  if ( ! loc.checksum().empty() )	// no cache hit without checksum
 	  {
 	    PathInfo pi( topCache.repoPackagesCachePath / info.packagesPath().basename() / loc.filename() );
-	    if ( pi.isExist() && loc.checksum() == CheckSum( loc.checksum().type(), std::ifstream( pi.c_str() ) ) )
+	    if ( pi.isExist() && filesystem::is_checksum( pi.path(), loc.checksum() ) )
 	    {
 	      report()->start( _package, pi.path().asFileUrl() );
 	      const Pathname & dest( info.packagesPath() / loc.filename() );
@@ -307,6 +308,47 @@ namespace zypp
 	}
       }
 
+      // Check the package store shared by all repos
+      {
+	const OnMediaLocation & loc( _package->location() );
+	PackageStore store;
+	if ( store.contains( loc.checksum() ) )
+	{
+	  report()->start( _package, store.storePath( loc.checksum() ).asFileUrl() );
+	  const Pathname & dest( info.packagesPath() / loc.filename() );
+	  if ( store.provide( loc.checksum(), dest ) )
+	  {
+	    ret = ManagedFile( dest );
+	    if ( ! info.keepPackages() )
+	      ret.setDispose( filesystem::unlink );
+
+	    // The store is shared by repos with different gpgcheck settings and keys.
+	    // A stored package replaces the download only if its signature is OK for
+	    // this repo; otherwise it is downloaded and checked (and reported) as usual.
+	    bool sigOk = true;
+	    if ( info.pkgGpgCheck() )
+	    {
+	      UserData userData( "pkgGpgCheck" );
+	      userData.set( "Package", _package );
+	      userData.set( "Localpath", ret.value() );
+	      sigOk = ( packageSigCheck( ret, userData ) == RpmDb::CHK_OK );
+	      if ( sigOk )
+		report()->pkgGpgCheck( userData );
+	    }
+
+	    if ( sigOk )
+	    {
+	      MIL << "provided Package from " << store << " " << _package << " at " << ret << endl;
+	      report()->finish( _package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
+	      return ret; // <-- package store hit
+	    }
+	    WAR << "Not using " << _package << " from " << store << ": signature check failed" << endl;
+	    ret.setDispose( filesystem::unlink );
+	    ret.reset();
+	  }
+	}
+      }
+
       // FIXME we only support the first url for now.
       if ( info.baseUrlsEmpty() )
         ZYPP_THROW(Exception("No url in repository."));
@@ -405,6 +447,10 @@ namespace zypp
           }
       } while ( _retry );
 
+      // Kept packages are shared with other repos providing the same file
+      if ( info.keepPackages() )
+	PackageStore().insert( ret, _package->location().checksum() );
+
       report()->finish( _package, repo::DownloadResolvableReport::NO_ERROR, std::string() );
       MIL << "provided Package " << _package << " at " << ret << endl;
       return ret;
@@ -0,0 +1,220 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PackageStore.cc
+ *
+*/
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cctype>
+#include <iostream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+#include "zypp/RepoManager.h"
+
+#include "zypp/repo/PackageStore.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Temporary name next to \a path_r, used to replace files atomically. */
+      inline Pathname tmpName( const Pathname & path_r )
+      { return path_r.extend( str::form( ".%d.tmp", ::getpid() ) ); }
+
+      /** Try to reflink \a oldpath_r to \a newpath_r (\c FICLONE). */
+      bool cloneFile( const Pathname & oldpath_r, const Pathname & newpath_r )
+      {
+#ifdef FICLONE
+	AutoDispose<int> src( ::open( oldpath_r.c_str(), O_RDONLY|O_CLOEXEC ), ::close );
+	if ( src < 0 )
+	{
+	  src.resetDispose();
+	  return false;
+	}
+	AutoDispose<int> dst( ::open( newpath_r.c_str(), O_WRONLY|O_CREAT|O_EXCL|O_CLOEXEC, 0644 ), ::close );
+	if ( dst < 0 )
+	{
+	  dst.resetDispose();
+	  return false;
+	}
+	if ( ::ioctl( dst, FICLONE, (int)src ) == 0 )
+	  return true;
+	dst.reset();
+	filesystem::unlink( newpath_r );
+#endif
+	return false;
+      }
+
+      /** Hardlink, reflink or copy \a oldpath_r to \a newpath_r, replacing it atomically. */
+      bool linkFile( const Pathname & oldpath_r, const Pathname & newpath_r )
+      {
+	Pathname tmp( tmpName( newpath_r ) );
+	filesystem::unlink( tmp );
+	if ( ::link( oldpath_r.c_str(), tmp.c_str() ) != 0 )
+	{
+	  int err = errno;
+	  if ( ( err != EXDEV && err != EPERM ) || ! ( cloneFile( oldpath_r, tmp ) || filesystem::copy( oldpath_r, tmp ) == 0 ) )
+	  {
+	    WAR << "Can't link " << oldpath_r << " -> " << newpath_r << ": " << str::strerror( err ) << endl;
+	    filesystem::unlink( tmp );
+	    return false;
+	  }
+	}
+	if ( filesystem::rename( tmp, newpath_r ) != 0 )
+	{
+	  filesystem::unlink( tmp );
+	  return false;
+	}
+	return true;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    PackageStore::PackageStore()
+    : _root( defaultRoot( RepoManagerOptions().repoPackagesCachePath ) )
+    {}
+
+    PackageStore::PackageStore( const Pathname & root_r )
+    : _root( root_r )
+    {}
+
+    Pathname PackageStore::storePath( const CheckSum & checksum_r ) const
+    {
+      std::string sum( str::toLower( checksum_r.checksum() ) );
+      if ( checksum_r.empty() || sum.size() < 8 )
+	return Pathname();
+      for ( char ch : sum )
+      {
+	if ( ! ::isxdigit( (unsigned char)ch ) )
+	  return Pathname();
+      }
+      return _root / checksum_r.type() / sum.substr( 0, 2 ) / sum;
+    }
+
+    bool PackageStore::contains( const CheckSum & checksum_r ) const
+    {
+      Pathname path( storePath( checksum_r ) );
+      return ! path.empty() && PathInfo( path ).isFile();
+    }
+
+    bool PackageStore::provide( const CheckSum & checksum_r, const Pathname & dest_r ) const
+    {
+      Pathname path( storePath( checksum_r ) );
+      if ( path.empty() || ! PathInfo( path ).isFile() )
+	return false;
+
+      if ( ! filesystem::is_checksum( path, checksum_r ) )
+      {
+	WAR << "Removing corrupt stored package " << path << endl;
+	filesystem::unlink( path );
+	return false;
+      }
+
+      PathInfo dest( dest_r );
+      if ( dest.isFile() && dest.ino() == PathInfo( path ).ino() && dest.dev() == PathInfo( path ).dev() )
+	return true;	// already linked
+
+      if ( filesystem::assert_dir( dest_r.dirname() ) != 0 || ! linkFile( path, dest_r ) )
+	return false;
+
+      DBG << "Provided " << dest_r << " from " << path << endl;
+      return true;
+    }
+
+    bool PackageStore::insert( const Pathname & file_r, const CheckSum & checksum_r ) const
+    {
+      Pathname path( storePath( checksum_r ) );
+      PathInfo file( file_r );
+      if ( path.empty() || ! file.isFile() )
+	return false;
+
+      PathInfo stored( path );
+      if ( stored.isFile() && stored.ino() == file.ino() && stored.dev() == file.dev() )
+	return true;	// already linked
+
+      if ( ! filesystem::is_checksum( file_r, checksum_r ) )
+      {
+	WAR << "Not storing " << file_r << ": checksum mismatch" << endl;
+	return false;
+      }
+
+      if ( stored.isFile() )
+      {
+	// same content stored: keep just one copy
+	return filesystem::is_checksum( path, checksum_r ) && linkFile( path, file_r );
+      }
+
+      if ( filesystem::assert_dir( path.dirname() ) != 0 )
+	return false;
+
+      // no copies into the store; only link if on the same filesystem
+      Pathname tmp( tmpName( path ) );
+      if ( ::link( file_r.c_str(), tmp.c_str() ) != 0 )
+      {
+	DBG << "Not storing " << file_r << ": " << str::strerror( errno ) << endl;
+	return false;
+      }
+      if ( filesystem::rename( tmp, path ) != 0 )
+      {
+	filesystem::unlink( tmp );
+	return false;
+      }
+      DBG << "Stored " << file_r << " as " << path << endl;
+      return true;
+    }
+
+    unsigned PackageStore::collectGarbage() const
+    {
+      unsigned removed = 0;
+      if ( ! PathInfo( _root ).isDir() )
+	return removed;
+
+      // root/<type>/<xx>/<checksum>
+      filesystem::dirForEach( _root, [&removed]( const Pathname & root_r, const char *const type_r )->bool
+      {
+	filesystem::dirForEach( root_r / type_r, [&removed]( const Pathname & typedir_r, const char *const bucket_r )->bool
+	{
+	  Pathname bucket( typedir_r / bucket_r );
+	  filesystem::dirForEach( bucket, [&removed]( const Pathname & bucketdir_r, const char *const name_r )->bool
+	  {
+	    PathInfo pi( bucketdir_r / name_r, PathInfo::LSTAT );
+	    if ( pi.isFile() && pi.nlink() <= 1 && filesystem::unlink( pi.path() ) == 0 )
+	      ++removed;
+	    return true;
+	  } );
+	  filesystem::rmdir( bucket );	// fails unless empty
+	  return true;
+	} );
+	return true;
+      } );
+
+      MIL << "Removed " << removed << " unreferenced packages from " << *this << endl;
+      return removed;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PackageStore & obj )
+    { return str << "PackageStore(" << obj.root() << ")"; }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,100 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PackageStore.h
+ *
+*/
+#ifndef ZYPP_REPO_PACKAGESTORE_H
+#define ZYPP_REPO_PACKAGESTORE_H
+
+#include <iosfwd>
+
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PackageStore
+    /// \brief Content addressed store shared by the repos package caches.
+    ///
+    /// Packages are stored once per checksum as
+    /// <tt>root/<type>/<2 hex digits>/<checksum></tt> and hardlinked into
+    /// the repos \ref RepoInfo::packagesPath. Identical packages reachable
+    /// via several repos (update and pool mirrors, modules,...) are thus
+    /// downloaded and kept on disk just once.
+    ///
+    /// The link count of a stored file tells whether it is still referenced
+    /// by a package cache. \ref collectGarbage removes the files no longer
+    /// referenced.
+    ///
+    /// If a hardlink can not be created, a reflink (\c FICLONE) and finally a
+    /// plain copy is tried when providing a stored package. Packages are not
+    /// stored if the repo cache is not on the same filesystem as the store.
+    ///
+    /// The store just matches checksums. The \ref PackageProvider still checks
+    /// the signature of a stored package, if the requesting repo wants it.
+    ///////////////////////////////////////////////////////////////////
+    class PackageStore
+    {
+    public:
+      /** The store below the toplevel packages cache (\ref RepoManagerOptions::repoPackagesCachePath). */
+      PackageStore();
+
+      /** The store located at \a root_r. */
+      explicit PackageStore( const Pathname & root_r );
+
+      /** The stores location below a packages cache directory. */
+      static Pathname defaultRoot( const Pathname & packagesCachePath_r )
+      { return packagesCachePath_r / ".store"; }
+
+    public:
+      /** The stores root directory. */
+      const Pathname & root() const
+      { return _root; }
+
+      /** Where a package with \a checksum_r is stored (empty if \a checksum_r is not usable). */
+      Pathname storePath( const CheckSum & checksum_r ) const;
+
+      /** Whether a package with \a checksum_r is stored. */
+      bool contains( const CheckSum & checksum_r ) const;
+
+      /** Link the stored package with \a checksum_r to \a dest_r.
+       * Returns \c false if there is no such package (or it turns out to be
+       * corrupt) or \a dest_r can not be created.
+       */
+      bool provide( const CheckSum & checksum_r, const Pathname & dest_r ) const;
+
+      /** Remember \a file_r in the store.
+       * \a file_r is stored only if it matches \a checksum_r. If a package with
+       * \a checksum_r is already stored, \a file_r is replaced by a link to it.
+       * Returns whether \a file_r is linked to the store afterwards.
+       */
+      bool insert( const Pathname & file_r, const CheckSum & checksum_r ) const;
+
+      /** Remove stored packages no longer referenced by any package cache.
+       * Returns the number of packages removed.
+       */
+      unsigned collectGarbage() const;
+
+    private:
+      Pathname _root;
+    };
+
+    /** \relates PackageStore Stream output */
+    std::ostream & operator<<( std::ostream & str, const PackageStore & obj );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_PACKAGESTORE_H
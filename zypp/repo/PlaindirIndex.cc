@@ -0,0 +1,418 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PlaindirIndex.cc
+ *
+*/
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
+#include <solv/repo_rpmdb.h>
+#include <solv/repo_autopattern.h>
+#include <solv/solvable.h>
+#include <solv/knownid.h>
+}
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/base/Errno.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+#include "zypp/sat/detail/PoolMember.h"
+#include "zypp/repo/RepoException.h"
+
+#include "zypp/repo/PlaindirIndex.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      using sat::detail::CPool;
+      using sat::detail::CRepo;
+
+      const std::string cacheMagic( "#plaindir-rpms 1" );
+
+      /** What tells whether a package changed. */
+      struct FileKey
+      {
+	FileKey()
+	: ino( 0 ), size( 0 ), mtime( 0 )
+	{}
+	FileKey( const struct stat & st_r )
+	: ino( st_r.st_ino ), size( st_r.st_size ), mtime( st_r.st_mtime )
+	{}
+
+	bool operator==( const FileKey & rhs ) const
+	{ return ino == rhs.ino && size == rhs.size && mtime == rhs.mtime; }
+
+	unsigned long long ino;
+	long long size;
+	long long mtime;
+      };
+
+      /** Packages by path relative to the repo directory. */
+      typedef std::map<std::string,FileKey> FileMap;
+
+      /** As repo2solv: any \c *.rpm except for delta and patch rpms. */
+      inline bool isPackage( const std::string & name_r )
+      { return str::hasSuffix( name_r, ".rpm" ) && ! str::hasSuffix( name_r, ".delta.rpm" ) && ! str::hasSuffix( name_r, ".patch.rpm" ); }
+
+      /** Collect the packages below \a dir_r / \a rel_r.
+       * Only directories, symlinks and package files are stat'ed. Symlinked
+       * directories are followed, but each directory is visited just once.
+       * As repo2solv, hidden files and directories are skipped.
+       */
+      void scanDir( const Pathname & dir_r, const std::string & rel_r, FileMap & files_r, std::set<std::pair<dev_t,ino_t>> & visited_r )
+      {
+	AutoDispose<DIR *> dir( ::opendir( ( dir_r / rel_r ).c_str() ),
+				[]( DIR * dir_r ) { if ( dir_r ) ::closedir( dir_r ); } );
+	if ( ! dir )
+	{
+	  WAR << "Can't read " << dir_r / rel_r << ": " << Errno() << endl;
+	  return;
+	}
+
+	for ( struct dirent * entry = ::readdir( dir ); entry; entry = ::readdir( dir ) )
+	{
+	  const char * name = entry->d_name;
+	  if ( name[0] == '.' )
+	    continue; // omitt ., .. and hidden entries
+	  if ( ::strchr( name, '\n' ) )
+	    continue; // can't be remembered in the cache file
+	  if ( entry->d_type == DT_REG && ! isPackage( name ) )
+	    continue; // no need to stat it
+
+	  std::string rel( rel_r.empty() ? std::string( name ) : rel_r + "/" + name );
+	  struct stat st;
+	  if ( ::stat( ( dir_r / rel ).c_str(), &st ) != 0 )
+	    continue; // e.g. dangling symlink
+	  if ( S_ISDIR( st.st_mode ) )
+	  {
+	    if ( visited_r.insert( std::make_pair( st.st_dev, st.st_ino ) ).second )
+	      scanDir( dir_r, rel, files_r, visited_r );
+	  }
+	  else if ( S_ISREG( st.st_mode ) && isPackage( name ) )
+	    files_r[rel] = FileKey( st );
+	}
+      }
+
+      /** The cache files 1st line, tying it to the solv file it was written for. */
+      std::string cacheHeader( const Pathname & solvfile_r )
+      {
+	struct stat st;
+	if ( ::stat( solvfile_r.c_str(), &st ) != 0 )
+	  return std::string();
+	FileKey key( st );
+	return str::Str() << cacheMagic << ' ' << key.ino << ' ' << key.size << ' ' << key.mtime;
+      }
+
+      /** Read the cache file (empty if it does not belong to \a solvfile_r). */
+      FileMap readCache( const Pathname & solvfile_r )
+      {
+	FileMap ret;
+	Pathname cachefile( PlaindirIndex::cacheFile( solvfile_r ) );
+	std::ifstream in( cachefile.c_str() );
+	std::string line;
+	if ( ! in || ! std::getline( in, line ) )
+	  return ret;
+	if ( line.empty() || line != cacheHeader( solvfile_r ) )
+	{
+	  MIL << cachefile << " does not belong to " << solvfile_r << endl;
+	  return ret;
+	}
+
+	while ( std::getline( in, line ) )
+	{
+	  // ino size mtime relpath
+	  std::istringstream str( line );
+	  FileKey key;
+	  std::string rel;
+	  if ( str >> key.ino >> key.size >> key.mtime && str.get() == ' ' && std::getline( str, rel ) && ! rel.empty() )
+	    ret[rel] = key;
+	}
+	return ret;
+      }
+
+      /** Write the cache file for \a solvfile_r. */
+      bool writeCache( const Pathname & solvfile_r, const FileMap & files_r )
+      {
+	Pathname cachefile( PlaindirIndex::cacheFile( solvfile_r ) );
+	Pathname tmpfile( cachefile.extend( ".new" ) );
+	{
+	  std::ofstream out( tmpfile.c_str() );
+	  out << cacheHeader( solvfile_r ) << endl;
+	  for ( const auto & file : files_r )
+	    out << file.second.ino << ' ' << file.second.size << ' ' << file.second.mtime << ' ' << file.first << endl;
+	  if ( ! out )
+	  {
+	    filesystem::unlink( tmpfile );
+	    return false;
+	  }
+	}
+	return filesystem::rename( tmpfile, cachefile ) == 0;
+      }
+
+      /** Load \a solvfile_r into \a repo_r, but keep just the solvables of unchanged packages.
+       * A package is unchanged if it is remembered in \a cached_r with the same
+       * key as in \a files_r. Solvables without location (autopatterns) are
+       * dropped as well. The locations of the kept packages are collected in
+       * \a kept_r.
+       */
+      void loadUnchanged( CRepo * repo_r, const Pathname & solvfile_r, const FileMap & cached_r, const FileMap & files_r, FileMap & kept_r )
+      {
+	AutoDispose<FILE*> fp( ::fopen( solvfile_r.c_str(), "re" ), ::fclose );
+	if ( fp == NULL )
+	{
+	  fp.resetDispose();
+	  return;
+	}
+	if ( ::repo_add_solv( repo_r, fp, 0 ) != 0 )
+	{
+	  WAR << "Can't read " << solvfile_r << ": " << ::pool_errstr( repo_r->pool ) << endl;
+	  ::repo_empty( repo_r, 0 );
+	  return;
+	}
+
+	Id p;
+	::Solvable * s;
+	FOR_REPO_SOLVABLES( repo_r, p, s )
+	{
+	  unsigned medianr;
+	  const char * loc = ::solvable_get_location( s, &medianr );
+	  if ( loc )
+	  {
+	    FileMap::const_iterator cached( cached_r.find( loc ) );
+	    FileMap::const_iterator file( files_r.find( loc ) );
+	    if ( cached != cached_r.end() && file != files_r.end() && cached->second == file->second
+	      && kept_r.insert( *file ).second )
+	      continue;
+	  }
+	  ::repo_free_solvable_block( repo_r, p, 1, 0 );
+	}
+      }
+
+      /** Packages read by one thread, written as solv data. */
+      struct Chunk
+      {
+	std::string solv;
+	std::vector<size_t> parsed;	// indices into the todo list
+	std::vector<std::pair<size_t,std::string>> failed;
+      };
+
+      /** Read the packages handed out by \a next_r into a private pool and store them in \a chunk_r.
+       * This must not touch anything but the private pool, as it runs in
+       * parallel to others (no logging).
+       */
+      template <class TNext>
+      void readPackages( const Pathname & dir_r, const std::vector<std::string> & todo_r, TNext next_r, Chunk & chunk_r )
+      {
+	AutoDispose<CPool *> pool( ::pool_create(), ::pool_free );
+	CRepo * repo = ::repo_create( pool, "" );
+	::Repodata * data = ::repo_add_repodata( repo, 0 );
+
+	for ( size_t idx = next_r(); idx < todo_r.size(); idx = next_r() )
+	{
+	  Id p = ::repo_add_rpm( repo, ( dir_r / todo_r[idx] ).c_str(), REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE|REPO_NO_LOCATION );
+	  if ( ! p )
+	  {
+	    chunk_r.failed.push_back( std::make_pair( idx, std::string( ::pool_errstr( pool ) ) ) );
+	    continue;
+	  }
+	  ::repodata_set_location( data, p, 0, 0, todo_r[idx].c_str() );
+	  chunk_r.parsed.push_back( idx );
+	}
+	if ( chunk_r.parsed.empty() )
+	  return;
+	::repo_internalize( repo );
+
+	char * buf = 0;
+	size_t len = 0;
+	FILE * fp = ::open_memstream( &buf, &len );
+	if ( ! fp )
+	  return;
+	int ret = ::repo_write( repo, fp );
+	::fclose( fp );
+	if ( ret == 0 )
+	  chunk_r.solv.assign( buf, len );
+	::free( buf );
+      }
+
+      /** Read the \a todo_r packages below \a dir_r.
+       * The packages are read in parallel, each thread producing one chunk.
+       */
+      std::vector<Chunk> readPackages( const Pathname & dir_r, const std::vector<std::string> & todo_r )
+      {
+	unsigned nworkers = std::thread::hardware_concurrency();
+	if ( nworkers > todo_r.size() )
+	  nworkers = todo_r.size();
+	if ( nworkers > 1 )
+	{
+	  std::vector<Chunk> ret( nworkers );
+	  std::atomic<size_t> next( 0 );
+	  std::vector<std::thread> workers;
+	  for ( unsigned i = 0; i < nworkers; ++i )
+	    workers.push_back( std::thread( [&,i]() { readPackages( dir_r, todo_r, [&next]() { return next++; }, ret[i] ); } ) );
+	  for ( auto & t : workers )
+	    t.join();
+	  return ret;
+	}
+	std::vector<Chunk> ret( 1 );
+	size_t next = 0;
+	readPackages( dir_r, todo_r, [&next]() { return next++; }, ret[0] );
+	return ret;
+      }
+
+      /** Write \a repo_r to \a solvfile_r, replacing it atomically. */
+      bool writeSolv( CRepo * repo_r, const Pathname & solvfile_r )
+      {
+	// Set the toolversion like the repo2* tools do: RepoManager
+	// rebuilds a solv file that has none.
+	::Repodata * meta = ::repo_add_repodata( repo_r, 0 );
+	::repodata_set_str( meta, SOLVID_META, REPOSITORY_TOOLVERSION, "1.0" );
+	::repodata_internalize( meta );
+
+	Pathname tmpfile( solvfile_r.extend( ".new" ) );
+	int ret = -1;
+	{
+	  AutoDispose<FILE*> fp( ::fopen( tmpfile.c_str(), "we" ), ::fclose );
+	  if ( fp == NULL )
+	  {
+	    fp.resetDispose();
+	    ERR << "Can't open " << tmpfile << ": " << Errno() << endl;
+	    return false;
+	  }
+	  ret = ::repo_write( repo_r, fp );
+	  if ( ::fflush( fp ) != 0 )
+	    ret = -1;
+	}
+	if ( ret != 0 || filesystem::rename( tmpfile, solvfile_r ) != 0 )
+	{
+	  ERR << "Can't write " << solvfile_r << endl;
+	  filesystem::unlink( tmpfile );
+	  return false;
+	}
+	return true;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    PlaindirIndex::PlaindirIndex( const Pathname & dir_r, const Pathname & solvfile_r )
+    : _dir( dir_r )
+    , _solvfile( solvfile_r )
+    , _packages( 0 )
+    , _reused( 0 )
+    , _parsed( 0 )
+    , _failed( 0 )
+    {}
+
+    void PlaindirIndex::update()
+    {
+      _packages = _reused = _parsed = _failed = 0;
+
+      FileMap files;
+      {
+	std::set<std::pair<dev_t,ino_t>> visited;
+	struct stat st;
+	if ( ::stat( _dir.c_str(), &st ) == 0 )
+	  visited.insert( std::make_pair( st.st_dev, st.st_ino ) );
+	scanDir( _dir, std::string(), files, visited );
+      }
+      _packages = files.size();
+
+      AutoDispose<CPool *> pool( ::pool_create(), ::pool_free );
+      CRepo * repo = ::repo_create( pool, "" );
+
+      FileMap indexed;	// what the new solv file will contain
+      {
+	FileMap cached( readCache( _solvfile ) );
+	if ( ! cached.empty() )
+	  loadUnchanged( repo, _solvfile, cached, files, indexed );
+      }
+      _reused = indexed.size();
+
+      std::vector<std::string> todo;
+      for ( const auto & file : files )
+      {
+	if ( indexed.find( file.first ) == indexed.end() )
+	  todo.push_back( file.first );
+      }
+      MIL << "Indexing " << _dir << ": " << _packages << " packages, " << _reused << " unchanged, " << todo.size() << " to read" << endl;
+
+      if ( ! todo.empty() )
+      {
+	for ( Chunk & chunk : readPackages( _dir, todo ) )
+	{
+	  for ( const auto & fail : chunk.failed )
+	    WAR << "Can't read " << _dir / todo[fail.first] << ": " << fail.second << endl;
+	  _failed += chunk.failed.size();
+	  if ( chunk.parsed.empty() )
+	    continue;
+
+	  AutoDispose<FILE*> fp( ::fmemopen( &chunk.solv[0], chunk.solv.size(), "r" ), ::fclose );
+	  if ( chunk.solv.empty() || fp == NULL || ::repo_add_solv( repo, fp, 0 ) != 0 )
+	  {
+	    if ( fp == NULL )
+	      fp.resetDispose();
+	    ERR << "Can't add " << chunk.parsed.size() << " packages read from " << _dir << endl;
+	    _failed += chunk.parsed.size();
+	    continue;
+	  }
+	  for ( size_t idx : chunk.parsed )
+	    indexed[todo[idx]] = files[todo[idx]];
+	  _parsed += chunk.parsed.size();
+	}
+      }
+
+      ::repo_add_autopattern( repo, 0 );	// repo2solv -X
+
+      if ( ! writeSolv( repo, _solvfile ) )
+	ZYPP_THROW( RepoException( str::Str() << "Can't write " << _solvfile ) );
+      if ( ! writeCache( _solvfile, indexed ) )
+      {
+	// without cache the next update reads all packages again
+	WAR << "Can't write " << cacheFile( _solvfile ) << endl;
+	filesystem::unlink( cacheFile( _solvfile ) );
+      }
+      MIL << *this << endl;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PlaindirIndex & obj )
+    {
+      return str << "PlaindirIndex(" << obj.dir() << " -> " << obj.solvfile() << ": "
+                 << obj.packages() << " packages, " << obj.reused() << " reused, "
+                 << obj.parsed() << " read, " << obj.failed() << " failed)";
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/PlaindirIndex.h
+ *
+*/
+#ifndef ZYPP_REPO_PLAINDIRINDEX_H
+#define ZYPP_REPO_PLAINDIRINDEX_H
+
+#include <iosfwd>
+
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PlaindirIndex
+    /// \brief Build the solv file of a \ref RepoType::RPMPLAINDIR repo.
+    ///
+    /// Replaces <tt>repo2solv.sh -X -R</tt> for plaindir repos. All \c *.rpm
+    /// files below the directory are indexed and their location is stored
+    /// relative to it. Pattern packages are turned into patterns (\c -X).
+    ///
+    /// Next to the solv file a \ref cacheFile remembers the inode, size and
+    /// mtime of each indexed package. On \ref update the solvables of
+    /// unchanged packages are taken from the existing solv file; only new or
+    /// changed packages are read. If the cache file does not match the solv
+    /// file, everything is read again.
+    ///
+    /// The package headers are read in parallel, one thread per core, each
+    /// using a private libsolv pool.
+    ///
+    /// \code
+    ///   repo::PlaindirIndex index( "/srv/rpms", solvdir/"solv" );
+    ///   index.update();
+    ///   MIL << index << endl;
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class PlaindirIndex
+    {
+    public:
+      /** Index the packages below \a dir_r into \a solvfile_r. */
+      PlaindirIndex( const Pathname & dir_r, const Pathname & solvfile_r );
+
+      /** The cache file kept next to \a solvfile_r. */
+      static Pathname cacheFile( const Pathname & solvfile_r )
+      { return solvfile_r.extend( ".rpms" ); }
+
+    public:
+      /** Scan the directory and (re)write the solv file and its cache.
+       * \throws Exception if the solv file can not be written.
+       */
+      void update();
+
+    public:
+      /** The indexed directory. */
+      const Pathname & dir() const
+      { return _dir; }
+
+      /** The solv file. */
+      const Pathname & solvfile() const
+      { return _solvfile; }
+
+      /** Number of packages found by the last \ref update. */
+      unsigned packages() const
+      { return _packages; }
+
+      /** Number of packages taken from the existing solv file by the last \ref update. */
+      unsigned reused() const
+      { return _reused; }
+
+      /** Number of packages read by the last \ref update. */
+      unsigned parsed() const
+      { return _parsed; }
+
+      /** Number of packages that could not be read by the last \ref update. */
+      unsigned failed() const
+      { return _failed; }
+
+    private:
+      Pathname _dir;
+      Pathname _solvfile;
+      unsigned _packages;
+      unsigned _reused;
+      unsigned _parsed;
+      unsigned _failed;
+    };
+
+    /** \relates PlaindirIndex Stream output */
+    std::ostream & operator<<( std::ostream & str, const PlaindirIndex & obj );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_PLAINDIRINDEX_H
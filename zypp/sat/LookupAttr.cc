@@ -580,6 +580,22 @@ namespace zypp
     { return asInt(); }
 
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** No new ids are added while concurrent readers hold the pool. */
+      inline detail::IdType globalizeId( const detail::DIWrap & dip_r )
+      { return ::repodata_globalize_id( dip_r->data, dip_r->kv.id, /*create*/! detail::PoolMember::myPool().readOnly() ); }
+
+      /** Stringified checksum, built in the pools tmpspace. */
+      inline std::string chk2str( const detail::DIWrap & dip_r, detail::IdType type_r )
+      {
+        auto lock( detail::PoolMember::myPool().tmpspaceLock() );
+        return ::repodata_chk2str( dip_r->data, type_r, (unsigned char *)dip_r->kv.str );
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     const char * LookupAttr::iterator::c_str() const
     {
       if ( _dip )
@@ -601,9 +617,12 @@ namespace zypp
 
           case REPOKEY_TYPE_DIRSTRARRAY:
 	    // may or may not be stringified depending on SEARCH_FILES flag
-            return( _dip->flags & SEARCH_FILES
-		    ? _dip->kv.str
-		    : ::repodata_dir2str( _dip->data, _dip->kv.id, _dip->kv.str ) );
+            if ( _dip->flags & SEARCH_FILES )
+              return _dip->kv.str;
+            {
+              auto lock( detail::PoolMember::myPool().tmpspaceLock() );
+              return ::repodata_dir2str( _dip->data, _dip->kv.id, _dip->kv.str );
+            }
             break;
         }
       }
@@ -620,20 +639,30 @@ namespace zypp
           case REPOKEY_TYPE_IDARRAY:
           case REPOKEY_TYPE_CONSTANTID:
             {
-              detail::IdType id = ::repodata_globalize_id( _dip->data, _dip->kv.id, 1 );
+              detail::IdType id = globalizeId( _dip );
               return ISRELDEP(id) ? Capability( id ).asString()
                                   : IdString( id ).asString();
             }
             break;
 
           case REPOKEY_TYPE_STR:
-          case REPOKEY_TYPE_DIRSTRARRAY:
             {
               const char * ret( c_str() );
               return ret ? ret : "";
             }
             break;
 
+          case REPOKEY_TYPE_DIRSTRARRAY:
+            {
+              if ( _dip->flags & SEARCH_FILES )
+                return _dip->kv.str ? _dip->kv.str : "";
+              // copy while holding the lock, the path is built in the pools tmpspace
+              auto lock( detail::PoolMember::myPool().tmpspaceLock() );
+              const char * ret( ::repodata_dir2str( _dip->data, _dip->kv.id, _dip->kv.str ) );
+              return ret ? ret : "";
+            }
+            break;
+
           case REPOKEY_TYPE_U32:
           case REPOKEY_TYPE_NUM:
           case REPOKEY_TYPE_CONSTANT:
@@ -674,7 +703,7 @@ namespace zypp
           case REPOKEY_TYPE_ID:
           case REPOKEY_TYPE_IDARRAY:
           case REPOKEY_TYPE_CONSTANTID:
-            return IdString( ::repodata_globalize_id( _dip->data, _dip->kv.id, 1 ) );
+            return IdString( globalizeId( _dip ) );
             break;
         }
       }
@@ -688,27 +717,27 @@ namespace zypp
         switch ( solvAttrType() )
         {
           case REPOKEY_TYPE_MD5:
-            return CheckSum::md5( ::repodata_chk2str( _dip->data, solvAttrType(), (unsigned char *)_dip->kv.str ) );
+            return CheckSum::md5( chk2str( _dip, solvAttrType() ) );
             break;
 
           case REPOKEY_TYPE_SHA1:
-            return CheckSum::sha1( ::repodata_chk2str( _dip->data, solvAttrType(), (unsigned char *)_dip->kv.str ) );
+            return CheckSum::sha1( chk2str( _dip, solvAttrType() ) );
             break;
 
           case REPOKEY_TYPE_SHA224:
-            return CheckSum::sha224( ::repodata_chk2str( _dip->data, solvAttrType(), (unsigned char *)_dip->kv.str ) );
+            return CheckSum::sha224( chk2str( _dip, solvAttrType() ) );
             break;
 
           case REPOKEY_TYPE_SHA256:
-            return CheckSum::sha256( ::repodata_chk2str( _dip->data, solvAttrType(), (unsigned char *)_dip->kv.str ) );
+            return CheckSum::sha256( chk2str( _dip, solvAttrType() ) );
             break;
 
           case REPOKEY_TYPE_SHA384:
-            return CheckSum::sha384( ::repodata_chk2str( _dip->data, solvAttrType(), (unsigned char *)_dip->kv.str ) );
+            return CheckSum::sha384( chk2str( _dip, solvAttrType() ) );
             break;
 
           case REPOKEY_TYPE_SHA512:
-            return CheckSum::sha512( ::repodata_chk2str( _dip->data, solvAttrType(), (unsigned char *)_dip->kv.str ) );
+            return CheckSum::sha512( chk2str( _dip, solvAttrType() ) );
             break;
         }
       }
@@ -762,7 +791,7 @@ namespace zypp
 
     detail::IdType LookupAttr::iterator::dereference() const
     {
-      return _dip ? ::repodata_globalize_id( _dip->data, _dip->kv.id, 1 )
+      return _dip ? globalizeId( _dip )
                   : detail::noId;
     }
 
@@ -770,6 +799,9 @@ namespace zypp
     {
       if ( _dip )
       {
+	// Matching may stringify files, checksums or dependencies in the pools
+	// tmpspace; dataiterator_strdup copies them before the lock is released.
+	auto lock( detail::PoolMember::myPool().tmpspaceLock() );
 	if ( ! ::dataiterator_step( _dip.get() ) )
 	{
 	  _dip.reset();
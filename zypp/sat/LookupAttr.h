@@ -498,7 +498,11 @@ namespace zypp
         /** \overload */
         unsigned long long asUnsignedLL() const;
 
-        /** Conversion to string types. */
+        /** Conversion to string types.
+         * \note File names may be built in a temporary buffer of the pool.
+         * Concurrent readers of a frozen pool (\ref Pool::freeze) must use
+         * \ref asString.
+         */
         const char * c_str() const;
         /** \overload
          * If used with non-string types, this method tries to create
@@ -58,6 +58,12 @@ namespace zypp
     void Pool::prepare() const
     { return myPool().prepare(); }
 
+    void Pool::freeze() const
+    { myPool().freeze(); }
+
+    bool Pool::frozen() const
+    { return myPool().frozen(); }
+
     Pathname Pool::rootDir() const
     { return myPool().rootDir(); }
 
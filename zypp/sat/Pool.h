@@ -67,6 +67,25 @@ namespace zypp
         /** Update housekeeping data if necessary (e.g. whatprovides). */
         void prepare() const;
 
+        /** Compute all lazily built data, so concurrent readers can access the pool.
+         *
+         * While frozen and a \ref ResPool::ReadGuard is held, readers (\ref Solvable,
+         * \ref Capability, \ref WhatProvides, \ref LookupAttr, ...) don't modify
+         * the pool, so multiple threads may access it at the same time. Any
+         * change to the pool content, the requested locales or the multiversion
+         * spec thaws it again, as does creating new strings or dependencies.
+         *
+         * While a \ref ResPool::ReadGuard is held no new strings or dependencies
+         * are created: an \ref IdString or \ref Capability built from an unknown
+         * string is \c Null. Threads must coordinate so that nobody changes the
+         * pool while others read it. \ref ResPool::ReadGuard and
+         * \ref ResPool::WriteGuard do this for you.
+         */
+        void freeze() const;
+
+        /** Whether the pool is frozen and unchanged since (see \ref freeze). */
+        bool frozen() const;
+
 	/** Get rootdir (for file conflicts check) */
 	Pathname rootDir() const;
 
@@ -0,0 +1,305 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/PoolSnapshot.cc
+ */
+extern "C"
+{
+#include <solv/repo_write.h>
+#include <solv/repodata.h>
+#include <solv/knownid.h>
+#include <solv/solvversion.h>
+}
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+
+#include "zypp/sat/PoolSnapshot.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/detail/PoolImpl.h"
+
+using std::endl;
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::satpool"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** File format:
+       * \code
+       *   ZYPP-POOL-SNAPSHOT 1
+       *   <stamp length>
+       *   <stamp>
+       *   <repo count>
+       *   <offset> <size> <alias>	// per repo; offset relative to the data
+       *   <data>			// the repos solv files
+       * \endcode
+       */
+      const std::string magic( "ZYPP-POOL-SNAPSHOT 1" );
+
+      /** The callers stamp plus the implicit ones. */
+      std::string fullStamp( const std::string & stamp_r )
+      {
+	str::Str ret;
+	ret << "arch " << ZConfig::instance().systemArchitecture() << endl;
+	ret << "libsolv " << ::solv_version << endl;
+	ret << stamp_r;
+	return ret;
+      }
+
+      /** A repo stored in the snapshot. */
+      struct Entry
+      {
+	Entry()
+	: offset( 0 ), size( 0 )
+	{}
+
+	off_t offset;
+	off_t size;
+	std::string alias;
+	std::string data;	// when writing
+      };
+
+      /** Read the snapshot header; \c false if it does not match \a stamp_r. */
+      bool readHeader( const Pathname & file_r, const std::string & stamp_r, std::vector<Entry> & entries_r, off_t & dataStart_r )
+      {
+	std::ifstream in( file_r.c_str() );
+	if ( ! in )
+	  return false;
+
+	std::string line;
+	if ( ! std::getline( in, line ) || line != magic )
+	{
+	  WAR << "Not a pool snapshot: " << file_r << endl;
+	  return false;
+	}
+
+	std::getline( in, line );
+	std::string stamp( str::strtonum<unsigned>( line ), '\0' );
+	if ( ! in.read( &stamp[0], stamp.size() ) || stamp != stamp_r )
+	{
+	  MIL << "Pool snapshot is outdated: " << file_r << endl;
+	  return false;
+	}
+
+	std::getline( in, line );
+	unsigned count = str::strtonum<unsigned>( line );
+	entries_r.resize( count );
+	for ( Entry & entry : entries_r )
+	{
+	  // the alias is the remainder of the line
+	  std::string::size_type sep1 = std::string::npos;
+	  std::string::size_type sep2 = std::string::npos;
+	  if ( std::getline( in, line ) && ( sep1 = line.find( ' ' ) ) != std::string::npos )
+	    sep2 = line.find( ' ', sep1+1 );
+	  if ( sep2 == std::string::npos )
+	  {
+	    WAR << "Broken pool snapshot: " << file_r << endl;
+	    return false;
+	  }
+	  entry.offset = str::strtonum<off_t>( line.substr( 0, sep1 ) );
+	  entry.size   = str::strtonum<off_t>( line.substr( sep1+1, sep2-sep1-1 ) );
+	  entry.alias  = line.substr( sep2+1 );
+	}
+	dataStart_r = in.tellg();
+	return in.good();
+      }
+
+      /** Write \a repo_r together with the \a addedFileProvides_r into \a data_r. */
+      bool writeRepo( detail::CRepo * repo_r, const Queue & addedFileProvides_r, std::string & data_r )
+      {
+	char * buf = 0;
+	size_t len = 0;
+	FILE * fp = ::open_memstream( &buf, &len );
+	if ( ! fp )
+	  return false;
+
+	// temporary repodata holding the meta info
+	::Repodata * meta = ::repo_add_repodata( repo_r, 0 );
+	if ( ! addedFileProvides_r.empty() )
+	  ::repodata_set_idarray( meta, SOLVID_META, REPOSITORY_ADDEDFILEPROVIDES, const_cast<detail::CQueue*>( static_cast<const detail::CQueue*>( addedFileProvides_r ) ) );
+	::repodata_internalize( meta );
+	int ret = ::repo_write( repo_r, fp );
+	::repodata_free( meta );
+
+	::fclose( fp );
+	if ( ret == 0 )
+	  data_r.assign( buf, len );
+	::free( buf );
+	return ret == 0;
+      }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    std::vector<Repository> PoolSnapshot::load( const Pathname & file_r, const std::string & stamp_r )
+    {
+      std::vector<Repository> ret;
+
+      std::vector<Entry> entries;
+      off_t dataStart = 0;
+      if ( ! readHeader( file_r, fullStamp( stamp_r ), entries, dataStart ) )
+	return ret;
+
+      Pool pool( Pool::instance() );
+      for ( const Entry & entry : entries )
+      {
+	if ( pool.reposFind( entry.alias ) )
+	{
+	  MIL << "Pool snapshot not used: repo " << entry.alias << " is already loaded." << endl;
+	  return ret;
+	}
+      }
+
+      AutoDispose<int> fd( ::open( file_r.c_str(), O_RDONLY|O_CLOEXEC ), ::close );
+      struct stat st;
+      if ( fd < 0 || ::fstat( fd, &st ) != 0 )
+      {
+	fd.resetDispose();
+	WAR << "Can't open pool snapshot: " << file_r << endl;
+	return ret;
+      }
+      size_t mapsize = st.st_size;
+      char * base = mapsize ? (char*)::mmap( 0, mapsize, PROT_READ, MAP_PRIVATE, fd, 0 ) : (char*)MAP_FAILED;
+      if ( base == MAP_FAILED )
+      {
+	WAR << "Can't map pool snapshot: " << file_r << endl;
+	return ret;
+      }
+      ::madvise( base, mapsize, MADV_SEQUENTIAL );
+
+      bool ok = true;
+      for ( const Entry & entry : entries )
+      {
+	if ( entry.offset < 0 || entry.size <= 0 || off_t(dataStart + entry.offset + entry.size) > st.st_size )
+	{
+	  ok = false;
+	  break;
+	}
+	// libsolv reads from a FILE*, so wrap the mapped region
+	AutoDispose<FILE*> fp( ::fmemopen( base + dataStart + entry.offset, entry.size, "r" ), ::fclose );
+	if ( fp == NULL )
+	{
+	  fp.resetDispose();
+	  ok = false;
+	  break;
+	}
+	Repository repo( pool.reposInsert( entry.alias ) );
+	ret.push_back( repo );
+	if ( myPool()._addSolv( repo.get(), fp ) != 0 )
+	{
+	  ok = false;
+	  break;
+	}
+      }
+      ::munmap( base, mapsize );
+
+      if ( ! ok )
+      {
+	WAR << "Broken pool snapshot: " << file_r << endl;
+	for ( Repository & repo : ret )
+	  repo.eraseFromPool();
+	ret.clear();
+	filesystem::unlink( file_r );
+	return ret;
+      }
+
+      MIL << "Loaded " << ret.size() << " repos from pool snapshot " << file_r << endl;
+      return ret;
+    }
+
+    bool PoolSnapshot::store( const Pathname & file_r, const std::string & stamp_r )
+    {
+      std::vector<Repository> repos;
+      for ( const Repository & repo : Pool::instance().repos() )
+      {
+	if ( ! repo.isSystemRepo() )
+	  repos.push_back( repo );
+      }
+      return store( file_r, stamp_r, repos );
+    }
+
+    bool PoolSnapshot::store( const Pathname & file_r, const std::string & stamp_r, const std::vector<Repository> & repos_r )
+    {
+      const Queue & addedFileProvides( myPool().addedFileProvides() ); // prepares the pool
+
+      std::vector<Entry> entries;
+      off_t offset = 0;
+      for ( const Repository & repo : repos_r )
+      {
+	if ( ! repo || repo.isSystemRepo() )
+	{
+	  ERR << "Can not store " << repo << " in pool snapshot." << endl;
+	  return false;
+	}
+
+	entries.push_back( Entry() );
+	Entry & entry( entries.back() );
+	if ( ! writeRepo( repo.get(), addedFileProvides, entry.data ) )
+	{
+	  ERR << "Failed to write " << repo << " into pool snapshot." << endl;
+	  return false;
+	}
+	entry.alias  = repo.alias();
+	entry.offset = offset;
+	entry.size   = entry.data.size();
+	offset += entry.size;
+      }
+
+      Pathname tmpfile( file_r.extend( ".new" ) );
+      {
+	std::ofstream out( tmpfile.c_str() );
+	std::string stamp( fullStamp( stamp_r ) );
+	out << magic << endl;
+	out << stamp.size() << endl;
+	out << stamp;
+	out << entries.size() << endl;
+	for ( const Entry & entry : entries )
+	  out << entry.offset << " " << entry.size << " " << entry.alias << endl;
+	for ( const Entry & entry : entries )
+	  out.write( entry.data.data(), entry.data.size() );
+	if ( ! out.flush() )
+	{
+	  ERR << "Failed to write pool snapshot " << tmpfile << endl;
+	  out.close();
+	  filesystem::unlink( tmpfile );
+	  return false;
+	}
+      }
+      if ( filesystem::rename( tmpfile, file_r ) != 0 )
+      {
+	filesystem::unlink( tmpfile );
+	return false;
+      }
+      MIL << "Stored " << entries.size() << " repos in pool snapshot " << file_r << " (" << offset << " bytes)" << endl;
+      return true;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,75 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/PoolSnapshot.h
+ */
+#ifndef ZYPP_SAT_POOLSNAPSHOT_H
+#define ZYPP_SAT_POOLSNAPSHOT_H
+
+#include <string>
+#include <vector>
+
+#include "zypp/Pathname.h"
+#include "zypp/sat/detail/PoolMember.h"
+#include "zypp/Repository.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PoolSnapshot
+    /// \brief Combined snapshot of all repositories loaded into the pool.
+    ///
+    /// \ref store writes all repositories except \c @System into a single
+    /// file, along with the file provides \ref Pool::prepare added to the
+    /// pool. \ref load maps the file once and adds the repositories from it.
+    /// As the stored repos already contain the added file provides, libsolv
+    /// is able to skip scanning their file lists when preparing the pool.
+    ///
+    /// The snapshot is tagged with a caller provided \a stamp_r describing
+    /// the state it was created from (e.g. the rpm database timestamp and the
+    /// repos cache status). A snapshot is used only if the stamp is unchanged.
+    /// Architecture and libsolv version are part of the stamp implicitly.
+    ///
+    /// \note libsolv does not offer a way to store the whatprovides index.
+    /// It is still created when the pool is prepared, but this is cheap
+    /// compared to the file provides scan.
+    ///
+    /// \see \ref misc::defaultLoadSystem with \ref misc::LS_SNAPSHOT
+    ///////////////////////////////////////////////////////////////////
+    class PoolSnapshot : protected detail::PoolMember
+    {
+    public:
+      /** Add the repositories stored in snapshot \a file_r to the pool.
+       * Returns the repos added in the order they were stored. If \a file_r does
+       * not exist, was written with a different \a stamp_r or can not be read,
+       * the pool is left unchanged and an empty vector is returned.
+       */
+      static std::vector<Repository> load( const Pathname & file_r, const std::string & stamp_r );
+
+      /** Store all repositories except \c @System into snapshot \a file_r.
+       * The pool is prepared before. Returns whether the snapshot was written.
+       */
+      static bool store( const Pathname & file_r, const std::string & stamp_r );
+
+      /** Store just \a repos_r into snapshot \a file_r.
+       * Use this if \a stamp_r describes a specific set of repos, so the snapshot
+       * contains exactly what the stamp covers. \c @System can not be stored.
+       */
+      static bool store( const Pathname & file_r, const std::string & stamp_r, const std::vector<Repository> & repos_r );
+    };
+
+    ///////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_POOLSNAPSHOT_H
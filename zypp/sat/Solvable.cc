@@ -134,9 +134,22 @@ namespace zypp
     {
       NO_SOLVABLE_RETURN( std::string() );
       const char * s = 0;
+      // pool_id2langid uses the pools tmpspace
+      auto lock( myPool().tmpspaceLock() );
       if ( !lang_r )
       {
-        s = ::solvable_lookup_str_poollang( _solvable, attr.id() );
+        if ( myPool().readOnly() )
+        {
+          // solvable_lookup_str_poollang fills the pools languagecache on the
+          // fly, so concurrent readers look up the text locales one by one.
+          const detail::CPool * pool( myPool().getPool() );
+          for ( int i = 0; i < pool->nlanguages; ++i )
+            if ( (s = ::solvable_lookup_str_lang( _solvable, attr.id(), pool->languages[i], 0 )) )
+              return s;
+          s = ::solvable_lookup_str( _solvable, attr.id() );
+        }
+        else
+          s = ::solvable_lookup_str_poollang( _solvable, attr.id() );
       }
       else
       {
@@ -171,9 +184,15 @@ namespace zypp
     {
       NO_SOLVABLE_RETURN( CheckSum() );
       detail::IdType chksumtype = 0;
-      const char * s = ::solvable_lookup_checksum( _solvable, attr.id(), &chksumtype );
-      if ( ! s )
-        return CheckSum();
+      std::string s;
+      {
+        // the hex string is built in the pools tmpspace
+        auto lock( myPool().tmpspaceLock() );
+        const char * cs = ::solvable_lookup_checksum( _solvable, attr.id(), &chksumtype );
+        if ( ! cs )
+          return CheckSum();
+        s = cs;
+      }
       switch ( chksumtype )
       {
         case REPOKEY_TYPE_MD5:    return CheckSum::md5( s );
@@ -214,9 +233,15 @@ namespace zypp
       NO_SOLVABLE_RETURN( OnMediaLocation() );
       // medianumber and path
       unsigned medianr;
-      const char * file = ::solvable_lookup_location( _solvable, &medianr );
-      if ( ! file )
-        return OnMediaLocation();
+      std::string file;
+      {
+        // the path may be built in the pools tmpspace
+        auto lock( myPool().tmpspaceLock() );
+        const char * cfile = ::solvable_lookup_location( _solvable, &medianr );
+        if ( ! cfile )
+          return OnMediaLocation();
+        file = cfile;
+      }
       if ( ! medianr )
 	medianr = 1;
 
@@ -228,7 +253,7 @@ namespace zypp
         case repo::RepoType::NONE_e:
         {
           path = lookupDatadirIn( repository() );
-          if ( ! path.empty() )
+          if ( ! path.empty() && ! myPool().readOnly() )
             repository().info().setProbedType( repo::RepoType::YAST2_e );
         }
         break;
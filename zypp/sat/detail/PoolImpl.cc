@@ -11,6 +11,7 @@
 */
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include <boost/mpl/int.hpp>
 
 #include "zypp/base/Easy.h"
@@ -18,6 +19,7 @@
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Exception.h"
 #include "zypp/base/Measure.h"
+#include "zypp/base/Trace.h"
 #include "zypp/base/WatchFile.h"
 #include "zypp/base/Sysconfig.h"
 #include "zypp/base/IOStream.h"
@@ -176,6 +178,10 @@ namespace zypp
       //
       PoolImpl::PoolImpl()
       : _pool( ::pool_create() )
+      , _frozen( false )
+      , _readers( 0 )
+      , _frozenStrings( 0 )
+      , _frozenRels( 0 )
       {
         MIL << "Creating sat-pool." << endl;
         if ( ! _pool )
@@ -254,11 +260,25 @@ namespace zypp
           else if ( a2 ) MIL << a1 << " " << a2 << endl;
           else           MIL << a1 << endl;
         }
+        thaw();
         ::pool_freewhatprovides( _pool );
       }
 
+      void PoolImpl::thaw()
+      {
+        if ( _frozen )
+        {
+          MIL << "Pool thawed." << endl;
+          _frozen = false;
+        }
+        _frozenStrings = _frozenRels = 0;
+      }
+
       void PoolImpl::prepare() const
       {
+        if ( _frozen )
+          return;	// nothing changed since freeze
+
 	// additional /etc/sysconfig/storage check:
 	static WatchFile sysconfigFile( sysconfigStoragePath(), WatchFile::NO_INIT );
 	if ( sysconfigFile.hasChanged() )
@@ -275,8 +295,11 @@ namespace zypp
         if ( ! _pool->whatprovides )
         {
           MIL << "pool_createwhatprovides..." << endl;
+          debug::TraceSpan span( "whatprovides" );
 
-          ::pool_addfileprovides( _pool );
+          // remember the file provides added (see \ref addedFileProvides)
+          sat::Queue addedinst;
+          ::pool_addfileprovides_queue( _pool, _addedFileProvides, addedinst );
           ::pool_createwhatprovides( _pool );
         }
         if ( ! _pool->languages )
@@ -286,6 +309,40 @@ namespace zypp
         }
       }
 
+      void PoolImpl::freeze()
+      {
+        // Ids created after the last freeze (e.g. by a writer) get their
+        // whatprovides computed; the rest is kept.
+        bool incremental = _frozen;
+        _frozen = false;
+        prepare();
+        getAvailableLocales();
+        multiversionList();
+        trackedLocaleIds();
+        requiredFilesystems();
+
+        // pool_whatprovides computes string and relation provides on demand
+        // and stores them in the pool. Do it now for all the ids we know.
+        IdType nstrings = _frozenStrings;
+        IdType nrels = _frozenRels;
+        for ( ; _frozenStrings < IdType(_pool->ss.nstrings); ++_frozenStrings )
+          ::pool_whatprovides( _pool, _frozenStrings );
+        for ( _frozenRels = std::max( _frozenRels, IdType(1) ); _frozenRels < IdType(_pool->nrels); ++_frozenRels )
+          ::pool_whatprovides( _pool, MAKERELDEP( _frozenRels ) );
+
+        // pool_createwhatprovides drops the string and relation hashes, and any
+        // lookup (even without create) rebuilds them. Do it now, so lookups by
+        // concurrent readers don't modify the pool.
+        ::pool_str2id( _pool, "zypp", /*create*/false );
+        ::pool_rel2id( _pool, STRID_EMPTY, STRID_EMPTY, REL_EQ, /*create*/false );
+
+        _frozen = true;
+        if ( incremental )
+          DBG << "Pool refrozen: +" << (_frozenStrings-nstrings) << " strings, +" << (_frozenRels-nrels) << " relations" << endl;
+        else
+          MIL << "Pool frozen: " << _frozenStrings << " strings, " << _frozenRels << " relations" << endl;
+      }
+
       ///////////////////////////////////////////////////////////////////
 
       CRepo * PoolImpl::_createRepo( const std::string & name_r )
@@ -583,7 +640,10 @@ namespace zypp
       }
 
       void PoolImpl::multiversionSpecChanged()
-      { _multiversionListPtr.reset(); }
+      {
+        thaw();
+        _multiversionListPtr.reset();
+      }
 
       const PoolImpl::MultiversionList & PoolImpl::multiversionList() const
       {
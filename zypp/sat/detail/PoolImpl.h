@@ -20,6 +20,8 @@ extern "C"
 #include <solv/repo_solv.h>
 }
 #include <iosfwd>
+#include <mutex>
+#include <atomic>
 
 #include "zypp/base/Hash.h"
 #include "zypp/base/NonCopyable.h"
@@ -71,6 +73,50 @@ namespace zypp
            */
           void prepare() const;
 
+          /** The file provides added to the pool by the last \ref prepare.
+           * Stored in solv files (\c REPOSITORY_ADDEDFILEPROVIDES) they allow
+           * libsolv to skip scanning the file lists of the repo when the file
+           * is loaded again (see \ref PoolSnapshot).
+           */
+          const sat::Queue & addedFileProvides() const
+          { prepare(); return _addedFileProvides; }
+
+        public:
+          /** \name Concurrent readers (see \ref Pool::freeze). */
+          //@{
+          /** Compute all lazily built data and keep them until the pool changes.
+           * Incremental if just strings or dependencies were added since the
+           * last call.
+           */
+          void freeze();
+
+          /** Whether the pool is frozen and neither its content changed nor
+           * new strings or dependencies were created since.
+           */
+          bool frozen() const
+          { return _frozen && _frozenStrings == IdType(_pool->ss.nstrings) && _frozenRels == IdType(_pool->nrels); }
+
+          /** Whether concurrent readers hold the pool (\ref ResPool::ReadGuard).
+           * No new strings or dependencies are created then.
+           */
+          bool readOnly() const
+          { return _readers; }
+
+          /** Counts the \ref ResPool::ReadGuard held, the pool must be \ref frozen. */
+          void addReader( bool yesno_r )
+          { if ( yesno_r ) ++_readers; else --_readers; }
+
+          /** Serialize libsolv calls using the pools tmpspace while \ref readOnly.
+           * Results must be copied before the lock is released.
+           */
+          std::unique_lock<std::mutex> tmpspaceLock() const
+          {
+            if ( readOnly() )
+              return std::unique_lock<std::mutex>( _tmpspaceMutex );
+            return std::unique_lock<std::mutex>();
+          }
+          //@}
+
         private:
           /** Invalidate housekeeping data (e.g. whatprovides) if the
            *  pools content changed.
@@ -85,6 +131,9 @@ namespace zypp
            */
           void depSetDirty( const char * a1 = 0, const char * a2 = 0, const char * a3 = 0 );
 
+          /** Lazily built data must be rebuilt. */
+          void thaw();
+
           /** Callback to resolve namespace dependencies (language, modalias, filesystem, etc.). */
           static detail::IdType nsCallback( CPool *, void * data, detail::IdType lhs, detail::IdType rhs );
 
@@ -199,7 +248,10 @@ namespace zypp
         public:
           /** */
           const RepoInfo & repoInfo( RepoIdType id_r )
-          { return _repoinfos[id_r]; }
+          {
+            std::map<RepoIdType,RepoInfo>::const_iterator it( _repoinfos.find( id_r ) );
+            return( it == _repoinfos.end() ? RepoInfo::noRepo : it->second );
+          }
           /** Also adjust repo priority and subpriority accordingly. */
           void setRepoInfo( RepoIdType id_r, const RepoInfo & info_r );
           /** */
@@ -328,8 +380,18 @@ namespace zypp
           /**  */
 	  sat::StringQueue _autoinstalled;
 
+	  /** file provides added by \ref prepare */
+	  mutable sat::Queue _addedFileProvides;
+
 	  /** filesystems mentioned in /etc/sysconfig/storage */
 	  mutable scoped_ptr<std::set<std::string> > _requiredFilesystemsPtr;
+
+	  /** \ref freeze state */
+	  bool _frozen;
+	  std::atomic<unsigned> _readers;
+	  detail::IdType _frozenStrings;	///< strings with whatprovides computed
+	  detail::IdType _frozenRels;	///< relations with whatprovides computed
+	  mutable std::mutex _tmpspaceMutex;
       };
       ///////////////////////////////////////////////////////////////////
 
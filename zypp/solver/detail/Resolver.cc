@@ -174,6 +174,9 @@ void Resolver::doUpdate()
 PoolItemList Resolver::problematicUpdateItems() const
 { return _satResolver->problematicUpdateItems(); }
 
+SolverStats Resolver::solverStats() const
+{ return _satResolver->solverStats(); }
+
 void Resolver::addExtraRequire( const Capability & capability )
 { _extra_requires.insert (capability); }
 
@@ -165,6 +165,7 @@ class Resolver : private base::NonCopyable
 
     bool doUpgrade();
     PoolItemList problematicUpdateItems() const;
+    SolverStats solverStats() const;
 
     /** \name Solver flags */
     //@{
@@ -28,6 +28,7 @@ extern "C"
 #include <solv/bitmap.h>
 #include <solv/queue.h>
 }
+#include <chrono>
 
 #define ZYPP_USE_RESOLVER_INTERNALS
 
@@ -40,6 +41,7 @@ extern "C"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Algorithm.h"
+#include "zypp/base/Trace.h"
 #include "zypp/ResPool.h"
 #include "zypp/ResFilters.h"
 #include "zypp/ZConfig.h"
@@ -132,6 +134,15 @@ inline PoolItem getPoolItem( Id id_r )
   return ret;
 }
 
+/** Run the solver; return the time spent in ms. */
+inline double timedSolve( sat::detail::CSolver * solver_r, sat::detail::CQueue * job_r )
+{
+  debug::TraceSpan span( "solve" );
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  solver_solve( solver_r, job_r );
+  return std::chrono::duration<double,std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
 //---------------------------------------------------------------------------
 
 std::ostream &
@@ -179,6 +190,7 @@ SATResolver::SATResolver (const ResPool & pool, sat::detail::CPool *satPool)
     : _pool(pool)
     , _satPool(satPool)
     , _satSolver(NULL)
+    , _solveTime(0.0)
     , _fixsystem(false)
     , _allowdowngrade(false)
     , _allowarchchange(false)
@@ -208,6 +220,31 @@ SATResolver::~SATResolver()
 
 //---------------------------------------------------------------------------
 
+SolverStats
+SATResolver::solverStats() const
+{
+  SolverStats ret;
+  if ( _satSolver )
+  {
+    // libsolv does not export the number of rules, but the rule classes
+    // cover the rule ids without gap.
+    Id rid = 1;
+    while ( solver_ruleclass( _satSolver, rid ) != SOLVER_RULE_UNKNOWN )
+      ++rid;
+    ret.rules = rid - 1;
+
+    Queue decisionq;
+    queue_init( &decisionq );
+    solver_get_decisionqueue( _satSolver, &decisionq );
+    ret.decisions = decisionq.count;
+    queue_free( &decisionq );
+
+    ret.problems = solver_problem_count( _satSolver );
+    ret.solveTime = _solveTime;
+  }
+  return ret;
+}
+
 ResPool
 SATResolver::pool (void) const
 {
@@ -417,7 +454,7 @@ SATResolver::solving(const CapabilitySet & requires_caps,
     // Solve !
     MIL << "Starting solving...." << endl;
     MIL << *this;
-    solver_solve( _satSolver, &(_jobQueue) );
+    _solveTime = timedSolve( _satSolver, &(_jobQueue) );
     MIL << "....Solver end" << endl;
 
     // copying solution back to zypp pool
@@ -843,7 +880,7 @@ void SATResolver::doUpdate()
     // Solve !
     MIL << "Starting solving for update...." << endl;
     MIL << *this;
-    solver_solve( _satSolver, &(_jobQueue) );
+    _solveTime = timedSolve( _satSolver, &(_jobQueue) );
     MIL << "....Solver end" << endl;
 
     // copying solution back to zypp pool
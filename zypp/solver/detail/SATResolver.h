@@ -80,6 +80,7 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
     sat::detail::CPool *_satPool;
     sat::detail::CSolver *_satSolver;
     sat::detail::CQueue _jobQueue;
+    double _solveTime;			// ms spent in the last solver_solve
 
     // list of problematic items (orphaned)
     PoolItemList _problem_items;
@@ -214,6 +215,9 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
     PoolItemList problematicUpdateItems( void ) const { return _problem_items; }
     PoolItemList problematicUpdateItems() { return _problem_items; }
 
+    /** Rules, decisions and problems of the last solver run. */
+    SolverStats solverStats() const;
+
     PoolItemList resultItemsToInstall () { return _result_items_to_install; }
     PoolItemList resultItemsToRemove () { return _result_items_to_remove; }
 
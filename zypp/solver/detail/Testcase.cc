@@ -9,6 +9,10 @@
 /** \file       zypp/solver/detail/Testcase.cc
  *
 */
+extern "C"
+{
+#include <solv/repo_write.h>
+}
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -27,6 +31,7 @@
 
 #include "zypp/parser/xml/XmlEscape.h"
 
+#include "zypp/AutoDispose.h"
 #include "zypp/ZConfig.h"
 #include "zypp/PathInfo.h"
 #include "zypp/ResPool.h"
@@ -485,6 +490,106 @@ void HelixControl::update()
     *file << "<update/>" << endl;
 }
 
+//---------------------------------------------------------------------------
+// The solv testcase: repos as solv files plus a compact job file.
+// See misc::TestcaseReplay for the format.
+//---------------------------------------------------------------------------
+
+/** Write \a repo_r as solv file \a path_r. */
+bool writeSolv( const Repository & repo_r, const std::string & path_r )
+{
+    AutoDispose<FILE*> fp( ::fopen( path_r.c_str(), "we" ), ::fclose );
+    if ( fp == NULL ) {
+	fp.resetDispose();
+	ERR << "Can't open " << path_r << endl;
+	return false;
+    }
+    if ( ::repo_write( repo_r.get(), fp ) != 0 ) {
+	ERR << "Can't write " << repo_r << " to " << path_r << endl;
+	return false;
+    }
+    return true;
+}
+
+/** An item in the job file: <tt>ident edition arch repoalias</tt> */
+std::string solvItem( const PoolItem & pi_r )
+{
+    return pi_r.satSolvable().ident().asString()
+	+ " " + pi_r.edition().asString()
+	+ " " + pi_r.arch().asString()
+	+ " " + pi_r.repository().alias();
+}
+
+class SolvControl : private base::NonCopyable
+{
+    ofstream _file;
+
+  public:
+    SolvControl( const std::string & controlPath,
+		 const RepositoryTable & repoTable,
+		 const Arch & systemArchitecture,
+		 const target::Modalias::ModaliasList & modaliasList,
+		 const std::set<std::string> & multiversionSpec,
+		 const bool forceResolve,
+		 const bool onlyRequires,
+		 const bool ignorealreadyrecommended )
+	: _file( controlPath.c_str() )
+    {
+	if ( !_file ) {
+	    ZYPP_THROW( Exception( "Can't open " + controlPath ) );
+	}
+	_file << "# zypp solver testcase" << endl
+	      << "version 1" << endl
+	      << "arch " << systemArchitecture << endl;
+	if ( sat::Pool::instance().findSystemRepo() )	// none e.g. at installation time
+	    _file << "system solver-system.solv" << endl;
+	for_( it, repoTable.begin(), repoTable.end() ) {
+	    _file << "repo " << str::numstring((long)it->first.id()) << "-package.solv "
+		  << it->first.info().priority() << " " << it->first.alias() << endl;
+	}
+
+	const sat::Pool & satpool( sat::Pool::instance() );
+	const LocaleSet & addedLocales( satpool.getAddedRequestedLocales() );
+	for ( Locale l : satpool.getRequestedLocales() )
+	    _file << "locale " << l << ( addedLocales.count(l) ? " added" : "" ) << endl;
+	for ( Locale l : satpool.getRemovedRequestedLocales() )
+	    _file << "locale " << l << " removed" << endl;
+	for ( IdString::IdType n : satpool.autoInstalled() )
+	    _file << "autoinst " << IdString(n) << endl;
+	for_( it, modaliasList.begin(), modaliasList.end() )
+	    _file << "modalias " << *it << endl;
+	for_( it, multiversionSpec.begin(), multiversionSpec.end() )
+	    _file << "multiversion " << *it << endl;
+
+	if (forceResolve)
+	    _file << "flag forceResolve" << endl;
+	if (onlyRequires)
+	    _file << "flag onlyRequires" << endl;
+	if (ignorealreadyrecommended)
+	    _file << "flag ignorealreadyrecommended" << endl;
+    }
+
+    void item( const char * what_r, const PoolItem & pi_r )
+    { _file << what_r << " " << solvItem( pi_r ) << endl; }
+
+    void addDependencies( const CapabilitySet & capRequire, const CapabilitySet & capConflict )
+    {
+	for_( it, capRequire.begin(), capRequire.end() )
+	    _file << "require " << *it << endl;
+	for_( it, capConflict.begin(), capConflict.end() )
+	    _file << "conflict " << *it << endl;
+    }
+
+    void addUpgradeRepos( const std::set<Repository> & upgradeRepos_r )
+    {
+	for_( it, upgradeRepos_r.begin(), upgradeRepos_r.end() )
+	    _file << "upgraderepo " << it->alias() << endl;
+    }
+
+    void mode( const char * mode_r )
+    { _file << "mode " << mode_r << endl; }
+};
+
 //---------------------------------------------------------------------------
 
 Testcase::Testcase()
@@ -536,6 +641,12 @@ bool Testcase::createTestcase(Resolver & resolver, bool dumpPool, bool runSolver
     if (dumpPool)
 	system = new HelixResolvable(dumpPath + "/solver-system.xml.gz");
 
+    if (dumpPool) {
+	Repository sysrepo( sat::Pool::instance().findSystemRepo() );
+	if ( sysrepo && ! writeSolv( sysrepo, dumpPath + "/solver-system.solv" ) )
+	    return false;
+    }
+
     for ( const PoolItem & pi : pool )
     {
 	if ( system && pi.status().isInstalled() ) {
@@ -607,6 +718,49 @@ bool Testcase::createTestcase(Resolver & resolver, bool dumpPool, bool runSolver
     if (resolver.isVerifyingMode())
 	control.verifySystem();
 
+    // and the same as solv testcase; the job refers to the solv files,
+    // so without a pool dump there is none.
+    if (!dumpPool)
+	return true;
+
+    for_( it, repoTable.begin(), repoTable.end() ) {
+	if ( ! writeSolv( it->first, dumpPath + "/" + str::numstring((long)it->first.id()) + "-package.solv" ) )
+	    return false;
+    }
+
+    SolvControl solvcontrol (dumpPath + "/solver-test.job",
+			     repoTable,
+			     ZConfig::instance().systemArchitecture(),
+			     target::Modalias::instance().modaliasList(),
+			     ZConfig::instance().multiversionSpec(),
+			     resolver.forceResolve(),
+			     resolver.onlyRequires(),
+			     resolver.ignoreAlreadyRecommended() );
+
+    for ( const PoolItem & pi : items_to_install )
+    { solvcontrol.item( "install", pi ); }
+
+    for ( const PoolItem & pi : items_locked )
+    { solvcontrol.item( "lock", pi ); }
+
+    for ( const PoolItem & pi : items_keep )
+    { solvcontrol.item( "keep", pi ); }
+
+    for ( const PoolItem & pi : items_to_remove )
+    { solvcontrol.item( "uninstall", pi ); }
+
+    solvcontrol.addDependencies (resolver.extraRequires(), resolver.extraConflicts());
+    solvcontrol.addDependencies (SystemCheck::instance().requiredSystemCap(),
+				 SystemCheck::instance().conflictSystemCap());
+    solvcontrol.addUpgradeRepos( resolver.upgradeRepos() );
+
+    if (resolver.isUpgradeMode())
+	solvcontrol.mode( "distupgrade" );
+    if (resolver.isUpdateMode())
+	solvcontrol.mode( "update" );
+    if (resolver.isVerifyingMode())
+	solvcontrol.mode( "verify" );
+
     return true;
 }
 
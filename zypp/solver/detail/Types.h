@@ -47,6 +47,18 @@ namespace zypp
       DEFINE_PTR_TYPE(SolutionAction);
       typedef std::list<SolutionAction_Ptr> SolutionActionList;
 
+      /** Size and time of the last solver run (\see \ref Resolver::solverStats). */
+      struct SolverStats
+      {
+        SolverStats()
+        : rules( 0 ), decisions( 0 ), problems( 0 ), solveTime( 0.0 )
+        {}
+        unsigned rules;		///< rules created
+        unsigned decisions;	///< decisions taken
+        unsigned problems;	///< problems found
+        double   solveTime;	///< ms spent in the sat solver
+      };
+
     } // namespace detail
     /////////////////////////////////////////////////////////////////////
   } // namespace solver
@@ -0,0 +1,240 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/PackagePrefetcher.cc
+ *
+*/
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <iostream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/UserRequestException.h"
+#include "zypp/ZConfig.h"
+#include "zypp/ZYppFactory.h"
+#include "zypp/Package.h"
+#include "zypp/PoolItem.h"
+
+#include "zypp/target/PackagePrefetcher.h"
+#include "zypp/target/CommitPackageCache.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      // linux/ioprio.h is not available everywhere
+      enum { IOPRIO_WHO_PROCESS = 1, IOPRIO_CLASS_IDLE = 3, IOPRIO_CLASS_SHIFT = 13 };
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class IdlePriority
+      /// \brief Run the calling thread at idle IO priority while in scope.
+      ///
+      /// The CPU priority is left alone: an unprivileged process may raise
+      /// its nice value, but not lower it again afterwards. The idle IO
+      /// priority is per thread on Linux and can always be restored.
+      ///////////////////////////////////////////////////////////////////
+      struct IdlePriority
+      {
+	IdlePriority( bool active_r )
+	: _active( active_r )
+	{
+	  if ( ! _active )
+	    return;
+#ifdef SYS_ioprio_get
+	  // IOPRIO_WHO_PROCESS with id 0 addresses the calling thread only
+	  _ioprio = ::syscall( SYS_ioprio_get, IOPRIO_WHO_PROCESS, 0 );
+	  if ( _ioprio < 0 || ::syscall( SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT ) != 0 )
+	  {
+	    WAR << "Can't set idle IO priority: " << str::strerror( errno ) << endl;
+	    _ioprio = -1;
+	  }
+#endif
+	}
+
+	~IdlePriority()
+	{
+	  if ( ! _active )
+	    return;
+#ifdef SYS_ioprio_set
+	  if ( _ioprio >= 0 && ::syscall( SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, _ioprio ) != 0 )
+	    WAR << "Can't restore IO priority " << _ioprio << ": " << str::strerror( errno ) << endl;
+#endif
+	}
+
+      private:
+	bool _active;
+	long _ioprio = -1;
+      };
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class DownloadSpeed
+      /// \brief Override \ref ZConfig::download_max_download_speed while in scope.
+      /// The value in effect before (e.g. set by the application) is restored.
+      ///////////////////////////////////////////////////////////////////
+      struct DownloadSpeed
+      {
+	DownloadSpeed( long speed_r )
+	: _active( speed_r > 0 )
+	, _saved( ZConfig::instance().download_max_download_speed() )
+	{
+	  if ( _active )
+	    ZConfig::instance().set_download_max_download_speed( speed_r );
+	}
+
+	~DownloadSpeed()
+	{
+	  if ( _active )
+	    ZConfig::instance().set_download_max_download_speed( _saved );
+	}
+
+      private:
+	bool _active;
+	long _saved;
+      };
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class UnlockedZYpp
+      /// \brief Release the global zypp lock while in scope.
+      /// Use \ref relock to reacquire the lock and see whether this succeeded.
+      ///////////////////////////////////////////////////////////////////
+      struct UnlockedZYpp
+      {
+	UnlockedZYpp( bool active_r )
+	: _released( active_r && ZYppFactory::instance().releaseLock() )
+	{
+	  if ( _released )
+	    MIL << "Released the zypp lock." << endl;
+	}
+
+	~UnlockedZYpp()
+	{
+	  // if this fails, ZYpp::commit will refuse to run without the lock
+	  try { relock(); }
+	  catch ( const Exception & excpt ) { ZYPP_CAUGHT( excpt ); }
+	}
+
+	void relock()
+	{
+	  if ( ! _released )
+	    return;
+	  _released = false;
+	  ZYppFactory::instance().reacquireLock();
+	  MIL << "Reacquired the zypp lock." << endl;
+	}
+
+      private:
+	bool _released;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    PackagePrefetcher::PackagePrefetcher()
+    : _maxDownloadSpeed( 0 )
+    , _idlePriority( true )
+    , _releaseLock( true )
+    {}
+
+    PackagePrefetcher::Result PackagePrefetcher::prefetch( const sat::Transaction & transaction_r ) const
+    {
+      MIL << "Prefetch " << *this << endl;
+
+      std::vector<PoolItem> todo;
+      for_( it, transaction_r.begin(), transaction_r.end() )
+      {
+	switch ( it->stepType() )
+	{
+	  case sat::Transaction::TRANSACTION_INSTALL:
+	  case sat::Transaction::TRANSACTION_MULTIINSTALL:
+	    // proceed: only install actions may require download.
+	    break;
+
+	  default:
+	    continue;
+	    break;
+	}
+	if ( it->satSolvable().isKind<Package>() )
+	  todo.push_back( PoolItem( it->satSolvable() ) );
+      }
+
+      Result ret;
+      if ( todo.empty() )
+	return ret;
+
+      UnlockedZYpp unlocked( _releaseLock );
+      {
+	IdlePriority idle( _idlePriority );
+	DownloadSpeed speed( _maxDownloadSpeed );	// media are attached by provider below
+
+	RepoProvidePackage provider;
+	for ( const PoolItem & pi : todo )
+	{
+	  try
+	  {
+	    ManagedFile localfile( provider( pi, /*fromCache*/true ) );
+	    if ( ! localfile->empty() )
+	    {
+	      localfile.resetDispose();	// keep the package file in the cache
+	      ++ret.cached;
+	      continue;
+	    }
+
+	    localfile = provider( pi, /*fromCache*/false );
+	    localfile.resetDispose();	// keep the package file in the cache
+	    ++ret.downloaded;
+	  }
+	  catch ( const AbortRequestException & excpt )
+	  {
+	    WAR << "Prefetch aborted by the user: " << ret << endl;
+	    throw;
+	  }
+	  catch ( const Exception & excpt )
+	  {
+	    ZYPP_CAUGHT( excpt );
+	    WAR << "Failed to prefetch " << pi << endl;
+	    ++ret.failed;
+	  }
+	}
+      }
+      unlocked.relock();
+
+      MIL << "Prefetched " << ret << endl;
+      return ret;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PackagePrefetcher::Result & obj )
+    {
+      return str << "{cached " << obj.cached
+                 << ", downloaded " << obj.downloaded
+                 << ", failed " << obj.failed << "}";
+    }
+
+    std::ostream & operator<<( std::ostream & str, const PackagePrefetcher & obj )
+    {
+      str << "PackagePrefetcher(";
+      if ( obj.maxDownloadSpeed() > 0 )
+	str << obj.maxDownloadSpeed() << "B/s";
+      else
+	str << "unlimited";
+      if ( obj.idlePriority() )
+	str << ", idle";
+      if ( obj.releaseLock() )
+	str << ", unlocked";
+      return str << ")";
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
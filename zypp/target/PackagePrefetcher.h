@@ -0,0 +1,122 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/PackagePrefetcher.h
+ *
+*/
+#ifndef ZYPP_TARGET_PACKAGEPREFETCHER_H
+#define ZYPP_TARGET_PACKAGEPREFETCHER_H
+
+#include <iosfwd>
+
+#include "zypp/sat/Transaction.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class PackagePrefetcher
+    /// \brief Download the packages of a transaction into the package cache.
+    ///
+    /// Unlike a \ref DownloadOnly commit, which downloads while the zypp
+    /// lock is held, the prefetcher is meant to run in the background
+    /// (e.g. from a timer, long before a maintenance window):
+    /// \li It releases the global zypp lock while downloading (\ref releaseLock),
+    ///     so other applications are not blocked meanwhile.
+    /// \li It limits the download bandwidth (\ref maxDownloadSpeed).
+    /// \li It runs downloads at idle IO priority (\ref idlePriority).
+    ///
+    /// Packages already in the cache are not downloaded again, so an
+    /// interrupted prefetch continues where it stopped. Downloaded packages
+    /// are verified and kept in the cache, so the later commit of the same
+    /// transaction just needs to install them.
+    ///
+    /// \code
+    ///   sat::Transaction trans( getZYpp()->resolver()->getTransaction() );
+    ///   target::PackagePrefetcher::Result res( target::PackagePrefetcher().maxDownloadSpeed( 500000 ).prefetch( trans ) );
+    ///   MIL << res << endl;
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class PackagePrefetcher
+    {
+    public:
+      /** Prefetch statistics. */
+      struct Result
+      {
+	Result()
+	: cached( 0 ), downloaded( 0 ), failed( 0 )
+	{}
+
+	/** Whether all packages are in the cache now. */
+	bool complete() const
+	{ return failed == 0; }
+
+	unsigned cached;	///< packages found in the cache
+	unsigned downloaded;	///< packages downloaded
+	unsigned failed;	///< packages which could not be downloaded
+      };
+
+    public:
+      /** Default: release the lock, idle priority, unlimited bandwidth. */
+      PackagePrefetcher();
+
+    public:
+      /** Download bandwidth limit in bytes per second (\c 0: \ref ZConfig::download_max_download_speed). */
+      PackagePrefetcher & maxDownloadSpeed( long val_r )
+      { _maxDownloadSpeed = val_r; return *this; }
+      long maxDownloadSpeed() const
+      { return _maxDownloadSpeed; }
+
+      /** Whether to download at idle IO priority (Linux).
+       * Only the calling thread is affected, and its IO priority is
+       * restored when done. The CPU priority is not changed, as an
+       * unprivileged process could not restore it.
+       */
+      PackagePrefetcher & idlePriority( bool yesNo_r )
+      { _idlePriority = yesNo_r; return *this; }
+      bool idlePriority() const
+      { return _idlePriority; }
+
+      /** Whether to release the global zypp lock while downloading.
+       * The lock is reacquired when done. \ref prefetch throws a
+       * \ref ZYppFactoryException if meanwhile another application
+       * took the lock; \ref ZYpp::commit then fails as well until
+       * \ref ZYppFactory::reacquireLock succeeds.
+       */
+      PackagePrefetcher & releaseLock( bool yesNo_r )
+      { _releaseLock = yesNo_r; return *this; }
+      bool releaseLock() const
+      { return _releaseLock; }
+
+    public:
+      /** Download the packages to be installed by \a transaction_r.
+       * Failing packages are skipped. A user abort (\ref AbortRequestException)
+       * is passed to the caller.
+       */
+      Result prefetch( const sat::Transaction & transaction_r ) const;
+
+    private:
+      long _maxDownloadSpeed;
+      bool _idlePriority;
+      bool _releaseLock;
+    };
+
+    /** \relates PackagePrefetcher::Result Stream output */
+    std::ostream & operator<<( std::ostream & str, const PackagePrefetcher::Result & obj );
+
+    /** \relates PackagePrefetcher Stream output */
+    std::ostream & operator<<( std::ostream & str, const PackagePrefetcher & obj );
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_PACKAGEPREFETCHER_H
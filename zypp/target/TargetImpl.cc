@@ -27,6 +27,7 @@
 #include "zypp/base/Functional.h"
 #include "zypp/base/UserRequestException.h"
 #include "zypp/base/Json.h"
+#include "zypp/base/Trace.h"
 
 #include "zypp/ZConfig.h"
 #include "zypp/ZYppFactory.h"
@@ -77,92 +78,105 @@ namespace zypp
   ///////////////////////////////////////////////////////////////////
   namespace json
   {
-    // Lazy via template specialisation / should switch to overloading
-
-    template<>
-    inline std::string toJSON( const ZYppCommitResult::TransactionStepList & steps_r )
-    {
-      using sat::Transaction;
-      json::Array ret;
-
-      for ( const Transaction::Step & step : steps_r )
-	// ignore implicit deletes due to obsoletes and non-package actions
-	if ( step.stepType() != Transaction::TRANSACTION_IGNORE )
-	  ret.add( step );
-
-      return ret.asJSON();
-    }
+    ///////////////////////////////////////////////////////////////////
+    // The TransactionStepList may contain thousands of steps. Instead of
+    // building json::Object/json::Array trees (a std::map and several
+    // string copies per step), the steps JSON is appended to a single
+    // string. The layout is the one json::Object and json::Array produce
+    // (keys sorted, one per line).
+    ///////////////////////////////////////////////////////////////////
 
-    /** See \ref commitbegin on page \ref plugin-commit for the specs. */
-    template<>
-    inline std::string toJSON( const sat::Transaction::Step & step_r )
+    /** Append the JSON object for \a step_r to \a ret.
+     * See \ref commitbegin on page \ref plugin-commit for the specs.
+     */
+    inline void appendJSON( std::string & ret, const sat::Transaction::Step & step_r )
     {
-      static const std::string strType( "type" );
-      static const std::string strStage( "stage" );
-      static const std::string strSolvable( "solvable" );
-
-      static const std::string strTypeDel( "-" );
-      static const std::string strTypeIns( "+" );
-      static const std::string strTypeMul( "M" );
-
-      static const std::string strStageDone( "ok" );
-      static const std::string strStageFailed( "err" );
-
-      static const std::string strSolvableN( "n" );
-      static const std::string strSolvableE( "e" );
-      static const std::string strSolvableV( "v" );
-      static const std::string strSolvableR( "r" );
-      static const std::string strSolvableA( "a" );
-
       using sat::Transaction;
-      json::Object ret;
 
+      const char * type = nullptr;
       switch ( step_r.stepType() )
       {
 	case Transaction::TRANSACTION_IGNORE:	/*empty*/ break;
-	case Transaction::TRANSACTION_ERASE:	ret.add( strType, strTypeDel ); break;
-	case Transaction::TRANSACTION_INSTALL:	ret.add( strType, strTypeIns ); break;
-	case Transaction::TRANSACTION_MULTIINSTALL: ret.add( strType, strTypeMul ); break;
+	case Transaction::TRANSACTION_ERASE:	type = "\"-\""; break;
+	case Transaction::TRANSACTION_INSTALL:	type = "\"+\""; break;
+	case Transaction::TRANSACTION_MULTIINSTALL: type = "\"M\""; break;
       }
 
+      const char * stage = nullptr;
       switch ( step_r.stepStage() )
       {
 	case Transaction::STEP_TODO:		/*empty*/ break;
-	case Transaction::STEP_DONE:		ret.add( strStage, strStageDone ); break;
-	case Transaction::STEP_ERROR:		ret.add( strStage, strStageFailed ); break;
+	case Transaction::STEP_DONE:		stage = "\"ok\""; break;
+	case Transaction::STEP_ERROR:		stage = "\"err\""; break;
       }
 
+      IdString ident;
+      Edition ed;
+      Arch arch;
+      if ( sat::Solvable solv = step_r.satSolvable() )
       {
-	IdString ident;
-	Edition ed;
-	Arch arch;
-	if ( sat::Solvable solv = step_r.satSolvable() )
-	{
-	  ident	= solv.ident();
-	  ed	= solv.edition();
-	  arch	= solv.arch();
-	}
-	else
-	{
-	  // deleted package; post mortem data stored in Transaction::Step
-	  ident	= step_r.ident();
-	  ed	= step_r.edition();
-	  arch	= step_r.arch();
-	}
-
-	json::Object s {
-	  { strSolvableN, ident.asString() },
-	  { strSolvableV, ed.version() },
-	  { strSolvableR, ed.release() },
-	  { strSolvableA, arch.asString() }
-	};
-	if ( Edition::epoch_t epoch = ed.epoch() )
-	  s.add( strSolvableE, epoch );
+	ident	= solv.ident();
+	ed	= solv.edition();
+	arch	= solv.arch();
+      }
+      else
+      {
+	// deleted package; post mortem data stored in Transaction::Step
+	ident	= step_r.ident();
+	ed	= step_r.edition();
+	arch	= step_r.arch();
+      }
 
-	ret.add( strSolvable, s );
+      // keys in json::Object order: "solvable", "stage", "type"; "a", "e", "n", "r", "v"
+      ret += "{\n\"solvable\": {\n\"a\": ";
+      ret += toJSON( arch.asString() );
+      if ( Edition::epoch_t epoch = ed.epoch() )
+      {
+	ret += ",\n\"e\": ";
+	ret += toJSON( epoch );
+      }
+      ret += ",\n\"n\": ";
+      ret += toJSON( ident.asString() );
+      ret += ",\n\"r\": ";
+      ret += toJSON( ed.release() );
+      ret += ",\n\"v\": ";
+      ret += toJSON( ed.version() );
+      ret += "\n}";
+      if ( stage )
+      {
+	ret += ",\n\"stage\": ";
+	ret += stage;
+      }
+      if ( type )
+      {
+	ret += ",\n\"type\": ";
+	ret += type;
       }
+      ret += "\n}";
+    }
+
+    /** The JSON object <tt>{ "TransactionStepList": [...] }</tt> sent with \c COMMITBEGIN/COMMITEND. */
+    inline std::string transactionStepListJSON( const ZYppCommitResult::TransactionStepList & steps_r )
+    {
+      using sat::Transaction;
+      std::string ret;
+      ret.reserve( 64 + 160 * steps_r.size() );
 
-      return ret.asJSON();
+      ret += "{\n\"TransactionStepList\": [";
+      bool first = true;
+      for ( const Transaction::Step & step : steps_r )
+      {
+	// ignore implicit deletes due to obsoletes and non-package actions
+	if ( step.stepType() == Transaction::TRANSACTION_IGNORE )
+	  continue;
+	if ( first )
+	  first = false;
+	else
+	  ret += ", ";
+	appendJSON( ret, step );
+      }
+      ret += "]\n}";
+      return ret;
     }
   } // namespace json
   ///////////////////////////////////////////////////////////////////
@@ -236,9 +250,7 @@ namespace zypp
     {
       inline PluginFrame transactionPluginFrame( const std::string & command_r, ZYppCommitResult::TransactionStepList & steps_r )
       {
-	return PluginFrame( command_r, json::Object {
-	  { "TransactionStepList", steps_r }
-	}.asJSON() );
+	return PluginFrame( command_r, json::transactionStepListJSON( steps_r ) );
       }
     } // namespace
     ///////////////////////////////////////////////////////////////////
@@ -922,19 +934,23 @@ namespace zypp
         cmd.push_back( "-o" );
         cmd.push_back( tmpsolv.path().asString() );
 
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
 	std::string errdetail;
+	int ret = 0;
+	{
+	  debug::TraceSpan span( "rpmdb2solv" );
+	  ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+
+	  for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+	    WAR << "  " << output;
+	    if ( errdetail.empty() ) {
+	      errdetail = prog.command();
+	      errdetail += '\n';
+	    }
+	    errdetail += output;
+	  }
 
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          if ( errdetail.empty() ) {
-            errdetail = prog.command();
-            errdetail += '\n';
-          }
-          errdetail += output;
-        }
-
-        int ret = prog.close();
+	  ret = prog.close();
+	}
         if ( ret != 0 )
         {
           Exception ex(str::form("Failed to cache rpm database (%d).", ret));
@@ -1466,7 +1482,10 @@ namespace zypp
               progress.tryLevel( target::rpm::InstallResolvableReport::RPM_NODEPS_FORCE );
 	      if ( postTransCollector.collectScriptFromPackage( localfile ) )
 		flags |= rpm::RPMINST_NOPOSTTRANS;
-	      rpm().installPackage( localfile, flags );
+	      {
+		debug::TraceSpan span( "rpm_install", citem.satSolvable().asString() );
+		rpm().installPackage( localfile, flags );
+	      }
               HistoryLog().install(citem);
 
               if ( progress.aborted() )
@@ -1528,7 +1547,10 @@ namespace zypp
 	    attemptToModify();
             try
             {
-	      rpm().removePackage( p, flags );
+	      {
+		debug::TraceSpan span( "rpm_remove", citem.satSolvable().asString() );
+		rpm().removePackage( p, flags );
+	      }
               HistoryLog().remove(citem);
 
               if ( progress.aborted() )
@@ -18,6 +18,8 @@ extern "C"
 #include <cstdlib>
 #include <cstdio>
 #include <ctime>
+#include <dirent.h>
+#include <sys/stat.h>
 
 #include <iostream>
 #include <fstream>
@@ -235,6 +237,240 @@ std::ostream & operator<<( std::ostream & str, const RpmDb::DbStateInfoBits & ob
 
 #define FAILIFNOTINITIALIZED if( ! initialized() ) { ZYPP_THROW(RpmDbNotOpenException()); }
 
+namespace
+{
+  /** Fingerprint of the rpmdb below \a root_r (name, inode, size and mtime of the files
+   * and directories in the database directory).
+   *
+   * Changes whenever rpm modifies the database, no matter which process did it or
+   * which backend is used (BDB \c Packages, ndb \c Packages.db, \c rpmdb.sqlite).
+   * Imported keys are stored in the database or, with the fs keyring, in the
+   * \c pubkeys subdirectory, whose mtime is included. BDB's \c __db.* region files
+   * and sqlite's \c -shm file are skipped, as they are touched by mere reads.
+   * Empty if there is no database directory.
+   */
+  std::string rpmdbStamp( const Pathname & root_r, const Pathname & dbPath_r )
+  {
+    std::vector<std::string> entries;
+    Pathname dbDir( root_r + ( dbPath_r.empty() ? Pathname( "/var/lib/rpm" ) : dbPath_r ) );
+    DIR * dir = ::opendir( dbDir.c_str() );
+    if ( ! dir )
+      return std::string();
+
+    while ( struct dirent * entry = ::readdir( dir ) )
+    {
+      if ( entry->d_name[0] == '.' || str::hasPrefix( entry->d_name, "__db." ) || str::hasSuffix( entry->d_name, "-shm" ) )
+        continue;
+      struct stat st;
+      if ( ::fstatat( ::dirfd( dir ), entry->d_name, &st, 0 ) != 0 )
+        continue;
+      entries.push_back( str::form( "%s:%lu:%lld:%ld.%09ld", entry->d_name, (unsigned long)st.st_ino, (long long)st.st_size,
+                                    (long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec ) );
+    }
+    ::closedir( dir );
+
+    std::sort( entries.begin(), entries.end() );
+    return str::join( entries.begin(), entries.end(), " " );
+  }
+} // namespace
+
+///////////////////////////////////////////////////////////////////
+/// \class RpmDb::CheckPackageCache
+/// \brief Remember \ref RpmDb::checkPackage results per file.
+///
+/// Entries are keyed by path and valid as long as inode, size and
+/// mtime of the file are unchanged.
+///
+/// Everything is dropped as soon as the rpmdb, and with it the trusted
+/// keyring, changes (see \ref validate); no matter whether by this or
+/// another \ref RpmDb instance or by rpm itself.
+///////////////////////////////////////////////////////////////////
+class RpmDb::CheckPackageCache : private base::NonCopyable
+{
+public:
+  /** Upper bound for the number of files remembered; the cache is simply dropped if exceeded. */
+  static const unsigned maxEntries = 8192;
+
+  /** Drop everything if the \ref rpmdbStamp changed; \c false if it is empty (nothing is cached then). */
+  bool validate( const std::string & stamp_r )
+  {
+    if ( stamp_r != _stamp )
+    {
+      if ( ! _cache.empty() )
+        DBG << "rpmdb changed: dropping " << _cache.size() << " remembered check results." << endl;
+      clear();
+      _stamp = stamp_r;
+    }
+    return ! _stamp.empty();
+  }
+
+  bool lookup( const Pathname & path_r, const struct stat & st_r, CheckPackageResult & result_r, CheckPackageDetail & detail_r ) const
+  {
+    std::map<std::string,Entry>::const_iterator it( _cache.find( path_r.asString() ) );
+    if ( it == _cache.end() || ! it->second.sameFile( st_r ) )
+      return false;
+    result_r = it->second.result;
+    detail_r.insert( detail_r.end(), it->second.detail.begin(), it->second.detail.end() );
+    return true;
+  }
+
+  void remember( const Pathname & path_r, const struct stat & st_r, CheckPackageResult result_r, const CheckPackageDetail & detail_r )
+  {
+    if ( result_r == CHK_ERROR )
+      return;
+    if ( _cache.size() >= maxEntries )
+      _cache.clear();
+    Entry & entry( _cache[path_r.asString()] );
+    entry.st = st_r;
+    entry.result = result_r;
+    entry.detail = detail_r;
+  }
+
+  void clear()
+  {
+    _cache.clear();
+    _stamp.clear();
+  }
+
+private:
+  struct Entry
+  {
+    bool sameFile( const struct stat & st_r ) const
+    {
+      return st.st_dev == st_r.st_dev && st.st_ino == st_r.st_ino && st.st_size == st_r.st_size
+          && st.st_mtim.tv_sec == st_r.st_mtim.tv_sec && st.st_mtim.tv_nsec == st_r.st_mtim.tv_nsec;
+    }
+
+    struct stat        st;
+    CheckPackageResult result;
+    CheckPackageDetail detail;
+  };
+  std::string _stamp;
+  std::map<std::string,Entry> _cache;
+};
+
+///////////////////////////////////////////////////////////////////
+/// \class RpmDb::HeaderCache
+/// \brief Remember rpmdb query results and the \ref RpmHeader they returned.
+///
+/// Headers are kept in a LRU list keyed by rpmdb record number. Query
+/// results are remembered as the list of record numbers they returned
+/// and are used as long as all these headers are still cached.
+///
+/// Whether a query matches anything at all is remembered separately
+/// (see \ref lookupAny), so the \c has* queries do not need to decode
+/// all the matching headers.
+///
+/// Everything is dropped as soon as the rpmdb changes (see \ref validate).
+///////////////////////////////////////////////////////////////////
+class RpmDb::HeaderCache : private base::NonCopyable
+{
+public:
+  /** Max. number of headers kept. */
+  static const unsigned maxHeaders = 512;
+  /** Upper bound for the number of queries remembered; they are simply dropped if exceeded. */
+  static const unsigned maxQueries = 8192;
+
+  /** Drop everything if the \ref rpmdbStamp changed; \c false if it is empty (nothing is cached then). */
+  bool validate( const std::string & stamp_r )
+  {
+    if ( stamp_r != _stamp )
+    {
+      if ( ! _headers.empty() )
+        DBG << "rpmdb changed: dropping " << _headers.size() << " cached headers." << endl;
+      clear();
+      _stamp = stamp_r;
+    }
+    return ! _stamp.empty();
+  }
+
+  bool lookup( const std::string & query_r, std::vector<RpmHeader::constPtr> & result_r )
+  {
+    std::map<std::string,std::vector<unsigned> >::const_iterator it( _queries.find( query_r ) );
+    if ( it == _queries.end() )
+      return false;
+
+    std::vector<RpmHeader::constPtr> ret;
+    for ( unsigned recnum : it->second )
+    {
+      HeaderIndex::iterator hit( _index.find( recnum ) );
+      if ( hit == _index.end() )
+	return false;
+      _headers.splice( _headers.begin(), _headers, hit->second );	// most recently used
+      ret.push_back( hit->second->second );
+    }
+    result_r.swap( ret );
+    return true;
+  }
+
+  void remember( const std::string & query_r, const std::vector<unsigned> & recnums_r, const std::vector<RpmHeader::constPtr> & headers_r )
+  {
+    for ( unsigned i = 0; i < recnums_r.size(); ++i )
+    {
+      HeaderIndex::iterator hit( _index.find( recnums_r[i] ) );
+      if ( hit != _index.end() )
+      {
+	_headers.splice( _headers.begin(), _headers, hit->second );
+	continue;
+      }
+      _headers.push_front( HeaderList::value_type( recnums_r[i], headers_r[i] ) );
+      _index[recnums_r[i]] = _headers.begin();
+      if ( _headers.size() > maxHeaders )
+      {
+	_index.erase( _headers.back().first );
+	_headers.pop_back();
+      }
+    }
+    if ( _queries.size() >= maxQueries )
+      _queries.clear();
+    _queries[query_r] = recnums_r;
+  }
+
+  /** Whether \a query_r matches anything, if known. */
+  bool lookupAny( const std::string & query_r, bool & result_r ) const
+  {
+    std::map<std::string,std::vector<unsigned> >::const_iterator it( _queries.find( query_r ) );
+    if ( it != _queries.end() )
+    {
+      result_r = ! it->second.empty();
+      return true;
+    }
+    std::map<std::string,bool>::const_iterator ait( _any.find( query_r ) );
+    if ( ait != _any.end() )
+    {
+      result_r = ait->second;
+      return true;
+    }
+    return false;
+  }
+
+  void rememberAny( const std::string & query_r, bool result_r )
+  {
+    if ( _any.size() >= maxQueries )
+      _any.clear();
+    _any[query_r] = result_r;
+  }
+
+  void clear()
+  {
+    _queries.clear();
+    _any.clear();
+    _index.clear();
+    _headers.clear();
+    _stamp.clear();
+  }
+
+private:
+  typedef std::list<std::pair<unsigned,RpmHeader::constPtr> > HeaderList;
+  typedef std::map<unsigned,HeaderList::iterator> HeaderIndex;
+
+  std::string _stamp;
+  HeaderList  _headers;		///< most recently used first
+  HeaderIndex _index;		///< record number -> _headers entry
+  std::map<std::string,std::vector<unsigned> > _queries;	///< query -> record numbers
+  std::map<std::string,bool> _any;			///< query -> whether it matches anything
+};
+
 ///////////////////////////////////////////////////////////////////
 
 ///////////////////////////////////////////////////////////////////
@@ -249,6 +485,8 @@ RpmDb::RpmDb()
     , _backuppath ("/var/adm/backup")
     , _packagebackups(false)
     , _warndirexists(false)
+    , _checkPackageCache( new CheckPackageCache )
+    , _headerCache( new HeaderCache )
 {
   process = 0;
   exit_code = -1;
@@ -763,6 +1001,8 @@ void RpmDb::closeDatabase()
   ///////////////////////////////////////////////////////////////////
   _root = _dbPath = Pathname();
   _dbStateInfo = DbSI_NO_INIT;
+  _checkPackageCache->clear();
+  _headerCache->clear();
 
   MIL << "closeDatabase: " << *this << endl;
 }
@@ -1102,6 +1342,7 @@ void RpmDb::importPubkey( const PublicKey & pubkey_r )
   }
 
   // import the new key
+  _checkPackageCache->clear();
   RpmArgVec opts;
   opts.push_back ( "--import" );
   opts.push_back ( "--" );
@@ -1164,6 +1405,7 @@ void RpmDb::removePubkey( const PublicKey & pubkey_r )
   }
 
   std::string rpm_name("gpg-pubkey-" + found_edition->asString());
+  _checkPackageCache->clear();
 
   RpmArgVec opts;
   opts.push_back ( "-e" );
@@ -1291,6 +1533,73 @@ RpmDb::fileList( const std::string & name_r, const Edition & edition_r ) const
 }
 
 
+///////////////////////////////////////////////////////////////////
+//
+//
+//	METHOD NAME : RpmDb::queryHeaders
+//	METHOD TYPE : shared_ptr<RpmException>
+//
+shared_ptr<RpmException> RpmDb::queryHeaders( HeaderQuery query_r, const std::string & arg_r,
+                                              std::vector<RpmHeader::constPtr> & result_r ) const
+{
+  result_r.clear();
+
+  bool useCache = _headerCache->validate( rpmdbStamp( root(), dbPath() ) );
+  std::string query( str::numstring( query_r ) + ":" + arg_r );
+  if ( useCache && _headerCache->lookup( query, result_r ) )
+    return shared_ptr<RpmException>();
+
+  librpmDb::db_const_iterator it;
+  switch ( query_r )
+  {
+    case BY_FILE:		it.findByFile( arg_r );		break;
+    case BY_PROVIDES:		it.findByProvides( arg_r );	break;
+    case BY_REQUIREDBY:		it.findByRequiredBy( arg_r );	break;
+    case BY_CONFLICTS:		it.findByConflicts( arg_r );	break;
+    case BY_NAME:		it.findByName( arg_r );		break;
+  }
+  std::vector<unsigned> recnums;
+  for ( ; *it; ++it )
+  {
+    recnums.push_back( it.dbHdrNum() );
+    result_r.push_back( *it );
+  }
+  if ( it.dbError() )
+    return it.dbError();
+
+  if ( useCache )
+    _headerCache->remember( query, recnums, result_r );
+  return shared_ptr<RpmException>();
+}
+
+///////////////////////////////////////////////////////////////////
+//
+//
+//	METHOD NAME : RpmDb::queryAny
+//	METHOD TYPE : bool
+//
+bool RpmDb::queryAny( HeaderQuery query_r, const std::string & arg_r ) const
+{
+  bool useCache = _headerCache->validate( rpmdbStamp( root(), dbPath() ) );
+  std::string query( str::numstring( query_r ) + ":" + arg_r );
+  bool ret = false;
+  if ( useCache && _headerCache->lookupAny( query, ret ) )
+    return ret;
+
+  librpmDb::db_const_iterator it;
+  switch ( query_r )
+  {
+    case BY_FILE:		ret = it.findByFile( arg_r );		break;
+    case BY_PROVIDES:		ret = it.findByProvides( arg_r );	break;
+    case BY_REQUIREDBY:		ret = it.findByRequiredBy( arg_r );	break;
+    case BY_CONFLICTS:		ret = it.findByConflicts( arg_r );	break;
+    case BY_NAME:		ret = it.findByName( arg_r );		break;
+  }
+  if ( useCache && ! it.dbError() )
+    _headerCache->rememberAny( query, ret );
+  return ret;
+}
+
 ///////////////////////////////////////////////////////////////////
 //
 //
@@ -1301,20 +1610,19 @@ RpmDb::fileList( const std::string & name_r, const Edition & edition_r ) const
 //
 bool RpmDb::hasFile( const std::string & file_r, const std::string & name_r ) const
 {
-  librpmDb::db_const_iterator it;
-  bool res;
-  do
+  std::vector<RpmHeader::constPtr> headers;
+  queryHeaders( BY_FILE, file_r, headers );
+  if ( headers.empty() )
+    return false;
+  if ( ! name_r.empty() )
   {
-    res = it.findByFile( file_r );
-    if (!res) break;
-    if (!name_r.empty())
+    for ( const RpmHeader::constPtr & header : headers )
     {
-      res = (it->tag_name() == name_r);
+      if ( header->tag_name() != name_r )
+        return false;
     }
-    ++it;
   }
-  while (res && *it);
-  return res;
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1327,12 +1635,9 @@ bool RpmDb::hasFile( const std::string & file_r, const std::string & name_r ) co
 //
 std::string RpmDb::whoOwnsFile( const std::string & file_r) const
 {
-  librpmDb::db_const_iterator it;
-  if (it.findByFile( file_r ))
-  {
-    return it->tag_name();
-  }
-  return "";
+  std::vector<RpmHeader::constPtr> headers;
+  queryHeaders( BY_FILE, file_r, headers );
+  return headers.empty() ? "" : headers.front()->tag_name();
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1345,8 +1650,7 @@ std::string RpmDb::whoOwnsFile( const std::string & file_r) const
 //
 bool RpmDb::hasProvides( const std::string & tag_r ) const
 {
-  librpmDb::db_const_iterator it;
-  return it.findByProvides( tag_r );
+  return queryAny( BY_PROVIDES, tag_r );
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1359,8 +1663,7 @@ bool RpmDb::hasProvides( const std::string & tag_r ) const
 //
 bool RpmDb::hasRequiredBy( const std::string & tag_r ) const
 {
-  librpmDb::db_const_iterator it;
-  return it.findByRequiredBy( tag_r );
+  return queryAny( BY_REQUIREDBY, tag_r );
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1373,8 +1676,7 @@ bool RpmDb::hasRequiredBy( const std::string & tag_r ) const
 //
 bool RpmDb::hasConflicts( const std::string & tag_r ) const
 {
-  librpmDb::db_const_iterator it;
-  return it.findByConflicts( tag_r );
+  return queryAny( BY_CONFLICTS, tag_r );
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1387,8 +1689,9 @@ bool RpmDb::hasConflicts( const std::string & tag_r ) const
 //
 bool RpmDb::hasPackage( const std::string & name_r ) const
 {
-  librpmDb::db_const_iterator it;
-  return it.findPackage( name_r );
+  RpmHeader::constPtr header;
+  findPackage( name_r, header );
+  return header != nullptr;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1401,8 +1704,9 @@ bool RpmDb::hasPackage( const std::string & name_r ) const
 //
 bool RpmDb::hasPackage( const std::string & name_r, const Edition & ed_r ) const
 {
-  librpmDb::db_const_iterator it;
-  return it.findPackage( name_r, ed_r );
+  RpmHeader::constPtr header;
+  findPackage( name_r, ed_r, header );
+  return header != nullptr;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1416,11 +1720,9 @@ bool RpmDb::hasPackage( const std::string & name_r, const Edition & ed_r ) const
 void RpmDb::getData( const std::string & name_r,
                      RpmHeader::constPtr & result_r ) const
 {
-  librpmDb::db_const_iterator it;
-  it.findPackage( name_r );
-  result_r = *it;
-  if (it.dbError())
-    ZYPP_THROW(*(it.dbError()));
+  shared_ptr<RpmException> err( findPackage( name_r, result_r ) );
+  if ( err )
+    ZYPP_THROW(*err);
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1434,11 +1736,59 @@ void RpmDb::getData( const std::string & name_r,
 void RpmDb::getData( const std::string & name_r, const Edition & ed_r,
                      RpmHeader::constPtr & result_r ) const
 {
-  librpmDb::db_const_iterator it;
-  it.findPackage( name_r, ed_r  );
-  result_r = *it;
-  if (it.dbError())
-    ZYPP_THROW(*(it.dbError()));
+  shared_ptr<RpmException> err( findPackage( name_r, ed_r, result_r ) );
+  if ( err )
+    ZYPP_THROW(*err);
+}
+
+///////////////////////////////////////////////////////////////////
+//
+//
+//	METHOD NAME : RpmDb::findPackage
+//	METHOD TYPE : shared_ptr<RpmException>
+//
+//	DESCRIPTION : Same as librpmDb::db_const_iterator::findPackage,
+//		      but using queryHeaders.
+//
+shared_ptr<RpmException> RpmDb::findPackage( const std::string & name_r, RpmHeader::constPtr & result_r ) const
+{
+  result_r = 0;
+  std::vector<RpmHeader::constPtr> headers;
+  shared_ptr<RpmException> err( queryHeaders( BY_NAME, name_r, headers ) );
+  if ( headers.size() == 1 )
+  {
+    result_r = headers.front();
+  }
+  else
+  {
+    // check installtime on multiple entries
+    time_t itime = 0;
+    for ( const RpmHeader::constPtr & header : headers )
+    {
+      if ( header->tag_installtime() > itime )
+      {
+        result_r = header;
+        itime = header->tag_installtime();
+      }
+    }
+  }
+  return err;
+}
+
+shared_ptr<RpmException> RpmDb::findPackage( const std::string & name_r, const Edition & ed_r, RpmHeader::constPtr & result_r ) const
+{
+  result_r = 0;
+  std::vector<RpmHeader::constPtr> headers;
+  shared_ptr<RpmException> err( queryHeaders( BY_NAME, name_r, headers ) );
+  for ( const RpmHeader::constPtr & header : headers )
+  {
+    if ( ed_r == header->tag_edition() )
+    {
+      result_r = header;
+      break;
+    }
+  }
+  return err;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -1486,6 +1836,7 @@ namespace
 
 
 } // namespace
+
 ///////////////////////////////////////////////////////////////////
 //
 //	METHOD NAME : RpmDb::checkPackage
@@ -1500,10 +1851,36 @@ RpmDb::CheckPackageResult RpmDb::checkPackage( const Pathname & path_r, CheckPac
     return CHK_ERROR;
   }
 
-  FD_t fd = ::Fopen( file.asString().c_str(), "r.ufdio" );
+  struct stat st;
+  bool useCache = _checkPackageCache->validate( rpmdbStamp( root(), dbPath() ) );
+  if ( useCache && ::stat( path_r.c_str(), &st ) == 0 )
+  {
+    CheckPackageResult ret = CHK_ERROR;
+    if ( _checkPackageCache->lookup( path_r, st, ret, detail_r ) )
+    {
+      DBG << "Remembered check result " << ret << " for " << path_r << endl;
+      return ret;
+    }
+  }
+  else
+  {
+    st.st_ino = 0;
+  }
+
+  CheckPackageDetail detail;
+  CheckPackageResult ret = doCheckPackage( path_r, detail );
+  if ( useCache && st.st_ino )
+    _checkPackageCache->remember( path_r, st, ret, detail );
+  detail_r.insert( detail_r.end(), std::make_move_iterator( detail.begin() ), std::make_move_iterator( detail.end() ) );
+  return ret;
+}
+
+RpmDb::CheckPackageResult RpmDb::doCheckPackage( const Pathname & path_r, CheckPackageDetail & detail_r )
+{
+  FD_t fd = ::Fopen( path_r.c_str(), "r.ufdio" );
   if ( fd == 0 || ::Ferror(fd) )
   {
-    ERR << "Can't open file for reading: " << file << " (" << ::Fstrerror(fd) << ")" << endl;
+    ERR << "Can't open file for reading: " << path_r << " (" << ::Fstrerror(fd) << ")" << endl;
     if ( fd )
       ::Fclose( fd );
     return CHK_ERROR;
@@ -29,6 +29,7 @@
 #include "zypp/target/rpm/RpmFlags.h"
 #include "zypp/target/rpm/RpmHeader.h"
 #include "zypp/target/rpm/RpmCallbacks.h"
+#include "zypp/target/rpm/RpmException.h"
 #include "zypp/ZYppCallbacks.h"
 
 namespace zypp
@@ -402,6 +403,35 @@ private:
   /** whether <_root>/<WARNINGMAILPATH> was already created */
   bool _warndirexists;
 
+  /** Remembered \ref checkPackage results. */
+  class CheckPackageCache;
+  RW_pointer<CheckPackageCache> _checkPackageCache;
+
+  /** Remembered rpmdb queries and headers. */
+  class HeaderCache;
+  mutable RW_pointer<HeaderCache> _headerCache;
+
+  /** Kinds of rpmdb queries remembered by the \ref HeaderCache. */
+  enum HeaderQuery { BY_FILE, BY_PROVIDES, BY_REQUIREDBY, BY_CONFLICTS, BY_NAME };
+
+  /** Headers of all packages matching \a arg_r in the \a query_r index.
+   * Results are remembered until the rpmdb changes. Returns the error
+   * if the database could not be accessed.
+   */
+  shared_ptr<RpmException> queryHeaders( HeaderQuery query_r, const std::string & arg_r,
+                                         std::vector<RpmHeader::constPtr> & result_r ) const;
+
+  /** Whether anything matches \a arg_r in the \a query_r index.
+   * Stops at the first match; the result is remembered until the rpmdb changes.
+   */
+  bool queryAny( HeaderQuery query_r, const std::string & arg_r ) const;
+
+  /** Header of the most recently installed package \a name_r (or \c NULL). */
+  shared_ptr<RpmException> findPackage( const std::string & name_r, RpmHeader::constPtr & result_r ) const;
+
+  /** Header of package \a name_r with edition \a ed_r (or \c NULL). */
+  shared_ptr<RpmException> findPackage( const std::string & name_r, const Edition & ed_r, RpmHeader::constPtr & result_r ) const;
+
   /**
    * handle rpm messages like "/etc/testrc saved as /etc/testrc.rpmorig"
    *
@@ -446,6 +476,13 @@ public:
   /**
    * Check signature of rpm file on disk.
    *
+   * The result is remembered per file (path, inode, size and mtime) until
+   * the rpmdb, and with it the trusted keyring, changes (by \ref importPubkey,
+   * \ref removePubkey, another process or rpm itself), or the database is
+   * closed. So checking an unchanged file again (e.g. when
+   * retrying a commit or installing packages downloaded in advance) does not
+   * read the file again. \ref CHK_ERROR results are not remembered.
+   *
    * @param path_r which file to check
    * @param detail_r Return detailed rpm log messages
    *
@@ -455,6 +492,12 @@ public:
   /** \overload Ignoring the \a datails_r */
   CheckPackageResult checkPackage( const Pathname & path_r );
 
+private:
+  /** \ref checkPackage calling \c rpmVerifySignatures. */
+  CheckPackageResult doCheckPackage( const Pathname & path_r, CheckPackageDetail & detail_r );
+
+public:
+
   /** install rpm package
    *
    * @param filename file to install
@@ -0,0 +1,95 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/thread/RWMutex.cc
+ */
+#include "zypp/thread/RWMutex.h"
+#include "zypp/thread/MutexException.h"
+#include "zypp/base/Gettext.h"
+
+
+//////////////////////////////////////////////////////////////////////
+namespace zypp
+{ ////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////
+  namespace thread
+  { //////////////////////////////////////////////////////////////////
+
+    // -------------------------------------------------------------
+    RWMutex::RWMutex()
+    {
+      int ret = pthread_rwlock_init(&m_rwlock, NULL);
+      if( ret != 0)
+      {
+        ZYPP_THROW_ERRNO_MSG1(MutexException, ret,
+        _("Can't initialize readers/writer lock"));
+      }
+    }
+
+    // -------------------------------------------------------------
+    RWMutex::~RWMutex()
+    {
+      pthread_rwlock_destroy(&m_rwlock);
+    }
+
+    // -------------------------------------------------------------
+    void RWMutex::lockRead()
+    {
+      int ret = pthread_rwlock_rdlock(&m_rwlock);
+      if( ret != 0)
+      {
+        ZYPP_THROW_ERRNO_MSG1(MutexException, ret,
+        _("Can't acquire the read lock"));
+      }
+    }
+
+    // -------------------------------------------------------------
+    void RWMutex::lockWrite()
+    {
+      int ret = pthread_rwlock_wrlock(&m_rwlock);
+      if( ret != 0)
+      {
+        ZYPP_THROW_ERRNO_MSG1(MutexException, ret,
+        _("Can't acquire the write lock"));
+      }
+    }
+
+    // -------------------------------------------------------------
+    void RWMutex::unlock()
+    {
+      int ret = pthread_rwlock_unlock(&m_rwlock);
+      if( ret != 0)
+      {
+        ZYPP_THROW_ERRNO_MSG1(MutexException, ret,
+        _("Can't release the readers/writer lock"));
+      }
+    }
+
+    // -------------------------------------------------------------
+    bool RWMutex::trylockRead()
+    {
+      return (pthread_rwlock_tryrdlock(&m_rwlock) == 0);
+    }
+
+    // -------------------------------------------------------------
+    bool RWMutex::trylockWrite()
+    {
+      return (pthread_rwlock_trywrlock(&m_rwlock) == 0);
+    }
+
+    //////////////////////////////////////////////////////////////////
+  } // namespace thread
+  ////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////
+} // namespace zypp
+//////////////////////////////////////////////////////////////////////
+/*
+** vim: set ts=2 sts=2 sw=2 ai et:
+*/
@@ -0,0 +1,125 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/thread/RWMutex.h
+ */
+#ifndef   ZYPP_THREAD_RWMUTEX_H
+#define   ZYPP_THREAD_RWMUTEX_H
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/thread/MutexException.h"
+#include <pthread.h>
+
+//////////////////////////////////////////////////////////////////////
+namespace zypp
+{ ////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////
+  namespace thread
+  { //////////////////////////////////////////////////////////////////
+
+    ////////////////////////////////////////////////////////////////
+    //
+    // CLASS NAME : RWMutex
+    //
+    /** A readers/writer lock.
+     *
+     * Any number of readers may hold the lock at the same time, a
+     * writer holds it exclusively. The lock is not recursive.
+     *
+     * \see \ref ReadLock, \ref WriteLock
+     */
+    class RWMutex: public zypp::base::NonCopyable
+    {
+    public:
+      /** Create a new RWMutex object.
+       * \throws MutexException on initialization failure.
+       */
+      RWMutex();
+
+      /** Destroys this RWMutex object.
+       */
+      ~RWMutex();
+
+      /** Acquire shared ownership.
+       * Blocks while a writer holds the lock.
+       * \throws MutexException on failure.
+       */
+      void lockRead();
+
+      /** Acquire exclusive ownership.
+       * Blocks while readers or a writer hold the lock.
+       * \throws MutexException on failure.
+       */
+      void lockWrite();
+
+      /** Release the ownership acquired by \ref lockRead or \ref lockWrite.
+       * \throws MutexException if the current thread does not own the lock.
+       */
+      void unlock();
+
+      /** Try to acquire shared ownership without blocking. */
+      bool trylockRead();
+
+      /** Try to acquire exclusive ownership without blocking. */
+      bool trylockWrite();
+
+    private:
+      pthread_rwlock_t m_rwlock;
+    };
+
+    ////////////////////////////////////////////////////////////////
+    /** Holds shared ownership of a \ref RWMutex while in scope. */
+    class ReadLock: public zypp::base::NonCopyable
+    {
+    public:
+      explicit ReadLock( RWMutex & mutex_r )
+        : m_mutex( mutex_r )
+      { m_mutex.lockRead(); }
+
+      ~ReadLock()
+      {
+        try { m_mutex.unlock(); }
+        catch( ... ) {} // don't let exceptions escape
+      }
+
+    private:
+      RWMutex & m_mutex;
+    };
+
+    ////////////////////////////////////////////////////////////////
+    /** Holds exclusive ownership of a \ref RWMutex while in scope. */
+    class WriteLock: public zypp::base::NonCopyable
+    {
+    public:
+      explicit WriteLock( RWMutex & mutex_r )
+        : m_mutex( mutex_r )
+      { m_mutex.lockWrite(); }
+
+      ~WriteLock()
+      {
+        try { m_mutex.unlock(); }
+        catch( ... ) {} // don't let exceptions escape
+      }
+
+    private:
+      RWMutex & m_mutex;
+    };
+
+    //////////////////////////////////////////////////////////////////
+  } // namespace thread
+  ////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////
+} // namespace zypp
+//////////////////////////////////////////////////////////////////////
+
+#endif // ZYPP_THREAD_RWMUTEX_H
+/*
+** vim: set ts=2 sts=2 sw=2 ai et:
+*/
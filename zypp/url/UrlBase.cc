@@ -13,9 +13,12 @@
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Regex.h"
+#include "zypp/thread/MutexLock.h"
 
 #include <stdexcept>
 #include <climits>
+#include <map>
+#include <unordered_set>
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -141,7 +144,158 @@ namespace zypp
     namespace // anonymous
     {
 
-			// -------------------------------------------------------------
+      // -------------------------------------------------------------
+      /*
+      ** Guards the caches below; urls are created in any thread.
+      */
+      inline thread::Mutex &
+      cacheMutex()
+      {
+        static thread::Mutex _mutex;
+        return _mutex;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** Compiled regexes used by checkUrlData, keyed by pattern.
+      ** The patterns come from the scheme configuration, so there
+      ** are just a few of them. Entries are never removed, so the
+      ** returned reference stays valid.
+      */
+      inline const str::regex &
+      compiledRegex(const std::string &regx)
+      {
+        static std::map<std::string, shared_ptr<str::regex> > _cache;
+        thread::MutexLock lock( cacheMutex());
+        shared_ptr<str::regex> &ret( _cache[regx]);
+        if( !ret)
+          ret.reset( new str::regex(regx));
+        return *ret;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** Locale independent character classes.
+      */
+      inline bool isAsciiAlpha(char c)
+      { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+      inline bool isAsciiDigit(char c)
+      { return c >= '0' && c <= '9'; }
+
+      inline bool isAsciiAlnum(char c)
+      { return isAsciiAlpha(c) || isAsciiDigit(c); }
+
+      inline bool isAsciiHex(char c)
+      { return isAsciiDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+      // -------------------------------------------------------------
+      /*
+      ** Same as matching RX_VALID_SCHEME.
+      */
+      bool
+      matchValidScheme(const std::string &scheme)
+      {
+        if( scheme.empty() || !isAsciiAlpha(scheme[0]))
+          return false;
+        for(std::string::size_type i = 1; i < scheme.size(); ++i)
+        {
+          char c = scheme[i];
+          if( !isAsciiAlnum(c) && c != '.' && c != '+' && c != '-')
+            return false;
+        }
+        return true;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** Same as matching RX_VALID_PORT.
+      */
+      bool
+      matchValidPort(const std::string &port)
+      {
+        if( port.empty() || port.size() > 5)
+          return false;
+        for(std::string::size_type i = 0; i < port.size(); ++i)
+        {
+          if( !isAsciiDigit(port[i]))
+            return false;
+        }
+        return true;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** A bracketed host consisting of IPv6 address characters.
+      ** Together with inet_pton the same as matching RX_VALID_HOSTIPV6.
+      */
+      bool
+      matchBracketedIPv6(const std::string &host)
+      {
+        if( host.size() < 3 || host[0] != '[' || host[host.size()-1] != ']')
+          return false;
+        for(std::string::size_type i = 1; i < host.size()-1; ++i)
+        {
+          char c = host[i];
+          if( !isAsciiHex(c) && c != ':' && c != '.')
+            return false;
+        }
+        return true;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** Same as matching RX_VALID_HOSTNAME.
+      ** [[:alnum:]] is locale dependent, so hostnames containing
+      ** non ASCII characters are still matched by the regex.
+      */
+      bool
+      matchValidHostname(const std::string &host)
+      {
+        bool sep = true;        // at start or after a separator
+        for(std::string::size_type i = 0; i < host.size(); ++i)
+        {
+          char c = host[i];
+          if( c & 0x80)
+          {
+            try
+            {
+              return str::regex_match(host, compiledRegex(RX_VALID_HOSTNAME));
+            }
+            catch( ... )
+            {}
+            return false;
+          }
+          if( c == '.' || c == '-')
+          {
+            if( sep)
+              return false;
+            sep = true;
+          }
+          else if( isAsciiAlnum(c))
+            sep = false;
+          else
+            return false;
+        }
+        return !sep;
+      }
+
+      // -------------------------------------------------------------
+      /*
+      ** Hosts already found to be valid. Repo, media and mirror
+      ** urls mention the same few hosts over and over again.
+      ** Access only while holding the cacheMutex.
+      */
+      std::unordered_set<std::string> &
+      knownValidHosts()
+      {
+        static std::unordered_set<std::string> _hosts;
+        return _hosts;
+      }
+
+      const std::unordered_set<std::string>::size_type knownValidHostsMax = 1024;
+
+      // -------------------------------------------------------------
       inline void
       checkUrlData(const std::string &data,
                    const std::string &name,
@@ -159,8 +313,7 @@ namespace zypp
           bool valid = false;
           try
           {
-            str::regex rex(regx);
-            valid = str::regex_match(data, rex);
+            valid = str::regex_match(data, compiledRegex(regx));
           }
           catch( ... )
           {}
@@ -373,18 +526,8 @@ namespace zypp
     bool
     UrlBase::isValidScheme(const std::string &scheme) const
     {
-      bool valid = false;
-      try
-      {
-        str::regex rex(RX_VALID_SCHEME);
-        valid = str::regex_match(scheme, rex);
-      }
-      catch( ... )
-      {}
-
-      if(valid)
+      if( matchValidScheme(scheme))
       {
-        std::string    lscheme( str::toLower(scheme));
         UrlSchemes     schemes( getKnownSchemes());
 
         if( schemes.empty())
@@ -393,7 +536,7 @@ namespace zypp
         UrlSchemes::const_iterator s;
         for(s=schemes.begin(); s!=schemes.end(); ++s)
         {
-          if( lscheme == str::toLower(*s))
+          if( str::compareCI(scheme, *s) == 0)
             return true;
         }
       }
@@ -1324,28 +1467,35 @@ namespace zypp
     bool
     UrlBase::isValidHost(const std::string &host) const
     {
-      try
       {
-        str::regex regx(RX_VALID_HOSTIPV6);
-        if( str::regex_match(host, regx))
-        {
-          struct in6_addr ip;
-          std::string temp( host.substr(1, host.size()-2));
+        thread::MutexLock lock( cacheMutex());
+        if( knownValidHosts().count(host))
+          return true;
+      }
 
-          return inet_pton(AF_INET6, temp.c_str(), &ip) > 0;
-        }
-        else
-        {
-          // matches also IPv4 dotted-decimal adresses...
-          std::string temp( zypp::url::decode(host));
-          str::regex  regx(RX_VALID_HOSTNAME);
-          return str::regex_match(temp, regx);
-        }
+      bool valid = false;
+      if( matchBracketedIPv6(host))
+      {
+        struct in6_addr ip;
+        std::string temp( host.substr(1, host.size()-2));
+
+        valid = inet_pton(AF_INET6, temp.c_str(), &ip) > 0;
+      }
+      else
+      {
+        // matches also IPv4 dotted-decimal adresses...
+        valid = matchValidHostname(zypp::url::decode(host));
       }
-      catch( ... )
-      {}
 
-      return false;
+      if( valid)
+      {
+        thread::MutexLock lock( cacheMutex());
+        std::unordered_set<std::string> &known( knownValidHosts());
+        if( known.size() >= knownValidHostsMax)
+          known.clear();
+        known.insert(host);
+      }
+      return valid;
     }
 
 
@@ -1353,17 +1503,11 @@ namespace zypp
     bool
     UrlBase::isValidPort(const std::string &port) const
     {
-      try
+      if( matchValidPort(port))
       {
-        str::regex regx(RX_VALID_PORT);
-        if( str::regex_match(port, regx))
-        {
-          long pnum = str::strtonum<long>(port);
-          return ( pnum >= 1 && pnum <= USHRT_MAX);
-        }
+        long pnum = str::strtonum<long>(port);
+        return ( pnum >= 1 && pnum <= USHRT_MAX);
       }
-      catch( ... )
-      {}
       return false;
     }
 
@@ -18,6 +18,7 @@
 #include "zypp/zypp_detail/ZYppImpl.h"
 #include "zypp/target/TargetImpl.h"
 #include "zypp/ZYpp.h"
+#include "zypp/ZYppFactory.h"
 #include "zypp/DiskUsageCounter.h"
 #include "zypp/ZConfig.h"
 #include "zypp/sat/Pool.h"
@@ -149,6 +150,9 @@ namespace zypp
     {
       setenv( "ZYPP_IS_RUNNING", str::numstring(getpid()).c_str(), 1 );
 
+      // if the lock was released (e.g. by the PackagePrefetcher) we must get it back
+      ZYppFactory::instance().reacquireLock();
+
       if ( getenv("ZYPP_TESTSUITE_FAKE_ARCH") )
       {
         ZYPP_THROW( Exception("ZYPP_TESTSUITE_FAKE_ARCH set. Commit not allowed and disabled.") );